@@ -1,6 +1,9 @@
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cinttypes>
+#include <climits>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdint>
@@ -8,12 +11,20 @@
 #include <cstring>
 #include <ctime>
 #include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <fcntl.h>
+#include <netdb.h>
 #include <poll.h>
 #include <signal.h>
+#include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -37,9 +48,18 @@ namespace {
     bool logAppend { };
     FILE *logFile { };
 
+    uint64_t coalesceWindowNs { };   // non-zero if info lines are coalesced
+    bool binaryOutput { };           // output binary frames instead of text lines
+    std::string daemonAddress { };   // non-empty in daemon mode
+    std::string daemonSocketPath { }; // unix socket to remove on exit
+    std::string daemonToken { };     // shared secret the clients must send first
+
+    constexpr const char *streamNames[] { "STATUS", "STDIN ", "STDOUT", "STDERR" };
+
     void print_usage()
     {
         puts("Usage: cuteseal-remote-runner [options] <engine> [engine-options ...]\n"
+             "       cuteseal-remote-runner [options] -d <address>\n"
              "\n"
              "Run engine and tag all input and output with time stamps. This is\n"
              "intended for lag elimination when running engines over a high-latency\n"
@@ -49,6 +69,21 @@ namespace {
              "-h         This help.\n"
              "-l <file>  Log output to a file. Truncate existing log.\n"
              "-la <file> Log output to a file. Append to existing log.\n"
+             "-c <ms>    Coalesce engine 'info' lines. An info line is held back for up\n"
+             "           to <ms> milliseconds and dropped if a newer line of the same\n"
+             "           kind (with a score or pv, or progress only) with the same\n"
+             "           multipv index and depth arrives meanwhile. A line with a new\n"
+             "           depth and all other lines are sent at once, after the held\n"
+             "           lines.\n"
+             "-b         Binary output. After a 'CUTESEAL-BINARY 1' line, every output line\n"
+             "           is sent as a frame: payload length (32 bits), stream (8 bits,\n"
+             "           0=STATUS 1=STDIN 2=STDOUT 3=STDERR), time in ns (64 bits), all\n"
+             "           little-endian, followed by the payload without a newline.\n"
+             "           Frames are written in batches. Not available in daemon mode.\n"
+             "-d <addr>  Daemon mode. Listen for connections on <addr>, which is either\n"
+             "           'tcp:[<host>:]<port>' or 'unix:<path>'. Without a host the daemon\n"
+             "           listens on 127.0.0.1 only. A TCP daemon needs a shared secret in\n"
+             "           the environment variable CUTESEAL_TOKEN.\n"
              "\n"
              "What the runner essentially does is as follows:\n"
              "- Launches the engine\n"
@@ -76,13 +111,38 @@ namespace {
              "       LINE         is the line sent or received\n"
              "\n"
              "If line starts with 'cuteseal-deadline <ns>', then the runner will expect that\n"
-             "the engine sends 'bestmove' command before the number of nanosecs has passed.\n"
-             "If bestmove is not sent in time, the runner will send 'STATUS TIMEOUT' message,\n"
-             "which the server-side will consider as a forfeit. This replaces the server-side\n"
-             "timer-based timeout mechanism. The prefix 'cutechess-deadline <ns>' is not sent\n"
-             "to the engine.\n"
+             "the engine sends its move before the number of nanosecs has passed. The move is\n"
+             "'bestmove' for UCI engines and 'move', 'resign' or a game result for xboard\n"
+             "engines. If the move is not sent in time, the runner will send 'STATUS TIMEOUT'\n"
+             "message, which the server-side will consider as a forfeit. This replaces the\n"
+             "server-side timer-based timeout mechanism. The prefix 'cutechess-deadline <ns>'\n"
+             "is not sent to the engine.\n"
              "\n"
              "Send signal USR1 to cuteseal-remote-runner process to request a status report.\n"
+             "\n"
+             "In daemon mode the runner serves any number of engine sessions over one\n"
+             "persistent connection, so that starting an engine does not need a new\n"
+             "connection. The client sends these commands:\n"
+             "\n"
+             "AUTH <token>                                   authenticate\n"
+             "OPEN <session> <engine> [engine-options ...]   launch an engine\n"
+             "IN <session> LINE                              send LINE to the engine\n"
+             "CLOSE <session>                                kill the engine\n"
+             "STATUS                                         request a status report\n"
+             "\n"
+             "If the daemon has a token (CUTESEAL_TOKEN), the first command must be AUTH\n"
+             "with the same token, otherwise the client is disconnected. Anyone who can\n"
+             "authenticate can run any command on the host with OPEN, so the token must\n"
+             "be kept secret and a TCP port should not be exposed to untrusted networks.\n"
+             "\n"
+             "where <session> is a client-chosen token without spaces. The output of a\n"
+             "session uses the format above with the session as the first field:\n"
+             "\n"
+             "<session> <line-num> <time-in-ns> <stream> LINE\n"
+             "\n"
+             "The line numbers run separately for each session. 'STATUS CLOSED' is the\n"
+             "last line of a session. Messages that don't belong to a session use \"*\"\n"
+             "as the session.\n"
             );
     }
 
@@ -104,23 +164,107 @@ namespace {
         sigExitSigNum.store(signum, std::memory_order_relaxed);
     }
 
-    void timedPrintLine(Stream stream, const char *fmt, ...)
+    std::string vformatLine(const char *fmt, va_list ap);
+
+    // queues binary frames and writes them with as few writev() calls as possible
+    class FrameWriter
+    {
+    private:
+        static constexpr size_t headerSize { 13 };
+
+        std::vector<std::array<uint8_t, headerSize>> headers;
+        std::vector<std::string> payloads;
+
+    public:
+        void add(Stream stream, uint64_t ns, std::string payload)
+        {
+            std::array<uint8_t, headerSize> header;
+            const uint32_t len { static_cast<uint32_t>(payload.size()) };
+
+            for (size_t i = 0; i < 4; ++i) {
+                header[i] = static_cast<uint8_t>(len >> (i * 8));
+            }
+            header[4] = static_cast<uint8_t>(stream);
+            for (size_t i = 0; i < 8; ++i) {
+                header[5 + i] = static_cast<uint8_t>(ns >> (i * 8));
+            }
+
+            headers.push_back(header);
+            payloads.push_back(std::move(payload));
+        }
+
+        // returns false on a write error; the queue is dropped either way
+        bool flush(int fd)
+        {
+            std::vector<iovec> iov;
+            iov.reserve(headers.size() * 2);
+            for (size_t i = 0; i < headers.size(); ++i) {
+                iov.push_back(iovec { headers[i].data(), headerSize });
+                if (!payloads[i].empty()) {
+                    iov.push_back(iovec { &payloads[i][0], payloads[i].size() });
+                }
+            }
+
+            bool good { true };
+            size_t first { };
+            while (first < iov.size()) {
+                const int count { static_cast<int>(std::min<size_t>(iov.size() - first, IOV_MAX)) };
+                ssize_t wlen { writev(fd, &iov[first], count) };
+                if (wlen < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    good = false;
+                    break;
+                }
+
+                // skip the written buffers and adjust a partially written one
+                while (first < iov.size() && static_cast<size_t>(wlen) >= iov[first].iov_len) {
+                    wlen -= iov[first].iov_len;
+                    ++first;
+                }
+                if (first < iov.size()) {
+                    iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + wlen;
+                    iov[first].iov_len -= wlen;
+                }
+            }
+
+            headers.clear();
+            payloads.clear();
+            return good;
+        }
+    };
+
+    FrameWriter frameOut;
+
+    void flushOutput()
     {
-        constexpr const char *streamNames[] { "STATUS", "STDIN ", "STDOUT", "STDERR" };
+        if (binaryOutput) {
+            frameOut.flush(STDOUT_FILENO);
+        }
+    }
 
+    void timedPrintLine(Stream stream, const char *fmt, ...)
+    {
         va_list ap;
         const uint64_t ns { getClockNs() };
 
-        printf("%" PRIu64 " %" PRIu64 " %s ",
-               outCmdCounter,
-               ns,
-               streamNames[static_cast<size_t>(stream)]);
+        if (binaryOutput) {
+            va_start(ap, fmt);
+            frameOut.add(stream, ns, vformatLine(fmt, ap));
+            va_end(ap);
+        } else {
+            printf("%" PRIu64 " %" PRIu64 " %s ",
+                   outCmdCounter,
+                   ns,
+                   streamNames[static_cast<size_t>(stream)]);
 
-        va_start(ap, fmt);
-        vprintf(fmt, ap);
-        va_end(ap);
+            va_start(ap, fmt);
+            vprintf(fmt, ap);
+            va_end(ap);
 
-        puts(""); // newline
+            puts(""); // newline
+        }
 
         if (logFile) {
             fprintf(logFile, "%" PRIu64 " %" PRIu64 " %s ",
@@ -171,11 +315,22 @@ namespace {
             }
         }
 
+        int getFd() const
+        {
+            return fd;
+        }
+
         int getError() const
         {
             return streamError;
         }
 
+        // return: true if data that has been read is still waiting to be processed
+        bool hasBufferedData() const
+        {
+            return bufpos < buflen;
+        }
+
         // return: true if line is available
         bool tryReadLine(std::string &line)
         {
@@ -218,7 +373,7 @@ namespace {
         }
     };
 
-    void printStatus(uint64_t bestmoveDeadlineNs)
+    void printStatus(uint64_t bestmoveDeadlineNs, uint64_t droppedInfoLines)
     {
         if (bestmoveDeadlineNs == 0) {
             timedPrintLine(Stream::STATUS, "REPORT Runner alive");
@@ -228,6 +383,280 @@ namespace {
             timedPrintLine(Stream::STATUS, "REPORT Runner alive, bestmove deadline in %" PRId64 " ns",
                            std::max<int64_t>(0, nsLeft));
         }
+
+        if (coalesceWindowNs != 0) {
+            timedPrintLine(Stream::STATUS, "REPORT Dropped %" PRIu64 " superseded info lines", droppedInfoLines);
+        }
+    }
+
+    // shortens the poll timeout so that poll returns by deadlineNs (0 = none)
+    void limitPollTimeout(int &pollDeadlineMs, uint64_t deadlineNs)
+    {
+        if (deadlineNs == 0) {
+            return;
+        }
+
+        const int64_t nsLeft = deadlineNs - getClockNs();
+        const int ms {
+            nsLeft <= 0 ? 0 : static_cast<int>(std::min<int64_t>(std::numeric_limits<int>::max(),
+                                                                  (nsLeft + 999999) / 1000000)) };
+        if (pollDeadlineMs < 0 || ms < pollDeadlineMs) {
+            pollDeadlineMs = ms;
+        }
+    }
+
+    // Holds back superseded 'info' lines of an engine for up to coalesceWindowNs.
+    // bestmove and the other lines are never held back; they first flush the
+    // pending info lines so the order of the output is kept.
+    class InfoCoalescer
+    {
+    private:
+        // a line only supersedes a line of the same multipv index and kind:
+        // search results (score or pv) or progress (currmove, nodes, ...)
+        using Key = std::pair<int, bool>;
+
+        struct Pending
+        {
+            uint64_t seq;
+            std::string line;
+        };
+
+        std::map<Key, Pending> pending;     // latest unsent line per key
+        std::map<int, int> sentDepth;       // depth of the last sent line per multipv
+        uint64_t nextSeq { };               // keeps the pending lines in arrival order
+        uint64_t flushDeadlineNs { };       // positive if lines are pending
+        uint64_t droppedTotal { };
+        uint64_t droppedUnreported { };
+
+        // return: true if the line can be coalesced
+        static bool parseInfo(const std::string &line, int &multipv, int &depth, bool &result)
+        {
+            if (line.compare(0, 5, "info ") != 0) {
+                return false;
+            }
+
+            multipv = 1;
+            depth = -1;
+            result = false;
+
+            const char *str { line.c_str() + 5 };
+            char token[32];
+            int chars { };
+            while (sscanf(str, "%31s%n", token, &chars) == 1) {
+                str += chars;
+                if (strcmp(token, "string") == 0) {
+                    return false; // free text is always sent
+                } else if (strcmp(token, "depth") == 0) {
+                    sscanf(str, "%d", &depth);
+                } else if (strcmp(token, "multipv") == 0) {
+                    sscanf(str, "%d", &multipv);
+                } else if (strcmp(token, "score") == 0 || strcmp(token, "pv") == 0) {
+                    result = true;
+                }
+            }
+
+            return true;
+        }
+
+        void drop()
+        {
+            ++droppedTotal;
+            ++droppedUnreported;
+        }
+
+    public:
+        // the lines to send now are appended to 'out'
+        void push(const std::string &line, std::vector<std::string> &out)
+        {
+            int multipv { };
+            int depth { };
+            bool result { };
+
+            if (coalesceWindowNs == 0 || !parseInfo(line, multipv, depth, result)) {
+                flush(out);
+                out.push_back(line);
+                return;
+            }
+
+            const auto sent = sentDepth.find(multipv);
+            if (depth >= 0 && (sent == sentDepth.end() || sent->second != depth)) {
+                // a new depth is sent at once, after the last lines of the previous one
+                flush(out);
+                sentDepth[multipv] = depth;
+                out.push_back(line);
+                return;
+            }
+
+            Pending &slot { pending[Key { multipv, result }] };
+            if (!slot.line.empty()) {
+                drop();
+            }
+            slot.seq = nextSeq++;
+            slot.line = line;
+
+            if (flushDeadlineNs == 0) {
+                flushDeadlineNs = getClockNs() + coalesceWindowNs;
+            }
+        }
+
+        // sends the pending lines if the window has passed
+        void poll(std::vector<std::string> &out)
+        {
+            if (flushDeadlineNs != 0 && getClockNs() >= flushDeadlineNs) {
+                flush(out);
+            }
+        }
+
+        void flush(std::vector<std::string> &out)
+        {
+            std::vector<Pending *> lines;
+            for (auto &entry : pending) {
+                lines.push_back(&entry.second);
+            }
+            std::sort(lines.begin(), lines.end(),
+                      [](const Pending *a, const Pending *b) { return a->seq < b->seq; });
+            for (Pending *p : lines) {
+                out.push_back(std::move(p->line));
+            }
+            pending.clear();
+            flushDeadlineNs = 0;
+        }
+
+        // the search has ended; the first line of every depth of the next
+        // search is sent at once again
+        void endSearch()
+        {
+            sentDepth.clear();
+        }
+
+        uint64_t getFlushDeadline() const
+        {
+            return flushDeadlineNs;
+        }
+
+        uint64_t getDropped() const
+        {
+            return droppedTotal;
+        }
+
+        // return: number of lines dropped since the previous call
+        uint64_t takeUnreported()
+        {
+            const uint64_t count { droppedUnreported };
+            droppedUnreported = 0;
+            return count;
+        }
+    };
+
+    // strips a 'cuteseal-deadline <ns>' prefix and sets the bestmove deadline
+    const char *parseDeadline(const char *line, uint64_t &bestmoveDeadlineNs)
+    {
+        if (strncmp("cuteseal-deadline ", line, 18) == 0) {
+            line += 18;
+            int chars = 0;
+            if (sscanf(line, "%" SCNu64 " %n", &bestmoveDeadlineNs, &chars) == 1)
+            {
+                line += chars;
+                bestmoveDeadlineNs += getClockNs(); // convert relative deadline to absolute dealine
+            }
+        }
+
+        return line;
+    }
+
+    // returns true if the engine line ends the search: UCI 'bestmove', or an
+    // xboard move, resignation or result claim
+    bool isMoveReply(const std::string &line)
+    {
+        const std::string command { line.substr(0, line.find(' ')) };
+
+        return command == "bestmove" || command == "move" || command == "resign" ||
+            command == "1-0" || command == "0-1" || command == "1/2-1/2" || command == "*";
+    }
+
+    // returns: engine pid, or -1 on failure with 'failure' set and errno intact
+    pid_t launchEngine(char *const *argv, int &childStdin, int &childStdout, int &childStderr,
+                       const char *&failure)
+    {
+        // [0]=read end; [1]=write end
+        int childIn[2] { -1, -1 };
+        int childOut[2] { -1, -1 };
+        int childErr[2] { -1, -1 };
+
+        if (pipe2(childIn,  O_CLOEXEC)) {
+            failure = "Failed to create STDIN for child";
+            return -1;
+        }
+
+        if (pipe2(childOut, O_CLOEXEC)) {
+            failure = "Failed to create STDOUT for child";
+            close(childIn[0]);
+            close(childIn[1]);
+            return -1;
+        }
+        if (pipe2(childErr, O_CLOEXEC)) {
+            failure = "Failed to create STDERR for child";
+            close(childIn[0]);
+            close(childIn[1]);
+            close(childOut[0]);
+            close(childOut[1]);
+            return -1;
+        }
+
+        pid_t child = fork();
+        if (child < 0) {
+            const int error { errno };
+            for (int fd : { childIn[0], childIn[1], childOut[0], childOut[1], childErr[0], childErr[1] }) {
+                close(fd);
+            }
+            errno = error;
+            failure = "Failed to create a child process";
+            return -1;
+        }
+
+        if (child == 0) {
+            // Note: these use intentionally perror(), as the fork parent will add
+            // the timestamps to the output
+
+            // rebind stdin/out/err - no cloexec for these
+            if (dup2(childIn[0],  STDIN_FILENO) == -1) {
+                perror("Failed to rebind STDIN for child");
+                _exit(126);
+            }
+            if (dup2(childOut[1], STDOUT_FILENO) == -1)  {
+                perror("Failed to rebind STDOUT for child");
+                _exit(126);
+            }
+            if (dup2(childErr[1], STDERR_FILENO) == -1)  {
+                perror("Failed to rebind STDERR for child");
+                _exit(126);
+            }
+
+            if (logFile) {
+                fclose(logFile);
+            }
+
+            // the daemon ignores SIGPIPE, but the engine shouldn't inherit that
+            signal(SIGPIPE, SIG_DFL);
+
+            // launch the engine
+            execvp(argv[0], argv);
+
+            // if we get here, something went wrong
+            perror("Failed to launch the engine");
+            _exit(126);
+        }
+
+        // close the pipe ends that we don't need
+        close(childIn[0]);
+        close(childOut[1]);
+        close(childErr[1]);
+
+        childStdin = childIn[1];
+        childStdout = childOut[0];
+        childStderr = childErr[0];
+
+        return child;
     }
 
     void runLoop(int childStdin, int childStdout, int childStderr)
@@ -238,6 +667,8 @@ namespace {
         bool allStreamsGood { true };
         FdLineBuffer *flbs[3] { &flbIn, &flbOut, &flbErr };
         uint64_t bestmoveDeadlineNs = 0; // positive if we have an active deadline
+        InfoCoalescer coalescer;
+        std::vector<std::string> outLines;
 
         FILE *toChild = fdopen(childStdin, "a");
         if (!toChild) {
@@ -257,20 +688,12 @@ namespace {
             // poll
             constexpr const char *pollEntryNames[std::size(fdsToPoll)] { "Input", "Engine output", "Engine stderr" };
 
-            int pollDeadlineMs;
+            int pollDeadlineMs { -1 };
+            limitPollTimeout(pollDeadlineMs, bestmoveDeadlineNs);
+            limitPollTimeout(pollDeadlineMs, coalescer.getFlushDeadline());
 
-            if (bestmoveDeadlineNs == 0) {
-                // no active DL
-                pollDeadlineMs = -1;
-            } else {
-                // active DL
-                int64_t nsLeft = bestmoveDeadlineNs - getClockNs();
-                if (nsLeft < 0) {
-                    pollDeadlineMs = 0; // one more try, but no wait
-                } else {
-                    pollDeadlineMs = std::min<int>(std::numeric_limits<int>::max(), nsLeft / 1000000);
-                }
-            }
+            // send everything queued so far before we block
+            flushOutput();
 
             if (poll(fdsToPoll, std::size(fdsToPoll), pollDeadlineMs) < 0) {
 
@@ -284,7 +707,7 @@ namespace {
             if (sigExitSigNum.load(std::memory_order_relaxed) != -1) {
                 const int signum = sigExitSigNum.load(std::memory_order_relaxed);
 
-                printStatus(bestmoveDeadlineNs);
+                printStatus(bestmoveDeadlineNs, coalescer.getDropped());
                 timedPrintLine(Stream::STATUS, "INFO Runner received exit signal %d (%s), exitting...", signum, strsignal(signum));
 
                 break; // exit
@@ -292,7 +715,7 @@ namespace {
 
             // status report requested by signal?
             if (sigStatusReport.load(std::memory_order_relaxed)) {
-                printStatus(bestmoveDeadlineNs);
+                printStatus(bestmoveDeadlineNs, coalescer.getDropped());
                 sigStatusReport.store(false, std::memory_order_relaxed);
             }
 
@@ -303,15 +726,7 @@ namespace {
 
                 timedPrintLine(Stream::STDIN, "%s", line);
 
-                if (strncmp("cuteseal-deadline ", line, 18) == 0) {
-                    line += 18;
-                    int chars = 0;
-                    if (sscanf(line, "%" SCNd64 " %n", &bestmoveDeadlineNs, &chars) == 1)
-                    {
-                        line += chars;
-                        bestmoveDeadlineNs += getClockNs(); // convert relative deadline to absolute dealine
-                    }
-                }
+                line = parseDeadline(line, bestmoveDeadlineNs);
 
                 // we'll also send the line to the engine
                 fputs(line, toChild);
@@ -320,14 +735,32 @@ namespace {
             }
 
             while (flbOut.tryReadLine(tmp)) {
-                if (tmp.substr(0, 8) == "bestmove") {
+                const bool bestmove { isMoveReply(tmp) };
+                if (bestmove) {
                     // reset deadline
                     bestmoveDeadlineNs = 0;
                 }
 
-                timedPrintLine(Stream::STDOUT, "%s", tmp.c_str());
+                coalescer.push(tmp, outLines);
+                for (const std::string &outLine : outLines) {
+                    timedPrintLine(Stream::STDOUT, "%s", outLine.c_str());
+                }
+                outLines.clear();
+
+                if (bestmove) {
+                    coalescer.endSearch();
+                    if (const uint64_t dropped { coalescer.takeUnreported() }) {
+                        timedPrintLine(Stream::STATUS, "INFO Dropped %" PRIu64 " superseded info lines", dropped);
+                    }
+                }
             }
 
+            coalescer.poll(outLines);
+            for (const std::string &outLine : outLines) {
+                timedPrintLine(Stream::STDOUT, "%s", outLine.c_str());
+            }
+            outLines.clear();
+
             // deadline check
             if ((bestmoveDeadlineNs > 0) && (getClockNs() > bestmoveDeadlineNs)) {
                 // timeout has been triggered
@@ -354,6 +787,11 @@ namespace {
             }
         }
 
+        coalescer.flush(outLines);
+        for (const std::string &outLine : outLines) {
+            timedPrintLine(Stream::STDOUT, "%s", outLine.c_str());
+        }
+
         if (toChild) {
             fclose(toChild);
         }
@@ -361,6 +799,669 @@ namespace {
         close(childStderr);
     }
 
+    std::string vformatLine(const char *fmt, va_list ap)
+    {
+        va_list ap2;
+        va_copy(ap2, ap);
+        const int len { vsnprintf(nullptr, 0, fmt, ap2) };
+        va_end(ap2);
+
+        if (len <= 0) {
+            return std::string { };
+        }
+
+        std::string str(len + 1, '\0');
+        vsnprintf(&str[0], str.size(), fmt, ap);
+        str.resize(len);
+        return str;
+    }
+
+    struct Session
+    {
+        std::string id;
+        pid_t pid { -1 };
+        int childStdin { -1 };
+        std::string inBuf; // input not yet accepted by the engine
+        std::unique_ptr<FdLineBuffer> flbOut;
+        std::unique_ptr<FdLineBuffer> flbErr;
+        uint64_t lineNum { };
+        uint64_t bestmoveDeadlineNs { }; // positive if we have an active deadline
+        InfoCoalescer coalescer;
+    };
+
+    struct Client
+    {
+        int fd { -1 };
+        std::unique_ptr<FdLineBuffer> flbIn;
+        std::string outBuf; // output not yet accepted by the socket
+        std::map<std::string, std::unique_ptr<Session>> sessions;
+        uint64_t lineNum { }; // for the messages that don't belong to a session
+        bool authenticated { };
+        bool good { true };
+    };
+
+    // a client that lets this much output pile up is considered dead
+    constexpr size_t maxClientBacklog { 64 * 1024 * 1024 };
+
+    // no more commands are read from a client while this much of its output
+    // waits, so the echo of its own input can't overrun the backlog
+    constexpr size_t clientOutputPause { 1024 * 1024 };
+
+    // sends as much of the queued output as the socket accepts without blocking
+    void flushClient(Client &client)
+    {
+        while (client.good && !client.outBuf.empty()) {
+            const ssize_t wlen { write(client.fd, client.outBuf.data(), client.outBuf.size()) };
+            if (wlen > 0) {
+                client.outBuf.erase(0, wlen);
+            } else if (wlen < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else if (!(wlen < 0 && errno == EINTR)) {
+                client.good = false;
+            }
+        }
+    }
+
+    // sends as much of the queued engine input as the pipe accepts without blocking;
+    // returns false if the engine can't take its input
+    bool flushSessionInput(Session &session)
+    {
+        while (!session.inBuf.empty()) {
+            const ssize_t wlen { write(session.childStdin, session.inBuf.data(), session.inBuf.size()) };
+            if (wlen > 0) {
+                session.inBuf.erase(0, wlen);
+            } else if (wlen < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else if (!(wlen < 0 && errno == EINTR)) {
+                // the engine is gone; its output streams report that
+                session.inBuf.clear();
+                break;
+            }
+        }
+
+        return session.inBuf.size() <= maxClientBacklog;
+    }
+
+    // sends a line with the daemon framing: <session> <line-num> <time-in-ns> <stream> LINE
+    void sessionPrintLine(Client &client, const std::string &id, uint64_t &lineNum,
+                          Stream stream, const char *fmt, ...)
+    {
+        char head[64];
+        snprintf(head, sizeof head, " %" PRIu64 " %" PRIu64 " %s ",
+                 lineNum++, getClockNs(), streamNames[static_cast<size_t>(stream)]);
+
+        va_list ap;
+        va_start(ap, fmt);
+        std::string line { id + head + vformatLine(fmt, ap) };
+        va_end(ap);
+
+        if (logFile) {
+            fprintf(logFile, "%d %s\n", client.fd, line.c_str());
+            fflush(logFile);
+        }
+
+        if (!client.good) {
+            return;
+        }
+
+        // the socket is non-blocking, so a slow client doesn't hold up the others
+        line.push_back('\n');
+        client.outBuf += line;
+        if (client.outBuf.size() > maxClientBacklog) {
+            timedPrintLine(Stream::STATUS, "ERROR Client %d is not reading its output", client.fd);
+            client.good = false;
+        }
+    }
+
+    void printSessionStatus(Client &client, Session &session)
+    {
+        if (session.bestmoveDeadlineNs == 0) {
+            sessionPrintLine(client, session.id, session.lineNum, Stream::STATUS,
+                             "REPORT Runner alive, engine pid %d", static_cast<int>(session.pid));
+        }
+        else {
+            const int64_t nsLeft = session.bestmoveDeadlineNs - getClockNs();
+            sessionPrintLine(client, session.id, session.lineNum, Stream::STATUS,
+                             "REPORT Runner alive, engine pid %d, bestmove deadline in %" PRId64 " ns",
+                             static_cast<int>(session.pid), std::max<int64_t>(0, nsLeft));
+        }
+
+        if (coalesceWindowNs != 0) {
+            sessionPrintLine(client, session.id, session.lineNum, Stream::STATUS,
+                             "REPORT Dropped %" PRIu64 " superseded info lines", session.coalescer.getDropped());
+        }
+    }
+
+    void printDaemonStatus(Client &client)
+    {
+        sessionPrintLine(client, "*", client.lineNum, Stream::STATUS,
+                         "REPORT Daemon alive, %zu sessions", client.sessions.size());
+
+        for (auto &entry : client.sessions) {
+            printSessionStatus(client, *entry.second);
+        }
+    }
+
+    void openSession(Client &client, const std::string &id, std::vector<std::string> args)
+    {
+        if (client.sessions.count(id)) {
+            sessionPrintLine(client, "*", client.lineNum, Stream::STATUS,
+                             "ERROR Session %s is already open", id.c_str());
+            return;
+        }
+
+        std::unique_ptr<Session> session { new Session };
+        session->id = id;
+
+        if (args.empty()) {
+            sessionPrintLine(client, id, session->lineNum, Stream::STATUS, "ERROR No engine given");
+            sessionPrintLine(client, id, session->lineNum, Stream::STATUS, "CLOSED");
+            return;
+        }
+
+        std::vector<char *> argv;
+        for (std::string &arg : args) {
+            argv.push_back(&arg[0]);
+        }
+        argv.push_back(nullptr);
+
+        int childStdout { -1 };
+        int childStderr { -1 };
+        const char *failure { };
+
+        session->pid = launchEngine(argv.data(), session->childStdin, childStdout, childStderr, failure);
+        if (session->pid < 0) {
+            const char *error { strerror(errno) };
+            sessionPrintLine(client, id, session->lineNum, Stream::STATUS, "ERROR %s: %s", failure, error);
+            sessionPrintLine(client, id, session->lineNum, Stream::STATUS, "CLOSED");
+            return;
+        }
+
+        // an engine that stops reading must not block the other sessions
+        const int flags { fcntl(session->childStdin, F_GETFL) };
+        if (flags != -1) {
+            fcntl(session->childStdin, F_SETFL, flags | O_NONBLOCK);
+        }
+
+        session->flbOut.reset(new FdLineBuffer { childStdout });
+        session->flbErr.reset(new FdLineBuffer { childStderr });
+
+        sessionPrintLine(client, id, session->lineNum, Stream::STATUS,
+                         "INFO Engine launched with pid %d with the following parameters",
+                         static_cast<int>(session->pid));
+        for (size_t i = 0; i < args.size(); ++i) {
+            sessionPrintLine(client, id, session->lineNum, Stream::STATUS,
+                             "INFO argv[%zu]='%s'", i, args[i].c_str());
+        }
+
+        client.sessions[id] = std::move(session);
+    }
+
+    void closeSession(Client &client, Session &session)
+    {
+        std::vector<std::string> outLines;
+        session.coalescer.flush(outLines);
+        for (const std::string &outLine : outLines) {
+            sessionPrintLine(client, session.id, session.lineNum, Stream::STDOUT, "%s", outLine.c_str());
+        }
+
+        close(session.childStdin);
+        close(session.flbOut->getFd());
+        close(session.flbErr->getFd());
+
+        // make sure the engine dies
+        kill(session.pid, SIGKILL);
+
+        int wstatus { };
+        if (waitpid(session.pid, &wstatus, 0) == session.pid) {
+            if (WIFEXITED(wstatus)) {
+                sessionPrintLine(client, session.id, session.lineNum, Stream::STATUS,
+                                 "INFO Engine has terminated with exit code %d", WEXITSTATUS(wstatus));
+            } else if (WIFSIGNALED(wstatus)) {
+                sessionPrintLine(client, session.id, session.lineNum, Stream::STATUS,
+                                 "INFO Engine has terminated by signal %d (%s)",
+                                 WTERMSIG(wstatus), strsignal(WTERMSIG(wstatus)));
+            } else {
+                sessionPrintLine(client, session.id, session.lineNum, Stream::STATUS,
+                                 "INFO Engine terminated for unknown reason, waitpid status=%d", wstatus);
+            }
+        } else {
+            const char *error { strerror(errno) };
+            sessionPrintLine(client, session.id, session.lineNum, Stream::STATUS,
+                             "ERROR Failed to wait for the child to terminate: %s", error);
+        }
+
+        sessionPrintLine(client, session.id, session.lineNum, Stream::STATUS, "CLOSED");
+    }
+
+    // returns: false if the session has terminated
+    bool serviceSession(Client &client, Session &session)
+    {
+        std::string tmp;
+
+        if (!flushSessionInput(session)) {
+            sessionPrintLine(client, session.id, session.lineNum, Stream::STATUS,
+                             "ERROR Engine is not reading its input");
+            return false;
+        }
+
+        std::vector<std::string> outLines;
+
+        while (session.flbOut->tryReadLine(tmp)) {
+            const bool bestmove { isMoveReply(tmp) };
+            if (bestmove) {
+                // reset deadline
+                session.bestmoveDeadlineNs = 0;
+            }
+
+            session.coalescer.push(tmp, outLines);
+            for (const std::string &outLine : outLines) {
+                sessionPrintLine(client, session.id, session.lineNum, Stream::STDOUT, "%s", outLine.c_str());
+            }
+            outLines.clear();
+
+            if (bestmove) {
+                session.coalescer.endSearch();
+                if (const uint64_t dropped { session.coalescer.takeUnreported() }) {
+                    sessionPrintLine(client, session.id, session.lineNum, Stream::STATUS,
+                                     "INFO Dropped %" PRIu64 " superseded info lines", dropped);
+                }
+            }
+        }
+
+        // an engine that stops talking still gets its last info lines out
+        if (session.flbOut->getError()) {
+            session.coalescer.flush(outLines);
+        } else {
+            session.coalescer.poll(outLines);
+        }
+        for (const std::string &outLine : outLines) {
+            sessionPrintLine(client, session.id, session.lineNum, Stream::STDOUT, "%s", outLine.c_str());
+        }
+
+        // deadline check
+        if ((session.bestmoveDeadlineNs > 0) && (getClockNs() > session.bestmoveDeadlineNs)) {
+            sessionPrintLine(client, session.id, session.lineNum, Stream::STATUS, "TIMEOUT");
+            session.bestmoveDeadlineNs = 0;
+        }
+
+        while (session.flbErr->tryReadLine(tmp)) {
+            sessionPrintLine(client, session.id, session.lineNum, Stream::STDERR, "%s", tmp.c_str());
+        }
+
+        for (FdLineBuffer *flb : { session.flbOut.get(), session.flbErr.get() }) {
+            if (flb->getError()) {
+                sessionPrintLine(client, session.id, session.lineNum, Stream::STATUS,
+                                 "INFO Stream %s has terminated: %s",
+                                 flb == session.flbOut.get() ? "Engine output" : "Engine stderr",
+                                 strerror(flb->getError()));
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // compares the rest of an AUTH command with the daemon's token in constant time
+    bool tokenMatches(const char *line)
+    {
+        while (*line == ' ') {
+            ++line;
+        }
+
+        const size_t len { strlen(line) };
+        unsigned char diff { static_cast<unsigned char>(len != daemonToken.size()) };
+        for (size_t i = 0; i < len; ++i) {
+            diff |= static_cast<unsigned char>(line[i] ^ daemonToken[i % std::max<size_t>(daemonToken.size(), 1)]);
+        }
+
+        return diff == 0;
+    }
+
+    // splits off the next space-separated token from 'str'
+    std::string nextToken(const char *&str)
+    {
+        while (*str == ' ') {
+            ++str;
+        }
+
+        const char *start { str };
+        while (*str != '\0' && *str != ' ') {
+            ++str;
+        }
+
+        return std::string(start, str);
+    }
+
+    void handleCommand(Client &client, const std::string &cmdLine)
+    {
+        const char *line { cmdLine.c_str() };
+        const std::string command { nextToken(line) };
+
+        if (!client.authenticated) {
+            if (command == "AUTH" && tokenMatches(line)) {
+                client.authenticated = true;
+                return;
+            }
+
+            sessionPrintLine(client, "*", client.lineNum, Stream::STATUS, "ERROR Authentication failed");
+            timedPrintLine(Stream::STATUS, "ERROR Client %d failed to authenticate", client.fd);
+            flushClient(client);
+            client.good = false;
+            return;
+        }
+
+        if (command == "AUTH") {
+            return; // already authenticated
+        }
+
+        if (command == "STATUS") {
+            printDaemonStatus(client);
+            return;
+        }
+
+        const std::string id { nextToken(line) };
+        if (id.empty() || id == "*" || !(command == "OPEN" || command == "IN" || command == "CLOSE")) {
+            sessionPrintLine(client, "*", client.lineNum, Stream::STATUS,
+                             "ERROR Bad command: %s", cmdLine.c_str());
+            return;
+        }
+
+        if (command == "OPEN") {
+            std::vector<std::string> args;
+            for (std::string arg { nextToken(line) }; !arg.empty(); arg = nextToken(line)) {
+                args.push_back(arg);
+            }
+            openSession(client, id, args);
+            return;
+        }
+
+        const auto it = client.sessions.find(id);
+        if (it == client.sessions.end()) {
+            sessionPrintLine(client, "*", client.lineNum, Stream::STATUS,
+                             "ERROR Unknown session %s", id.c_str());
+            return;
+        }
+        Session &session { *it->second };
+
+        if (command == "CLOSE") {
+            // pass on what the engine has already said
+            serviceSession(client, session);
+            closeSession(client, session);
+            client.sessions.erase(it);
+            return;
+        }
+
+        // IN: the rest of the line goes to the engine as is
+        if (*line == ' ') {
+            ++line;
+        }
+
+        sessionPrintLine(client, session.id, session.lineNum, Stream::STDIN, "%s", line);
+        line = parseDeadline(line, session.bestmoveDeadlineNs);
+
+        // queued and written when the engine's pipe has room
+        session.inBuf += line;
+        session.inBuf.push_back('\n');
+        flushSessionInput(session);
+    }
+
+    int listenOn(const std::string &address)
+    {
+        if (address.compare(0, 5, "unix:") == 0) {
+            const std::string path { address.substr(5) };
+            sockaddr_un sa { };
+
+            if (path.empty() || path.size() >= sizeof sa.sun_path) {
+                errno = ENAMETOOLONG;
+                return -1;
+            }
+            sa.sun_family = AF_UNIX;
+            strcpy(sa.sun_path, path.c_str());
+
+            const int fd { socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0) };
+            if (fd < 0) {
+                return -1;
+            }
+
+            unlink(path.c_str()); // stale socket from an earlier run
+            if (bind(fd, reinterpret_cast<sockaddr *>(&sa), sizeof sa) || listen(fd, 16)) {
+                const int error { errno };
+                close(fd);
+                errno = error;
+                return -1;
+            }
+
+            daemonSocketPath = path;
+            return fd;
+        }
+
+        if (address.compare(0, 4, "tcp:") == 0) {
+            std::string host { };
+            std::string port { address.substr(4) };
+            const size_t colon { port.rfind(':') };
+            if (colon != std::string::npos) {
+                host = port.substr(0, colon);
+                port = port.substr(colon + 1);
+            }
+            if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+                host = host.substr(1, host.size() - 2);
+            }
+
+            // only local clients unless a host is given; listening on
+            // every interface needs eg. "0.0.0.0" or "[::]"
+            if (host.empty()) {
+                host = "127.0.0.1";
+            }
+
+            addrinfo hints { };
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+
+            addrinfo *result { };
+            if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result)) {
+                errno = EADDRNOTAVAIL;
+                return -1;
+            }
+
+            int fd { -1 };
+            for (addrinfo *ai = result; ai; ai = ai->ai_next) {
+                fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+                if (fd < 0) {
+                    continue;
+                }
+
+                const int one { 1 };
+                setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+                if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, 16) == 0) {
+                    break;
+                }
+
+                close(fd);
+                fd = -1;
+            }
+            freeaddrinfo(result);
+            return fd;
+        }
+
+        errno = EINVAL;
+        return -1;
+    }
+
+    void runDaemon(int listenFd)
+    {
+        std::vector<std::unique_ptr<Client>> clients;
+
+        while (true) {
+            std::vector<pollfd> fdsToPoll;
+            int pollDeadlineMs { -1 };
+
+            fdsToPoll.push_back(pollfd { listenFd, POLLIN, 0 });
+            for (auto &client : clients) {
+                const bool reading { client->outBuf.size() < clientOutputPause };
+                const short events = (reading ? POLLIN | POLLRDHUP : 0) | (client->outBuf.empty() ? 0 : POLLOUT);
+                fdsToPoll.push_back(pollfd { client->fd, events, 0 });
+                if (reading && client->flbIn->hasBufferedData()) {
+                    pollDeadlineMs = 0; // commands left over from a pause
+                }
+
+                for (auto &entry : client->sessions) {
+                    Session &session { *entry.second };
+                    if (!session.inBuf.empty()) {
+                        fdsToPoll.push_back(pollfd { session.childStdin, POLLOUT, 0 });
+                    }
+                    fdsToPoll.push_back(pollfd { session.flbOut->getFd(), POLLIN | POLLRDHUP, 0 });
+                    fdsToPoll.push_back(pollfd { session.flbErr->getFd(), POLLIN | POLLRDHUP, 0 });
+
+                    limitPollTimeout(pollDeadlineMs, session.bestmoveDeadlineNs);
+                    limitPollTimeout(pollDeadlineMs, session.coalescer.getFlushDeadline());
+                }
+            }
+
+            if (poll(fdsToPoll.data(), fdsToPoll.size(), pollDeadlineMs) < 0) {
+
+                if (errno != EINTR) {
+                    timedPerror("Poll failed, aborting");
+                    abort();
+                }
+            }
+
+            // exit signal occurred?
+            if (sigExitSigNum.load(std::memory_order_relaxed) != -1) {
+                const int signum = sigExitSigNum.load(std::memory_order_relaxed);
+                timedPrintLine(Stream::STATUS, "INFO Runner received exit signal %d (%s), exitting...", signum, strsignal(signum));
+                break; // exit
+            }
+
+            // status report requested by signal?
+            if (sigStatusReport.load(std::memory_order_relaxed)) {
+                timedPrintLine(Stream::STATUS, "REPORT Daemon alive, %zu clients", clients.size());
+                for (auto &client : clients) {
+                    printDaemonStatus(*client);
+                }
+                sigStatusReport.store(false, std::memory_order_relaxed);
+            }
+
+            // new client?
+            if (fdsToPoll[0].revents & POLLIN) {
+                const int fd { accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC) };
+                if (fd >= 0) {
+                    std::unique_ptr<Client> client { new Client };
+                    client->fd = fd;
+                    client->authenticated = daemonToken.empty();
+                    client->flbIn.reset(new FdLineBuffer { fd });
+                    timedPrintLine(Stream::STATUS, "INFO Client %d connected", fd);
+                    clients.push_back(std::move(client));
+                } else if (errno != EINTR && errno != EAGAIN) {
+                    timedPerror("Failed to accept a connection");
+                }
+            }
+
+            for (auto &client : clients) {
+                std::string tmp;
+                while (client->good && client->outBuf.size() < clientOutputPause &&
+                       client->flbIn->tryReadLine(tmp)) {
+                    handleCommand(*client, tmp);
+                    flushClient(*client);
+                }
+
+                for (auto it = client->sessions.begin(); it != client->sessions.end(); ) {
+                    if (serviceSession(*client, *it->second)) {
+                        ++it;
+                    } else {
+                        closeSession(*client, *it->second);
+                        it = client->sessions.erase(it);
+                    }
+                }
+
+                if (client->flbIn->getError()) {
+                    client->good = false;
+                }
+
+                flushClient(*client);
+            }
+
+            // drop the disconnected clients and their engines
+            for (auto it = clients.begin(); it != clients.end(); ) {
+                Client &client { **it };
+                if (client.good) {
+                    ++it;
+                    continue;
+                }
+
+                for (auto &entry : client.sessions) {
+                    closeSession(client, *entry.second);
+                }
+                timedPrintLine(Stream::STATUS, "INFO Client %d disconnected, %zu sessions closed",
+                               client.fd, client.sessions.size());
+                close(client.fd);
+                it = clients.erase(it);
+            }
+        }
+
+        for (auto &client : clients) {
+            for (auto &entry : client->sessions) {
+                closeSession(*client, *entry.second);
+            }
+            flushClient(*client);
+            close(client->fd);
+        }
+    }
+
+    void assignSignalHandlers()
+    {
+        struct sigaction sigact { };
+
+        sigact.sa_flags = SA_RESTART;
+
+        sigact.sa_handler = &terminatingSignalHandler;
+        sigaction(SIGTERM, &sigact, NULL);
+        sigaction(SIGINT, &sigact, NULL);
+        sigaction(SIGHUP, &sigact, NULL);
+
+        sigact.sa_handler = &statusSignalHandler;
+        sigaction(SIGUSR1, &sigact, NULL);
+    }
+
+    int daemonMain()
+    {
+        if (const char *token { getenv("CUTESEAL_TOKEN") }) {
+            daemonToken = token;
+        }
+
+        // OPEN runs any command, so a TCP daemon must not be open to everyone
+        if (daemonToken.empty() && daemonAddress.compare(0, 4, "tcp:") == 0) {
+            timedPrintLine(Stream::STATUS, "ERROR A TCP daemon needs a token in CUTESEAL_TOKEN");
+            return 126;
+        }
+
+        const int listenFd { listenOn(daemonAddress) };
+        if (listenFd < 0) {
+            timedPerror("Failed to listen on the daemon address");
+            return 126;
+        }
+
+        timedPrintLine(Stream::STATUS, "INFO Daemon listening on %s", daemonAddress.c_str());
+
+        // a client that goes away must not kill the daemon
+        signal(SIGPIPE, SIG_IGN);
+        assignSignalHandlers();
+
+        runDaemon(listenFd);
+
+        close(listenFd);
+        if (!daemonSocketPath.empty()) {
+            unlink(daemonSocketPath.c_str());
+        }
+
+        if (logFile) {
+            fclose(logFile);
+            logFile = nullptr;
+        }
+
+        return 0;
+    }
+
 } // anonymous namespace
 
 int main(int argc, char **argv)
@@ -390,14 +1491,29 @@ int main(int argc, char **argv)
             argc -= 2;
             logAppend = true;
         }
+        else if (strcmp(argv[0], "-c") == 0 && argc >= 2) {
+            coalesceWindowNs = strtoull(argv[1], nullptr, 10) * 1000000;
+            argv += 2;
+            argc -= 2;
+        }
+        else if (strcmp(argv[0], "-b") == 0) {
+            binaryOutput = true;
+            argv += 1;
+            argc -= 1;
+        }
+        else if (strcmp(argv[0], "-d") == 0 && argc >= 2) {
+            daemonAddress = argv[1];
+            argv += 2;
+            argc -= 2;
+        }
         else {
             print_usage();
             return 127;
         }
     }
 
-    // engine specified after options?
-    if (argc < 1) {
+    // engine specified after options? (the daemon launches engines on request)
+    if (daemonAddress.empty() ? argc < 1 : (argc > 0 || binaryOutput)) {
         print_usage();
         return 127;
     }
@@ -405,96 +1521,47 @@ int main(int argc, char **argv)
     // ensure we print in line-buffered mode
     setlinebuf(stdout);
 
+    if (binaryOutput) {
+        // the only text line; stdout isn't used by stdio after this
+        puts("CUTESEAL-BINARY 1");
+        fflush(stdout);
+    }
+
     // open log file if specified
     if (!logPath.empty()) {
         logFile = fopen(logPath.c_str(), logAppend ? "a" : "w");
         if (!logFile) {
             timedPerror("Failed to open log file");
+            flushOutput();
             return 126;
         }
     }
 
-    // set up the pipes and launch the engine; [0]=read end; [1]=write end
-    int childIn[2] { -1, -1 };
-    int childOut[2] { -1, -1 };
-    int childErr[2] { -1, -1 };
-
-    if (pipe2(childIn,  O_CLOEXEC)) {
-        timedPerror("Failed to create STDIN for child");
-        return 126;
+    if (!daemonAddress.empty()) {
+        return daemonMain();
     }
 
-    if (pipe2(childOut, O_CLOEXEC)) {
-        timedPerror("Failed to create STDOUT for child");
-        return 126;
-    }
-    if (pipe2(childErr, O_CLOEXEC)) {
-        timedPerror("Failed to create STDERR for child");
-        return 126;
-    }
+    // set up the pipes and launch the engine
+    int childStdin { -1 };
+    int childStdout { -1 };
+    int childStderr { -1 };
+    const char *failure { };
 
-    pid_t child = fork();
+    pid_t child = launchEngine(argv, childStdin, childStdout, childStderr, failure);
     if (child < 0) {
-        timedPerror("Failed to create a child process");
+        timedPerror(failure);
+        flushOutput();
         return 126;
     }
 
-    if (child == 0) {
-        // Note: these use intentionally perror(), as the fork parent will add
-        // the timestamps to the output
-
-        // rebind stdin/out/err - no cloexec for these
-        if (dup2(childIn[0],  STDIN_FILENO) == -1) {
-            perror("Failed to rebind STDIN for child");
-            return 126;
-        }
-        if (dup2(childOut[1], STDOUT_FILENO) == -1)  {
-            perror("Failed to rebind STDOUT for child");
-            return 126;
-        }
-        if (dup2(childErr[1], STDERR_FILENO) == -1)  {
-            perror("Failed to rebind STDERR for child");
-            return 126;
-        }
-
-        if (logFile) {
-            fclose(logFile);
-        }
-
-        // launch the engine
-        execvp(argv[0], argv);
-
-        // if we get here, something went wrong
-        perror("Failed to launch the engine");
-        return 126;
-    }
-
-    // close the pipe ends that we don't need
-    close(childIn[0]);
-    close(childOut[1]);
-    close(childErr[1]);
-
     timedPrintLine(Stream::STATUS, "INFO Engine launched with pid %d with the following parameters", static_cast<int>(child));
     for (int i = 0; i < argc; ++i) {
         timedPrintLine(Stream::STATUS, "INFO argv[%d]='%s'", i, argv[i]);
     }
 
-    // assign signal handlers
-    {
-        struct sigaction sigact { };
-
-        sigact.sa_flags = SA_RESTART;
-
-        sigact.sa_handler = &terminatingSignalHandler;
-        sigaction(SIGTERM, &sigact, NULL);
-        sigaction(SIGINT, &sigact, NULL);
-        sigaction(SIGHUP, &sigact, NULL);
+    assignSignalHandlers();
 
-        sigact.sa_handler = &statusSignalHandler;
-        sigaction(SIGUSR1, &sigact, NULL);
-    }
-
-    runLoop(childIn[1], childOut[0], childErr[0]);
+    runLoop(childStdin, childStdout, childStderr);
 
     // exit from runLoop, make sure our child dies
     kill(child, SIGKILL);
@@ -511,9 +1578,12 @@ int main(int argc, char **argv)
         }
     } else {
         timedPerror("Failed to wait for the child to terminate");
+        flushOutput();
         return 126;
     }
 
+    flushOutput();
+
     if (logFile) {
         fclose(logFile);
         logFile = nullptr;
@@ -30,8 +30,10 @@
 #include <tournament.h>
 #include <gamemanager.h>
 #include <sprt.h>
-#include <jsonparser.h>
-#include <jsonserializer.h>
+#include <jsonreader.h>
+#include <jsonwriter.h>
+#include <tracer.h>
+#include <gameoutputwriter.h>
 
 EngineMatch::EngineMatch(Tournament* tournament, QObject* parent)
 	: QObject(parent),
@@ -41,7 +43,9 @@ EngineMatch::EngineMatch(Tournament* tournament, QObject* parent)
 	  m_bookMode(OpeningBook::Ram),
 	  m_eloKfactor(32.0),
 	  m_pgnFormat(true),
-	  m_jsonFormat(true)
+	  m_jsonFormat(true),
+	  m_tracePerGame(false),
+	  m_streaming(false)
 {
 	Q_ASSERT(tournament != nullptr);
 
@@ -140,6 +144,16 @@ void EngineMatch::setDebugFile(const QString& debugFile)
 	}
 }
 
+void EngineMatch::setTracePerGame(bool enabled)
+{
+	m_tracePerGame = enabled;
+}
+
+void EngineMatch::setStreamingMode(bool enabled)
+{
+	m_streaming = enabled;
+}
+
 void EngineMatch::generateSchedule(QVariantMap& eMap)
 {
 	QVariantList pList = eMap["matchProgress"].toList();
@@ -168,33 +182,34 @@ void EngineMatch::generateSchedule(QVariantMap& eMap)
 			qWarning("cannot open schedule JSON file: %s", qUtf8Printable(tempName));
 			return;
 		}
-		QTextStream out(&output);
+		JsonWriter json(&output);
+		json.writeStartArray();
 		QVariantMap pMap;
-		QVariantList sList;
 		QList< QPair<QString, QString> >::iterator i;
 		int count = 0;
 		for (i = pairings.begin(); i != pairings.end(); ++i, ++count) {
-			QVariantMap	sMap;
-			QString opening;
+			json.writeStartObject();
+			json.writeMember("Game", count + 1);
 
 			if (count < pList.size()) {
+				QString opening;
 				pMap = pList.at(count).toMap();
-				if (pMap.contains("white"))
-					sMap["White"] = pMap["white"];
-				if (pMap.contains("black"))
-					sMap["Black"] = pMap["black"];
-				if (pMap.contains("startTime"))
-					sMap["Start"] = pMap["startTime"];
-				if (pMap.contains("result"))
-					sMap["Result"] = pMap["result"];
-				if (pMap.contains("terminationDetails"))
-					sMap["Termination"] = pMap["terminationDetails"];
-				if (pMap.contains("gameDuration"))
-					sMap["Duration"] = pMap["gameDuration"];
-				if (pMap.contains("finalFen"))
-					sMap["FinalFen"] = pMap["finalFen"];
-				if (pMap.contains("ECO"))
-					sMap["ECO"] = pMap["ECO"];
+				static const char* const keys[][2] = {
+					{"white", "White"},
+					{"black", "Black"},
+					{"startTime", "Start"},
+					{"result", "Result"},
+					{"terminationDetails", "Termination"},
+					{"gameDuration", "Duration"},
+					{"finalFen", "FinalFen"},
+					{"ECO", "ECO"}
+				};
+				for (const auto& key : keys) {
+					if (pMap.contains(key[0])) {
+						json.writeName(key[1]);
+						json.writeVariant(pMap[key[0]]);
+					}
+				}
 				if (pMap.contains("opening"))
 					opening = pMap["opening"].toString();
 				if (pMap.contains("variation")) {
@@ -203,31 +218,35 @@ void EngineMatch::generateSchedule(QVariantMap& eMap)
 						opening += ", " + variation;
 				}
 				if (!opening.isEmpty())
-					sMap["Opening"] = opening;
-				if (pMap.contains("plyCount"))
-					sMap["Moves"] = pMap["plyCount"];
-				if (pMap.contains("whiteEval"))
-					sMap["WhiteEv"] = pMap["whiteEval"];
+					json.writeMember("Opening", opening);
+				if (pMap.contains("plyCount")) {
+					json.writeName("Moves");
+					json.writeVariant(pMap["plyCount"]);
+				}
+				if (pMap.contains("whiteEval")) {
+					json.writeName("WhiteEv");
+					json.writeVariant(pMap["whiteEval"]);
+				}
 				if (pMap.contains("blackEval")) {
 					QString blackEval = pMap["blackEval"].toString();
 					if (blackEval.at(0) == '-')
 						blackEval.remove(0, 1);
 					else if (blackEval != "0.00")
 						blackEval = "-" + blackEval;
-					sMap["BlackEv"] = blackEval;
+					json.writeMember("BlackEv", blackEval);
 				}
 			} else {
-				sMap["White"] = i->first;
-				sMap["Black"] = i->second;
+				json.writeMember("White", i->first);
+				json.writeMember("Black", i->second);
 				if (disqualifications[i->first] || disqualifications[i->second])
-					sMap["Termination"] = "Canceled";
+					json.writeMember("Termination", "Canceled");
 			}
-			sMap["Game"] = count + 1;
-			sList.append(sMap);
+			json.writeEndObject();
 		}
+		json.writeEndArray();
 
-		JsonSerializer serializer(sList);
-		serializer.serialize(out);
+		if (!json.flush())
+			qWarning("cannot write schedule JSON file: %s", qUtf8Printable(tempName));
 		output.close();
 		if (QFile::exists(finalName))
 			QFile::remove(finalName);
@@ -753,80 +772,92 @@ void EngineMatch::generateCrossTable(QVariantMap& eMap)
 			qWarning("cannot open crosstable JSON file: %s", qUtf8Printable(tempName));
 			return;
 		}
-		QTextStream out(&output);
+		JsonWriter json(&output);
+		json.writeStartObject();
 
-		QVariantMap cMap;
-		QVariantList order;
+		json.writeName("Order");
+		json.writeStartArray();
 		for (i = list.begin(); i != list.end(); ++i)
-			order << i->m_engineName;
-		cMap["Order"] = order;
+			json.writeValue(i->m_engineName);
+		json.writeEndArray();
 
-		QVariantMap	table;
+		json.writeName("Table");
+		json.writeStartObject();
 		int rank = 1;
 		for (i = list.begin(); i != list.end(); ++i, ++rank) {
-			QVariantMap obj;
-			QVariantMap results;
-			obj["Rank"] = rank;
-			obj["Abbreviation"] = i->m_engineAbbrev;
-			obj["Rating"] = i->m_rating;
-			obj["Score"] = i->m_score;
-			obj["GamesAsWhite"] = i->m_gamesPlayedAsWhite;
-			obj["GamesAsBlack"] = i->m_gamesPlayedAsBlack;
-			obj["WinsAsWhite"] = i->m_winsAsWhite;
-			obj["WinsAsBlack"] = i->m_winsAsBlack;
-			obj["LossAsWhite"] = i->m_lossAsWhite;
-			obj["LossAsBlack"] = i->m_lossAsBlack;
-			obj["Games"] = i->m_gamesPlayedAsWhite + i->m_gamesPlayedAsBlack;
-			obj["Neustadtl"] = i->m_neustadtlScore;
-			obj["Strikes"] = i->m_strikes;
-			obj["Performance"] = i->m_performance * 100.0;
-			obj["Elo"] = i->m_elo;
-			for(const QVariant& eVar : order) {
-				const QString engineName(eVar.toString());
+			json.writeName(i->m_engineName);
+			json.writeStartObject();
+			json.writeMember("Rank", rank);
+			json.writeMember("Abbreviation", i->m_engineAbbrev);
+			json.writeMember("Rating", i->m_rating);
+			json.writeMember("Score", i->m_score);
+			json.writeMember("GamesAsWhite", i->m_gamesPlayedAsWhite);
+			json.writeMember("GamesAsBlack", i->m_gamesPlayedAsBlack);
+			json.writeMember("WinsAsWhite", i->m_winsAsWhite);
+			json.writeMember("WinsAsBlack", i->m_winsAsBlack);
+			json.writeMember("LossAsWhite", i->m_lossAsWhite);
+			json.writeMember("LossAsBlack", i->m_lossAsBlack);
+			json.writeMember("Games", i->m_gamesPlayedAsWhite + i->m_gamesPlayedAsBlack);
+			json.writeMember("Neustadtl", i->m_neustadtlScore);
+			json.writeMember("Strikes", i->m_strikes);
+			json.writeMember("Performance", i->m_performance * 100.0);
+			json.writeMember("Elo", i->m_elo);
+
+			QString opponent;
+			json.writeName("Results");
+			json.writeStartObject();
+			QList<CrossTableData>::iterator j;
+			for (j = list.begin(); j != list.end(); ++j) {
+				const QString& engineName(j->m_engineName);
 				if (engineName == i->m_engineName)
 					continue;
-				QVariantMap result;
-				QVariantList scores;
-				result["H2h"] = 0;
-				for (const CrossTableData::SlotData& slotData : i->m_crossData[engineName]) {
-					QVariantMap slot;
-					slot["Game"] = slotData.m_gameNo;
-					slot["Result"] = slotData.m_result;
-					result["H2h"] = result["H2h"].toDouble() + slotData.m_result;
+				const QList<CrossTableData::SlotData> slotList(i->m_crossData[engineName]);
+				double h2h = 0;
+				json.writeName(engineName);
+				json.writeStartObject();
+				json.writeName("Scores");
+				json.writeStartArray();
+				for (const CrossTableData::SlotData& slotData : slotList) {
+					json.writeStartObject();
+					json.writeMember("Game", slotData.m_gameNo);
+					json.writeMember("Result", slotData.m_result);
+					h2h += slotData.m_result;
 					switch (slotData.m_winner) {
 					case CrossTableData::WinnerNone:
-						slot["Winner"] = "None";
+						json.writeMember("Winner", "None");
 						break;
 					case CrossTableData::WinnerWhite:
-						slot["Winner"] = "White";
+						json.writeMember("Winner", "White");
 						break;
 					case CrossTableData::WinnerBlack:
-						slot["Winner"] = "Black";
+						json.writeMember("Winner", "Black");
 						break;
 					}
-					if (slot.contains("Winner")) {
-						obj["Opponent"] = engineName;
-					}
-					scores.append(slot);
+					opponent = engineName;
+					json.writeEndObject();
 				}
-				result["Text"] = i->m_tableData[engineName];
-				result["Scores"] = scores;
-				results[engineName] = result;
+				json.writeEndArray();
+				json.writeMember("H2h", h2h);
+				json.writeMember("Text", i->m_tableData[engineName]);
+				json.writeEndObject();
 			}
+			json.writeEndObject();
+			if (!opponent.isEmpty())
+				json.writeMember("Opponent", opponent);
 
-			obj["Results"] = results;
-			table[i->m_engineName] = obj;
+			json.writeEndObject();
 		}
-		cMap["Table"] = table;
+		json.writeEndObject();
 
 		if (tsMap.contains("name"))
-			cMap["Event"] = tsMap["name"].toString();
+			json.writeMember("Event", tsMap["name"].toString());
 
 		if (tsMap.contains("type"))
-			cMap["Type"] = tsMap["type"].toString();
+			json.writeMember("Type", tsMap["type"].toString());
 
-		JsonSerializer serializer(cMap);
-		serializer.serialize(out);
+		json.writeEndObject();
+		if (!json.flush())
+			qWarning("cannot write crosstable JSON file: %s", qUtf8Printable(tempName));
 		output.close();
 		if (QFile::exists(finalName))
 			QFile::remove(finalName);
@@ -955,19 +986,11 @@ void EngineMatch::onGameStarted(ChessGame* game, int number)
 	      qUtf8Printable(game->player(Chess::Side::White)->name()),
 	      qUtf8Printable(game->player(Chess::Side::Black)->name()));
 
-	if (!m_tournamentFile.isEmpty()) {
+	// In streaming mode only finished games are recorded
+	if (!m_tournamentFile.isEmpty() && !m_streaming) {
 		QVariantMap tfMap;
-		if (QFile::exists(m_tournamentFile)) {
-			QFile input(m_tournamentFile);
-			if (!input.open(QIODevice::ReadOnly | QIODevice::Text)) {
-				qWarning("cannot open tournament configuration file: %s", qUtf8Printable(m_tournamentFile));
-				return;
-			}
-
-			QTextStream stream(&input);
-			JsonParser jsonParser(stream);
-			tfMap = jsonParser.parse().toMap();
-		}
+		if (!readTournamentFile(&tfMap))
+			return;
 
 		QVariantList pList;
 		QVariantMap tsMap;
@@ -996,16 +1019,7 @@ void EngineMatch::onGameStarted(ChessGame* game, int number)
 		pMap.insert("terminationDetails", "in progress");
 		pList.append(pMap);
 		tfMap.insert("matchProgress", pList);
-		{
-			QFile output(m_tournamentFile);
-			if (!output.open(QIODevice::WriteOnly | QIODevice::Text)) {
-				qWarning("cannot open tournament configuration file: %s", qUtf8Printable(m_tournamentFile));
-			} else {
-				QTextStream out(&output);
-				JsonSerializer serializer(tfMap);
-				serializer.serialize(out);
-			}
-		}
+		writeTournamentFile(tfMap);
 		QVariantMap eMap;
 		eMap.insert("matchProgress", pList);
 		eMap.insert("tournamentSettings", tsMap);
@@ -1032,18 +1046,17 @@ void EngineMatch::onGameFinished(ChessGame* game, int number)
 	      qUtf8Printable(game->player(Chess::Side::Black)->name()),
 	      qUtf8Printable(result.toVerboseString()));
 
-	if (!m_tournamentFile.isEmpty()) {
+	if (m_streaming) {
+		if (!m_tournamentFile.isEmpty())
+			updateMatchSummary(number,
+					   game->player(Chess::Side::White)->name(),
+					   game->player(Chess::Side::Black)->name(),
+					   result.toShortString());
+	} else if (!m_tournamentFile.isEmpty()) {
 		QVariantMap tfMap;
 
 		if (QFile::exists(m_tournamentFile)) {
-			QFile input(m_tournamentFile);
-			if (!input.open(QIODevice::ReadOnly | QIODevice::Text)) {
-				qWarning("cannot open tournament configuration file: %s", qUtf8Printable(m_tournamentFile));
-			} else {
-				QTextStream stream(&input);
-				JsonParser jsonParser(stream);
-				tfMap = jsonParser.parse().toMap();
-			}
+			readTournamentFile(&tfMap);
 
 			QVariantMap pMap;
 			QVariantList pList;
@@ -1119,14 +1132,7 @@ void EngineMatch::onGameFinished(ChessGame* game, int number)
 				tfMap.insert("matchProgress", pList);
 				tfMap.insert("strikes", stMap);
 
-				QFile output(m_tournamentFile);
-				if (!output.open(QIODevice::WriteOnly | QIODevice::Text)) {
-					qWarning("cannot open tournament configuration file: %s", qUtf8Printable(m_tournamentFile));
-				} else {
-					QTextStream out(&output);
-					JsonSerializer serializer(tfMap);
-					serializer.serialize(out);
-				}
+				writeTournamentFile(tfMap);
 				QVariantMap eMap;
 				eMap.insert("matchProgress", pList);
 				eMap.insert("tournamentSettings", tsMap);
@@ -1153,6 +1159,9 @@ void EngineMatch::onGameFinished(ChessGame* game, int number)
 	if (m_ratingInterval != 0
 	&&  (m_tournament->finishedGameCount() % m_ratingInterval) == 0)
 		printRanking();
+
+	if (m_tracePerGame)
+		Tracer::write();
 }
 
 void EngineMatch::onGameSkipped(int number, int iWhite, int iBlack)
@@ -1162,19 +1171,16 @@ void EngineMatch::onGameSkipped(int number, int iWhite, int iBlack)
 	      qUtf8Printable(m_tournament->playerAt(iWhite).name()),
 	      qUtf8Printable(m_tournament->playerAt(iBlack).name()));
 
-	if (!m_tournamentFile.isEmpty()) {
+	if (m_streaming) {
+		if (!m_tournamentFile.isEmpty())
+			updateMatchSummary(number,
+					   m_tournament->playerAt(iWhite).name(),
+					   m_tournament->playerAt(iBlack).name(),
+					   QString());
+	} else if (!m_tournamentFile.isEmpty()) {
 		QVariantMap tfMap;
-		if (QFile::exists(m_tournamentFile)) {
-			QFile input(m_tournamentFile);
-			if (!input.open(QIODevice::ReadOnly | QIODevice::Text)) {
-				qWarning("cannot open tournament configuration file: %s", qUtf8Printable(m_tournamentFile));
-				return;
-			}
-
-			QTextStream stream(&input);
-			JsonParser jsonParser(stream);
-			tfMap = jsonParser.parse().toMap();
-		}
+		if (!readTournamentFile(&tfMap))
+			return;
 
 		QVariantList pList;
 		QVariantMap tsMap;
@@ -1202,16 +1208,7 @@ void EngineMatch::onGameSkipped(int number, int iWhite, int iBlack)
 		pMap.insert("terminationDetails", "Skipped");
 		pList.append(pMap);
 		tfMap.insert("matchProgress", pList);
-		{
-			QFile output(m_tournamentFile);
-			if (!output.open(QIODevice::WriteOnly | QIODevice::Text)) {
-				qWarning("cannot open tournament configuration file: %s", qUtf8Printable(m_tournamentFile));
-			} else {
-				QTextStream out(&output);
-				JsonSerializer serializer(tfMap);
-				serializer.serialize(out);
-			}
-		}
+		writeTournamentFile(tfMap);
 		QVariantMap eMap;
 		eMap.insert("matchProgress", pList);
 		eMap.insert("tournamentSettings", tsMap);
@@ -1238,6 +1235,113 @@ void EngineMatch::onGameSkipped(int number, int iWhite, int iBlack)
 		printRanking();
 }
 
+bool EngineMatch::readTournamentFile(QVariantMap* tfMap) const
+{
+	if (!QFile::exists(m_tournamentFile))
+		return true;
+
+	JsonReader reader;
+	if (!reader.openFile(m_tournamentFile)) {
+		qWarning("cannot open tournament configuration file: %s", qUtf8Printable(m_tournamentFile));
+		return false;
+	}
+
+	reader.readNext();
+	*tfMap = reader.readVariant().toMap();
+	return true;
+}
+
+void EngineMatch::writeTournamentFile(const QVariantMap& tfMap) const
+{
+	QFile output(m_tournamentFile);
+	if (!output.open(QIODevice::WriteOnly | QIODevice::Text)) {
+		qWarning("cannot open tournament configuration file: %s", qUtf8Printable(m_tournamentFile));
+		return;
+	}
+
+	JsonWriter json(&output);
+	if (!json.writeVariant(tfMap) || !json.flush())
+		qWarning("cannot write tournament configuration file: %s", qUtf8Printable(m_tournamentFile));
+}
+
+void EngineMatch::updateMatchSummary(int number,
+				     const QString& white,
+				     const QString& black,
+				     const QString& result)
+{
+	/*
+	 * Instead of a "matchProgress" entry for every game, the streaming
+	 * mode keeps a summary whose size only depends on the number of
+	 * players: the number of the last game before which every game has
+	 * finished, the scores of that prefix for resuming, and per-pairing
+	 * result counts. Games that finish out of order wait in "pending"
+	 * until the games before them have finished.
+	 */
+	QVariantMap tfMap;
+	if (!readTournamentFile(&tfMap))
+		return;
+
+	QVariantMap summary = tfMap["matchSummary"].toMap();
+	int nextGame = summary["nextGame"].toInt();
+
+	// Already counted before the match was resumed, or
+	// unfinished and to be replayed when resuming
+	if (number <= nextGame || result == "*")
+		return;
+
+	QVariantMap pending = summary["pending"].toMap();
+	QVariantMap scores = summary["scores"].toMap();
+	QVariantMap pairs = summary["pairs"].toMap();
+
+	QVariantMap pMap;
+	pMap.insert("white", white);
+	pMap.insert("black", black);
+	pMap.insert("result", result);
+	pending.insert(QString::number(number), pMap);
+
+	while (pending.contains(QString::number(nextGame + 1))) {
+		const QVariantMap game = pending.take(QString::number(++nextGame)).toMap();
+		const QString whiteName = game["white"].toString();
+		const QString blackName = game["black"].toString();
+		const QString gameResult = game["result"].toString();
+
+		int index;
+		if (gameResult == "1-0") {
+			scores[whiteName] = scores[whiteName].toInt() + 2;
+			index = 0;
+		} else if (gameResult == "0-1") {
+			scores[blackName] = scores[blackName].toInt() + 2;
+			index = 2;
+		} else if (gameResult == "1/2-1/2") {
+			scores[whiteName] = scores[whiteName].toInt() + 1;
+			scores[blackName] = scores[blackName].toInt() + 1;
+			index = 1;
+		} else
+			continue; // skipped game
+
+		// White wins, draws and black wins
+		const QString key = whiteName + " - " + blackName;
+		QVariantList counts = pairs[key].toList();
+		while (counts.size() < 3)
+			counts.append(0);
+		counts[index] = counts.at(index).toInt() + 1;
+		pairs.insert(key, counts);
+	}
+
+	summary.insert("nextGame", nextGame);
+	summary.insert("pending", pending);
+	summary.insert("scores", scores);
+	summary.insert("pairs", pairs);
+	tfMap.insert("matchSummary", summary);
+
+	QVariantMap stMap;
+	for (int i = 0; i < m_tournament->playerCount(); i++)
+		updateCrashCount(&stMap, m_tournament->playerAt(i));
+	tfMap.insert("strikes", stMap);
+
+	writeTournamentFile(tfMap);
+}
+
 void EngineMatch::onTournamentFinished()
 {
 	if (m_ratingInterval == 0
@@ -1248,6 +1352,14 @@ void EngineMatch::onTournamentFinished()
 	if (!error.isEmpty())
 		qWarning("%s", qUtf8Printable(error));
 
+	const auto stats = m_tournament->outputWriter()->stats();
+	if (stats.batchCount > 0)
+		qInfo("Saved %d games in %d batches, max queue depth %d, "
+		      "flush latency avg %.1f ms, max %.1f ms",
+		      stats.gameCount, stats.batchCount, stats.maxQueueDepth,
+		      stats.totalFlushLatency / 1000.0 / stats.batchCount,
+		      stats.maxFlushLatency / 1000.0);
+
 	qInfo("Finished match");
 	connect(m_tournament->gameManager(), SIGNAL(finished()),
 		this, SIGNAL(finished()));
@@ -48,6 +48,8 @@ class EngineMatch : public QObject
 		void setEloKfactor(qreal eloKfactor);
 		void setOutputFormats(bool pgnFormat, bool jsonFormat);
 		void setDebugFile(const QString& debugFile);
+		void setTracePerGame(bool enabled);
+		void setStreamingMode(bool enabled);
 
 		void start();
 		void stop();
@@ -66,6 +68,12 @@ class EngineMatch : public QObject
 		void printRanking();
 		void generateSchedule(QVariantMap& eMap);
 		void generateCrossTable(QVariantMap& eMap);
+		bool readTournamentFile(QVariantMap* tfMap) const;
+		void writeTournamentFile(const QVariantMap& tfMap) const;
+		void updateMatchSummary(int number,
+					const QString& white,
+					const QString& black,
+					const QString& result);
 
 		Tournament* m_tournament;
 		bool m_debug;
@@ -79,6 +87,8 @@ class EngineMatch : public QObject
 		bool m_jsonFormat;
 		QFile m_debugFile;
 		QTextStream m_debugOut;
+		bool m_tracePerGame;
+		bool m_streaming;
 };
 
 #endif // ENGINEMATCH_H
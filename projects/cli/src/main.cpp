@@ -43,6 +43,10 @@
 #include <jsonserializer.h>
 #include <econode.h>
 #include <pgnstream.h>
+#include <tracer.h>
+#include <gamearchivereader.h>
+#include <gamearchivewriter.h>
+#include <gameoutputwriter.h>
 
 #include "cutechesscoreapp.h"
 #include "matchparser.h"
@@ -61,6 +65,88 @@ void sigintHandler(int param)
 		abort();
 }
 
+/*
+ * Converts the games in \a inputFile from PGN to a binary game archive,
+ * or from an archive to PGN, and saves them to \a outputFile.
+ */
+int convertGames(const QString& inputFile, const QString& outputFile)
+{
+	int count = 0;
+	PgnGame game;
+
+	if (GameArchive::isArchive(inputFile))
+	{
+		GameArchiveReader reader;
+		if (!reader.open(inputFile))
+		{
+			qWarning("%s", qUtf8Printable(reader.errorString()));
+			return 1;
+		}
+
+		QFile output(outputFile);
+		if (!output.open(QIODevice::WriteOnly | QIODevice::Text))
+		{
+			qWarning("Could not open PGN file %s",
+				 qUtf8Printable(outputFile));
+			return 1;
+		}
+
+		QTextStream out(&output);
+		while (reader.readNext(game))
+		{
+			if (!game.write(out))
+			{
+				qWarning("Could not write PGN game %d", count + 1);
+				return 1;
+			}
+			count++;
+		}
+		if (!reader.errorString().isEmpty())
+		{
+			qWarning("%s", qUtf8Printable(reader.errorString()));
+			return 1;
+		}
+	}
+	else
+	{
+		QFile input(inputFile);
+		if (!input.open(QIODevice::ReadOnly | QIODevice::Text))
+		{
+			qWarning("Could not open PGN file %s",
+				 qUtf8Printable(inputFile));
+			return 1;
+		}
+
+		GameArchiveWriter writer;
+		writer.setMoveCommentsEnabled(true);
+		if (!writer.open(outputFile))
+		{
+			qWarning("%s", qUtf8Printable(writer.errorString()));
+			return 1;
+		}
+
+		PgnStream in(&input);
+		while (game.read(in))
+		{
+			if (!writer.write(game))
+			{
+				qWarning("%s", qUtf8Printable(writer.errorString()));
+				return 1;
+			}
+			count++;
+		}
+		if (!writer.close())
+		{
+			qWarning("%s", qUtf8Printable(writer.errorString()));
+			return 1;
+		}
+	}
+
+	qInfo("Converted %d games from %s to %s", count,
+	      qUtf8Printable(inputFile), qUtf8Printable(outputFile));
+	return 0;
+}
+
 
 struct EngineData
 {
@@ -90,7 +176,7 @@ bool readEngineConfig(const QString& name, EngineConfiguration& config)
 OpeningSuite* parseOpenings(const MatchParser::Option& option, Tournament* tournament)
 {
 	QMap<QString, QString> params =
-		option.toMap("file|format=pgn|order=sequential|plies=1024|start=1");
+		option.toMap("file|format=pgn|order=sequential|plies=1024|start=1|cache=none");
 	bool ok = !params.isEmpty();
 
 	OpeningSuite::Format format = OpeningSuite::EpdFormat;
@@ -129,11 +215,17 @@ OpeningSuite* parseOpenings(const MatchParser::Option& option, Tournament* tourn
 							   format,
 							   order,
 							   start - 1);
-		if (order == OpeningSuite::RandomOrder)
-			qInfo("Indexing opening suite...");
-		ok = suite->initialize();
+		QString cache(params["cache"]);
+		if (cache == "none")
+			cache.clear();
+
+		qInfo("Compiling opening suite...");
+		ok = suite->compile(tournament->variant(), plies, cache);
 		if (ok)
+		{
+			qInfo("%d openings", suite->openingCount());
 			return suite;
+		}
 		delete suite;
 	}
 	return nullptr;
@@ -389,6 +481,10 @@ EngineMatch* parseMatch(const QStringList& args, CuteChessCoreApplication& app)
 	parser.addOption("-bookmode", QVariant::String);
 	parser.addOption("-pgnout", QVariant::StringList, 1, 3);
 	parser.addOption("-epdout", QVariant::String, 1, 1);
+	parser.addOption("-gameout", QVariant::StringList, 1, 2);
+	parser.addOption("-outputsync", QVariant::String, 1, 1);
+	parser.addOption("-outputqueue", QVariant::Int, 1, 1);
+	parser.addOption("-streaming", QVariant::Bool, 0, 0);
 	parser.addOption("-repeat", QVariant::Int, 0, 1);
 	parser.addOption("-noswap", QVariant::Bool, 0, 0);
 	parser.addOption("-recover", QVariant::Bool, 0, 0);
@@ -404,6 +500,7 @@ EngineMatch* parseMatch(const QStringList& args, CuteChessCoreApplication& app)
 	parser.addOption("-reloadconf", QVariant::Bool, 0, 0);
 	parser.addOption("-tcecadj", QVariant::Bool, 0, 0);
 	parser.addOption("-strikes", QVariant::Int, 1, 1);
+	parser.addOption("-trace", QVariant::StringList, 1, 2);
 
 	if (!parser.parse())
 		return nullptr;
@@ -561,6 +658,18 @@ EngineMatch* parseMatch(const QStringList& args, CuteChessCoreApplication& app)
 			tournament->setStrikes(tMap["Strikes"].toInt());
 		if (tMap.contains("epdOutput"))
 			tournament->setEpdOutput(tMap["epdOutput"].toString());
+		if (tMap.contains("gameOutput"))
+			tournament->setGameArchiveOutput(tMap["gameOutput"].toString(),
+							 tMap["gameOutComments"].toBool());
+		if (tMap.contains("outputSync"))
+			tournament->outputWriter()->setSyncPolicy(
+				GameOutputWriter::SyncPolicy(tMap["outputSync"].toInt()));
+		if (tMap.contains("outputQueue"))
+			tournament->outputWriter()->setQueueCapacity(tMap["outputQueue"].toInt());
+		if (tMap.contains("streaming")) {
+			tournament->setStreamingMode(tMap["streaming"].toBool());
+			match->setStreamingMode(tMap["streaming"].toBool());
+		}
 		if (tMap.contains("pgnCleanupEnabled"))
 			tournament->setPgnCleanupEnabled(tMap["pgnCleanupEnabled"].toBool());
 		if (tMap.contains("openingRepetitions"))
@@ -663,6 +772,17 @@ EngineMatch* parseMatch(const QStringList& args, CuteChessCoreApplication& app)
 					tournament->setResume(nextGame, engineOne, engineTwo);
 			}
 		}
+		if (tfMap.contains("matchSummary")) {
+			if (!wantsResume) {
+				tfMap.remove("matchSummary");
+			} else {
+				const QVariantMap summary = tfMap["matchSummary"].toMap();
+				const int nextGame = summary["nextGame"].toInt();
+				engineMap = summary["scores"].toMap();
+				if (nextGame > 0)
+					tournament->setResume(nextGame, 0, 0);
+			}
+		}
 		if (eMap.contains("engines")) {
 			eList = eMap["engines"].toList();
 			for (int e = 0; e < eList.size(); e++) {
@@ -848,21 +968,30 @@ EngineMatch* parseMatch(const QStringList& args, CuteChessCoreApplication& app)
 			// SPRT-based stopping rule
 			else if (name == "-sprt")
 			{
-				QMap<QString, QString> params = option.toMap("elo0|elo1|alpha|beta");
+				QMap<QString, QString> params = option.toMap("elo0|elo1|alpha|beta|model=trinomial");
 				bool sprtOk[4];
 				double elo0 = params["elo0"].toDouble(sprtOk);
 				double elo1 = params["elo1"].toDouble(sprtOk + 1);
 				double alpha = params["alpha"].toDouble(sprtOk + 2);
 				double beta = params["beta"].toDouble(sprtOk + 3);
+				const QString model = params["model"];
 
 				ok = (sprtOk[0] && sprtOk[1] && sprtOk[2] && sprtOk[3]);
+				if (ok && model != "trinomial" && model != "pentanomial")
+				{
+					qWarning("Invalid SPRT model: \"%s\"", qUtf8Printable(model));
+					ok = false;
+				}
 				if (ok) {
 					tournament->sprt()->initialize(elo0, elo1, alpha, beta);
+					tournament->sprt()->setModel(model == "pentanomial"
+						? Sprt::Pentanomial : Sprt::Trinomial);
 					QVariantMap sMap;
 					sMap.insert("elo0", elo0);
 					sMap.insert("elo1", elo1);
 					sMap.insert("alpha", alpha);
 					sMap.insert("beta", beta);
+					sMap.insert("model", model);
 					tMap.insert("sprt", sMap);
 				}
 			}
@@ -937,6 +1066,18 @@ EngineMatch* parseMatch(const QStringList& args, CuteChessCoreApplication& app)
 					tMap.insert("jsonFormat", wantsJsonFormat);
 				}
 			}
+			// Timeline of harness events in Chrome Trace Event format
+			else if (name == "-trace")
+			{
+				QStringList list = value.toStringList();
+				if (list.size() == 2 && list.at(1) != "pergame")
+					ok = false;
+				if (ok)
+				{
+					Tracer::start(list.at(0));
+					match->setTracePerGame(list.size() == 2);
+				}
+			}
 			else if (name == "-strikes")
 			{
 				const int st = value.toInt();
@@ -953,6 +1094,58 @@ EngineMatch* parseMatch(const QStringList& args, CuteChessCoreApplication& app)
 				tournament->setEpdOutput(fileName);
 				tMap.insert("epdOutput", fileName);
 			}
+			// Binary game archive to save the games
+			else if (name == "-gameout")
+			{
+				QStringList list = value.toStringList();
+				bool comments = false;
+				if (list.size() == 2)
+				{
+					comments = list.at(1) == "comments";
+					ok = comments;
+				}
+				if (ok)
+				{
+					ok = tournament->setGameArchiveOutput(list.at(0), comments);
+					tMap.insert("gameOutput", list.at(0));
+					tMap.insert("gameOutComments", comments);
+				}
+			}
+			// When to force the PGN and EPD output to disk
+			else if (name == "-outputsync")
+			{
+				const QString val(value.toString());
+				GameOutputWriter::SyncPolicy policy = GameOutputWriter::NoSync;
+				if (val == "batch")
+					policy = GameOutputWriter::BatchSync;
+				else if (val == "game")
+					policy = GameOutputWriter::GameSync;
+				else if (val != "never")
+					ok = false;
+				if (ok)
+				{
+					tournament->outputWriter()->setSyncPolicy(policy);
+					tMap.insert("outputSync", policy);
+				}
+			}
+			// Maximum number of games and positions waiting to be saved
+			else if (name == "-outputqueue")
+			{
+				const int capacity = value.toInt();
+				ok = capacity > 0;
+				if (ok)
+				{
+					tournament->outputWriter()->setQueueCapacity(capacity);
+					tMap.insert("outputQueue", capacity);
+				}
+			}
+			// Keep memory use independent of the number of games
+			else if (name == "-streaming")
+			{
+				tournament->setStreamingMode(true);
+				match->setStreamingMode(true);
+				tMap.insert("streaming", true);
+			}
 			// Play every opening twice (default), or multiple times
 			else if (name == "-repeat")
 			{
@@ -1203,6 +1396,10 @@ int main(int argc, char* argv[])
 
 	// Use trivial command-line parsing for now
 	QTextStream out(stdout);
+	if (arguments.size() == 3
+	&&  (arguments.at(0) == "--convert" || arguments.at(0) == "-convert"))
+		return convertGames(arguments.at(1), arguments.at(2));
+
 	const auto& constArguments = arguments;
 	for (const auto& arg : constArguments)
 	{
@@ -1243,5 +1440,10 @@ int main(int argc, char* argv[])
 	QObject::connect(s_match, SIGNAL(finished()), &app, SLOT(quit()));
 
 	s_match->start();
-	return app.exec();
+	int ret = app.exec();
+
+	if (Tracer::isEnabled())
+		Tracer::write();
+
+	return ret;
 }
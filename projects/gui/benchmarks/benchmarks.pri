@@ -0,0 +1,14 @@
+TEMPLATE = app
+
+win32:config += CONSOLE
+QT += testlib widgets printsupport
+
+include(../../lib/lib.pri)
+include(../../lib/libexport.pri)
+include(../3rdparty/qcustomplot/qcustomplot.pri)
+
+INCLUDEPATH += $$PWD/../src
+DEPENDPATH += $$PWD/../src
+
+OBJECTS_DIR = .obj
+MOC_DIR = .moc
@@ -0,0 +1,10 @@
+include(../benchmarks.pri)
+
+TARGET = tst_evalupdates
+SOURCES += tst_evalupdates.cpp \
+    ../../src/evalwidget.cpp \
+    ../../src/evalhistory.cpp \
+    ../../src/updatecoalescer.cpp
+HEADERS += ../../src/evalwidget.h \
+    ../../src/evalhistory.h \
+    ../../src/updatecoalescer.h
@@ -0,0 +1,210 @@
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QGridLayout>
+#include <ctime>
+#include <chessgame.h>
+#include <chessplayer.h>
+#include <enginebuilder.h>
+#include <engineconfiguration.h>
+#include <enginemanager.h>
+#include <gamemanager.h>
+#include <gameadjudicator.h>
+#include <pgngame.h>
+#include <timecontrol.h>
+#include <tournament.h>
+#include <tournamentfactory.h>
+#include "evalhistory.h"
+#include "evalwidget.h"
+
+/*
+ * Measures the GUI thread's CPU time spent on the eval widgets and
+ * the eval graph while concurrent games between two instances of the
+ * stub engine (see projects/lib/benchmarks/stubengine) are shown, like
+ * on a game wall. Each update rate is a separate row; a rate of 0
+ * updates the widgets after every evaluation.
+ *
+ * CUTECHESS_STUB_ENGINE	Path to the stub engine
+ * CUTECHESS_STUB_ARGS		Arguments for the stub engine
+ *				(default "-think 20 -info 100 -multipv 4")
+ * CUTECHESS_BENCH_GAMES	Number of games (default 16)
+ * CUTECHESS_BENCH_CONCURRENCY	Number of concurrent games (default 8)
+ *
+ * Run with QT_QPA_PLATFORM=offscreen on a headless machine.
+ */
+class tst_EvalUpdates: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void games_data() const;
+		void games();
+
+	private:
+		static int envValue(const char* name, int defaultValue);
+		static qint64 threadCpuTime();
+};
+
+int tst_EvalUpdates::envValue(const char* name, int defaultValue)
+{
+	bool ok = false;
+	const int value = qEnvironmentVariableIntValue(name, &ok);
+	return ok && value > 0 ? value : defaultValue;
+}
+
+qint64 tst_EvalUpdates::threadCpuTime()
+{
+	// CPU time of the calling (GUI) thread in microseconds
+#ifdef Q_OS_UNIX
+	struct timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+		return 0;
+	return qint64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#else
+	return qint64(std::clock()) * 1000000 / CLOCKS_PER_SEC;
+#endif
+}
+
+void tst_EvalUpdates::games_data() const
+{
+	QTest::addColumn<int>("rate");
+
+	QTest::newRow("unlimited") << 0;
+	QTest::newRow("30 Hz") << 30;
+	QTest::newRow("10 Hz") << 10;
+}
+
+void tst_EvalUpdates::games()
+{
+	QFETCH(int, rate);
+
+	QString command(QString::fromLocal8Bit(qgetenv("CUTECHESS_STUB_ENGINE")));
+	if (command.isEmpty())
+		command = QCoreApplication::applicationDirPath()
+			+ "/../../../lib/benchmarks/stubengine/stubengine";
+	QString args(QString::fromLocal8Bit(qgetenv("CUTECHESS_STUB_ARGS")));
+	if (args.isEmpty())
+		args = "-think 20 -info 100 -multipv 4";
+	const QStringList arguments(args.split(' ', QString::SkipEmptyParts));
+
+	if (!QFileInfo(command).isExecutable())
+		QSKIP(qPrintable("Stub engine not found: " + command));
+
+	const int games = envValue("CUTECHESS_BENCH_GAMES", 16);
+	const int concurrency = envValue("CUTECHESS_BENCH_CONCURRENCY", 8);
+
+	EngineManager engineManager;
+	GameManager* gameManager = new GameManager;
+	gameManager->setConcurrency(concurrency);
+
+	Tournament* tournament = TournamentFactory::create("round-robin",
+							   gameManager,
+							   &engineManager);
+	QVERIFY(tournament != nullptr);
+
+	GameAdjudicator adjudicator;
+	adjudicator.setMaximumGameLength(60);
+	tournament->setAdjudicator(adjudicator);
+	tournament->setGamesPerEncounter(games);
+	for (int i = 0; i < 2; i++)
+	{
+		EngineConfiguration config;
+		config.setName(QString("Stub %1").arg(i + 1));
+		config.setCommand(command);
+		config.setProtocol("uci");
+		config.setArguments(arguments);
+		tournament->addPlayer(new EngineBuilder(config),
+				      TimeControl("inf"), nullptr, 0);
+	}
+
+	// One tile per concurrent game: an eval widget for each
+	// player and the eval graph
+	QWidget wall;
+	auto layout = new QGridLayout(&wall);
+	QVector<EvalHistory*> histories;
+	QVector<EvalWidget*> evalWidgets;
+	for (int i = 0; i < concurrency; i++)
+	{
+		auto history = new EvalHistory(&wall);
+		history->setUpdateRate(rate);
+		layout->addWidget(history, i, 0);
+		histories.append(history);
+
+		for (int j = 0; j < 2; j++)
+		{
+			auto evalWidget = new EvalWidget(&wall);
+			evalWidget->setUpdateRate(rate);
+			layout->addWidget(evalWidget, i, j + 1);
+			evalWidgets.append(evalWidget);
+		}
+	}
+	wall.resize(1600, 200 * concurrency);
+	wall.show();
+
+	QMap<ChessGame*, int> tiles;
+	qint64 evalCount = 0;
+	qint64 moveCount = 0;
+
+	connect(tournament, &Tournament::gameStarted, this,
+		[&](ChessGame* game, int, int, int)
+	{
+		int tile = 0;
+		while (tiles.key(tile) != nullptr)
+			tile++;
+		tiles[game] = tile;
+
+		histories[tile]->setGame(game);
+		for (int i = 0; i < 2; i++)
+		{
+			ChessPlayer* player = game->player(Chess::Side::Type(i));
+			evalWidgets[tile * 2 + i]->setPlayer(player);
+			connect(player, &ChessPlayer::thinking, this,
+				[&](const MoveEvaluation&) { evalCount++; });
+		}
+	});
+	connect(tournament, &Tournament::gameFinished, this,
+		[&](ChessGame* game, int, int, int)
+	{
+		moveCount += game->pgn()->moves().size();
+
+		const int tile = tiles.take(game);
+		histories[tile]->setGame(nullptr);
+		for (int i = 0; i < 2; i++)
+			evalWidgets[tile * 2 + i]->setPlayer(nullptr);
+	});
+
+	QEventLoop loop;
+	connect(tournament, SIGNAL(finished()), &loop, SLOT(quit()));
+
+	QElapsedTimer clock;
+	const qint64 startCpu = threadCpuTime();
+	clock.start();
+	QBENCHMARK_ONCE
+	{
+		QMetaObject::invokeMethod(tournament, "start", Qt::QueuedConnection);
+		loop.exec();
+	}
+	const qint64 elapsed = clock.nsecsElapsed();
+	const qint64 cpu = threadCpuTime() - startCpu;
+
+	connect(gameManager, SIGNAL(finished()), &loop, SLOT(quit()));
+	gameManager->finish();
+	loop.exec();
+
+	QCOMPARE(tournament->finishedGameCount(), games);
+	QVERIFY(moveCount > 0);
+
+	const double seconds = elapsed / 1.0e9;
+	qInfo("Update rate %d: %lld evaluations, %lld moves in %.2f s",
+	      rate, evalCount, moveCount, seconds);
+	qInfo("GUI thread CPU: %.1f%%, %.1f us per evaluation",
+	      100.0 * cpu / (elapsed / 1000.0),
+	      evalCount > 0 ? double(cpu) / evalCount : 0.0);
+
+	delete tournament;
+	delete gameManager;
+}
+
+QTEST_MAIN(tst_EvalUpdates)
+#include "tst_evalupdates.moc"
@@ -17,7 +17,6 @@
 */
 
 #include "boardscene.h"
-#include <QSvgRenderer>
 #include <QGraphicsSceneMouseEvent>
 #include <QPropertyAnimation>
 #include <QParallelAnimationGroup>
@@ -31,6 +30,7 @@
 #include "graphicspiecereserve.h"
 #include "graphicspiece.h"
 #include "piecechooser.h"
+#include "piecepixmapcache.h"
 
 namespace {
 
@@ -46,10 +46,11 @@ BoardScene::BoardScene(QObject* parent)
 	  m_reserve(nullptr),
 	  m_chooser(nullptr),
 	  m_anim(nullptr),
-	  m_renderer(new QSvgRenderer(QString(":/default.svg"), this)),
+	  m_pixmapCache(PiecePixmapCache::instance()),
 	  m_highlightPiece(nullptr),
 	  m_moveArrows(nullptr)
 {
+	connect(m_pixmapCache, SIGNAL(invalidated()), this, SLOT(update()));
 }
 
 BoardScene::~BoardScene()
@@ -80,11 +81,26 @@ void BoardScene::setBoard(Chess::Board* board)
 	m_board = board;
 }
 
+void BoardScene::prefetchPieces(qreal scale, qreal dpr)
+{
+	QStringList elementIds;
+	const auto items = this->items();
+	for (auto item : items)
+	{
+		auto piece = qgraphicsitem_cast<GraphicsPiece*>(item);
+		if (piece != nullptr && !elementIds.contains(piece->elementId()))
+			elementIds.append(piece->elementId());
+	}
+
+	m_pixmapCache->prefetch(elementIds, qRound(s_squareSize * scale * dpr), dpr);
+}
+
 void BoardScene::populate()
 {
 	Q_ASSERT(m_board != nullptr);
 
 	stopAnimation();
+	const bool flipped = m_squares != nullptr && m_squares->isFlipped();
 	clear();
 	m_history.clear();
 	m_transition.clear();
@@ -97,6 +113,7 @@ void BoardScene::populate()
 	m_squares = new GraphicsBoard(m_board->width(),
 				      m_board->height(),
 				      s_squareSize);
+	m_squares->setFlipped(flipped);
 	addItem(m_squares);
 
 	if (m_board->variantHasDrops())
@@ -142,6 +159,34 @@ void BoardScene::setFenString(const QString& fenString)
 	populate();
 }
 
+void BoardScene::setPosition(const QString& fenString,
+			     const QVector<Chess::GenericMove>& moves)
+{
+	Q_ASSERT(m_board != nullptr);
+
+	stopAnimation();
+	bool ok = m_board->setFenString(fenString);
+	Q_ASSERT(ok); Q_UNUSED(ok);
+
+	// Make all but the last move on the internal board only
+	QList<Chess::BoardTransition> history;
+	for (int i = 0; i < moves.size() - 1; i++)
+	{
+		const Chess::Move move(m_board->moveFromGenericMove(moves.at(i)));
+		Q_ASSERT(m_board->isLegalMove(move));
+
+		Chess::BoardTransition transition;
+		m_board->makeMove(move, &transition);
+		history << transition;
+	}
+
+	populate();
+	m_history = history;
+
+	if (!moves.isEmpty())
+		makeMove(moves.last());
+}
+
 void BoardScene::makeMove(const Chess::Move& move)
 {
 	stopAnimation();
@@ -412,7 +457,7 @@ GraphicsPiece* BoardScene::pieceAt(const QPointF& pos) const
 GraphicsPiece* BoardScene::createPiece(const Chess::Piece& piece)
 {
 	Q_ASSERT(m_board != nullptr);
-	Q_ASSERT(m_renderer != nullptr);
+	Q_ASSERT(m_pixmapCache != nullptr);
 	Q_ASSERT(m_squares != nullptr);
 
 	if (!piece.isValid())
@@ -421,7 +466,7 @@ GraphicsPiece* BoardScene::createPiece(const Chess::Piece& piece)
 	return new GraphicsPiece(piece,
 				 s_squareSize,
 				 m_board->representation(piece),
-				 m_renderer);
+				 m_pixmapCache);
 }
 
 QPropertyAnimation* BoardScene::pieceAnimation(GraphicsPiece* piece,
@@ -22,6 +22,7 @@
 #include <QGraphicsScene>
 #include <QMultiMap>
 #include <QPointer>
+#include <QVector>
 #include <board/square.h>
 #include <board/genericmove.h>
 #include <board/boardtransition.h>
@@ -34,7 +35,7 @@ namespace Chess
 	class Piece;
 }
 class ChessGame;
-class QSvgRenderer;
+class PiecePixmapCache;
 class QAbstractAnimation;
 class QPropertyAnimation;
 class GraphicsBoard;
@@ -73,6 +74,12 @@ class BoardScene : public QGraphicsScene
 		 * best to give the scene its own copy of a board.
 		 */
 		void setBoard(Chess::Board* board);
+		/*!
+		 * Renders the pieces in the scene in a worker thread for a
+		 * view that will show the scene at \a scale on a device with
+		 * a pixel ratio of \a dpr.
+		 */
+		void prefetchPieces(qreal scale, qreal dpr);
 
 	public slots:
 		/*!
@@ -86,6 +93,16 @@ class BoardScene : public QGraphicsScene
 		void populate();
 		/*! Re-populates the scene according to \a fenString. */
 		void setFenString(const QString& fenString);
+		/*!
+		 * Re-populates the scene with the position that follows
+		 * \a moves from \a fenString.
+		 *
+		 * Only the last move is animated, so this is much faster
+		 * than making the moves one by one. The moves can still be
+		 * reversed with undoMove().
+		 */
+		void setPosition(const QString& fenString,
+				 const QVector<Chess::GenericMove>& moves);
 		/*! Makes the move \a move in the scene. */
 		void makeMove(const Chess::Move& move);
 		/*! Makes the move \a move in the scene. */
@@ -153,7 +170,7 @@ class BoardScene : public QGraphicsScene
 		GraphicsPieceReserve* m_reserve;
 		QPointer<PieceChooser> m_chooser;
 		QPointer<QAbstractAnimation> m_anim;
-		QSvgRenderer* m_renderer;
+		PiecePixmapCache* m_pixmapCache;
 		QMultiMap<GraphicsPiece*, Chess::Square> m_targets;
 		QList<Chess::GenericMove> m_moves;
 		Chess::GenericMove m_promotionMove;
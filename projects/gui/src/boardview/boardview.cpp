@@ -20,6 +20,7 @@
 #include <QPainter>
 #include <QResizeEvent>
 #include <QTimer>
+#include "boardscene.h"
 
 
 BoardView::BoardView(QGraphicsScene* scene, QWidget* parent)
@@ -101,6 +102,18 @@ void BoardView::resizeEvent(QResizeEvent* event)
 		scene()->render(&painter);
 	}
 
+	// Render the pieces for the new size while the resize timer
+	// is running. fitInView() leaves a margin of 2 pixels.
+	auto boardScene = qobject_cast<BoardScene*>(scene());
+	const QSizeF sceneSize(sceneRect().size());
+	if (boardScene != nullptr && !sceneSize.isEmpty())
+	{
+		const QRect rect(viewport()->rect().adjusted(2, 2, -2, -2));
+		const qreal scale = qMin(rect.width() / sceneSize.width(),
+					 rect.height() / sceneSize.height());
+		boardScene->prefetchPieces(scale, devicePixelRatioF());
+	}
+
 	m_resizeTimer->start();
 }
 
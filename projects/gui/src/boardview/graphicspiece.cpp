@@ -17,24 +17,26 @@
 */
 
 #include "graphicspiece.h"
-#include <QSvgRenderer>
+#include <QPainter>
+#include <QPaintDevice>
+#include <QtMath>
+#include "piecepixmapcache.h"
 
 
 GraphicsPiece::GraphicsPiece(const Chess::Piece& piece,
 			     qreal squareSize,
 			     const QString& elementId,
-			     QSvgRenderer* renderer,
+			     PiecePixmapCache* cache,
 			     QGraphicsItem* parent)
 	: QGraphicsObject(parent),
 	  m_piece(piece),
 	  m_rect(-squareSize / 2, -squareSize / 2,
 		  squareSize, squareSize),
 	  m_elementId(elementId),
-	  m_renderer(renderer),
+	  m_cache(cache),
 	  m_container(nullptr)
 {
 	setAcceptedMouseButtons(Qt::LeftButton);
-	setCacheMode(DeviceCoordinateCache);
 }
 
 int GraphicsPiece::type() const
@@ -54,23 +56,19 @@ void GraphicsPiece::paint(QPainter* painter,
 	Q_UNUSED(option);
 	Q_UNUSED(widget);
 
-	QRectF bounds(m_renderer->boundsOnElement(m_elementId));
-	qreal ar = bounds.width() / bounds.height();
-	qreal width = m_rect.width() * 0.8;
+	// Size of the square in device pixels
+	const QTransform& transform = painter->worldTransform();
+	const qreal scale = qSqrt(transform.m11() * transform.m11()
+				  + transform.m12() * transform.m12());
+	const qreal dpr = painter->device()->devicePixelRatioF();
+	const int size = qRound(m_rect.width() * scale * dpr);
 
-	if (ar > 1.0)
-	{
-		bounds.setWidth(width);
-		bounds.setHeight(width / ar);
-	}
-	else
-	{
-		bounds.setHeight(width);
-		bounds.setWidth(width * ar);
-	}
-	bounds.moveCenter(m_rect.center());
+	const QPixmap pixmap(m_cache->pixmap(m_elementId, size, dpr));
+	if (pixmap.isNull())
+		return;
 
-	m_renderer->render(painter, m_elementId, bounds);
+	painter->setRenderHint(QPainter::SmoothPixmapTransform);
+	painter->drawPixmap(m_rect, pixmap, QRectF(pixmap.rect()));
 }
 
 Chess::Piece GraphicsPiece::pieceType() const
@@ -78,6 +76,11 @@ Chess::Piece GraphicsPiece::pieceType() const
 	return m_piece;
 }
 
+QString GraphicsPiece::elementId() const
+{
+	return m_elementId;
+}
+
 QGraphicsItem* GraphicsPiece::container() const
 {
 	return m_container;
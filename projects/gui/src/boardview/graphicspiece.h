@@ -21,7 +21,7 @@
 
 #include <QGraphicsObject>
 #include <board/piece.h>
-class QSvgRenderer;
+class PiecePixmapCache;
 
 /*!
  * \brief A graphical representation of a chess piece.
@@ -29,7 +29,9 @@ class QSvgRenderer;
  * A GraphicsPiece object is a chess piece that can be easily
  * dragged and animated in a QGraphicsScene. Scalable Vector
  * Graphics (SVG) are used to ensure that the pieces look good
- * at any resolution, and a shared SVG renderer is used.
+ * at any resolution. The pictures are rendered once for each
+ * size and shared through a PiecePixmapCache, so painting a
+ * piece only draws a pixmap.
  *
  * For convenience reasons the boundingRect() of a piece should
  * be equal to that of a square on the chessboard.
@@ -48,12 +50,12 @@ class GraphicsPiece : public QGraphicsObject
 		 * The painted image is scaled to fit inside a square that is
 		 * \a squareSize wide and high.
 		 * \a elementId is the XML ID of the piece picture which is
-		 * rendered by \a renderer.
+		 * taken from \a cache.
 		 */
 		GraphicsPiece(const Chess::Piece& piece,
 			      qreal squareSize,
 			      const QString& elementId,
-			      QSvgRenderer* renderer,
+			      PiecePixmapCache* cache,
 			      QGraphicsItem* parent = nullptr);
 
 		// Inherited from QGraphicsObject
@@ -65,6 +67,8 @@ class GraphicsPiece : public QGraphicsObject
 
 		/*! Returns the type of the chess piece. */
 		Chess::Piece pieceType() const;
+		/*! Returns the XML ID of the piece picture. */
+		QString elementId() const;
 		/*!
 		 * Returns the container of the piece.
 		 *
@@ -91,7 +95,7 @@ class GraphicsPiece : public QGraphicsObject
 		Chess::Piece m_piece;
 		QRectF m_rect;
 		QString m_elementId;
-		QSvgRenderer* m_renderer;
+		PiecePixmapCache* m_cache;
 		QGraphicsItem* m_container;
 };
 
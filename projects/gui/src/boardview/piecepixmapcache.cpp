@@ -0,0 +1,210 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "piecepixmapcache.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QPainter>
+#include <QSvgRenderer>
+#include <QtConcurrentRun>
+
+namespace {
+
+const int s_defaultCacheLimit = 64 * 1024;
+
+} // anonymous namespace
+
+PiecePixmapCache::PiecePixmapCache(const QString& themeFile, QObject* parent)
+	: QObject(parent),
+	  m_renderer(new QSvgRenderer(this)),
+	  m_cache(s_defaultCacheLimit),
+	  m_generation(0),
+	  m_prefetchGeneration(0)
+{
+	connect(&m_prefetchWatcher, SIGNAL(finished()),
+		this, SLOT(onPrefetchFinished()));
+	setThemeFile(themeFile);
+}
+
+PiecePixmapCache::~PiecePixmapCache()
+{
+	m_prefetchWatcher.waitForFinished();
+}
+
+PiecePixmapCache* PiecePixmapCache::instance()
+{
+	static PiecePixmapCache* cache = nullptr;
+	if (cache == nullptr)
+		cache = new PiecePixmapCache(":/default.svg",
+					     QCoreApplication::instance());
+	return cache;
+}
+
+QString PiecePixmapCache::themeFile() const
+{
+	return m_themeFile;
+}
+
+void PiecePixmapCache::setThemeFile(const QString& themeFile)
+{
+	m_themeFile = themeFile;
+
+	QFile file(themeFile);
+	if (file.open(QIODevice::ReadOnly))
+		m_theme = file.readAll();
+	else
+	{
+		qWarning("Could not open piece theme %s", qUtf8Printable(themeFile));
+		m_theme.clear();
+	}
+	m_renderer->load(m_theme);
+
+	clear();
+}
+
+int PiecePixmapCache::cacheLimit() const
+{
+	return m_cache.maxCost();
+}
+
+void PiecePixmapCache::setCacheLimit(int kbytes)
+{
+	m_cache.setMaxCost(kbytes);
+}
+
+void PiecePixmapCache::clear()
+{
+	m_cache.clear();
+	m_generation++;
+	emit invalidated();
+}
+
+QString PiecePixmapCache::cacheKey(const QString& elementId,
+				   int squareSize,
+				   qreal dpr)
+{
+	return QString("%1/%2@%3").arg(elementId).arg(squareSize).arg(dpr);
+}
+
+QImage PiecePixmapCache::render(QSvgRenderer* renderer,
+				const QString& elementId,
+				int squareSize)
+{
+	QImage image(squareSize, squareSize, QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::transparent);
+
+	// The piece fills 80% of the square and keeps its aspect ratio
+	QRectF bounds(renderer->boundsOnElement(elementId));
+	if (bounds.isEmpty())
+		return image;
+	const qreal ar = bounds.width() / bounds.height();
+	const qreal width = squareSize * 0.8;
+
+	if (ar > 1.0)
+	{
+		bounds.setWidth(width);
+		bounds.setHeight(width / ar);
+	}
+	else
+	{
+		bounds.setHeight(width);
+		bounds.setWidth(width * ar);
+	}
+	bounds.moveCenter(QPointF(squareSize / 2.0, squareSize / 2.0));
+
+	QPainter painter(&image);
+	painter.setRenderHint(QPainter::Antialiasing);
+	renderer->render(&painter, elementId, bounds);
+
+	return image;
+}
+
+void PiecePixmapCache::insert(const QString& key, const QImage& image)
+{
+	const int cost = qMax(1, image.width() * image.height() * 4 / 1024);
+	m_cache.insert(key, new QPixmap(QPixmap::fromImage(image)), cost);
+}
+
+QPixmap PiecePixmapCache::pixmap(const QString& elementId,
+				 int squareSize,
+				 qreal dpr)
+{
+	if (squareSize <= 0)
+		return QPixmap();
+
+	const QString key(cacheKey(elementId, squareSize, dpr));
+	QPixmap* pixmap = m_cache.object(key);
+	if (pixmap != nullptr)
+		return *pixmap;
+
+	const QImage image(render(m_renderer, elementId, squareSize));
+	insert(key, image);
+
+	pixmap = m_cache.object(key);
+	if (pixmap != nullptr)
+		return *pixmap;
+	return QPixmap::fromImage(image);
+}
+
+QVector<PiecePixmapCache::RenderJob> PiecePixmapCache::renderJobs(
+	const QByteArray& theme,
+	QVector<RenderJob> jobs)
+{
+	// QSvgRenderer is not thread-safe, so the worker has its own
+	QSvgRenderer renderer(theme);
+	for (RenderJob& job : jobs)
+		job.image = render(&renderer, job.elementId, job.squareSize);
+
+	return jobs;
+}
+
+void PiecePixmapCache::prefetch(const QStringList& elementIds,
+				int squareSize,
+				qreal dpr)
+{
+	if (squareSize <= 0 || m_prefetchWatcher.isRunning())
+		return;
+
+	QVector<RenderJob> jobs;
+	for (const QString& elementId : elementIds)
+	{
+		const QString key(cacheKey(elementId, squareSize, dpr));
+		if (!m_cache.contains(key))
+			jobs.append(RenderJob{key, elementId, squareSize, QImage()});
+	}
+	if (jobs.isEmpty())
+		return;
+
+	m_prefetchGeneration = m_generation;
+	m_prefetchWatcher.setFuture(QtConcurrent::run(renderJobs, m_theme, jobs));
+}
+
+void PiecePixmapCache::onPrefetchFinished()
+{
+	// The theme was changed while the pieces were being rendered
+	if (m_prefetchGeneration != m_generation)
+		return;
+
+	const auto jobs = m_prefetchWatcher.result();
+	for (const RenderJob& job : jobs)
+	{
+		if (!m_cache.contains(job.key))
+			insert(job.key, job.image);
+	}
+}
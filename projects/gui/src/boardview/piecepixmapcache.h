@@ -0,0 +1,131 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef PIECEPIXMAPCACHE_H
+#define PIECEPIXMAPCACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QPixmap>
+#include <QStringList>
+#include <QVector>
+class QSvgRenderer;
+
+/*!
+ * \brief A shared cache of pre-rendered piece pictures
+ *
+ * Rendering an SVG picture is slow compared to drawing a pixmap, so
+ * all board views share one cache of rasterized pieces. A pixmap is
+ * identified by the XML ID of the piece picture (which encodes the
+ * piece type and side), the size of a square in device pixels and
+ * the device pixel ratio.
+ *
+ * Missing pixmaps are rendered when they are first needed. A view
+ * that knows its next size in advance can have them rendered in a
+ * worker thread with prefetch(). Changing the theme discards all
+ * pixmaps; pixmaps of unused sizes are dropped when the cache is full.
+ */
+class PiecePixmapCache : public QObject
+{
+	Q_OBJECT
+
+	public:
+		/*! Creates a new cache for the pieces in \a themeFile. */
+		explicit PiecePixmapCache(const QString& themeFile,
+					  QObject* parent = nullptr);
+		/*! Destroys the cache. */
+		virtual ~PiecePixmapCache();
+
+		/*! Returns the cache shared by all board scenes. */
+		static PiecePixmapCache* instance();
+
+		/*! Returns the SVG file of the piece pictures. */
+		QString themeFile() const;
+		/*!
+		 * Sets the SVG file of the piece pictures to \a themeFile
+		 * and discards all cached pixmaps.
+		 */
+		void setThemeFile(const QString& themeFile);
+
+		/*! Returns the maximum size of the cache in kilobytes. */
+		int cacheLimit() const;
+		/*! Sets the maximum size of the cache to \a kbytes. */
+		void setCacheLimit(int kbytes);
+
+		/*!
+		 * Returns the picture \a elementId for a square that is
+		 * \a squareSize device pixels wide on a device with a pixel
+		 * ratio of \a dpr.
+		 *
+		 * The pixmap is rendered now if it's not in the cache.
+		 */
+		QPixmap pixmap(const QString& elementId, int squareSize, qreal dpr);
+		/*!
+		 * Renders the pictures in \a elementIds for a square of
+		 * \a squareSize device pixels in a worker thread.
+		 *
+		 * Pictures that are already cached are skipped.
+		 */
+		void prefetch(const QStringList& elementIds, int squareSize, qreal dpr);
+
+	public slots:
+		/*! Discards all cached pixmaps. */
+		void clear();
+
+	signals:
+		/*!
+		 * This signal is emitted when the cached pixmaps are
+		 * discarded, eg. after a theme change.
+		 */
+		void invalidated();
+
+	private slots:
+		void onPrefetchFinished();
+
+	private:
+		struct RenderJob
+		{
+			QString key;
+			QString elementId;
+			int squareSize;
+			QImage image;
+		};
+
+		static QString cacheKey(const QString& elementId,
+					int squareSize,
+					qreal dpr);
+		static QImage render(QSvgRenderer* renderer,
+				     const QString& elementId,
+				     int squareSize);
+		static QVector<RenderJob> renderJobs(const QByteArray& theme,
+						     QVector<RenderJob> jobs);
+		void insert(const QString& key, const QImage& image);
+
+		QString m_themeFile;
+		QByteArray m_theme;
+		QSvgRenderer* m_renderer;
+		QCache<QString, QPixmap> m_cache;
+		int m_generation;
+		int m_prefetchGeneration;
+		QFutureWatcher<QVector<RenderJob>> m_prefetchWatcher;
+};
+
+#endif // PIECEPIXMAPCACHE_H
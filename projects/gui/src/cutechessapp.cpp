@@ -203,7 +203,12 @@ void CuteChessApplication::showGameWindow(int index)
 GameDatabaseManager* CuteChessApplication::gameDatabaseManager()
 {
 	if (m_gameDatabaseManager == nullptr)
+	{
 		m_gameDatabaseManager = new GameDatabaseManager(this);
+		if (QSettings().value("ui/position_index", true).toBool())
+			m_gameDatabaseManager->setPositionIndexDirectory(
+				configPath() + QLatin1String("/positionindex"));
+	}
 
 	return m_gameDatabaseManager;
 }
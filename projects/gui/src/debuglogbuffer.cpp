@@ -0,0 +1,89 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "debuglogbuffer.h"
+#include <QMutexLocker>
+
+namespace {
+
+QAtomicInteger<quint64> s_sequence(0);
+
+} // anonymous namespace
+
+DebugLogBuffer::DebugLogBuffer(int capacity)
+	: m_ring(capacity + 1),
+	  m_head(0),
+	  m_tail(0),
+	  m_overflowing(0)
+{
+	Q_ASSERT(capacity > 0);
+}
+
+quint64 DebugLogBuffer::nextSequence()
+{
+	return s_sequence.fetchAndAddRelaxed(1);
+}
+
+void DebugLogBuffer::push(const QString& line)
+{
+	const quint64 seq = nextSequence();
+
+	if (!m_overflowing.loadAcquire())
+	{
+		const int head = m_head.load();
+		const int next = (head + 1) % m_ring.size();
+
+		// One slot is always left empty to tell a full ring
+		// from an empty one
+		if (next != m_tail.loadAcquire())
+		{
+			Entry& entry = m_ring[head];
+			entry.seq = seq;
+			entry.line = line;
+			m_head.storeRelease(next);
+			return;
+		}
+	}
+
+	QMutexLocker locker(&m_overflowMutex);
+	m_overflow.append(Entry{seq, line});
+	m_overflowing.storeRelease(1);
+}
+
+void DebugLogBuffer::drain(QVector<Entry>& entries)
+{
+	const int head = m_head.loadAcquire();
+	int tail = m_tail.load();
+
+	while (tail != head)
+	{
+		Entry& entry = m_ring[tail];
+		entries.append(Entry{entry.seq, std::move(entry.line)});
+		entry.line = QString();
+		tail = (tail + 1) % m_ring.size();
+	}
+	m_tail.storeRelease(tail);
+
+	if (m_overflowing.loadAcquire())
+	{
+		QMutexLocker locker(&m_overflowMutex);
+		entries += m_overflow;
+		m_overflow.clear();
+		m_overflowing.storeRelease(0);
+	}
+}
@@ -0,0 +1,81 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DEBUG_LOG_BUFFER_H
+#define DEBUG_LOG_BUFFER_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+/*!
+ * \brief A single-producer, single-consumer queue of log lines
+ *
+ * DebugLogBuffer carries debug lines from an engine's thread to the
+ * GUI thread without taking a lock. The producer calls push() and the
+ * consumer calls drain(). Each line is tagged with a sequence number so
+ * that lines from several buffers can be merged in their original order.
+ *
+ * If the consumer falls behind and the ring is full, lines go to an
+ * overflow list that is protected by a mutex, so nothing is lost.
+ */
+class DebugLogBuffer
+{
+	public:
+		/*! A log line and its sequence number. */
+		struct Entry
+		{
+			quint64 seq;
+			QString line;
+		};
+
+		/*! The default number of slots in the ring. */
+		static const int DefaultCapacity = 4096;
+
+		/*! Creates a new buffer with room for \a capacity lines. */
+		explicit DebugLogBuffer(int capacity = DefaultCapacity);
+
+		/*!
+		 * Adds \a line to the buffer.
+		 *
+		 * Must only be called from the producer thread.
+		 */
+		void push(const QString& line);
+		/*!
+		 * Moves all buffered lines to the end of \a entries.
+		 *
+		 * Must only be called from the consumer thread.
+		 */
+		void drain(QVector<Entry>& entries);
+
+		/*! Returns the next sequence number shared by all buffers. */
+		static quint64 nextSequence();
+
+	private:
+		Q_DISABLE_COPY(DebugLogBuffer)
+
+		QVector<Entry> m_ring;
+		QAtomicInt m_head;
+		QAtomicInt m_tail;
+		QAtomicInt m_overflowing;
+		QMutex m_overflowMutex;
+		QVector<Entry> m_overflow;
+};
+
+#endif // DEBUG_LOG_BUFFER_H
@@ -0,0 +1,319 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "enginedebuglog.h"
+#include <QFile>
+#include <QTextStream>
+#include <QtConcurrentRun>
+#include <algorithm>
+#include <chessplayer.h>
+#include "debuglogbuffer.h"
+
+namespace {
+
+QStringList filterLines(const QString& fileName,
+			qint64 fileSize,
+			const QContiguousCache<QString>& lines,
+			const QString& filter,
+			int limit)
+{
+	// Only the last matches fit in the view
+	QContiguousCache<QString> matches(limit);
+
+	if (!fileName.isEmpty() && !filter.isEmpty())
+	{
+		QFile file(fileName);
+		if (file.open(QIODevice::ReadOnly))
+		{
+			while (file.pos() < fileSize && !file.atEnd())
+			{
+				QString line(QString::fromUtf8(file.readLine()));
+				line.chop(1);
+				if (line.contains(filter, Qt::CaseInsensitive))
+					matches.append(line);
+			}
+		}
+	}
+
+	for (int i = lines.firstIndex(); i <= lines.lastIndex(); i++)
+	{
+		const QString& line = lines.at(i);
+		if (filter.isEmpty() || line.contains(filter, Qt::CaseInsensitive))
+			matches.append(line);
+	}
+
+	QStringList result;
+	result.reserve(matches.count());
+	for (int i = matches.firstIndex(); i <= matches.lastIndex(); i++)
+		result.append(matches.at(i));
+
+	return result;
+}
+
+} // anonymous namespace
+
+EngineDebugLog::EngineDebugLog(QWidget* parent)
+	: PlainTextLog(parent),
+	  m_flushRequested(0),
+	  m_lines(DefaultLineLimit),
+	  m_filterPending(false),
+	  m_filterStart(0)
+{
+	setMaximumBlockCount(DefaultLineLimit);
+
+	m_flushCoalescer.setRate(MaxFrameRate);
+	connect(&m_flushCoalescer, SIGNAL(update()), this, SLOT(flush()));
+	connect(&m_filterWatcher, SIGNAL(finished()),
+		this, SLOT(onFilterFinished()));
+}
+
+EngineDebugLog::~EngineDebugLog()
+{
+	removePlayers();
+	m_filterWatcher.waitForFinished();
+}
+
+void EngineDebugLog::addPlayer(ChessPlayer* player)
+{
+	Q_ASSERT(player != nullptr);
+	if (m_buffers.contains(player))
+		return;
+
+	auto buffer = QSharedPointer<DebugLogBuffer>::create();
+	m_buffers[player] = buffer;
+
+	// This is called in the player's thread. Only the first line
+	// after a flush posts an event to the GUI thread.
+	m_connections[player] = connect(player, &ChessPlayer::debugMessage,
+					this, [=](const QString& line)
+	{
+		buffer->push(line);
+		if (m_flushRequested.testAndSetOrdered(0, 1))
+			QMetaObject::invokeMethod(&m_flushCoalescer,
+						  "requestUpdate",
+						  Qt::QueuedConnection);
+	}, Qt::DirectConnection);
+}
+
+void EngineDebugLog::removePlayers()
+{
+	// The players may already be gone, so the pointers are
+	// only used as keys here
+	for (const auto& connection : qAsConst(m_connections))
+		disconnect(connection);
+	m_connections.clear();
+
+	flush();
+	m_buffers.clear();
+}
+
+int EngineDebugLog::lineLimit() const
+{
+	return m_lines.capacity();
+}
+
+void EngineDebugLog::setLineLimit(int limit)
+{
+	limit = qMax(limit, 1);
+	if (limit == m_lines.capacity())
+		return;
+
+	QStringList spilled;
+	while (m_lines.count() > limit)
+		spilled.append(m_lines.takeFirst());
+	spillLines(spilled);
+
+	m_lines.setCapacity(limit);
+	setMaximumBlockCount(limit);
+}
+
+QString EngineDebugLog::filter() const
+{
+	return m_filter;
+}
+
+void EngineDebugLog::setFilter(const QString& filter)
+{
+	if (filter == m_filter)
+		return;
+
+	m_filter = filter;
+	if (m_filterWatcher.isRunning())
+		m_filterPending = true;
+	else
+		startFilter();
+}
+
+void EngineDebugLog::clearLog()
+{
+	QVector<DebugLogBuffer::Entry> entries;
+	for (const auto& buffer : qAsConst(m_buffers))
+		buffer->drain(entries);
+
+	m_lines.clear();
+	if (m_spillFile.isOpen())
+	{
+		m_spillFile.resize(0);
+		m_spillFile.seek(0);
+	}
+	if (m_filterWatcher.isRunning())
+		m_filterPending = true;
+
+	clear();
+}
+
+void EngineDebugLog::writeLog(QTextStream& out)
+{
+	// The whole log is saved, regardless of the filter
+	flush();
+
+	if (m_spillFile.isOpen() && m_spillFile.flush())
+	{
+		QFile file(m_spillFile.fileName());
+		if (file.open(QIODevice::ReadOnly))
+		{
+			while (!file.atEnd())
+				out << QString::fromUtf8(file.readLine());
+		}
+	}
+
+	for (int i = m_lines.firstIndex(); i <= m_lines.lastIndex(); i++)
+		out << m_lines.at(i) << '\n';
+}
+
+void EngineDebugLog::flush()
+{
+	m_flushCoalescer.cancel();
+	m_flushRequested.storeRelease(0);
+
+	QVector<DebugLogBuffer::Entry> entries;
+	for (const auto& buffer : qAsConst(m_buffers))
+		buffer->drain(entries);
+	if (entries.isEmpty())
+		return;
+
+	std::sort(entries.begin(), entries.end(),
+		  [](const DebugLogBuffer::Entry& a, const DebugLogBuffer::Entry& b)
+	{
+		return a.seq < b.seq;
+	});
+
+	QStringList lines;
+	lines.reserve(entries.size());
+	for (const auto& entry : qAsConst(entries))
+		lines.append(entry.line);
+	storeLines(lines);
+
+	// A running filter shows the new lines when it's done
+	if (m_filterWatcher.isRunning())
+		return;
+
+	if (!m_filter.isEmpty())
+	{
+		QStringList shown;
+		for (const QString& line : qAsConst(lines))
+		{
+			if (matches(line))
+				shown.append(line);
+		}
+		lines = shown;
+	}
+	if (!lines.isEmpty())
+		appendPlainText(lines.join('\n'));
+}
+
+void EngineDebugLog::startFilter()
+{
+	m_filterPending = false;
+	m_filterStart = m_lines.lastIndex() + 1;
+
+	QString fileName;
+	qint64 fileSize = 0;
+	if (m_spillFile.isOpen() && m_spillFile.flush())
+	{
+		fileName = m_spillFile.fileName();
+		fileSize = m_spillFile.size();
+	}
+
+	m_filterWatcher.setFuture(QtConcurrent::run(filterLines,
+						    fileName,
+						    fileSize,
+						    m_lines,
+						    m_filter,
+						    lineLimit()));
+}
+
+void EngineDebugLog::onFilterFinished()
+{
+	if (m_filterPending)
+	{
+		startFilter();
+		return;
+	}
+
+	// Add the lines that were logged while the filter was running
+	QStringList lines(m_filterWatcher.result());
+	for (int i = qMax(m_filterStart, m_lines.firstIndex());
+	     i <= m_lines.lastIndex(); i++)
+	{
+		if (matches(m_lines.at(i)))
+			lines.append(m_lines.at(i));
+	}
+
+	setPlainText(lines.join('\n'));
+	moveCursor(QTextCursor::End);
+}
+
+void EngineDebugLog::storeLines(const QStringList& lines)
+{
+	QStringList spilled;
+	for (const QString& line : lines)
+	{
+		if (m_lines.isFull())
+			spilled.append(m_lines.takeFirst());
+		m_lines.append(line);
+	}
+	spillLines(spilled);
+}
+
+void EngineDebugLog::spillLines(const QStringList& lines)
+{
+	if (lines.isEmpty())
+		return;
+
+	if (!m_spillFile.isOpen() && !m_spillFile.open())
+	{
+		qWarning("Could not open a temporary file for the debug log: %s",
+			 qUtf8Printable(m_spillFile.errorString()));
+		return;
+	}
+
+	QByteArray data;
+	for (const QString& line : lines)
+	{
+		data += line.toUtf8();
+		data += '\n';
+	}
+	m_spillFile.write(data);
+}
+
+bool EngineDebugLog::matches(const QString& line) const
+{
+	return m_filter.isEmpty() || line.contains(m_filter, Qt::CaseInsensitive);
+}
@@ -0,0 +1,122 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef ENGINE_DEBUG_LOG_H
+#define ENGINE_DEBUG_LOG_H
+
+#include "plaintextlog.h"
+#include <QAtomicInt>
+#include <QContiguousCache>
+#include <QFutureWatcher>
+#include <QMap>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QTemporaryFile>
+#include "updatecoalescer.h"
+
+class ChessPlayer;
+class DebugLogBuffer;
+
+/*!
+ * \brief A bounded log of the players' debug output
+ *
+ * EngineDebugLog collects the debugMessage() lines of its players in
+ * a lock-free DebugLogBuffer per player. The engine threads never post
+ * an event per line: the buffers are drained in the GUI thread and the
+ * lines are appended to the view in one batch, at most maxFrameRate()
+ * times per second.
+ *
+ * Only the latest lineLimit() lines are kept in memory. Older lines
+ * are moved to a temporary file, so the whole log can still be saved
+ * and searched. Filtering runs in a worker thread.
+ */
+class EngineDebugLog : public PlainTextLog
+{
+	Q_OBJECT
+
+	public:
+		/*! The default number of lines kept in memory. */
+		static const int DefaultLineLimit = 10000;
+		/*! The maximum number of view updates per second. */
+		static const int MaxFrameRate = 30;
+
+		/*! Creates a new log with the given \a parent. */
+		explicit EngineDebugLog(QWidget* parent = nullptr);
+		/*! Destroys the log and its temporary file. */
+		virtual ~EngineDebugLog();
+
+		/*! Starts collecting the debug output of \a player. */
+		void addPlayer(ChessPlayer* player);
+		/*!
+		 * Stops collecting the debug output of all players.
+		 *
+		 * Lines that are still in the buffers are added to the log.
+		 */
+		void removePlayers();
+
+		/*! Returns the number of lines kept in memory. */
+		int lineLimit() const;
+		/*!
+		 * Sets the number of lines kept in memory to \a limit.
+		 *
+		 * Lines that don't fit are moved to the temporary file.
+		 */
+		void setLineLimit(int limit);
+
+		/*! Returns the filter string. */
+		QString filter() const;
+
+	public slots:
+		/*!
+		 * Shows only the lines that contain \a filter.
+		 *
+		 * The comparison is case-insensitive. An empty string
+		 * shows all lines.
+		 */
+		void setFilter(const QString& filter);
+		// Inherited from PlainTextLog
+		virtual void clearLog();
+
+	protected:
+		// Inherited from PlainTextLog
+		virtual void writeLog(QTextStream& out);
+
+	private slots:
+		void flush();
+		void onFilterFinished();
+
+	private:
+		void startFilter();
+		void storeLines(const QStringList& lines);
+		void spillLines(const QStringList& lines);
+		bool matches(const QString& line) const;
+
+		QMap<ChessPlayer*, QSharedPointer<DebugLogBuffer>> m_buffers;
+		QMap<ChessPlayer*, QMetaObject::Connection> m_connections;
+		QAtomicInt m_flushRequested;
+		UpdateCoalescer m_flushCoalescer;
+		QContiguousCache<QString> m_lines;
+		QTemporaryFile m_spillFile;
+		QString m_filter;
+		bool m_filterPending;
+		int m_filterStart;
+		QFutureWatcher<QStringList> m_filterWatcher;
+};
+
+#endif // ENGINE_DEBUG_LOG_H
@@ -22,11 +22,13 @@
 #include <qcustomplot.h>
 #include <chessgame.h>
 #include <moveevaluation.h>
+#include "updatecoalescer.h"
 
 EvalHistory::EvalHistory(QWidget *parent)
 	: QWidget(parent),
 	  m_plot(new QCustomPlot(this)),
-	  m_game(nullptr)
+	  m_game(nullptr),
+	  m_coalescer(new UpdateCoalescer(this))
 {
 	auto x = m_plot->xAxis;
 	auto y = m_plot->yAxis;
@@ -47,6 +49,18 @@ EvalHistory::EvalHistory(QWidget *parent)
 	setLayout(layout);
 
 	setMinimumHeight(120);
+
+	connect(m_coalescer, SIGNAL(update()), this, SLOT(flush()));
+}
+
+int EvalHistory::updateRate() const
+{
+	return m_coalescer->rate();
+}
+
+void EvalHistory::setUpdateRate(int rate)
+{
+	m_coalescer->setRate(rate);
 }
 
 void EvalHistory::setGame(ChessGame* game)
@@ -54,6 +68,8 @@ void EvalHistory::setGame(ChessGame* game)
 	if (m_game)
 		m_game->disconnect(this);
 	m_game = game;
+	m_coalescer->cancel();
+	m_pendingScores.clear();
 	m_plot->clearGraphs();
 	if (!game)
 	{
@@ -128,6 +144,20 @@ void EvalHistory::replot(int maxPly)
 
 void EvalHistory::onScore(int ply, int score)
 {
-	addData(ply, score);
-	replot(ply);
+	m_pendingScores[ply] = score;
+	m_coalescer->requestUpdate();
+}
+
+void EvalHistory::flush()
+{
+	if (m_pendingScores.isEmpty())
+		return;
+
+	for (auto it = m_pendingScores.constBegin();
+	     it != m_pendingScores.constEnd(); ++it)
+		addData(it.key(), it.value());
+	const int maxPly = m_pendingScores.lastKey();
+	m_pendingScores.clear();
+
+	replot(maxPly);
 }
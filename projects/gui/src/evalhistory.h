@@ -21,15 +21,20 @@
 
 #include <QWidget>
 #include <QPointer>
+#include <QMap>
 
 class QCustomPlot;
 class ChessGame;
+class UpdateCoalescer;
 
 /*!
  * \brief A widget that shows engines' move evaluation history.
  *
  * The fullmove number is on the X axis and score (from white's
  * perspective) is on the Y axis.
+ *
+ * New scores are collected and added to the graph in one batch, with
+ * one replot at most updateRate() times per second.
  */
 class EvalHistory : public QWidget
 {
@@ -44,8 +49,17 @@ class EvalHistory : public QWidget
 		 */
 		void setGame(ChessGame* game);
 
+		/*! Returns the maximum number of replots per second. */
+		int updateRate() const;
+		/*!
+		 * Sets the maximum number of replots per second to \a rate.
+		 * A rate of 0 replots after every score.
+		 */
+		void setUpdateRate(int rate);
+
 	private slots:
 		void onScore(int ply, int score);
+		void flush();
 
 	private:
 		void addData(int ply, int score);
@@ -53,6 +67,8 @@ class EvalHistory : public QWidget
 
 		QCustomPlot* m_plot;
 		QPointer<ChessGame> m_game;
+		UpdateCoalescer* m_coalescer;
+		QMap<int, int> m_pendingScores;
 };
 
 #endif // EVALHISTORY_H
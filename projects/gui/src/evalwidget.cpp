@@ -24,10 +24,12 @@
 #include <QVector>
 #include <QTime>
 #include <chessplayer.h>
+#include "updatecoalescer.h"
 
 EvalWidget::EvalWidget(QWidget *parent)
 	: QWidget(parent),
 	  m_player(nullptr),
+	  m_coalescer(new UpdateCoalescer(this)),
 	  m_statsTable(new QTableWidget(1, 5, this)),
 	  m_pvTable(new QTableWidget(0, 5, this)),
 	  m_depth(-1)
@@ -66,10 +68,24 @@ EvalWidget::EvalWidget(QWidget *parent)
 	layout->addWidget(m_pvTable);
 	layout->setContentsMargins(0, 0, 0, 0);
 	setLayout(layout);
+
+	connect(m_coalescer, SIGNAL(update()), this, SLOT(flush()));
+}
+
+int EvalWidget::updateRate() const
+{
+	return m_coalescer->rate();
+}
+
+void EvalWidget::setUpdateRate(int rate)
+{
+	m_coalescer->setRate(rate);
 }
 
 void EvalWidget::clear()
 {
+	m_coalescer->cancel();
+	m_pending.clear();
 	m_statsTable->clearContents();
 	m_depth = -1;
 	m_pv.clear();
@@ -94,6 +110,37 @@ void EvalWidget::setPlayer(ChessPlayer* player)
 }
 
 void EvalWidget::onEval(const MoveEvaluation& eval)
+{
+	// A newer evaluation of the same PV at the same depth replaces
+	// the pending one. The fields it doesn't have are kept.
+	MoveEvaluation latest(eval);
+	for (int i = m_pending.size() - 1; i >= 0; i--)
+	{
+		const MoveEvaluation& old = m_pending.at(i);
+		if (old.pvNumber() == eval.pvNumber()
+		&&  old.depth() == eval.depth())
+		{
+			latest = old;
+			latest.merge(eval);
+			m_pending.remove(i);
+			break;
+		}
+	}
+	m_pending.append(latest);
+	m_coalescer->requestUpdate();
+}
+
+void EvalWidget::flush()
+{
+	for (const MoveEvaluation& eval : qAsConst(m_pending))
+	{
+		updateStats(eval);
+		updatePv(eval);
+	}
+	m_pending.clear();
+}
+
+void EvalWidget::updateStats(const MoveEvaluation& eval)
 {
 	auto nps = eval.nps();
 	if (nps)
@@ -130,7 +177,10 @@ void EvalWidget::onEval(const MoveEvaluation& eval)
 		item->setText(QString("%1%").arg(rate, 0, 'f', 1));
 		m_statsTable->setItem(0, PonderHitHeader, item);
 	}
+}
 
+void EvalWidget::updatePv(const MoveEvaluation& eval)
+{
 	QString depth;
 	if (eval.depth())
 	{
@@ -21,13 +21,19 @@
 
 #include <QWidget>
 #include <QPointer>
+#include <QVector>
 #include <moveevaluation.h>
 
 class QTableWidget;
 class ChessPlayer;
+class UpdateCoalescer;
 
 /*!
  * \brief A widget that shows the engine's thinking in realtime.
+ *
+ * The evaluations are not shown as soon as they arrive. Only the
+ * latest evaluation for each PV and depth is kept, and the tables
+ * are updated at most updateRate() times per second.
  */
 class EvalWidget : public QWidget
 {
@@ -43,9 +49,18 @@ class EvalWidget : public QWidget
 		 */
 		void setPlayer(ChessPlayer* player);
 
+		/*! Returns the maximum number of updates per second. */
+		int updateRate() const;
+		/*!
+		 * Sets the maximum number of updates per second to \a rate.
+		 * A rate of 0 shows every evaluation as it arrives.
+		 */
+		void setUpdateRate(int rate);
+
 	private slots:
 		void clear();
 		void onEval(const MoveEvaluation& eval);
+		void flush();
 
 	private:
 		enum StatHeaders
@@ -57,7 +72,12 @@ class EvalWidget : public QWidget
 			TbHeader
 		};
 
+		void updateStats(const MoveEvaluation& eval);
+		void updatePv(const MoveEvaluation& eval);
+
 		QPointer<ChessPlayer> m_player;
+		UpdateCoalescer* m_coalescer;
+		QVector<MoveEvaluation> m_pending;
 		QTableWidget* m_statsTable;
 		QTableWidget* m_pvTable;
 		int m_depth;
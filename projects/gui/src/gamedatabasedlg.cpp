@@ -31,6 +31,7 @@
 #include <pgngame.h>
 #include <pgngameentry.h>
 #include <polyglotbook.h>
+#include <positionindex.h>
 
 #include "pgndatabasemodel.h"
 #include "pgngameentrymodel.h"
@@ -257,6 +258,8 @@ GameDatabaseDialog::GameDatabaseDialog(GameDatabaseManager* dbManager, QWidget*
 	  m_dbManager(dbManager),
 	  m_pgnDatabaseModel(nullptr),
 	  m_pgnGameEntryModel(nullptr),
+	  m_positionSearch(false),
+	  m_positionKey(0),
 	  ui(new Ui::GameDatabaseDialog)
 {
 	Q_ASSERT(dbManager != nullptr);
@@ -335,6 +338,9 @@ GameDatabaseDialog::GameDatabaseDialog(GameDatabaseManager* dbManager, QWidget*
 	connect(ui->m_advancedSearchBtn, SIGNAL(clicked()),
 		this, SLOT(onAdvancedSearch()));
 
+	connect(ui->m_positionSearchBtn, SIGNAL(clicked()),
+		this, SLOT(onPositionSearch()));
+
 	connect(m_pgnGameEntryModel, SIGNAL(modelReset()), this,
 		SLOT(updateUi()));
 	connect(m_pgnGameEntryModel, SIGNAL(rowsInserted(const QModelIndex&, int, int)),
@@ -372,7 +378,10 @@ void GameDatabaseDialog::databaseSelectionChanged(const QItemSelection& selected
 		entries.append(it.value()->entries());
 
 	m_pgnGameEntryModel->setEntries(entries);
+	if (m_positionSearch)
+		searchPosition();
 	ui->m_advancedSearchBtn->setEnabled(true);
+	ui->m_positionSearchBtn->setEnabled(true);
 }
 
 void GameDatabaseDialog::gameSelectionChanged(const QModelIndex& current,
@@ -464,6 +473,12 @@ void GameDatabaseDialog::updateSearch(const QString& terms)
 
 void GameDatabaseDialog::onSearchTimeout()
 {
+	// Clearing the search also ends the position search
+	if (m_searchTerms.isEmpty() && m_positionSearch)
+	{
+		m_positionSearch = false;
+		m_pgnGameEntryModel->clearIndexFilter();
+	}
 	m_pgnGameEntryModel->setFilter(m_searchTerms);
 }
 
@@ -479,6 +494,59 @@ void GameDatabaseDialog::onAdvancedSearch()
 	ui->m_clearBtn->setEnabled(true);
 }
 
+void GameDatabaseDialog::onPositionSearch()
+{
+	const Chess::Board* board = m_gameViewer->board();
+	if (board == nullptr)
+		return;
+
+	m_positionKey = board->key();
+	m_positionSearch = true;
+
+	ui->m_searchEdit->setText(tr("[Position search]"));
+	ui->m_searchEdit->setEnabled(false);
+	ui->m_clearBtn->setEnabled(true);
+
+	const QStringList unindexed(searchPosition());
+	if (!unindexed.isEmpty())
+	{
+		QMessageBox::information(this, tr("Position search"),
+			tr("These databases don't have a position index and "
+			   "must be imported again to be searched:\n\n%1")
+			.arg(unindexed.join('\n')));
+	}
+}
+
+QStringList GameDatabaseDialog::searchPosition()
+{
+	QVector<int> indexes;
+	QStringList unindexed;
+	int offset = 0;
+
+	// The model's source indexes run through the selected databases
+	// in the same order as in databaseSelectionChanged()
+	for (const PgnDatabase* db : qAsConst(m_selectedDatabases))
+	{
+		const int count = db->entries().size();
+
+		PositionIndex index;
+		if (index.open(m_dbManager->positionIndexFile(db))
+		&&  index.gameCount() == quint32(count))
+		{
+			const auto games = index.find(m_positionKey);
+			for (quint32 game : games)
+				indexes.append(offset + int(game));
+		}
+		else
+			unindexed.append(db->displayName());
+
+		offset += count;
+	}
+
+	m_pgnGameEntryModel->setIndexFilter(indexes);
+	return unindexed;
+}
+
 int GameDatabaseDialog::databaseIndexFromGame(int game) const
 {
 	if (m_selectedDatabases.isEmpty())
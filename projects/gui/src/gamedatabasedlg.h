@@ -22,6 +22,7 @@
 #include <QDialog>
 #include <QTimer>
 #include <QItemSelection>
+#include <QStringList>
 
 #include <pgngame.h>
 
@@ -59,6 +60,7 @@ class GameDatabaseDialog : public QDialog
 		void updateSearch(const QString& terms = QString());
 		void onSearchTimeout();
 		void onAdvancedSearch();
+		void onPositionSearch();
 		void exportPgn(const QString& filename);
 		void createOpeningBook();
 		void copyGame();
@@ -68,6 +70,7 @@ class GameDatabaseDialog : public QDialog
 	private:
 		friend class PgnGameIterator;
 		int databaseIndexFromGame(int game) const;
+		QStringList searchPosition();
 
 		GameViewer* m_gameViewer;
 		PgnGame m_game;
@@ -80,6 +83,8 @@ class GameDatabaseDialog : public QDialog
 
 		QTimer m_searchTimer;
 		QString m_searchTerms;
+		bool m_positionSearch;
+		quint64 m_positionKey;
 		Ui::GameDatabaseDialog* ui;
 };
 
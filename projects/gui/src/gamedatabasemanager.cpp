@@ -21,6 +21,8 @@
 #include <QFileInfo>
 #include <QDataStream>
 #include <QThreadPool>
+#include <QDir>
+#include <QCryptographicHash>
 
 #include <pgngameentry.h>
 
@@ -178,6 +180,8 @@ bool GameDatabaseManager::readState(const QString& fileName)
 void GameDatabaseManager::importPgnFile(const QString& fileName)
 {
 	PgnImporter* pgnImporter = new PgnImporter(fileName);
+	if (!m_positionIndexDir.isEmpty() && QDir().mkpath(m_positionIndexDir))
+		pgnImporter->setPositionIndexFile(positionIndexFile(fileName));
 	connect(pgnImporter, SIGNAL(databaseRead(PgnDatabase*)),
 		this, SLOT(addDatabase(PgnDatabase*)));
 
@@ -199,6 +203,9 @@ void GameDatabaseManager::addDatabase(PgnDatabase* database)
 void GameDatabaseManager::removeDatabase(int index)
 {
 	emit databaseAboutToBeRemoved(index);
+	const QString indexFile(positionIndexFile(m_databases.at(index)));
+	if (!indexFile.isEmpty())
+		QFile::remove(indexFile);
 	m_databases.removeAt(index);
 	m_modified = true;
 }
@@ -220,3 +227,25 @@ void GameDatabaseManager::setModified(bool modified)
 {
 	m_modified = modified;
 }
+
+void GameDatabaseManager::setPositionIndexDirectory(const QString& path)
+{
+	m_positionIndexDir = path;
+}
+
+QString GameDatabaseManager::positionIndexFile(const PgnDatabase* database) const
+{
+	return positionIndexFile(database->fileName());
+}
+
+QString GameDatabaseManager::positionIndexFile(const QString& fileName) const
+{
+	if (m_positionIndexDir.isEmpty())
+		return QString();
+
+	// One index per PGN file, named after a hash of its path
+	const QByteArray hash(QCryptographicHash::hash(
+		QFileInfo(fileName).absoluteFilePath().toUtf8(),
+		QCryptographicHash::Sha1));
+	return m_positionIndexDir + '/' + QString::fromLatin1(hash.toHex()) + ".idx";
+}
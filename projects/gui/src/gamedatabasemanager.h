@@ -64,6 +64,24 @@ class GameDatabaseManager : public QObject
 		/*! Sets the state modified flag to \a modified. */
 		void setModified(bool modified);
 
+		/*!
+		 * Stores the position indexes of imported databases in
+		 * directory \a path. An empty path (the default) disables
+		 * position indexing.
+		 *
+		 * \sa positionIndexFile()
+		 */
+		void setPositionIndexDirectory(const QString& path);
+		/*!
+		 * Returns the position index file of the database
+		 * \a database, or an empty string if position indexing
+		 * is disabled.
+		 *
+		 * The file may not exist if the database was imported
+		 * before indexing was enabled.
+		 */
+		QString positionIndexFile(const PgnDatabase* database) const;
+
 	public slots:
 		/*! Adds \a database to the list of managed databases. */
 		void addDatabase(PgnDatabase* database);
@@ -109,7 +127,10 @@ class GameDatabaseManager : public QObject
 		void databasesReset();
 
 	private:
+		QString positionIndexFile(const QString& fileName) const;
+
 		QList<PgnDatabase*> m_databases;
+		QString m_positionIndexDir;
 		bool m_modified;
 
 };
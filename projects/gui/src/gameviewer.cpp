@@ -25,10 +25,17 @@
 #include <pgngame.h>
 #include <chessgame.h>
 #include <chessplayer.h>
+#include <board/board.h>
 #include "boardview/boardscene.h"
 #include "boardview/boardview.h"
 #include "chessclock.h"
 
+namespace {
+
+const int s_keyframeInterval = 16;
+
+} // anonymous namespace
+
 GameViewer::GameViewer(Qt::Orientation orientation,
                        QWidget* parent,
                        bool addChessClock)
@@ -38,7 +45,9 @@ GameViewer::GameViewer(Qt::Orientation orientation,
 	  m_viewPreviousMoveBtn(new QToolButton),
 	  m_viewNextMoveBtn(new QToolButton),
 	  m_viewLastMoveBtn(new QToolButton),
-	  m_moveIndex(0)
+	  m_moveIndex(0),
+	  m_keyBoard(nullptr),
+	  m_sceneBase(0)
 {
 	#ifdef Q_OS_MAC
 	setStyleSheet("QToolButton:!hover { border: none; }");
@@ -134,6 +143,11 @@ GameViewer::GameViewer(Qt::Orientation orientation,
 	setLayout(layout);
 }
 
+GameViewer::~GameViewer()
+{
+	delete m_keyBoard;
+}
+
 ChessClock* GameViewer::chessClock(Chess::Side side)
 {
 	return m_chessClock[side];
@@ -188,8 +202,12 @@ void GameViewer::setGame(const PgnGame* pgn)
 	m_moveIndex = 0;
 
 	m_moves.clear();
+	resetKeyframes(pgn->createBoard());
 	for (const PgnGame::MoveData& md : pgn->moves())
+	{
 		m_moves.append(md.move);
+		addKeyframeMove(md.move);
+	}
 
 	m_viewFirstMoveBtn->setEnabled(false);
 	m_viewPreviousMoveBtn->setEnabled(false);
@@ -241,8 +259,7 @@ void GameViewer::viewFirstMoveClicked()
 
 void GameViewer::viewFirstMove()
 {
-	while (m_moveIndex > 0)
-		viewPreviousMove();
+	viewPosition(0);
 }
 
 void GameViewer::viewPreviousMoveClicked()
@@ -253,21 +270,16 @@ void GameViewer::viewPreviousMoveClicked()
 
 void GameViewer::viewPreviousMove()
 {
-	m_moveIndex--;
-
-	if (m_moveIndex == 0)
+	// The scene can't undo moves past the keyframe it was set to
+	if (m_moveIndex <= m_sceneBase)
 	{
-		m_viewPreviousMoveBtn->setEnabled(false);
-		m_viewFirstMoveBtn->setEnabled(false);
+		viewPosition(m_moveIndex - 1);
+		return;
 	}
 
+	m_moveIndex--;
 	m_boardScene->undoMove();
-
-	m_viewNextMoveBtn->setEnabled(true);
-	m_viewLastMoveBtn->setEnabled(true);
-	m_boardView->setEnabled(false);
-
-	m_moveNumberSlider->setSliderPosition(m_moveIndex);
+	updateControls();
 }
 
 void GameViewer::viewNextMoveClicked()
@@ -279,21 +291,7 @@ void GameViewer::viewNextMoveClicked()
 void GameViewer::viewNextMove()
 {
 	m_boardScene->makeMove(m_moves.at(m_moveIndex++));
-
-	m_viewPreviousMoveBtn->setEnabled(true);
-	m_viewFirstMoveBtn->setEnabled(true);
-
-	if (m_moveIndex >= m_moves.count())
-	{
-		m_viewNextMoveBtn->setEnabled(false);
-		m_viewLastMoveBtn->setEnabled(false);
-
-		if (!m_game.isNull()
-		&&  !m_game->isFinished() && m_game->playerToMove()->isHuman())
-			m_boardView->setEnabled(true);
-	}
-
-	m_moveNumberSlider->setSliderPosition(m_moveIndex);
+	updateControls();
 }
 
 void GameViewer::viewLastMoveClicked()
@@ -304,8 +302,7 @@ void GameViewer::viewLastMoveClicked()
 
 void GameViewer::viewLastMove()
 {
-	while (m_moveIndex < m_moves.count())
-		viewNextMove();
+	viewPosition(m_moves.count());
 }
 
 void GameViewer::viewPositionClicked(int index)
@@ -316,13 +313,42 @@ void GameViewer::viewPositionClicked(int index)
 
 void GameViewer::viewPosition(int index)
 {
-	if (m_moves.isEmpty())
+	if (m_moves.isEmpty() || index == m_moveIndex)
 		return;
 
-	while (index < m_moveIndex)
-		viewPreviousMove();
-	while (index > m_moveIndex)
+	// Single steps are animated
+	if (index == m_moveIndex + 1)
+	{
 		viewNextMove();
+		return;
+	}
+	if (index == m_moveIndex - 1 && index >= m_sceneBase)
+	{
+		viewPreviousMove();
+		return;
+	}
+	if (m_keyframes.isEmpty())
+	{
+		// Without keyframes the scene can only step through the moves
+		while (m_moveIndex < index)
+			viewNextMove();
+		while (m_moveIndex > index)
+			viewPreviousMove();
+		return;
+	}
+
+	// Jump to the nearest keyframe before the target position and
+	// replay the remaining moves. Only the last one is animated.
+	// Positions past the last keyframe are replayed from it.
+	const int keyframe = qMin(index > 0 ? (index - 1) / s_keyframeInterval : 0,
+				  m_keyframes.size() - 1);
+	const int base = keyframe * s_keyframeInterval;
+
+	m_boardScene->setPosition(m_keyframes.at(keyframe),
+				  m_moves.mid(base, index - base));
+	m_sceneBase = base;
+	m_moveIndex = index;
+	updateControls();
 }
 
 void GameViewer::viewMove(int index, bool keyLeft)
@@ -332,7 +358,9 @@ void GameViewer::viewMove(int index, bool keyLeft)
 
 	if (keyLeft && index == m_moveIndex - 2)
 		viewPreviousMove();
-	else if (index < m_moveIndex)
+	else if (index < m_moveIndex
+	     &&  m_moveIndex - index <= 2
+	     &&  index >= m_sceneBase)
 	{
 		// We backtrack one move too far and then make one
 		// move forward to highlight the correct move
@@ -341,10 +369,57 @@ void GameViewer::viewMove(int index, bool keyLeft)
 		viewNextMove();
 	}
 	else
+		viewPosition(index + 1);
+}
+
+void GameViewer::updateControls()
+{
+	const bool atStart = m_moveIndex == 0;
+	const bool atEnd = m_moveIndex >= m_moves.count();
+
+	m_viewFirstMoveBtn->setEnabled(!atStart);
+	m_viewPreviousMoveBtn->setEnabled(!atStart);
+	m_viewNextMoveBtn->setEnabled(!atEnd);
+	m_viewLastMoveBtn->setEnabled(!atEnd);
+
+	m_boardView->setEnabled(atEnd
+				&& !m_game.isNull()
+				&& !m_game->isFinished()
+				&& m_game->playerToMove()->isHuman());
+
+	m_moveNumberSlider->setSliderPosition(m_moveIndex);
+}
+
+void GameViewer::resetKeyframes(Chess::Board* board)
+{
+	delete m_keyBoard;
+	m_keyBoard = board;
+	m_keyframes.clear();
+	m_sceneBase = 0;
+
+	if (m_keyBoard != nullptr)
+		m_keyframes.append(m_keyBoard->fenString());
+}
+
+void GameViewer::addKeyframeMove(const Chess::GenericMove& move)
+{
+	if (m_keyBoard == nullptr)
+		return;
+
+	const Chess::Move boardMove(m_keyBoard->moveFromGenericMove(move));
+	if (boardMove.isNull())
 	{
-		while (index + 1 > m_moveIndex)
-			viewNextMove();
+		// Keyframes can't be created past an unknown move, but
+		// the earlier ones are still valid
+		delete m_keyBoard;
+		m_keyBoard = nullptr;
+		return;
 	}
+	m_keyBoard->makeMove(boardMove);
+
+	// m_moves already includes the move
+	if (m_moves.count() % s_keyframeInterval == 0)
+		m_keyframes.append(m_keyBoard->fenString());
 }
 
 void GameViewer::onFenChanged(const QString& fen)
@@ -360,11 +435,13 @@ void GameViewer::onFenChanged(const QString& fen)
 	m_moveNumberSlider->setMaximum(0);
 
 	m_boardScene->setFenString(fen);
+	resetKeyframes(m_boardScene->board()->copy());
 }
 
 void GameViewer::onMoveMade(const Chess::GenericMove& move)
 {
 	m_moves.append(move);
+	addKeyframeMove(move);
 
 	m_moveNumberSlider->setEnabled(true);
 	m_moveNumberSlider->setMaximum(m_moves.count());
@@ -22,6 +22,7 @@
 #include <QWidget>
 #include <QVector>
 #include <QPointer>
+#include <QStringList>
 #include <board/side.h>
 #include <board/genericmove.h>
 class QToolButton;
@@ -44,6 +45,7 @@ class GameViewer : public QWidget
 		explicit GameViewer(Qt::Orientation orientation = Qt::Horizontal,
 		                    QWidget* parent = nullptr,
 		                    bool addChessClock = false);
+		virtual ~GameViewer();
 
 		void setGame(ChessGame* game);
 		void setGame(const PgnGame* pgn);
@@ -74,6 +76,9 @@ class GameViewer : public QWidget
 		void viewNextMove();
 		void viewLastMove();
 		void viewPosition(int index);
+		void updateControls();
+		void resetKeyframes(Chess::Board* board);
+		void addKeyframeMove(const Chess::GenericMove& move);
 
 		BoardScene* m_boardScene;
 		BoardView* m_boardView;
@@ -88,6 +93,19 @@ class GameViewer : public QWidget
 		QPointer<ChessGame> m_game;
 		QVector<Chess::GenericMove> m_moves;
 		int m_moveIndex;
+
+		/*
+		 * The position after every KeyframeInterval plies is saved
+		 * as a FEN string, so any position can be shown by replaying
+		 * at most KeyframeInterval moves from the nearest keyframe.
+		 * m_keyBoard follows the game to create the keyframes up to
+		 * the first unknown move, and m_sceneBase is the ply the
+		 * board scene can undo moves to. Without any keyframe the
+		 * viewer steps through the moves one at a time.
+		 */
+		Chess::Board* m_keyBoard;
+		QStringList m_keyframes;
+		int m_sceneBase;
 };
 
 #endif // GAMEVIEWER_H
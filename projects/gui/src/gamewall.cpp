@@ -23,6 +23,8 @@
 #include <chessplayer.h>
 #include <chessgame.h>
 #include <gamemanager.h>
+#include <pgngame.h>
+#include <board/board.h>
 
 #include "tilelayout.h"
 #include "boardview/boardscene.h"
@@ -126,8 +128,11 @@ void GameWallWidget::setGame(ChessGame* game)
 	if (game->boardShouldBeFlipped())
 		m_scene->flip();
 
-	for (const Chess::Move& move : game->moves())
-		m_scene->makeMove(move);
+	QVector<Chess::GenericMove> moves;
+	for (const PgnGame::MoveData& md : game->pgn()->moves())
+		moves.append(md.move);
+	if (!moves.isEmpty())
+		m_scene->setPosition(m_scene->board()->fenString(), moves);
 
 	game->unlockThread();
 
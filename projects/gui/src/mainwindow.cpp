@@ -24,6 +24,8 @@
 #include <QMenuBar>
 #include <QToolBar>
 #include <QDockWidget>
+#include <QVBoxLayout>
+#include <QLineEdit>
 #include <QTreeView>
 #include <QMessageBox>
 #include <QFileDialog>
@@ -49,7 +51,7 @@
 #include "newgamedlg.h"
 #include "newtournamentdialog.h"
 #include "chessclock.h"
-#include "plaintextlog.h"
+#include "enginedebuglog.h"
 #include "gamedatabasemanager.h"
 #include "pgntagsmodel.h"
 #include "gametabbar.h"
@@ -57,6 +59,7 @@
 #include "evalwidget.h"
 #include "boardview/boardscene.h"
 #include "tournamentresultsdlg.h"
+#include "updatecoalescer.h"
 
 #ifdef QT_DEBUG
 #include <modeltest.h>
@@ -350,8 +353,18 @@ void MainWindow::createDockWindows()
 	// Engine debug
 	QDockWidget* engineDebugDock = new QDockWidget(tr("Engine Debug"), this);
 	engineDebugDock->setObjectName("EngineDebugDock");
-	m_engineDebugLog = new PlainTextLog(engineDebugDock);
-	engineDebugDock->setWidget(m_engineDebugLog);
+	auto engineDebugWidget = new QWidget(engineDebugDock);
+	auto engineDebugFilter = new QLineEdit(engineDebugWidget);
+	engineDebugFilter->setPlaceholderText(tr("Filter"));
+	engineDebugFilter->setClearButtonEnabled(true);
+	m_engineDebugLog = new EngineDebugLog(engineDebugWidget);
+	connect(engineDebugFilter, SIGNAL(textChanged(QString)),
+		m_engineDebugLog, SLOT(setFilter(QString)));
+	auto engineDebugLayout = new QVBoxLayout(engineDebugWidget);
+	engineDebugLayout->setContentsMargins(0, 0, 0, 0);
+	engineDebugLayout->addWidget(engineDebugFilter);
+	engineDebugLayout->addWidget(m_engineDebugLog);
+	engineDebugDock->setWidget(engineDebugWidget);
 	engineDebugDock->close();
 	addDockWidget(Qt::BottomDockWidgetArea, engineDebugDock);
 
@@ -508,12 +521,12 @@ void MainWindow::setCurrentGame(const TabData& gameData)
 	if (gameData.m_game == m_game && m_game != nullptr)
 		return;
 
+	m_engineDebugLog->removePlayers();
 	for (int i = 0; i < 2; i++)
 	{
 		ChessPlayer* player(m_players[i]);
 		if (player != nullptr)
 		{
-			disconnect(player, nullptr, m_engineDebugLog, nullptr);
 			disconnect(player, nullptr,
 			           m_gameViewer->chessClock(Chess::Side::White), nullptr);
 			disconnect(player, nullptr,
@@ -548,7 +561,15 @@ void MainWindow::setCurrentGame(const TabData& gameData)
 
 	lockCurrentGame();
 
-	m_engineDebugLog->clear();
+	m_engineDebugLog->setLineLimit(QSettings().value("ui/engine_debug_log_lines",
+		EngineDebugLog::DefaultLineLimit).toInt());
+	m_engineDebugLog->clearLog();
+
+	const int updateRate = QSettings().value("ui/engine_output_update_rate",
+		UpdateCoalescer::DefaultRate).toInt();
+	m_evalHistory->setUpdateRate(updateRate);
+	for (auto evalWidget : m_evalWidgets)
+		evalWidget->setUpdateRate(updateRate);
 
 	m_moveList->setGame(m_game, gameData.m_pgn);
 	m_evalHistory->setGame(m_game);
@@ -588,8 +609,7 @@ void MainWindow::setCurrentGame(const TabData& gameData)
 		ChessPlayer* player(m_game->player(side));
 		m_players[i] = player;
 
-		connect(player, SIGNAL(debugMessage(QString)),
-			m_engineDebugLog, SLOT(appendPlainText(QString)));
+		m_engineDebugLog->addPlayer(player);
 
 		auto clock = m_gameViewer->chessClock(side);
 
@@ -33,7 +33,7 @@ class QCloseEvent;
 class QTabBar;
 class GameViewer;
 class MoveList;
-class PlainTextLog;
+class EngineDebugLog;
 class PgnGame;
 class ChessGame;
 class ChessPlayer;
@@ -159,7 +159,7 @@ class MainWindow : public QMainWindow
 		QAction* m_aboutAct;
 		QAction* m_showSettingsAct;
 
-		PlainTextLog* m_engineDebugLog;
+		EngineDebugLog* m_engineDebugLog;
 
 		EvalHistory* m_evalHistory;
 		EvalWidget* m_evalWidgets[2];
@@ -20,6 +20,8 @@
 
 #include <QFileDialog>
 #include <QSettings>
+#include <QMessageBox>
+#include <QtConcurrentRun>
 #include <functional>
 #include <algorithm>
 
@@ -45,6 +47,7 @@ NewTournamentDialog::NewTournamentDialog(EngineManager* engineManager,
 					 QWidget *parent)
 	: QDialog(parent),
 	  m_srcEngineManager(engineManager),
+	  m_openingSuite(nullptr),
 	  ui(new Ui::NewTournamentDialog)
 {
 	Q_ASSERT(engineManager != nullptr);
@@ -120,6 +123,9 @@ NewTournamentDialog::NewTournamentDialog(EngineManager* engineManager,
 		ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(ok);
 	});
 
+	connect(&m_compileWatcher, SIGNAL(finished()),
+		this, SLOT(onOpeningSuiteCompiled()));
+
 	ui->m_gameSettings->onHumanCountChanged(0);
 	onVariantChanged(ui->m_gameSettings->chessVariant());
 	readSettings();
@@ -127,9 +133,62 @@ NewTournamentDialog::NewTournamentDialog(EngineManager* engineManager,
 
 NewTournamentDialog::~NewTournamentDialog()
 {
+	m_compileWatcher.waitForFinished();
+	delete m_openingSuite;
 	delete ui;
 }
 
+void NewTournamentDialog::accept()
+{
+	if (m_compileWatcher.isRunning())
+		return;
+
+	delete m_openingSuite;
+	m_openingSuite = ui->m_gameSettings->openingSuite();
+	if (m_openingSuite == nullptr)
+	{
+		QDialog::accept();
+		return;
+	}
+
+	// Check the openings once instead of in every game. A large
+	// suite takes a while, so the dialog stays responsive meanwhile.
+	ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(false);
+	setCursor(Qt::BusyCursor);
+
+	OpeningSuite* suite = m_openingSuite;
+	const QString variant(ui->m_gameSettings->chessVariant());
+	const int depth = ui->m_gameSettings->openingSuiteDepth();
+	m_compileWatcher.setFuture(QtConcurrent::run([=]()
+	{
+		return suite->compile(variant, depth);
+	}));
+}
+
+void NewTournamentDialog::onOpeningSuiteCompiled()
+{
+	unsetCursor();
+	ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(true);
+	if (!isVisible())
+		return;
+
+	if (!m_compileWatcher.result())
+	{
+		QMessageBox::critical(this, tr("Invalid opening suite"),
+			tr("The opening suite cannot be used:\n\n%1")
+			.arg(m_openingSuite->errorString()));
+		delete m_openingSuite;
+		m_openingSuite = nullptr;
+		return;
+	}
+	if (!m_openingSuite->errorString().isEmpty())
+		QMessageBox::warning(this, tr("Broken openings"),
+			tr("Some openings were skipped:\n\n%1")
+			.arg(m_openingSuite->errorString()));
+
+	QDialog::accept();
+}
+
 void NewTournamentDialog::addEngine()
 {
 	EngineSelectionDialog dlg(m_proxyModel);
@@ -245,7 +304,7 @@ void NewTournamentDialog::onPlayerSelectionChanged(const QItemSelection& selecte
 	ui->m_moveEngineDownBtn->setEnabled(enable && i < m_addedEnginesManager->engineCount() - 1);
 }
 
-Tournament* NewTournamentDialog::createTournament(GameManager* gameManager) const
+Tournament* NewTournamentDialog::createTournament(GameManager* gameManager)
 {
 	Q_ASSERT(gameManager != nullptr);
 	auto ts = ui->m_tournamentSettings;
@@ -268,7 +327,9 @@ Tournament* NewTournamentDialog::createTournament(GameManager* gameManager) cons
 
 	t->setAdjudicator(ui->m_gameSettings->adjudicator());
 
-	t->setOpeningSuite(ui->m_gameSettings->openingSuite());
+	// The suite was compiled when the dialog was accepted
+	t->setOpeningSuite(m_openingSuite);
+	m_openingSuite = nullptr;
 	t->setOpeningDepth(ui->m_gameSettings->openingSuiteDepth());
 
 	t->setOpeningBookOwnership(true);
@@ -20,6 +20,7 @@
 #define NEWTOURNAMENTDIALOG_H
 
 #include <QDialog>
+#include <QFutureWatcher>
 #include <timecontrol.h>
 
 class QModelIndex;
@@ -29,6 +30,7 @@ class EngineConfigurationModel;
 class EngineConfigurationProxyModel;
 class GameManager;
 class Tournament;
+class OpeningSuite;
 
 namespace Ui {
 	class NewTournamentDialog;
@@ -43,7 +45,16 @@ class NewTournamentDialog : public QDialog
 					     QWidget* parent = nullptr);
 		virtual ~NewTournamentDialog();
 
-		Tournament* createTournament(GameManager* gameManager) const;
+		Tournament* createTournament(GameManager* gameManager);
+
+	public slots:
+		/*!
+		 * Compiles the opening suite in another thread and
+		 * closes the dialog once it's done. If the suite can't
+		 * be used, the problems are shown and the dialog stays
+		 * open.
+		 */
+		virtual void accept();
 
 	private slots:
 		void addEngine();
@@ -52,6 +63,7 @@ class NewTournamentDialog : public QDialog
 		void onVariantChanged(const QString& variant);
 		void onPlayerSelectionChanged(const QItemSelection& selected,
 					      const QItemSelection& deselected);
+		void onOpeningSuiteCompiled();
 	
 	private:
 		void moveEngine(int offset);
@@ -63,6 +75,8 @@ class NewTournamentDialog : public QDialog
 		EngineConfigurationModel* m_srcEnginesModel;
 		EngineConfigurationModel* m_addedEnginesModel;
 		EngineConfigurationProxyModel* m_proxyModel;
+		OpeningSuite* m_openingSuite;
+		QFutureWatcher<bool> m_compileWatcher;
 		Ui::NewTournamentDialog* ui;
 };
 
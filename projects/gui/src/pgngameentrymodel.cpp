@@ -18,30 +18,38 @@
 
 #include "pgngameentrymodel.h"
 #include <QtConcurrentFilter>
+#include <algorithm>
 #include <pgngameentry.h>
 
 
 struct EntryContains
 {
 	EntryContains(const QList<const PgnGameEntry*>& entries,
-		      const PgnGameFilter& filter)
-		: m_entries(entries), m_filter(filter) { }
+		      const PgnGameFilter& filter,
+		      const QVector<int>* indexes)
+		: m_entries(entries), m_filter(filter), m_indexes(indexes) { }
 
 	typedef bool result_type;
 
 	inline bool operator()(int index)
 	{
+		if (m_indexes != nullptr
+		&&  !std::binary_search(m_indexes->constBegin(),
+					m_indexes->constEnd(), index))
+			return false;
 		return m_entries.at(index)->match(m_filter);
 	}
 
 	const QList<const PgnGameEntry*>& m_entries;
 	PgnGameFilter m_filter;
+	const QVector<int>* m_indexes;
 };
 
 
 PgnGameEntryModel::PgnGameEntryModel(QObject* parent)
 	: QAbstractItemModel(parent),
-	  m_entryCount(0)
+	  m_entryCount(0),
+	  m_hasIndexFilter(false)
 {
 	connect(&m_watcher, SIGNAL(resultsReadyAt(int,int)),
 		this, SLOT(onResultsReady()));
@@ -68,6 +76,8 @@ void PgnGameEntryModel::setEntries(const QList<const PgnGameEntry*>& entries)
 	m_watcher.waitForFinished();
 
 	m_entries = entries;
+	m_indexFilter.clear();
+	m_hasIndexFilter = false;
 
 	if (entries.size() > m_indexes.size())
 	{
@@ -92,7 +102,9 @@ void PgnGameEntryModel::applyFilter(const PgnGameFilter& filter)
 
 	m_filtered = QtConcurrent::filtered(m_indexes.constBegin(),
 					    m_indexes.constBegin() + m_entries.size(),
-					    EntryContains(m_entries, filter));
+					    EntryContains(m_entries, filter,
+							  m_hasIndexFilter ? &m_indexFilter
+									   : nullptr));
 
 	m_watcher.setFuture(m_filtered);
 	endResetModel();
@@ -107,6 +119,29 @@ void PgnGameEntryModel::setFilter(const PgnGameFilter& filter)
 	applyFilter(filter);
 }
 
+void PgnGameEntryModel::setIndexFilter(const QVector<int>& indexes)
+{
+	m_watcher.cancel();
+	m_watcher.waitForFinished();
+
+	m_indexFilter = indexes;
+	m_hasIndexFilter = true;
+	applyFilter(m_filter);
+}
+
+void PgnGameEntryModel::clearIndexFilter()
+{
+	if (!m_hasIndexFilter)
+		return;
+
+	m_watcher.cancel();
+	m_watcher.waitForFinished();
+
+	m_indexFilter.clear();
+	m_hasIndexFilter = false;
+	applyFilter(m_filter);
+}
+
 QModelIndex PgnGameEntryModel::index(int row, int column,
 				 const QModelIndex& parent) const
 {
@@ -52,8 +52,22 @@ class PgnGameEntryModel : public QAbstractItemModel
 		 * \a row in the model.
 		 */
 		int sourceIndex(int row) const;
-		/*! Associates a list of PGN game entries with this model. */
+		/*!
+		 * Associates a list of PGN game entries with this model.
+		 *
+		 * \note This also clears the index filter.
+		 */
 		void setEntries(const QList<const PgnGameEntry*>& entries);
+		/*!
+		 * Restricts the model to the entries at the source
+		 * \a indexes, which must be in ascending order.
+		 *
+		 * The index filter is applied in addition to the tag filter.
+		 * It's used to show the results of a position search.
+		 */
+		void setIndexFilter(const QVector<int>& indexes);
+		/*! Removes the index filter. */
+		void clearIndexFilter();
 
 		// Inherited from QAbstractItemModel
 		virtual QModelIndex index(int row, int column,
@@ -86,6 +100,8 @@ class PgnGameEntryModel : public QAbstractItemModel
 		QFuture<int> m_filtered;
 		QFutureWatcher<int> m_watcher;
 		PgnGameFilter m_filter;
+		QVector<int> m_indexFilter;
+		bool m_hasIndexFilter;
 };
 
 #endif // PGN_GAME_ENTRY_MODEL_H
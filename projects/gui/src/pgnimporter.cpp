@@ -23,6 +23,8 @@
 
 #include <pgnstream.h>
 #include <pgngameentry.h>
+#include <pgngame.h>
+#include <positionindexwriter.h>
 #include "pgndatabase.h"
 
 PgnImporter::PgnImporter(const QString& fileName)
@@ -36,6 +38,11 @@ QString PgnImporter::fileName() const
 	return m_fileName;
 }
 
+void PgnImporter::setPositionIndexFile(const QString& fileName)
+{
+	m_indexFileName = fileName;
+}
+
 void PgnImporter::work()
 {
 	QFile file(m_fileName);
@@ -58,6 +65,18 @@ void PgnImporter::work()
 	PgnStream pgnStream(&file);
 	QList<const PgnGameEntry*> games;
 
+	PositionIndexWriter* index = nullptr;
+	if (!m_indexFileName.isEmpty())
+	{
+		index = new PositionIndexWriter;
+		if (!index->open(m_indexFileName))
+		{
+			qWarning("%s", qUtf8Printable(index->errorString()));
+			delete index;
+			index = nullptr;
+		}
+	}
+
 	for (;;)
 	{
 		PgnGameEntry* game = new PgnGameEntry;
@@ -68,12 +87,40 @@ void PgnImporter::work()
 		}
 
 		games << game;
+
+		if (index != nullptr)
+		{
+			// The entry only has the tags, so the moves are read
+			// again from the start of the game
+			const qint64 pos = pgnStream.pos();
+			const qint64 lineNumber = pgnStream.lineNumber();
+			PgnGame pgnGame;
+			if (pgnStream.seek(game->pos(), game->lineNumber()))
+				pgnGame.read(pgnStream, INT_MAX - 1, false);
+			pgnStream.seek(pos, lineNumber);
+
+			if (!index->addGame(pgnGame))
+			{
+				qWarning("%s", qUtf8Printable(index->errorString()));
+				delete index;
+				index = nullptr;
+			}
+		}
+
 		numReadGames++;
 
 		if (numReadGames % updateInterval == 0)
 			emit databaseReadStatus(startTime(), numReadGames,
 			    pgnStream.pos());
 	}
+
+	if (index != nullptr)
+	{
+		if (!index->close())
+			qWarning("%s", qUtf8Printable(index->errorString()));
+		delete index;
+	}
+
 	PgnDatabase* db = new PgnDatabase(m_fileName);
 	db->setEntries(games);
 	db->setLastModified(fileInfo.lastModified());
@@ -47,6 +47,14 @@ class PgnImporter : public Worker
 		PgnImporter(const QString& fileName);
 		/*! Returns the file name of the database to be imported. */
 		QString fileName() const;
+		/*!
+		 * Builds a position index of the database into \a fileName
+		 * during the import. An empty file name (the default)
+		 * disables the index.
+		 *
+		 * \sa PositionIndex
+		 */
+		void setPositionIndexFile(const QString& fileName);
 
 	protected:
 		void work() override;
@@ -64,6 +72,7 @@ class PgnImporter : public Worker
 
 	private:
 		QString m_fileName;
+		QString m_indexFileName;
 
 };
 
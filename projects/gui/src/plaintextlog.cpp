@@ -42,7 +42,7 @@ void PlainTextLog::contextMenuEvent(QContextMenuEvent* event)
 	QMenu* menu = createStandardContextMenu();
 
 	menu->addSeparator();
-	menu->addAction(tr("Clear Log"), this, SLOT(clear()));
+	menu->addAction(tr("Clear Log"), this, SLOT(clearLog()));
 
 	menu->addSeparator();
 	auto saveAct = menu->addAction(tr("Save Log to File..."));
@@ -110,6 +110,16 @@ void PlainTextLog::saveLogToFile(const QString& fileName)
 	}
 
 	QTextStream out(&file);
+	writeLog(out);
+}
+
+void PlainTextLog::clearLog()
+{
+	clear();
+}
+
+void PlainTextLog::writeLog(QTextStream& out)
+{
 	out << toPlainText();
 }
 
@@ -23,6 +23,7 @@
 
 class QContextMenuEvent;
 class QAction;
+class QTextStream;
 
 /*!
  * \brief Widget that is used to display log messages in plain text.
@@ -43,11 +44,20 @@ class PlainTextLog : public QPlainTextEdit
 	public slots:
 		/*! Save the log to file \a filename. */
 		void saveLogToFile(const QString& fileName);
+		/*! Clears the log. */
+		virtual void clearLog();
 
 	protected:
 		// Inherited from QPlainTextEdit
 		virtual void contextMenuEvent(QContextMenuEvent* event);
 
+		/*!
+		 * Writes the contents of the log to \a out.
+		 *
+		 * The default implementation writes the displayed text.
+		 */
+		virtual void writeLog(QTextStream& out);
+
 };
 
 #endif // PLAIN_TEXT_LOG_H
@@ -65,6 +65,18 @@ SettingsDialog::SettingsDialog(QWidget* parent)
 	});
 
 
+	connect(ui->m_engineDebugLogLinesSpin, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+		this, [=](int value)
+	{
+		QSettings().setValue("ui/engine_debug_log_lines", value);
+	});
+
+	connect(ui->m_engineOutputUpdateRateSpin, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+		this, [=](int value)
+	{
+		QSettings().setValue("ui/engine_output_update_rate", value);
+	});
+
 	connect(ui->m_concurrencySpin, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
 		this, [=](int value)
 	{
@@ -200,6 +212,10 @@ void SettingsDialog::readSettings()
 	ui->m_playersSidesOnClocksCheck->setChecked(
 		s.value("display_players_sides_on_clocks", false).toBool());
 	ui->m_tbPathEdit->setText(s.value("tb_path").toString());
+	ui->m_engineDebugLogLinesSpin->setValue(
+		s.value("engine_debug_log_lines", 10000).toInt());
+	ui->m_engineOutputUpdateRateSpin->setValue(
+		s.value("engine_output_update_rate", 20).toInt());
 	s.endGroup();
 
 	s.beginGroup("pgn");
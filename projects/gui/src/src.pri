@@ -5,6 +5,8 @@ HEADERS += $$PWD/chessclock.h \
     $$PWD/engineconfigurationdlg.h \
     $$PWD/mainwindow.h \
     $$PWD/plaintextlog.h \
+    $$PWD/debuglogbuffer.h \
+    $$PWD/enginedebuglog.h \
     $$PWD/newgamedlg.h \
     $$PWD/cutechessapp.h \
     $$PWD/autoverticalscroller.h \
@@ -37,6 +39,7 @@ HEADERS += $$PWD/chessclock.h \
     $$PWD/gametabbar.h \
     $$PWD/evalhistory.h \
     $$PWD/evalwidget.h \
+    $$PWD/updatecoalescer.h \
     $$PWD/settingsdlg.h \
     $$PWD/enginemanagementwidget.h \
     $$PWD/tournamentresultsdlg.h \
@@ -48,6 +51,8 @@ SOURCES += $$PWD/main.cpp \
     $$PWD/engineconfigurationdlg.cpp \
     $$PWD/mainwindow.cpp \
     $$PWD/plaintextlog.cpp \
+    $$PWD/debuglogbuffer.cpp \
+    $$PWD/enginedebuglog.cpp \
     $$PWD/newgamedlg.cpp \
     $$PWD/cutechessapp.cpp \
     $$PWD/autoverticalscroller.cpp \
@@ -80,6 +85,7 @@ SOURCES += $$PWD/main.cpp \
     $$PWD/gametabbar.cpp \
     $$PWD/evalhistory.cpp \
     $$PWD/evalwidget.cpp \
+    $$PWD/updatecoalescer.cpp \
     $$PWD/settingsdlg.cpp \
     $$PWD/enginemanagementwidget.cpp \
     $$PWD/tournamentresultsdlg.cpp \
@@ -0,0 +1,82 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "updatecoalescer.h"
+
+UpdateCoalescer::UpdateCoalescer(QObject* parent)
+	: QObject(parent),
+	  m_rate(DefaultRate)
+{
+	m_timer.setSingleShot(true);
+	connect(&m_timer, SIGNAL(timeout()), this, SLOT(onTimeout()));
+}
+
+int UpdateCoalescer::rate() const
+{
+	return m_rate;
+}
+
+void UpdateCoalescer::setRate(int rate)
+{
+	m_rate = qMax(rate, 0);
+	if (m_rate == 0)
+		flush();
+}
+
+bool UpdateCoalescer::isPending() const
+{
+	return m_timer.isActive();
+}
+
+void UpdateCoalescer::requestUpdate()
+{
+	if (m_rate == 0)
+	{
+		emit update();
+		return;
+	}
+	if (m_timer.isActive())
+		return;
+
+	// The first request after a quiet period is served at once
+	int delay = 0;
+	if (m_lastUpdate.isValid())
+		delay = qMax(qint64(0), 1000 / m_rate - m_lastUpdate.elapsed());
+	m_timer.start(int(delay));
+}
+
+void UpdateCoalescer::flush()
+{
+	if (m_timer.isActive())
+	{
+		m_timer.stop();
+		onTimeout();
+	}
+}
+
+void UpdateCoalescer::cancel()
+{
+	m_timer.stop();
+}
+
+void UpdateCoalescer::onTimeout()
+{
+	m_lastUpdate.start();
+	emit update();
+}
@@ -0,0 +1,80 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef UPDATE_COALESCER_H
+#define UPDATE_COALESCER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+
+/*!
+ * \brief Limits how often a view is updated
+ *
+ * A view that receives data faster than anyone can read it (eg. the
+ * thinking output of a fast engine) stores only the latest data and
+ * calls requestUpdate(). UpdateCoalescer then emits update() at most
+ * rate() times per second, so any number of requests between two
+ * frames result in a single update.
+ */
+class UpdateCoalescer : public QObject
+{
+	Q_OBJECT
+
+	public:
+		/*! The default number of updates per second. */
+		static const int DefaultRate = 20;
+
+		/*! Creates a new coalescer with the given \a parent. */
+		explicit UpdateCoalescer(QObject* parent = nullptr);
+
+		/*! Returns the maximum number of updates per second. */
+		int rate() const;
+		/*!
+		 * Sets the maximum number of updates per second to \a rate.
+		 *
+		 * A rate of 0 disables coalescing: every request is
+		 * followed immediately by an update.
+		 */
+		void setRate(int rate);
+		/*! Returns true if an update is waiting for its frame. */
+		bool isPending() const;
+
+	public slots:
+		/*! Schedules an update for the next frame. */
+		void requestUpdate();
+		/*! Emits a pending update right away. */
+		void flush();
+		/*! Cancels a pending update. */
+		void cancel();
+
+	signals:
+		/*! The view should be updated now. */
+		void update();
+
+	private slots:
+		void onTimeout();
+
+	private:
+		int m_rate;
+		QTimer m_timer;
+		QElapsedTimer m_lastUpdate;
+};
+
+#endif // UPDATE_COALESCER_H
@@ -1,2 +1,2 @@
 TEMPLATE = subdirs
-SUBDIRS = pgngame
+SUBDIRS = perft pgngame soak stubengine throughput cuteseal engineparse
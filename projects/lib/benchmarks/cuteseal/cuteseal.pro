@@ -0,0 +1,4 @@
+include(../benchmarks.pri)
+
+TARGET = tst_cuteseal
+SOURCES += tst_cuteseal.cpp
@@ -0,0 +1,154 @@
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QProcess>
+#include <ctime>
+#include <chessengine.h>
+#include <engineconfiguration.h>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+/*
+ * Measures how fast engine output gets through cuteseal-remote-runner
+ * and ChessEngine's cuteseal decoder in the text and binary formats.
+ * The "engine" is a shell pipeline that prints the same info line
+ * over and over.
+ *
+ * CUTESEAL_RUNNER		Path to cuteseal-remote-runner
+ * CUTECHESS_BENCH_LINES	Number of engine lines (default 200000)
+ */
+
+class CountingEngine : public ChessEngine
+{
+	Q_OBJECT
+
+	public:
+		explicit CountingEngine(QObject* parent = nullptr)
+			: ChessEngine(parent),
+			  lineCount(0)
+		{
+		}
+
+		virtual void makeMove(const Chess::Move&) {}
+		virtual QString protocol() const { return "counter"; }
+
+		int lineCount;
+
+	protected:
+		virtual void startGame() {}
+		virtual void startThinking() {}
+		virtual void startProtocol() {}
+		virtual void parseLine(const QString& line)
+		{
+			if (line.startsWith("info"))
+				lineCount++;
+		}
+		virtual bool sendPing() { return false; }
+		virtual void sendStop() {}
+		virtual void sendQuit() {}
+		virtual void sendOption(const QString&, const QVariant&) {}
+};
+
+class tst_Cuteseal: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void transport_data() const;
+		void transport();
+
+	private:
+		static qint64 cpuTime(bool children);
+};
+
+qint64 tst_Cuteseal::cpuTime(bool children)
+{
+	// User and system time in microseconds
+#ifdef Q_OS_UNIX
+	struct rusage usage;
+	if (getrusage(children ? RUSAGE_CHILDREN : RUSAGE_SELF, &usage) != 0)
+		return 0;
+	return qint64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+	     + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#else
+	if (children)
+		return 0;
+	return qint64(std::clock()) * 1000000 / CLOCKS_PER_SEC;
+#endif
+}
+
+void tst_Cuteseal::transport_data() const
+{
+	QTest::addColumn<bool>("binary");
+
+	QTest::newRow("text") << false;
+	QTest::newRow("binary") << true;
+}
+
+void tst_Cuteseal::transport()
+{
+	QFETCH(bool, binary);
+
+	QString runner(QString::fromLocal8Bit(qgetenv("CUTESEAL_RUNNER")));
+	if (runner.isEmpty())
+		runner = QCoreApplication::applicationDirPath()
+			+ "/../../../../cuteseal-remote-runner/cuteseal-remote-runner";
+	if (!QFileInfo(runner).isExecutable())
+		QSKIP(qPrintable("Runner not found: " + runner));
+
+	bool ok = false;
+	int lines = qEnvironmentVariableIntValue("CUTECHESS_BENCH_LINES", &ok);
+	if (!ok || lines <= 0)
+		lines = 200000;
+
+	QStringList arguments;
+	if (binary)
+		arguments << "-b";
+	arguments << "sh" << "-c"
+		  << QString("yes 'info depth 20 seldepth 31 multipv 1 "
+			     "score cp 18 nodes 23456789 nps 2345678 "
+			     "time 10000 pv e2e4 e7e5 g1f3 b8c6 f1b5' "
+			     "| head -n %1").arg(lines);
+
+	EngineConfiguration config;
+	config.setCuteseal(true);
+
+	CountingEngine engine;
+	engine.applyConfiguration(config);
+
+	// The engine disconnects when the runner's output ends
+	QProcess* process = new QProcess;
+	QEventLoop loop;
+	connect(&engine, SIGNAL(disconnected()), &loop, SLOT(quit()));
+
+	const qint64 startCpu = cpuTime(false);
+	const qint64 startChildCpu = cpuTime(true);
+	QElapsedTimer clock;
+	clock.start();
+	QBENCHMARK_ONCE
+	{
+		process->start(runner, arguments);
+		QVERIFY(process->waitForStarted());
+		engine.setDevice(process);
+		loop.exec();
+	}
+	const qint64 elapsed = clock.nsecsElapsed();
+	process->waitForFinished();
+	const qint64 cpu = cpuTime(false) - startCpu;
+	const qint64 childCpu = cpuTime(true) - startChildCpu;
+
+	QCOMPARE(engine.lineCount, lines);
+
+	const double seconds = elapsed / 1.0e9;
+	qInfo("%d lines in %.2f s, %.0f lines/s",
+	      lines, seconds, lines / seconds);
+	qInfo("Harness CPU time per line: %.2f us", double(cpu) / lines);
+	qInfo("Runner and engine CPU time per line: %.2f us",
+	      double(childCpu) / lines);
+}
+
+QTEST_MAIN(tst_Cuteseal)
+#include "tst_cuteseal.moc"
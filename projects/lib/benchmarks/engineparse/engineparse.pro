@@ -0,0 +1,4 @@
+include(../benchmarks.pri)
+
+TARGET = tst_engineparse
+SOURCES += tst_engineparse.cpp
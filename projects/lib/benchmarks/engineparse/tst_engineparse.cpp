@@ -0,0 +1,129 @@
+#include <QtTest/QtTest>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <board/board.h>
+#include <board/boardfactory.h>
+#include <uciengine.h>
+#include <xboardengine.h>
+
+/*
+ * Replays a transcript of thinking output through the UCI and xboard
+ * line parsers without an engine process, and reports how many lines
+ * each parser handles per second.
+ *
+ * CUTECHESS_BENCH_LINES	Number of lines to replay (default 200000)
+ */
+
+template <class Engine>
+class ReplayEngine : public Engine
+{
+	public:
+		~ReplayEngine()
+		{
+			delete m_board;
+		}
+
+		void startGame(ChessPlayer* opponent)
+		{
+			// Commands to the engine are written to a buffer that
+			// isn't read back
+			QBuffer* device = new QBuffer;
+			device->open(QIODevice::WriteOnly);
+			this->setDevice(device);
+
+			m_board = Chess::BoardFactory::create("standard");
+			m_board->setFenString(m_board->defaultFenString());
+
+			this->setState(ChessPlayer::Idle);
+			this->newGame(Chess::Side::White, opponent, m_board);
+		}
+
+		void replay(const QString& line)
+		{
+			this->parseLine(line);
+		}
+
+	private:
+		Chess::Board* m_board = nullptr;
+};
+
+class tst_EngineParse: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void uci();
+		void xboard();
+
+	private:
+		template <class Engine>
+		void replay(const QStringList& transcript, const char* protocol);
+
+		static int lineCount();
+};
+
+int tst_EngineParse::lineCount()
+{
+	bool ok = false;
+	const int value = qEnvironmentVariableIntValue("CUTECHESS_BENCH_LINES",
+						       &ok);
+	return ok && value > 0 ? value : 200000;
+}
+
+template <class Engine>
+void tst_EngineParse::replay(const QStringList& transcript,
+			     const char* protocol)
+{
+	ReplayEngine<Engine> opponent;
+	ReplayEngine<Engine> engine;
+	engine.startGame(&opponent);
+
+	int evals = 0;
+	connect(&engine, &ChessPlayer::thinking, this,
+		[&](const MoveEvaluation&) { evals++; });
+
+	QElapsedTimer timer;
+	timer.start();
+	QBENCHMARK_ONCE
+	{
+		for (const QString& line : transcript)
+			engine.replay(line);
+	}
+	const qint64 elapsed = timer.nsecsElapsed();
+
+	QVERIFY(evals > 0);
+	qInfo("%s: %d lines in %.2f s, %.0f lines/s, %.2f us per line",
+	      protocol, transcript.size(), elapsed / 1.0e9,
+	      transcript.size() / (elapsed / 1.0e9),
+	      elapsed / 1000.0 / transcript.size());
+}
+
+void tst_EngineParse::uci()
+{
+	QStringList transcript;
+	const int count = lineCount();
+	for (int i = 0; i < count; i++)
+		transcript << QString("info depth %1 seldepth %2 multipv 1 "
+				      "score cp %3 nodes %4 nps 1500000 "
+				      "time %5 pv e2e4 e7e5 g1f3 b8c6 f1b5 "
+				      "a7a6 b5a4 g8f6")
+			      .arg(i % 40 + 1).arg(i % 40 + 8)
+			      .arg(i % 50 - 25).arg(i * 1500).arg(i);
+
+	replay<UciEngine>(transcript, "uci");
+}
+
+void tst_EngineParse::xboard()
+{
+	QStringList transcript;
+	const int count = lineCount();
+	for (int i = 0; i < count; i++)
+		transcript << QString("%1 %2 %3 %4 e4 e5 Nf3 Nc6 Bb5 a6 Ba4 Nf6")
+			      .arg(i % 40 + 1).arg(i % 50 - 25)
+			      .arg(i / 10).arg(i * 1500);
+
+	replay<XboardEngine>(transcript, "xboard");
+}
+
+QTEST_MAIN(tst_EngineParse)
+#include "tst_engineparse.moc"
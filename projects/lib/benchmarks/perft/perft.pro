@@ -0,0 +1,4 @@
+include(../benchmarks.pri)
+
+TARGET = tst_perft
+SOURCES += tst_perft.cpp
@@ -0,0 +1,98 @@
+#include <QtTest/QtTest>
+#include <board/board.h>
+#include <board/boardfactory.h>
+
+
+class tst_Perft: public QObject
+{
+	Q_OBJECT
+	
+	private slots:
+		void perft_data() const;
+		void perft();
+};
+
+static quint64 perftVal(Chess::Board* board, int depth)
+{
+	QVector<Chess::Move> moves(board->legalMoves());
+	if (depth == 1 || moves.isEmpty())
+		return moves.size();
+
+	quint64 nodeCount = 0;
+	for (const Chess::Move& move : qAsConst(moves))
+	{
+		board->makeMove(move);
+		nodeCount += perftVal(board, depth - 1);
+		board->undoMove();
+	}
+
+	return nodeCount;
+}
+
+void tst_Perft::perft_data() const
+{
+	QTest::addColumn<QString>("variant");
+	QTest::addColumn<QString>("fen");
+	QTest::addColumn<int>("depth");
+	QTest::addColumn<quint64>("nodecount");
+
+	QTest::newRow("standard")
+		<< "standard"
+		<< "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+		<< 4
+		<< Q_UINT64_C(197281);
+	QTest::newRow("capablanca")
+		<< "capablanca"
+		<< "rnbqckabnr/pppppppppp/10/10/10/10/PPPPPPPPPP/RNBQCKABNR w KQkq - 0 1"
+		<< 4
+		<< Q_UINT64_C(808984);
+	QTest::newRow("grand")
+		<< "grand"
+		<< "r8r/1nbqkcabn1/pppppppppp/10/10/10/10/PPPPPPPPPP/1NBQKCABN1/R8R w - - 0 1"
+		<< 3
+		<< Q_UINT64_C(259514);
+	QTest::newRow("gryphon")
+		<< "gryphon"
+		<< "rnbq1bnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQ1BNR w - - 0 1"
+		<< 4
+		<< Q_UINT64_C(280477);
+	QTest::newRow("shatranj")
+		<< "shatranj"
+		<< "rnbkqbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBKQBNR w - - 0 1"
+		<< 4
+		<< Q_UINT64_C(68122);
+	QTest::newRow("courier")
+		<< "courier"
+		<< "rnebmkfwbenr/pppppppppppp/12/12/12/12/PPPPPPPPPPPP/RNEBMKFWBENR w - - 0 1"
+		<< 4
+		<< Q_UINT64_C(180571);
+	QTest::newRow("makruk")
+		<< "makruk"
+		<< "rnsmksnr/8/pppppppp/8/8/PPPPPPPP/8/RNSKMSNR w - 0 0 1"
+		<< 4
+		<< Q_UINT64_C(273026);
+}
+
+void tst_Perft::perft()
+{
+	QFETCH(QString, variant);
+	QFETCH(QString, fen);
+	QFETCH(int, depth);
+	QFETCH(quint64, nodecount);
+
+	Chess::Board* board = Chess::BoardFactory::create(variant);
+	QVERIFY(board != nullptr);
+	QVERIFY(board->setFenString(fen));
+
+	quint64 nodes = 0;
+	QBENCHMARK
+	{
+		nodes = perftVal(board, depth);
+	}
+	QCOMPARE(nodes, nodecount);
+
+	delete board;
+}
+
+QTEST_MAIN(tst_Perft)
+#include "tst_perft.moc"
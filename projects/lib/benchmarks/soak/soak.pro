@@ -0,0 +1,4 @@
+include(../benchmarks.pri)
+
+TARGET = tst_soak
+SOURCES += tst_soak.cpp
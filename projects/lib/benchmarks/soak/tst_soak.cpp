@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <QtTest/QtTest>
+#include <QEventLoop>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <board/board.h>
+#include <chessplayer.h>
+#include <playerbuilder.h>
+#include <gamemanager.h>
+#include <enginemanager.h>
+#include <gameadjudicator.h>
+#include <timecontrol.h>
+#include <tournament.h>
+#include <tournamentfactory.h>
+#include <mersenne.h>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+/*
+ * A player that makes a random legal move as soon as it gets its turn.
+ * The move is played from the event loop to keep the stack flat.
+ */
+class StubPlayer : public ChessPlayer
+{
+	public:
+		StubPlayer(QObject* parent = nullptr)
+			: ChessPlayer(parent)
+		{
+			setState(Idle);
+		}
+
+		virtual void endGame(const Chess::Result& result)
+		{
+			ChessPlayer::endGame(result);
+			setState(Idle);
+		}
+		virtual void makeMove(const Chess::Move& move)
+		{
+			Q_UNUSED(move);
+		}
+		virtual bool supportsVariant(const QString& variant) const
+		{
+			Q_UNUSED(variant);
+			return true;
+		}
+		virtual bool isHuman() const
+		{
+			return false;
+		}
+
+	protected:
+		virtual void startGame()
+		{
+		}
+		virtual void startThinking()
+		{
+			QTimer::singleShot(0, this, [this]()
+			{
+				if (state() != Thinking)
+					return;
+				const auto moves = board()->legalMoves();
+				if (!moves.isEmpty())
+					emitMove(moves.at(Mersenne::random() % moves.size()));
+			});
+		}
+};
+
+class StubBuilder : public PlayerBuilder
+{
+	public:
+		StubBuilder(const QString& name)
+			: PlayerBuilder(name)
+		{
+		}
+
+		virtual bool isHuman() const
+		{
+			return false;
+		}
+		virtual ChessPlayer* create(QObject* receiver,
+					    const char* method,
+					    QObject* parent,
+					    QString* error) const
+		{
+			Q_UNUSED(receiver);
+			Q_UNUSED(method);
+			Q_UNUSED(error);
+
+			ChessPlayer* player = new StubPlayer(parent);
+			player->setName(name());
+			return player;
+		}
+};
+
+class tst_Soak: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void streaming();
+
+	private:
+		static qint64 residentMemory();
+		static int envValue(const char* name, int defaultValue);
+};
+
+qint64 tst_Soak::residentMemory()
+{
+#ifdef Q_OS_LINUX
+	QFile file("/proc/self/statm");
+	if (!file.open(QIODevice::ReadOnly))
+		return -1;
+
+	const QList<QByteArray> fields(file.readAll().split(' '));
+	if (fields.size() < 2)
+		return -1;
+	return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+	return -1;
+#endif
+}
+
+int tst_Soak::envValue(const char* name, int defaultValue)
+{
+	bool ok = false;
+	const int value = qEnvironmentVariableIntValue(name, &ok);
+	return ok && value > 0 ? value : defaultValue;
+}
+
+void tst_Soak::streaming()
+{
+	if (residentMemory() < 0)
+		QSKIP("Resident memory can't be measured on this platform");
+
+	// CUTECHESS_SOAK_GAMES and CUTECHESS_SOAK_CONCURRENCY
+	// can be used for shorter or heavier runs
+	const int playerCount = 4;
+	const int pairCount = playerCount * (playerCount - 1) / 2;
+	const int games = envValue("CUTECHESS_SOAK_GAMES", 100000);
+	const int concurrency = envValue("CUTECHESS_SOAK_CONCURRENCY",
+					 QThread::idealThreadCount());
+
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+
+	EngineManager engineManager;
+	GameManager* gameManager = new GameManager;
+	gameManager->setConcurrency(concurrency);
+
+	Tournament* tournament = TournamentFactory::create("round-robin",
+							   gameManager,
+							   &engineManager);
+	QVERIFY(tournament != nullptr);
+
+	GameAdjudicator adjudicator;
+	adjudicator.setMaximumGameLength(20);
+	tournament->setAdjudicator(adjudicator);
+	const int gamesPerEncounter = (games + pairCount - 1) / pairCount;
+	tournament->setGamesPerEncounter(gamesPerEncounter);
+	tournament->setStreamingMode(true);
+	tournament->setPgnOutput(dir.filePath("soak.pgn"), PgnGame::Minimal);
+	for (int i = 0; i < playerCount; i++)
+		tournament->addPlayer(new StubBuilder(QString("Stub %1").arg(i + 1)),
+				      TimeControl("inf"), nullptr, 0);
+
+	// Sample the resident memory 20 times, the first sample after
+	// a warm-up period of 10% of the games
+	QVector<qint64> samples;
+	const int interval = qMax(1, gamesPerEncounter * pairCount / 20);
+	connect(tournament, &Tournament::gameFinished, this,
+		[&](ChessGame*, int, int, int)
+	{
+		const int finished = tournament->finishedGameCount();
+		if (finished >= interval * 2 && finished % interval == 0)
+			samples.append(residentMemory());
+	});
+
+	QEventLoop loop;
+	connect(tournament, SIGNAL(finished()), &loop, SLOT(quit()));
+	QBENCHMARK_ONCE
+	{
+		QMetaObject::invokeMethod(tournament, "start", Qt::QueuedConnection);
+		loop.exec();
+	}
+
+	connect(gameManager, SIGNAL(finished()), &loop, SLOT(quit()));
+	gameManager->finish();
+	loop.exec();
+
+	qInfo("%d games, resident memory (MB):", tournament->finishedGameCount());
+	QStringList values;
+	for (qint64 sample : qAsConst(samples))
+		values << QString::number(sample / 1048576.0, 'f', 1);
+	qInfo("%s", qUtf8Printable(values.join(' ')));
+
+	QVERIFY(samples.size() >= 2);
+	const qint64 baseline = samples.first();
+	const qint64 peak = *std::max_element(samples.begin(), samples.end());
+
+	// Allow some allocator noise, but no growth with the game count
+	const qint64 tolerance = qMax(Q_INT64_C(16) * 1048576, baseline / 10);
+	QVERIFY2(peak - baseline <= tolerance,
+		 qPrintable(QString("Resident memory grew from %1 to %2 bytes")
+			    .arg(baseline).arg(peak)));
+
+	delete tournament;
+	delete gameManager;
+}
+
+QTEST_MAIN(tst_Soak)
+#include "tst_soak.moc"
@@ -0,0 +1,393 @@
+/*
+   A minimal UCI/Xboard chess engine for measuring the harness's own
+   overhead. It plays random legal moves, or the moves of a script,
+   after a fixed think time and can print a configurable amount of
+   thinking output.
+
+   Usage: stubengine [-think MS] [-info N] [-multipv N] [-pvlength N]
+                     [-script FILE] [-seed N]
+
+   -think MS	Think for MS milliseconds before every move (default 0)
+   -info N	Print N thinking lines (depths) per move (default 1)
+   -multipv N	Print N lines per depth (default 1)
+   -pvlength N	Make the PVs N moves long (default 8)
+   -script FILE	Play the moves in FILE, one per ply, when they're legal
+   -seed N	Seed the random move generator with N
+
+   The think time, info lines, MultiPV and PV length are also
+   available as UCI and Xboard options.
+*/
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include <QFile>
+#include <board/board.h>
+#include <board/boardfactory.h>
+#include <mersenne.h>
+
+
+class StubEngine
+{
+	public:
+		StubEngine();
+		~StubEngine();
+
+		bool parseArguments(const QStringList& args);
+		int exec();
+
+	private:
+		enum Protocol
+		{
+			NoProtocol,
+			Uci,
+			Xboard
+		};
+
+		void processUci(const QString& cmd, const QString& args);
+		void processXboard(const QString& cmd, const QString& args);
+		bool setOption(const QString& name, const QString& value);
+		void setPosition(const QString& fen, const QStringList& moves);
+		Chess::Move think();
+		QString randomPv(const Chess::Move& first, int* length);
+		QString moveString(const Chess::Move& move);
+		void writeLine(const QString& line);
+
+		Chess::Board* m_board;
+		QTextStream m_out;
+		Protocol m_protocol;
+		bool m_force;
+		bool m_post;
+		int m_thinkTime;
+		int m_infoLines;
+		int m_multiPv;
+		int m_pvLength;
+		QStringList m_script;
+};
+
+StubEngine::StubEngine()
+	: m_board(Chess::BoardFactory::create("standard")),
+	  m_out(stdout),
+	  m_protocol(NoProtocol),
+	  m_force(false),
+	  m_post(true),
+	  m_thinkTime(0),
+	  m_infoLines(1),
+	  m_multiPv(1),
+	  m_pvLength(8)
+{
+	m_board->initialize();
+	m_board->setFenString(m_board->defaultFenString());
+}
+
+StubEngine::~StubEngine()
+{
+	delete m_board;
+}
+
+bool StubEngine::parseArguments(const QStringList& args)
+{
+	for (int i = 1; i < args.size(); i++)
+	{
+		const QString& arg = args.at(i);
+		if (i + 1 >= args.size())
+			return false;
+		const QString& value = args.at(++i);
+
+		if (arg == "-script")
+		{
+			QFile file(value);
+			if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+				return false;
+			m_script = QString::fromUtf8(file.readAll())
+				.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+		}
+		else if (arg == "-seed")
+			Mersenne::initialize(value.toUInt());
+		else if (!setOption(arg.mid(1), value))
+			return false;
+	}
+
+	return true;
+}
+
+bool StubEngine::setOption(const QString& name, const QString& value)
+{
+	bool ok = false;
+	const int n = value.toInt(&ok);
+	if (!ok || n < 0)
+		return false;
+
+	const QString key(name.toLower());
+	if (key == "think" || key == "thinktime")
+		m_thinkTime = n;
+	else if (key == "info" || key == "infolines")
+		m_infoLines = n;
+	else if (key == "multipv")
+		m_multiPv = qMax(1, n);
+	else if (key == "pvlength")
+		m_pvLength = qMax(1, n);
+	else
+		return false;
+
+	return true;
+}
+
+void StubEngine::writeLine(const QString& line)
+{
+	m_out << line << endl;
+}
+
+QString StubEngine::moveString(const Chess::Move& move)
+{
+	return m_board->moveString(move, m_protocol == Uci
+		? Chess::Board::LongAlgebraic
+		: Chess::Board::StandardAlgebraic);
+}
+
+void StubEngine::setPosition(const QString& fen, const QStringList& moves)
+{
+	m_board->setFenString(fen.isEmpty() ? m_board->defaultFenString() : fen);
+	for (const QString& str : moves)
+	{
+		const Chess::Move move(m_board->moveFromString(str));
+		if (move.isNull())
+			break;
+		m_board->makeMove(move);
+	}
+}
+
+QString StubEngine::randomPv(const Chess::Move& first, int* length)
+{
+	QStringList pv;
+	Chess::Move move(first);
+	while (!move.isNull() && pv.size() < m_pvLength)
+	{
+		pv << moveString(move);
+		m_board->makeMove(move);
+
+		const QVector<Chess::Move> moves(m_board->legalMoves());
+		move = moves.isEmpty()
+			? Chess::Move()
+			: moves.at(Mersenne::random() % moves.size());
+	}
+	for (int i = 0; i < pv.size(); i++)
+		m_board->undoMove();
+
+	*length = pv.size();
+	return pv.join(' ');
+}
+
+Chess::Move StubEngine::think()
+{
+	const QVector<Chess::Move> moves(m_board->legalMoves());
+	if (moves.isEmpty())
+		return Chess::Move();
+
+	Chess::Move best;
+	const int ply = m_board->plyCount();
+	if (ply < m_script.size())
+	{
+		best = m_board->moveFromString(m_script.at(ply));
+		if (!best.isNull() && !m_board->isLegalMove(best))
+			best = Chess::Move();
+	}
+	if (best.isNull())
+		best = moves.at(Mersenne::random() % moves.size());
+
+	const int depths = m_post ? m_infoLines : 0;
+	if (depths == 0)
+		QThread::msleep(m_thinkTime);
+
+	for (int depth = 1; depth <= depths; depth++)
+	{
+		QThread::msleep(m_thinkTime / depths);
+
+		const int time = m_thinkTime * depth / depths;
+		const quint64 nodes = quint64(depth) * 100000;
+		for (int i = 0; i < m_multiPv && i < moves.size(); i++)
+		{
+			const Chess::Move first(i == 0 ? best : moves.at(i));
+			const int score = int(Mersenne::random() % 101) - 50;
+			int length = 0;
+			const QString pv(randomPv(first, &length));
+
+			if (m_protocol == Uci)
+				writeLine(QString("info depth %1 seldepth %2 multipv %3 "
+						  "score cp %4 nodes %5 nps 10000000 "
+						  "time %6 pv %7")
+					  .arg(depth).arg(length).arg(i + 1).arg(score)
+					  .arg(nodes).arg(time).arg(pv));
+			else
+				writeLine(QString("%1 %2 %3 %4 %5")
+					  .arg(depth).arg(score).arg(time / 10)
+					  .arg(nodes).arg(pv));
+		}
+	}
+
+	return best;
+}
+
+void StubEngine::processUci(const QString& cmd, const QString& args)
+{
+	if (cmd == "uci")
+	{
+		writeLine("id name StubEngine");
+		writeLine("id author Cute Chess");
+		writeLine(QString("option name ThinkTime type spin default %1 "
+				  "min 0 max 3600000").arg(m_thinkTime));
+		writeLine(QString("option name InfoLines type spin default %1 "
+				  "min 0 max 1000").arg(m_infoLines));
+		writeLine(QString("option name MultiPV type spin default %1 "
+				  "min 1 max 500").arg(m_multiPv));
+		writeLine(QString("option name PvLength type spin default %1 "
+				  "min 1 max 100").arg(m_pvLength));
+		writeLine("uciok");
+	}
+	else if (cmd == "isready")
+		writeLine("readyok");
+	else if (cmd == "setoption")
+	{
+		const int valuePos = args.indexOf(" value ");
+		if (args.startsWith("name ") && valuePos > 0)
+			setOption(args.mid(5, valuePos - 5).trimmed(),
+				  args.mid(valuePos + 7).trimmed());
+	}
+	else if (cmd == "position")
+	{
+		QString fen;
+		QStringList moves;
+		const int movesPos = args.indexOf("moves");
+		if (movesPos >= 0)
+			moves = args.mid(movesPos + 5).split(' ', QString::SkipEmptyParts);
+		if (args.startsWith("fen "))
+			fen = args.mid(4, movesPos >= 0 ? movesPos - 4 : -1).trimmed();
+		setPosition(fen, moves);
+	}
+	else if (cmd == "go")
+	{
+		const Chess::Move move(think());
+		writeLine("bestmove " + (move.isNull() ? QString("0000")
+						       : moveString(move)));
+	}
+}
+
+void StubEngine::processXboard(const QString& cmd, const QString& args)
+{
+	if (cmd == "protover")
+	{
+		writeLine("feature done=0");
+		writeLine("feature myname=\"StubEngine\" ping=1 setboard=1 "
+			  "usermove=1 sigint=0 sigterm=0 reuse=1 colors=0");
+		writeLine(QString("feature option=\"ThinkTime -spin %1 0 3600000\"")
+			  .arg(m_thinkTime));
+		writeLine(QString("feature option=\"InfoLines -spin %1 0 1000\"")
+			  .arg(m_infoLines));
+		writeLine(QString("feature option=\"MultiPV -spin %1 1 500\"")
+			  .arg(m_multiPv));
+		writeLine(QString("feature option=\"PvLength -spin %1 1 100\"")
+			  .arg(m_pvLength));
+		writeLine("feature done=1");
+		return;
+	}
+	if (cmd == "ping")
+	{
+		writeLine("pong " + args);
+		return;
+	}
+	if (cmd == "new")
+	{
+		setPosition(QString(), QStringList());
+		m_force = false;
+		return;
+	}
+	if (cmd == "setboard")
+	{
+		setPosition(args, QStringList());
+		return;
+	}
+	if (cmd == "force")
+	{
+		m_force = true;
+		return;
+	}
+	if (cmd == "post" || cmd == "nopost")
+	{
+		m_post = cmd == "post";
+		return;
+	}
+	if (cmd == "option")
+	{
+		setOption(args.section('=', 0, 0), args.section('=', 1));
+		return;
+	}
+	if (cmd == "usermove")
+	{
+		const Chess::Move move(m_board->moveFromString(args));
+		if (move.isNull() || !m_board->isLegalMove(move))
+		{
+			writeLine("Illegal move: " + args);
+			return;
+		}
+		m_board->makeMove(move);
+		if (m_force)
+			return;
+	}
+	else if (cmd == "go")
+		m_force = false;
+	else
+		return;
+
+	const Chess::Move move(think());
+	if (move.isNull())
+		return;
+	writeLine("move " + moveString(move));
+	m_board->makeMove(move);
+}
+
+int StubEngine::exec()
+{
+	QTextStream in(stdin);
+	QString line;
+
+	while (in.readLineInto(&line))
+	{
+		line = line.trimmed();
+		const QString cmd(line.section(' ', 0, 0));
+		const QString args(line.section(' ', 1));
+
+		if (cmd == "quit")
+			break;
+		if (m_protocol == NoProtocol)
+		{
+			if (cmd == "uci")
+				m_protocol = Uci;
+			else if (cmd == "xboard")
+				m_protocol = Xboard;
+		}
+
+		if (m_protocol == Uci)
+			processUci(cmd, args);
+		else if (m_protocol == Xboard)
+			processXboard(cmd, args);
+	}
+
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	StubEngine engine;
+	if (!engine.parseArguments(app.arguments()))
+	{
+		QTextStream(stderr) << "Usage: stubengine [-think MS] [-info N] "
+				       "[-multipv N] [-pvlength N] [-script FILE] "
+				       "[-seed N]" << endl;
+		return 1;
+	}
+
+	return engine.exec();
+}
@@ -0,0 +1,17 @@
+TEMPLATE = app
+TARGET = stubengine
+
+win32:CONFIG += console
+
+mac {
+	CONFIG -= app_bundle
+}
+
+QT = core
+
+include(../../lib.pri)
+include(../../libexport.pri)
+
+OBJECTS_DIR = .obj
+
+SOURCES += stubengine.cpp
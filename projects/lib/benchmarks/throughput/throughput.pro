@@ -0,0 +1,4 @@
+include(../benchmarks.pri)
+
+TARGET = tst_throughput
+SOURCES += tst_throughput.cpp
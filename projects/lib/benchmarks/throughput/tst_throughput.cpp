@@ -0,0 +1,199 @@
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSharedPointer>
+#include <ctime>
+#include <chessgame.h>
+#include <chessplayer.h>
+#include <enginebuilder.h>
+#include <engineconfiguration.h>
+#include <enginemanager.h>
+#include <gamemanager.h>
+#include <gameadjudicator.h>
+#include <pgngame.h>
+#include <timecontrol.h>
+#include <tournament.h>
+#include <tournamentfactory.h>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+/*
+ * Measures the harness's own overhead by playing games between two
+ * instances of the stub engine (see ../stubengine), which moves
+ * instantly unless it's told to think.
+ *
+ * CUTECHESS_STUB_ENGINE	Path to the stub engine
+ * CUTECHESS_STUB_PROTOCOL	"uci" (default) or "xboard"
+ * CUTECHESS_STUB_ARGS		Extra arguments for the stub engine,
+ *				eg. "-info 20 -multipv 4"
+ * CUTECHESS_BENCH_GAMES	Number of games (default 200)
+ * CUTECHESS_BENCH_CONCURRENCY	Number of concurrent games
+ */
+class tst_Throughput: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void games();
+
+	private:
+		static int envValue(const char* name, int defaultValue);
+		static qint64 cpuTime();
+};
+
+int tst_Throughput::envValue(const char* name, int defaultValue)
+{
+	bool ok = false;
+	const int value = qEnvironmentVariableIntValue(name, &ok);
+	return ok && value > 0 ? value : defaultValue;
+}
+
+qint64 tst_Throughput::cpuTime()
+{
+	// User and system time of the harness process in microseconds;
+	// the engines run in their own processes and aren't included
+#ifdef Q_OS_UNIX
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+	return qint64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+	     + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#else
+	return qint64(std::clock()) * 1000000 / CLOCKS_PER_SEC;
+#endif
+}
+
+void tst_Throughput::games()
+{
+	QString command(QString::fromLocal8Bit(qgetenv("CUTECHESS_STUB_ENGINE")));
+	if (command.isEmpty())
+		command = QCoreApplication::applicationDirPath()
+			+ "/../stubengine/stubengine";
+	QString protocol(QString::fromLocal8Bit(qgetenv("CUTECHESS_STUB_PROTOCOL")));
+	if (protocol.isEmpty())
+		protocol = "uci";
+	const QString args(QString::fromLocal8Bit(qgetenv("CUTECHESS_STUB_ARGS")));
+	const QStringList arguments(args.split(' ', QString::SkipEmptyParts));
+
+	if (!QFileInfo(command).isExecutable())
+		QSKIP(qPrintable("Stub engine not found: " + command));
+
+	const int games = envValue("CUTECHESS_BENCH_GAMES", 200);
+	const int concurrency = envValue("CUTECHESS_BENCH_CONCURRENCY",
+					 QThread::idealThreadCount());
+
+	EngineManager engineManager;
+	GameManager* gameManager = new GameManager;
+	gameManager->setConcurrency(concurrency);
+
+	Tournament* tournament = TournamentFactory::create("round-robin",
+							   gameManager,
+							   &engineManager);
+	QVERIFY(tournament != nullptr);
+
+	GameAdjudicator adjudicator;
+	adjudicator.setMaximumGameLength(100);
+	tournament->setAdjudicator(adjudicator);
+	tournament->setGamesPerEncounter(games);
+	for (int i = 0; i < 2; i++)
+	{
+		EngineConfiguration config;
+		config.setName(QString("Stub %1").arg(i + 1));
+		config.setCommand(command);
+		config.setProtocol(protocol);
+		config.setArguments(arguments);
+		tournament->addPlayer(new EngineBuilder(config),
+				      TimeControl("inf"), nullptr, 0);
+	}
+
+	/*
+	 * The latency of a move is the time between the player
+	 * receiving the move (moveMade) and the opponent being told
+	 * to think (startedThinking). The signals are connected
+	 * directly, so the time is measured in the game's thread.
+	 */
+	QMutex mutex;
+	QElapsedTimer clock;
+	qint64 latencyCount = 0;
+	qint64 totalLatency = 0;
+	qint64 maxLatency = 0;
+	qint64 moveCount = 0;
+	quint64 generationCount = 0;
+
+	connect(tournament, &Tournament::gameStarted, this,
+		[&](ChessGame* game, int, int, int)
+	{
+		auto lastMove = QSharedPointer<qint64>::create(-1);
+		for (int i = 0; i < 2; i++)
+		{
+			ChessPlayer* player = game->player(Chess::Side::Type(i));
+			connect(player, &ChessPlayer::moveMade, game,
+				[&clock, lastMove](const Chess::Move&)
+			{
+				*lastMove = clock.nsecsElapsed();
+			}, Qt::DirectConnection);
+			connect(player, &ChessPlayer::startedThinking, game,
+				[&, lastMove](int)
+			{
+				if (*lastMove < 0)
+					return;
+				const qint64 latency = clock.nsecsElapsed() - *lastMove;
+				*lastMove = -1;
+
+				QMutexLocker locker(&mutex);
+				latencyCount++;
+				totalLatency += latency;
+				maxLatency = qMax(maxLatency, latency);
+			}, Qt::DirectConnection);
+		}
+	});
+	connect(tournament, &Tournament::gameFinished, this,
+		[&](ChessGame* game, int, int, int)
+	{
+		moveCount += game->pgn()->moves().size();
+		generationCount += game->board()->legalMoveGenerations();
+	});
+
+	QEventLoop loop;
+	connect(tournament, SIGNAL(finished()), &loop, SLOT(quit()));
+
+	const qint64 startCpu = cpuTime();
+	clock.start();
+	QBENCHMARK_ONCE
+	{
+		QMetaObject::invokeMethod(tournament, "start", Qt::QueuedConnection);
+		loop.exec();
+	}
+	const qint64 elapsed = clock.nsecsElapsed();
+	const qint64 cpu = cpuTime() - startCpu;
+
+	connect(gameManager, SIGNAL(finished()), &loop, SLOT(quit()));
+	gameManager->finish();
+	loop.exec();
+
+	const int finished = tournament->finishedGameCount();
+	QCOMPARE(finished, games);
+	QVERIFY(moveCount > 0);
+
+	const double seconds = elapsed / 1.0e9;
+	qInfo("%d games, %lld moves in %.2f s at concurrency %d",
+	      finished, moveCount, seconds, concurrency);
+	qInfo("%.1f games/s, %.0f moves/s",
+	      finished / seconds, moveCount / seconds);
+	qInfo("Harness CPU time per move: %.1f us", double(cpu) / moveCount);
+	qInfo("Legal move generations per move: %.2f",
+	      double(generationCount) / moveCount);
+	if (latencyCount > 0)
+		qInfo("Move to go latency: %.1f us average, %.1f us max",
+		      totalLatency / 1000.0 / latencyCount, maxLatency / 1000.0);
+
+	delete tournament;
+	delete gameManager;
+}
+
+QTEST_MAIN(tst_Throughput)
+#include "tst_throughput.moc"
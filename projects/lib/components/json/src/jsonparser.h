@@ -27,7 +27,6 @@
 #define JSONPARSER_H
 
 #include <QVariant>
-#include <QCoreApplication>
 
 class QTextStream;
 
@@ -36,15 +35,15 @@ class QTextStream;
  * \brief A JSON (JavaScript Object Notation) parser.
  *
  * JsonParser parses JSON data from a text stream and
- * converts it into a QVariant.
+ * converts it into a QVariant. It reads the whole stream and
+ * parses it with JsonReader, which should be used directly when
+ * the data is in a file or only a part of it is needed.
  *
  * JSON specification: http://json.org/
- * \sa JsonSerializer
+ * \sa JsonSerializer, JsonReader
  */
 class LIB_EXPORT JsonParser
 {
-	Q_DECLARE_TR_FUNCTIONS(JsonParser)
-
 	public:
 		/*! Creates a new parser that reads data from \a stream. */
 		JsonParser(QTextStream& stream);
@@ -64,41 +63,9 @@ class LIB_EXPORT JsonParser
 		qint64 errorLineNumber() const;
 
 	private:
-		enum Token
-		{
-			JsonError,
-			JsonGeneric,
-			JsonNone,
-			JsonComma,
-			JsonColon,
-			JsonBeginObject,
-			JsonEndObject,
-			JsonBeginArray,
-			JsonEndArray,
-			JsonTrue,
-			JsonFalse,
-			JsonNull,
-			JsonNumber,
-			JsonString
-		};
-
-		static QString tokenString(Token type,
-					   const QString& str = QString());
-
-		Token parseToken();
-		QVariant parseValue(Token* tokenType = 0);
-		QVariant parseObject();
-		QVariant parseArray();
-		QString parseString();
-		void setError(const QString& message);
-		void clearError();
-
 		bool m_error;
-		qint64 m_currentLine;
 		qint64 m_errorLine;
 		QString m_errorString;
-		QString m_lastToken;
-		QChar m_buffer;
 		QTextStream& m_stream;
 };
 
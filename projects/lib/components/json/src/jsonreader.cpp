@@ -0,0 +1,633 @@
+/*
+    Copyright (c) 2010 Ilari Pihlajisto
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use,
+    copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following
+    conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "jsonreader.h"
+#include <limits>
+
+namespace {
+
+inline bool isSpace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline int hexValue(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+} // anonymous namespace
+
+JsonReader::JsonReader()
+	: m_map(nullptr)
+{
+	reset(nullptr, 0);
+}
+
+JsonReader::JsonReader(const QByteArray& data)
+	: m_map(nullptr)
+{
+	setData(data);
+}
+
+JsonReader::~JsonReader()
+{
+	clear();
+}
+
+void JsonReader::reset(const char* data, qint64 size)
+{
+	m_begin = data;
+	m_end = data + size;
+	m_pos = data;
+	m_tokenBegin = data;
+	m_tokenSize = 0;
+	m_tokenEscaped = false;
+	m_tokenType = NoToken;
+	m_scopes.clear();
+	m_errorString.clear();
+	m_errorLine = 0;
+
+	// Skip the UTF-8 byte order mark
+	if (size >= 3 && qstrncmp(data, "\xef\xbb\xbf", 3) == 0)
+		m_pos += 3;
+}
+
+void JsonReader::clear()
+{
+	if (m_map != nullptr)
+	{
+		m_file.unmap(m_map);
+		m_map = nullptr;
+	}
+	m_file.close();
+	m_data.clear();
+	reset(nullptr, 0);
+}
+
+void JsonReader::setData(const QByteArray& data)
+{
+	clear();
+	m_data = data;
+	reset(m_data.constData(), m_data.size());
+}
+
+bool JsonReader::openFile(const QString& fileName)
+{
+	clear();
+
+	m_file.setFileName(fileName);
+	if (!m_file.open(QIODevice::ReadOnly))
+		return false;
+
+	const qint64 size = m_file.size();
+	if (size > 0)
+		m_map = m_file.map(0, size);
+	if (m_map != nullptr)
+	{
+		reset(reinterpret_cast<const char*>(m_map), size);
+		return true;
+	}
+
+	// The file can't be mapped, eg. because it's empty or it's
+	// not a regular file
+	m_data = m_file.readAll();
+	m_file.close();
+	reset(m_data.constData(), m_data.size());
+
+	return true;
+}
+
+JsonReader::TokenType JsonReader::tokenType() const
+{
+	return m_tokenType;
+}
+
+int JsonReader::depth() const
+{
+	return m_scopes.size();
+}
+
+bool JsonReader::hasError() const
+{
+	return m_tokenType == Invalid;
+}
+
+QString JsonReader::errorString() const
+{
+	return m_errorString;
+}
+
+qint64 JsonReader::errorLineNumber() const
+{
+	return m_errorLine;
+}
+
+JsonReader::TokenType JsonReader::setError(const QString& message)
+{
+	if (m_tokenType == Invalid)
+		return Invalid;
+
+	m_tokenType = Invalid;
+	m_errorString = message;
+	m_errorLine = 1;
+	for (const char* p = m_begin; p < m_pos && p < m_end; p++)
+	{
+		if (*p == '\n')
+			m_errorLine++;
+	}
+
+	return Invalid;
+}
+
+QString JsonReader::tokenText() const
+{
+	if (m_pos >= m_end)
+		return tr("end of file");
+
+	const char* end = m_pos + 1;
+	while (end < m_end && !isDelimiter(end))
+		end++;
+	return QString::fromUtf8(m_pos, int(end - m_pos));
+}
+
+bool JsonReader::isDelimiter(const char* pos) const
+{
+	if (pos >= m_end)
+		return true;
+
+	const char c = *pos;
+	return isSpace(c) || c == ',' || c == ']' || c == '}';
+}
+
+void JsonReader::skipWhitespace()
+{
+	while (m_pos < m_end && isSpace(*m_pos))
+		m_pos++;
+}
+
+JsonReader::TokenType JsonReader::readNext()
+{
+	if (m_tokenType == Invalid || m_tokenType == EndDocument)
+		return m_tokenType;
+
+	skipWhitespace();
+	if (m_scopes.isEmpty())
+	{
+		if (m_tokenType != NoToken)
+			return m_tokenType = EndDocument;
+		return readValue();
+	}
+	if (m_tokenType == Name)
+		return readValue();
+
+	if (m_pos >= m_end)
+		return setError(tr("Reached EOF unexpectedly"));
+
+	const Scope& scope = m_scopes.last();
+	const char close = scope.isObject ? '}' : ']';
+	if (*m_pos == close)
+		return endScope();
+	if (scope.count > 0)
+	{
+		if (*m_pos != ',')
+			return setError(tr("Expected comma or closing bracket instead of: %1")
+					.arg(tokenText()));
+		m_pos++;
+		skipWhitespace();
+	}
+
+	if (scope.isObject)
+		return readName();
+	return readValue();
+}
+
+JsonReader::TokenType JsonReader::endScope()
+{
+	const bool isObject = m_scopes.takeLast().isObject;
+	m_pos++;
+	m_tokenBegin = m_pos - 1;
+	m_tokenSize = 1;
+	return m_tokenType = isObject ? EndObject : EndArray;
+}
+
+JsonReader::TokenType JsonReader::readName()
+{
+	if (m_pos >= m_end)
+		return setError(tr("Reached EOF unexpectedly"));
+	if (*m_pos != '\"')
+		return setError(tr("Invalid key: %1").arg(tokenText()));
+	if (readString(Name) == Invalid)
+		return Invalid;
+
+	skipWhitespace();
+	if (m_pos >= m_end || *m_pos != ':')
+		return setError(tr("Expected colon instead of: %1")
+				.arg(tokenText()));
+	m_pos++;
+
+	return Name;
+}
+
+JsonReader::TokenType JsonReader::readValue()
+{
+	if (m_pos >= m_end)
+		return setError(tr("Reached EOF unexpectedly"));
+
+	if (!m_scopes.isEmpty())
+		m_scopes.last().count++;
+
+	switch (*m_pos)
+	{
+	case '{':
+	case '[':
+		m_scopes.append(Scope{*m_pos == '{', 0});
+		m_tokenBegin = m_pos++;
+		m_tokenSize = 1;
+		return m_tokenType = m_scopes.last().isObject ? StartObject
+							      : StartArray;
+	case '\"':
+		return readString(String);
+	case 't':
+		return readLiteral("true", Bool);
+	case 'f':
+		return readLiteral("false", Bool);
+	case 'n':
+		return readLiteral("null", Null);
+	case '-':
+	case '0': case '1': case '2': case '3': case '4':
+	case '5': case '6': case '7': case '8': case '9':
+		return readNumber();
+	case ']':
+	case '}':
+	case ',':
+	case ':':
+		return setError(tr("Invalid value: %1").arg(QLatin1Char(*m_pos)));
+	default:
+		return setError(tr("Unknown token: %1").arg(tokenText()));
+	}
+}
+
+JsonReader::TokenType JsonReader::readString(TokenType type)
+{
+	const char* p = m_pos + 1;
+	bool escaped = false;
+
+	for (;;)
+	{
+		while (p < m_end && *p != '\"' && *p != '\\')
+			p++;
+		if (p >= m_end)
+			return setError(tr("Reached EOF unexpectedly"));
+		if (*p == '\"')
+			break;
+
+		// Validate escape sequences here so that decodeString()
+		// doesn't have to
+		escaped = true;
+		if (++p >= m_end)
+			return setError(tr("Reached EOF unexpectedly"));
+		switch (*p)
+		{
+		case '\"': case '\\': case '/':
+		case 'b': case 'f': case 'n': case 'r': case 't':
+			p++;
+			break;
+		case 'u':
+			if (m_end - p < 5)
+				return setError(tr("Reached EOF unexpectedly"));
+			for (int i = 1; i <= 4; i++)
+			{
+				if (hexValue(p[i]) < 0)
+				{
+					m_pos = p;
+					return setError(tr("Invalid unicode value: \\u%1")
+							.arg(QString::fromUtf8(p + 1, 4)));
+				}
+			}
+			p += 5;
+			break;
+		default:
+			m_pos = p;
+			return setError(tr("Unknown escape sequence: \\%1")
+					.arg(QLatin1Char(*p)));
+		}
+	}
+
+	m_tokenBegin = m_pos + 1;
+	m_tokenSize = int(p - m_tokenBegin);
+	m_tokenEscaped = escaped;
+	m_pos = p + 1;
+
+	return m_tokenType = type;
+}
+
+JsonReader::TokenType JsonReader::readLiteral(const char* literal,
+					      TokenType type)
+{
+	const int size = int(qstrlen(literal));
+	if (m_end - m_pos < size
+	||  qstrncmp(m_pos, literal, uint(size)) != 0
+	||  !isDelimiter(m_pos + size))
+		return setError(tr("Unknown token: %1").arg(tokenText()));
+
+	m_tokenBegin = m_pos;
+	m_tokenSize = size;
+	m_pos += size;
+
+	return m_tokenType = type;
+}
+
+JsonReader::TokenType JsonReader::readNumber()
+{
+	const char* p = m_pos;
+	while (p < m_end
+	&&     ((*p >= '0' && *p <= '9')
+	||      *p == '-' || *p == '+' || *p == '.' || *p == 'e' || *p == 'E'))
+		p++;
+	if (!isDelimiter(p))
+		return setError(tr("Unknown token: %1").arg(tokenText()));
+
+	m_tokenBegin = m_pos;
+	m_tokenSize = int(p - m_pos);
+	m_pos = p;
+
+	return m_tokenType = Number;
+}
+
+void JsonReader::skipCurrentValue()
+{
+	if (m_tokenType != StartObject && m_tokenType != StartArray)
+		return;
+
+	int depth = 1;
+	const char* p = m_pos;
+	while (p < m_end)
+	{
+		switch (*p++)
+		{
+		case '\"':
+			while (p < m_end && *p != '\"')
+			{
+				if (*p == '\\')
+					p++;
+				p++;
+			}
+			p++;
+			break;
+		case '{':
+		case '[':
+			depth++;
+			break;
+		case '}':
+		case ']':
+			if (--depth == 0)
+			{
+				m_pos = p - 1;
+				endScope();
+				return;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	m_pos = m_end;
+	setError(tr("Reached EOF unexpectedly"));
+}
+
+QString JsonReader::decodeString() const
+{
+	if (!m_tokenEscaped)
+		return QString::fromUtf8(m_tokenBegin, m_tokenSize);
+
+	QString str;
+	str.reserve(m_tokenSize);
+
+	const char* p = m_tokenBegin;
+	const char* const end = m_tokenBegin + m_tokenSize;
+	while (p < end)
+	{
+		const char* run = p;
+		while (p < end && *p != '\\')
+			p++;
+		if (p > run)
+			str += QString::fromUtf8(run, int(p - run));
+		if (p >= end)
+			break;
+
+		// The escape sequences were validated by readString()
+		switch (p[1])
+		{
+		case 'b':
+			str += QLatin1Char('\b');
+			break;
+		case 'f':
+			str += QLatin1Char('\f');
+			break;
+		case 'n':
+			str += QLatin1Char('\n');
+			break;
+		case 'r':
+			str += QLatin1Char('\r');
+			break;
+		case 't':
+			str += QLatin1Char('\t');
+			break;
+		case 'u':
+			str += QChar(ushort((hexValue(p[2]) << 12)
+					  | (hexValue(p[3]) << 8)
+					  | (hexValue(p[4]) << 4)
+					  | hexValue(p[5])));
+			p += 4;
+			break;
+		default:
+			str += QLatin1Char(p[1]);
+			break;
+		}
+		p += 2;
+	}
+
+	return str;
+}
+
+QString JsonReader::name() const
+{
+	if (m_tokenType != Name)
+		return QString();
+	return decodeString();
+}
+
+bool JsonReader::isName(const char* name) const
+{
+	if (m_tokenType != Name)
+		return false;
+	if (m_tokenEscaped)
+		return decodeString() == QLatin1String(name);
+
+	return qstrlen(name) == uint(m_tokenSize)
+	    && qstrncmp(m_tokenBegin, name, uint(m_tokenSize)) == 0;
+}
+
+QString JsonReader::stringValue() const
+{
+	if (m_tokenType != String && m_tokenType != Name)
+		return QString();
+	return decodeString();
+}
+
+qint64 JsonReader::intValue(bool* ok) const
+{
+	if (ok != nullptr)
+		*ok = false;
+	if (m_tokenType != Number || m_tokenSize == 0)
+		return 0;
+
+	const char* p = m_tokenBegin;
+	const char* const end = m_tokenBegin + m_tokenSize;
+	const bool negative = *p == '-';
+	if (negative && ++p == end)
+		return 0;
+
+	// Accumulate as a negative number to reach the minimum value
+	qint64 value = 0;
+	for (; p < end; p++)
+	{
+		if (*p < '0' || *p > '9')
+			return 0;
+		const int digit = *p - '0';
+		if (value < (std::numeric_limits<qint64>::min() + digit) / 10)
+			return 0;
+		value = value * 10 - digit;
+	}
+	if (!negative)
+	{
+		if (value == std::numeric_limits<qint64>::min())
+			return 0;
+		value = -value;
+	}
+
+	if (ok != nullptr)
+		*ok = true;
+	return value;
+}
+
+double JsonReader::doubleValue(bool* ok) const
+{
+	if (m_tokenType != Number)
+	{
+		if (ok != nullptr)
+			*ok = false;
+		return 0.0;
+	}
+
+	return QByteArray::fromRawData(m_tokenBegin, m_tokenSize).toDouble(ok);
+}
+
+bool JsonReader::boolValue() const
+{
+	return m_tokenType == Bool && *m_tokenBegin == 't';
+}
+
+QVariant JsonReader::numberVariant()
+{
+	bool ok = false;
+	const QByteArray token(QByteArray::fromRawData(m_tokenBegin, m_tokenSize));
+
+	if (token.contains('.') || token.contains('e') || token.contains('E'))
+	{
+		const double val = doubleValue(&ok);
+		if (ok)
+			return val;
+		setError(tr("Invalid fraction: %1").arg(QString::fromLatin1(token)));
+		return QVariant();
+	}
+
+	const qint64 val = intValue(&ok);
+	if (!ok)
+	{
+		setError(tr("Invalid integer: %1").arg(QString::fromLatin1(token)));
+		return QVariant();
+	}
+	if (val >= std::numeric_limits<int>::min()
+	&&  val <= std::numeric_limits<int>::max())
+		return int(val);
+	return qlonglong(val);
+}
+
+QVariant JsonReader::readVariant()
+{
+	switch (m_tokenType)
+	{
+	case StartObject:
+		{
+			QVariantMap map;
+			while (readNext() == Name)
+			{
+				const QString key(decodeString());
+				readNext();
+				const QVariant value(readVariant());
+				if (m_tokenType == Invalid)
+					return QVariant();
+				map.insert(key, value);
+			}
+			if (m_tokenType != EndObject)
+				return QVariant();
+			return map;
+		}
+	case StartArray:
+		{
+			QVariantList list;
+			for (;;)
+			{
+				const TokenType type = readNext();
+				if (type == EndArray)
+					return list;
+				if (type == Invalid)
+					return QVariant();
+
+				const QVariant value(readVariant());
+				if (m_tokenType == Invalid)
+					return QVariant();
+				list.append(value);
+			}
+		}
+	case String:
+		return decodeString();
+	case Number:
+		return numberVariant();
+	case Bool:
+		return boolValue();
+	default:
+		return QVariant();
+	}
+}
@@ -0,0 +1,217 @@
+/*
+    Copyright (c) 2010 Ilari Pihlajisto
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use,
+    copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following
+    conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+#include <QCoreApplication>
+
+
+/*!
+ * \brief A pull-style JSON (JavaScript Object Notation) reader.
+ *
+ * JsonReader reads UTF-8 encoded JSON data one token at a time, in
+ * the manner of QXmlStreamReader. The data can be a byte array or a
+ * file, which is memory-mapped when possible. Tokens are not copied:
+ * names and strings are only decoded into QStrings when name() or
+ * stringValue() is called, and isName() compares a name without
+ * decoding it.
+ *
+ * A value that isn't needed can be skipped with skipCurrentValue(),
+ * which only matches the brackets of the skipped objects and arrays.
+ * A value can also be converted into a QVariant with readVariant().
+ *
+ * Example:
+ * \code
+ * JsonReader reader;
+ * reader.openFile("tournament.json");
+ * if (reader.readNext() == JsonReader::StartObject)
+ * {
+ *     while (reader.readNext() == JsonReader::Name)
+ *     {
+ *         const bool wanted = reader.isName("tournamentSettings");
+ *         reader.readNext();
+ *         if (wanted)
+ *             settings = reader.readVariant().toMap();
+ *         else
+ *             reader.skipCurrentValue();
+ *     }
+ * }
+ * \endcode
+ *
+ * JSON specification: http://json.org/
+ * \sa JsonParser
+ */
+class LIB_EXPORT JsonReader
+{
+	Q_DECLARE_TR_FUNCTIONS(JsonReader)
+
+	public:
+		/*! The type of a token. */
+		enum TokenType
+		{
+			/*! No token has been read yet. */
+			NoToken,
+			/*! An error occured; see errorString(). */
+			Invalid,
+			/*! The start of an object. */
+			StartObject,
+			/*! The end of an object. */
+			EndObject,
+			/*! The start of an array. */
+			StartArray,
+			/*! The end of an array. */
+			EndArray,
+			/*! The name of an object member. */
+			Name,
+			/*! A string value. */
+			String,
+			/*! A number value. */
+			Number,
+			/*! A boolean value. */
+			Bool,
+			/*! A null value. */
+			Null,
+			/*! The top-level value has been read. */
+			EndDocument
+		};
+
+		/*! Creates a new reader with no data. */
+		JsonReader();
+		/*! Creates a new reader that reads \a data. */
+		explicit JsonReader(const QByteArray& data);
+		/*! Destroys the reader and unmaps the file. */
+		~JsonReader();
+
+		/*! Starts reading \a data. */
+		void setData(const QByteArray& data);
+		/*!
+		 * Starts reading the file \a fileName.
+		 *
+		 * The file is memory-mapped if possible, otherwise it's
+		 * read into memory. Returns false if the file can't be
+		 * opened.
+		 */
+		bool openFile(const QString& fileName);
+		/*! Releases the data and resets the reader. */
+		void clear();
+
+		/*! Reads the next token and returns its type. */
+		TokenType readNext();
+		/*! Returns the type of the current token. */
+		TokenType tokenType() const;
+		/*! Returns the number of objects and arrays that are open. */
+		int depth() const;
+
+		/*!
+		 * Skips the rest of the value that starts at the current
+		 * token. If the token is StartObject or StartArray, the
+		 * reader moves to the matching end token. The contents of
+		 * the skipped value are not validated.
+		 */
+		void skipCurrentValue();
+		/*!
+		 * Reads the value that starts at the current token and
+		 * converts it into a QVariant. Objects become QVariantMaps
+		 * and arrays become QVariantLists.
+		 *
+		 * Returns a null QVariant if an error occurs.
+		 */
+		QVariant readVariant();
+
+		/*! Returns the current token as a member name. */
+		QString name() const;
+		/*!
+		 * Returns true if the current token is a member name that
+		 * equals \a name, which must be in Latin-1.
+		 */
+		bool isName(const char* name) const;
+		/*! Returns the current token as a string value. */
+		QString stringValue() const;
+		/*!
+		 * Returns the current token as an integer. If \a ok is not
+		 * null, it's set to false if the token isn't an integer.
+		 */
+		qint64 intValue(bool* ok = nullptr) const;
+		/*!
+		 * Returns the current token as a floating point number. If
+		 * \a ok is not null, it's set to false if the token isn't
+		 * a number.
+		 */
+		double doubleValue(bool* ok = nullptr) const;
+		/*! Returns the current token as a boolean. */
+		bool boolValue() const;
+
+		/*! Returns true if a parsing error occured. */
+		bool hasError() const;
+		/*! Returns a detailed description of the error. */
+		QString errorString() const;
+		/*! Returns the line number on which the error occured. */
+		qint64 errorLineNumber() const;
+
+	private:
+		Q_DISABLE_COPY(JsonReader)
+
+		struct Scope
+		{
+			bool isObject;
+			int count;
+		};
+
+		void reset(const char* data, qint64 size);
+		void skipWhitespace();
+		TokenType readValue();
+		TokenType readName();
+		TokenType readString(TokenType type);
+		TokenType readLiteral(const char* literal, TokenType type);
+		TokenType readNumber();
+		TokenType endScope();
+		TokenType setError(const QString& message);
+		QString tokenText() const;
+		QString decodeString() const;
+		bool isDelimiter(const char* pos) const;
+		QVariant numberVariant();
+
+		QFile m_file;
+		uchar* m_map;
+		QByteArray m_data;
+		const char* m_begin;
+		const char* m_end;
+		const char* m_pos;
+		const char* m_tokenBegin;
+		int m_tokenSize;
+		bool m_tokenEscaped;
+		TokenType m_tokenType;
+		QVector<Scope> m_scopes;
+		QString m_errorString;
+		qint64 m_errorLine;
+};
+
+#endif // JSONREADER_H
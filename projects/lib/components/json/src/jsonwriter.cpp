@@ -0,0 +1,482 @@
+/*
+    Copyright (c) 2010 Ilari Pihlajisto
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use,
+    copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following
+    conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "jsonwriter.h"
+#include <QIODevice>
+#include <QLocale>
+#include <cmath>
+
+namespace {
+
+// Device output is written out in blocks of about this size
+const int s_flushThreshold = 16384;
+
+} // anonymous namespace
+
+JsonWriter::JsonWriter(QByteArray* buffer, Format format)
+	: m_device(nullptr),
+	  m_buffer(buffer),
+	  m_format(format),
+	  m_indentLevel(0),
+	  m_afterName(false),
+	  m_error(false)
+{
+	Q_ASSERT(buffer != nullptr);
+}
+
+JsonWriter::JsonWriter(QIODevice* device, Format format)
+	: m_device(device),
+	  m_buffer(&m_ownBuffer),
+	  m_format(format),
+	  m_indentLevel(0),
+	  m_afterName(false),
+	  m_error(false)
+{
+	Q_ASSERT(device != nullptr);
+
+	// A reserved buffer keeps its memory when it's emptied
+	m_ownBuffer.reserve(s_flushThreshold * 2);
+}
+
+JsonWriter::~JsonWriter()
+{
+	flush();
+}
+
+void JsonWriter::setIndentLevel(int level)
+{
+	Q_ASSERT(level >= 0);
+	m_indentLevel = level;
+}
+
+bool JsonWriter::hasError() const
+{
+	return m_error;
+}
+
+QString JsonWriter::errorString() const
+{
+	return m_errorString;
+}
+
+void JsonWriter::setError(const QString& message)
+{
+	if (m_error)
+		return;
+	m_error = true;
+	m_errorString = message;
+}
+
+bool JsonWriter::flush()
+{
+	if (m_device == nullptr || m_buffer->isEmpty())
+		return !m_error;
+
+	if (m_device->write(*m_buffer) != m_buffer->size())
+		setError(tr("Cannot write JSON data: %1")
+			 .arg(m_device->errorString()));
+	m_buffer->resize(0);
+
+	return !m_error;
+}
+
+void JsonWriter::newLine(int level)
+{
+	if (m_format != Indented)
+		return;
+
+	const int pos = m_buffer->size();
+	m_buffer->resize(pos + 1 + level);
+	char* out = m_buffer->data() + pos;
+	*out++ = '\n';
+	for (int i = 0; i < level; i++)
+		*out++ = '\t';
+}
+
+void JsonWriter::beginValue()
+{
+	if (m_afterName)
+	{
+		m_afterName = false;
+		return;
+	}
+	if (m_scopes.isEmpty())
+		return;
+
+	Scope& scope = m_scopes.last();
+	Q_ASSERT_X(!scope.isObject, "JsonWriter",
+		   "object members need a name");
+	if (scope.count++ > 0)
+		m_buffer->append(',');
+	newLine(m_indentLevel + m_scopes.size());
+}
+
+void JsonWriter::endValue()
+{
+	if (!m_scopes.isEmpty())
+		return;
+
+	if (m_format == Indented && m_indentLevel == 0)
+		m_buffer->append('\n');
+	if (m_device != nullptr && m_buffer->size() >= s_flushThreshold)
+		flush();
+}
+
+void JsonWriter::startScope(char bracket, bool isObject)
+{
+	beginValue();
+	m_buffer->append(bracket);
+	m_scopes.append(Scope{isObject, 0});
+}
+
+void JsonWriter::endScope(char bracket, bool isObject)
+{
+	Q_ASSERT(!m_scopes.isEmpty());
+	Q_ASSERT(m_scopes.last().isObject == isObject);
+	Q_ASSERT(!m_afterName);
+	Q_UNUSED(isObject);
+
+	const Scope scope(m_scopes.takeLast());
+	if (scope.count > 0)
+		newLine(m_indentLevel + m_scopes.size());
+	m_buffer->append(bracket);
+
+	// Large documents are written out before they're complete
+	if (m_device != nullptr && m_buffer->size() >= s_flushThreshold)
+		flush();
+	endValue();
+}
+
+void JsonWriter::writeStartObject()
+{
+	startScope('{', true);
+}
+
+void JsonWriter::writeEndObject()
+{
+	endScope('}', true);
+}
+
+void JsonWriter::writeStartArray()
+{
+	startScope('[', false);
+}
+
+void JsonWriter::writeEndArray()
+{
+	endScope(']', false);
+}
+
+template<typename Char>
+void JsonWriter::appendString(const Char* data, int size)
+{
+	static const char hexDigits[] = "0123456789abcdef";
+
+	// Every character takes at most six bytes ("\uXXXX"); reserve
+	// the worst case and trim the buffer afterwards
+	int pos = m_buffer->size();
+	m_buffer->resize(pos + 2 + size * 6);
+	char* const begin = m_buffer->data() + pos;
+	char* out = begin;
+
+	*out++ = '\"';
+	for (int i = 0; i < size; i++)
+	{
+		const uint c = uint(data[i]);
+
+		if (c >= 0x20 && c < 0x80)
+		{
+			if (c == '\"' || c == '\\')
+				*out++ = '\\';
+			*out++ = char(c);
+		}
+		else if (c < 0x20)
+		{
+			*out++ = '\\';
+			switch (c)
+			{
+			case '\b':
+				*out++ = 'b';
+				break;
+			case '\f':
+				*out++ = 'f';
+				break;
+			case '\n':
+				*out++ = 'n';
+				break;
+			case '\r':
+				*out++ = 'r';
+				break;
+			case '\t':
+				*out++ = 't';
+				break;
+			default:
+				*out++ = 'u';
+				*out++ = '0';
+				*out++ = '0';
+				*out++ = hexDigits[c >> 4];
+				*out++ = hexDigits[c & 0xF];
+				break;
+			}
+		}
+		else if (c < 0x800)
+		{
+			*out++ = char(0xC0 | (c >> 6));
+			*out++ = char(0x80 | (c & 0x3F));
+		}
+		else if (c >= 0xD800 && c < 0xDC00
+		     &&  i + 1 < size
+		     &&  uint(data[i + 1]) >= 0xDC00 && uint(data[i + 1]) < 0xE000)
+		{
+			const uint cp = 0x10000 + ((c - 0xD800) << 10)
+				      + (uint(data[++i]) - 0xDC00);
+			*out++ = char(0xF0 | (cp >> 18));
+			*out++ = char(0x80 | ((cp >> 12) & 0x3F));
+			*out++ = char(0x80 | ((cp >> 6) & 0x3F));
+			*out++ = char(0x80 | (cp & 0x3F));
+		}
+		else if (c >= 0xD800 && c < 0xE000)
+		{
+			// An unpaired surrogate can't be encoded in UTF-8
+			*out++ = '\\';
+			*out++ = 'u';
+			*out++ = hexDigits[c >> 12];
+			*out++ = hexDigits[(c >> 8) & 0xF];
+			*out++ = hexDigits[(c >> 4) & 0xF];
+			*out++ = hexDigits[c & 0xF];
+		}
+		else
+		{
+			*out++ = char(0xE0 | (c >> 12));
+			*out++ = char(0x80 | ((c >> 6) & 0x3F));
+			*out++ = char(0x80 | (c & 0x3F));
+		}
+	}
+	*out++ = '\"';
+
+	m_buffer->resize(pos + int(out - begin));
+}
+
+void JsonWriter::appendInteger(qint64 value)
+{
+	char digits[24];
+	char* const end = digits + sizeof(digits);
+	char* p = end;
+
+	// Work with negative numbers to handle the minimum value
+	const bool negative = value < 0;
+	if (!negative)
+		value = -value;
+	do
+	{
+		*--p = char('0' - value % 10);
+		value /= 10;
+	} while (value != 0);
+	if (negative)
+		*--p = '-';
+
+	m_buffer->append(p, int(end - p));
+}
+
+void JsonWriter::writeName(const QString& name)
+{
+	Q_ASSERT(!m_scopes.isEmpty() && m_scopes.last().isObject);
+	Q_ASSERT(!m_afterName);
+
+	Scope& scope = m_scopes.last();
+	if (scope.count++ > 0)
+		m_buffer->append(',');
+	newLine(m_indentLevel + m_scopes.size());
+	appendString(reinterpret_cast<const ushort*>(name.constData()),
+		     name.size());
+	if (m_format == Indented)
+		m_buffer->append(" : ", 3);
+	else
+		m_buffer->append(':');
+	m_afterName = true;
+}
+
+void JsonWriter::writeName(QLatin1String name)
+{
+	Q_ASSERT(!m_scopes.isEmpty() && m_scopes.last().isObject);
+	Q_ASSERT(!m_afterName);
+
+	Scope& scope = m_scopes.last();
+	if (scope.count++ > 0)
+		m_buffer->append(',');
+	newLine(m_indentLevel + m_scopes.size());
+	appendString(reinterpret_cast<const uchar*>(name.data()), name.size());
+	if (m_format == Indented)
+		m_buffer->append(" : ", 3);
+	else
+		m_buffer->append(':');
+	m_afterName = true;
+}
+
+void JsonWriter::writeName(const char* name)
+{
+	writeName(QLatin1String(name));
+}
+
+void JsonWriter::writeValue(const QString& value)
+{
+	beginValue();
+	appendString(reinterpret_cast<const ushort*>(value.constData()),
+		     value.size());
+	endValue();
+}
+
+void JsonWriter::writeValue(QLatin1String value)
+{
+	beginValue();
+	appendString(reinterpret_cast<const uchar*>(value.data()), value.size());
+	endValue();
+}
+
+void JsonWriter::writeValue(const char* value)
+{
+	writeValue(QLatin1String(value));
+}
+
+void JsonWriter::writeValue(bool value)
+{
+	beginValue();
+	if (value)
+		m_buffer->append("true", 4);
+	else
+		m_buffer->append("false", 5);
+	endValue();
+}
+
+void JsonWriter::writeValue(int value)
+{
+	writeValue(qint64(value));
+}
+
+void JsonWriter::writeValue(qint64 value)
+{
+	beginValue();
+	appendInteger(value);
+	endValue();
+}
+
+void JsonWriter::writeValue(double value)
+{
+	if (!std::isfinite(value))
+	{
+		writeNull();
+		return;
+	}
+
+	beginValue();
+	m_buffer->append(QByteArray::number(value, 'g',
+					    QLocale::FloatingPointShortest));
+	endValue();
+}
+
+void JsonWriter::writeNull()
+{
+	beginValue();
+	m_buffer->append("null", 4);
+	endValue();
+}
+
+void JsonWriter::writeRawValue(const QByteArray& value)
+{
+	beginValue();
+	m_buffer->append(value);
+	endValue();
+}
+
+bool JsonWriter::writeVariant(const QVariant& value)
+{
+	switch (value.type())
+	{
+	case QVariant::Invalid:
+		writeNull();
+		break;
+	case QVariant::Map:
+		{
+			writeStartObject();
+
+			const QVariantMap map(value.toMap());
+			for (auto it = map.constBegin(); it != map.constEnd(); ++it)
+			{
+				writeName(it.key());
+				if (!writeVariant(it.value()))
+					return false;
+			}
+
+			writeEndObject();
+		}
+		break;
+	case QVariant::List:
+	case QVariant::StringList:
+		{
+			writeStartArray();
+
+			const QVariantList list(value.toList());
+			for (const QVariant& item : list)
+			{
+				if (!writeVariant(item))
+					return false;
+			}
+
+			writeEndArray();
+		}
+		break;
+	case QVariant::String:
+	case QVariant::ByteArray:
+		writeValue(value.toString());
+		break;
+	case QVariant::Bool:
+		writeValue(value.toBool());
+		break;
+	case QVariant::Int:
+	case QVariant::UInt:
+	case QVariant::LongLong:
+		writeValue(value.toLongLong());
+		break;
+	case QVariant::Double:
+		writeValue(value.toDouble());
+		break;
+	default:
+		if (value.canConvert(QVariant::String))
+		{
+			beginValue();
+			m_buffer->append(value.toString().toUtf8());
+			endValue();
+		}
+		else
+		{
+			setError(tr("Invalid variant type: %1")
+				 .arg(value.typeName()));
+			return false;
+		}
+		break;
+	}
+
+	return true;
+}
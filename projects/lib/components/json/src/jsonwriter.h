@@ -0,0 +1,202 @@
+/*
+    Copyright (c) 2010 Ilari Pihlajisto
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use,
+    copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following
+    conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+#include <QCoreApplication>
+
+class QIODevice;
+
+
+/*!
+ * \brief A streaming JSON (JavaScript Object Notation) writer.
+ *
+ * JsonWriter writes JSON data as UTF-8 directly into a byte buffer
+ * or a device, without building a QVariant tree first. Objects and
+ * arrays are opened and closed with writeStartObject(),
+ * writeEndObject(), writeStartArray() and writeEndArray(). Inside an
+ * object every value must be preceded by writeName().
+ *
+ * Example:
+ * \code
+ * QByteArray buffer;
+ * JsonWriter json(&buffer);
+ * json.writeStartObject();
+ * json.writeMember("name", "Cute Chess");
+ * json.writeName("ratings");
+ * json.writeStartArray();
+ * json.writeValue(2800);
+ * json.writeValue(2750.5);
+ * json.writeEndArray();
+ * json.writeEndObject();
+ * \endcode
+ *
+ * When writing to a device the data is buffered and written out in
+ * large blocks. The buffer is reused, so a writer that stays alive
+ * doesn't allocate memory for every document.
+ *
+ * Unlike JsonSerializer, JsonWriter writes the members of an object
+ * in the order they are given.
+ *
+ * JSON specification: http://json.org/
+ * \sa JsonSerializer, JsonParser
+ */
+class LIB_EXPORT JsonWriter
+{
+	Q_DECLARE_TR_FUNCTIONS(JsonWriter)
+
+	public:
+		/*! The output format. */
+		enum Format
+		{
+			/*! One value per line, indented with tabs. */
+			Indented,
+			/*! No whitespace at all. */
+			Compact
+		};
+
+		/*! Creates a new writer that appends to \a buffer. */
+		explicit JsonWriter(QByteArray* buffer, Format format = Indented);
+		/*! Creates a new writer that writes to \a device. */
+		explicit JsonWriter(QIODevice* device, Format format = Indented);
+		/*! Flushes the buffered data to the device. */
+		~JsonWriter();
+
+		/*!
+		 * Sets the indentation level of the top-level value to
+		 * \a level. This is useful for writing fragments that are
+		 * later inserted into a document with writeRawValue().
+		 *
+		 * In the Indented format a complete top-level value is
+		 * followed by a newline, but only if the level is zero.
+		 */
+		void setIndentLevel(int level);
+
+		/*! Starts a new object. */
+		void writeStartObject();
+		/*! Ends the current object. */
+		void writeEndObject();
+		/*! Starts a new array. */
+		void writeStartArray();
+		/*! Ends the current array. */
+		void writeEndArray();
+
+		/*! Writes the name of the next member of the current object. */
+		void writeName(const QString& name);
+		/*! \overload */
+		void writeName(QLatin1String name);
+		/*! \overload */
+		void writeName(const char* name);
+
+		/*! Writes a string value. */
+		void writeValue(const QString& value);
+		/*! \overload */
+		void writeValue(QLatin1String value);
+		/*! \overload */
+		void writeValue(const char* value);
+		/*! Writes a boolean value. */
+		void writeValue(bool value);
+		/*! Writes an integer value. */
+		void writeValue(int value);
+		/*! \overload */
+		void writeValue(qint64 value);
+		/*!
+		 * Writes a floating point value. Infinite and NaN values
+		 * are written as null.
+		 */
+		void writeValue(double value);
+		/*! Writes a null value. */
+		void writeNull();
+		/*!
+		 * Writes \a value, which must be a complete JSON value, as
+		 * it is.
+		 */
+		void writeRawValue(const QByteArray& value);
+		/*!
+		 * Writes \a value with the same rules as JsonSerializer.
+		 *
+		 * Returns false if an invalid or unsupported variant type
+		 * is encountered. Otherwise returns true.
+		 */
+		bool writeVariant(const QVariant& value);
+
+		/*! Writes the member \a name with value \a value. */
+		template<typename T>
+		void writeMember(const char* name, const T& value);
+
+		/*!
+		 * Writes the buffered data to the device.
+		 * Returns false if the data couldn't be written.
+		 */
+		bool flush();
+
+		/*! Returns true if an error occured. */
+		bool hasError() const;
+		/*! Returns a detailed description of the error. */
+		QString errorString() const;
+
+	private:
+		Q_DISABLE_COPY(JsonWriter)
+
+		struct Scope
+		{
+			bool isObject;
+			int count;
+		};
+
+		void beginValue();
+		void endValue();
+		void startScope(char bracket, bool isObject);
+		void endScope(char bracket, bool isObject);
+		void newLine(int level);
+		template<typename Char>
+		void appendString(const Char* data, int size);
+		void appendInteger(qint64 value);
+		void setError(const QString& message);
+
+		QIODevice* m_device;
+		QByteArray m_ownBuffer;
+		QByteArray* m_buffer;
+		Format m_format;
+		int m_indentLevel;
+		bool m_afterName;
+		QVector<Scope> m_scopes;
+		bool m_error;
+		QString m_errorString;
+};
+
+template<typename T>
+void JsonWriter::writeMember(const char* name, const T& value)
+{
+	writeName(name);
+	writeValue(value);
+}
+
+#endif // JSONWRITER_H
@@ -0,0 +1,4 @@
+TARGET = tst_jsonreader
+
+include(../tests.pri)
+SOURCES += tst_jsonreader.cpp
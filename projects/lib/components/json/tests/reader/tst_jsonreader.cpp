@@ -0,0 +1,318 @@
+/*
+    Copyright (c) 2010 Ilari Pihlajisto
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use,
+    copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following
+    conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <QtTest/QtTest>
+#include <QTemporaryFile>
+#include <jsonparser.h>
+#include <jsonreader.h>
+#include <jsonwriter.h>
+
+class tst_JsonReader: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void tokens() const;
+		void names() const;
+		void skip() const;
+		void numbers_data() const;
+		void numbers() const;
+		void errors_data() const;
+		void errors() const;
+		void file() const;
+
+		void benchmark_data() const;
+		void benchmark() const;
+
+	private:
+		QByteArray tournamentFile(int games) const;
+};
+Q_DECLARE_METATYPE(QVariant)
+
+
+QByteArray tst_JsonReader::tournamentFile(int games) const
+{
+	// Similar to a tournament file of EngineMatch
+	QByteArray data;
+	JsonWriter json(&data);
+	json.writeStartObject();
+	json.writeName("matchProgress");
+	json.writeStartArray();
+	for (int i = 0; i < games; i++)
+	{
+		json.writeStartObject();
+		json.writeMember("index", i + 1);
+		json.writeMember("white", "Engine A");
+		json.writeMember("black", "Engine B");
+		json.writeMember("startTime", "12:00:00 on 2018.01.01");
+		json.writeMember("result", "1/2-1/2");
+		json.writeMember("terminationDetails", "3-fold repetition");
+		json.writeMember("gameDuration", "01:23:45");
+		json.writeMember("finalFen", "8/5k2/8/8/8/8/2K5/8 w - - 0 100");
+		json.writeMember("ECO", "C65");
+		json.writeMember("opening", "Ruy Lopez");
+		json.writeMember("variation", "Berlin defence");
+		json.writeMember("plyCount", 120);
+		json.writeMember("whiteEval", "0.00");
+		json.writeMember("blackEval", "0.00");
+		json.writeEndObject();
+	}
+	json.writeEndArray();
+	json.writeName("tournamentSettings");
+	json.writeStartObject();
+	json.writeMember("name", "TCEC Season 1 - Superfinal");
+	json.writeMember("type", "round-robin");
+	json.writeMember("gamesPerEncounter", 100);
+	json.writeEndObject();
+	json.writeEndObject();
+
+	return data;
+}
+
+void tst_JsonReader::tokens() const
+{
+	JsonReader reader("{\"a\" : [1, -2.5, \"x\", true, false, null], \"b\" : {}}");
+
+	QCOMPARE(reader.readNext(), JsonReader::StartObject);
+	QCOMPARE(reader.depth(), 1);
+	QCOMPARE(reader.readNext(), JsonReader::Name);
+	QCOMPARE(reader.name(), QString("a"));
+	QCOMPARE(reader.readNext(), JsonReader::StartArray);
+	QCOMPARE(reader.depth(), 2);
+	QCOMPARE(reader.readNext(), JsonReader::Number);
+	QCOMPARE(reader.intValue(), Q_INT64_C(1));
+	QCOMPARE(reader.readNext(), JsonReader::Number);
+	QCOMPARE(reader.doubleValue(), -2.5);
+	QCOMPARE(reader.readNext(), JsonReader::String);
+	QCOMPARE(reader.stringValue(), QString("x"));
+	QCOMPARE(reader.readNext(), JsonReader::Bool);
+	QCOMPARE(reader.boolValue(), true);
+	QCOMPARE(reader.readNext(), JsonReader::Bool);
+	QCOMPARE(reader.boolValue(), false);
+	QCOMPARE(reader.readNext(), JsonReader::Null);
+	QCOMPARE(reader.readNext(), JsonReader::EndArray);
+	QCOMPARE(reader.readNext(), JsonReader::Name);
+	QVERIFY(reader.isName("b"));
+	QCOMPARE(reader.readNext(), JsonReader::StartObject);
+	QCOMPARE(reader.readNext(), JsonReader::EndObject);
+	QCOMPARE(reader.readNext(), JsonReader::EndObject);
+	QCOMPARE(reader.depth(), 0);
+	QCOMPARE(reader.readNext(), JsonReader::EndDocument);
+	QVERIFY(!reader.hasError());
+}
+
+void tst_JsonReader::names() const
+{
+	JsonReader reader("{\"plain\" : 1, \"esc\\u0061ped\" : 2, "
+			  "\"\xe2\x99\x94\" : 3}");
+
+	QCOMPARE(reader.readNext(), JsonReader::StartObject);
+	QCOMPARE(reader.readNext(), JsonReader::Name);
+	QVERIFY(reader.isName("plain"));
+	QVERIFY(!reader.isName("plai"));
+	QVERIFY(!reader.isName("plainer"));
+	reader.readNext();
+	QCOMPARE(reader.readNext(), JsonReader::Name);
+	QVERIFY(reader.isName("escaped"));
+	QCOMPARE(reader.name(), QString("escaped"));
+	reader.readNext();
+	QCOMPARE(reader.readNext(), JsonReader::Name);
+	QCOMPARE(reader.name(), QString(QChar(0x2654)));
+	QCOMPARE(reader.readNext(), JsonReader::Number);
+	QCOMPARE(reader.readNext(), JsonReader::EndObject);
+}
+
+void tst_JsonReader::skip() const
+{
+	const QByteArray data(tournamentFile(10));
+	JsonReader reader(data);
+
+	QVariantMap settings;
+	QCOMPARE(reader.readNext(), JsonReader::StartObject);
+	while (reader.readNext() == JsonReader::Name)
+	{
+		const bool wanted = reader.isName("tournamentSettings");
+		reader.readNext();
+		if (wanted)
+			settings = reader.readVariant().toMap();
+		else
+		{
+			reader.skipCurrentValue();
+			QCOMPARE(reader.tokenType(), JsonReader::EndArray);
+		}
+	}
+	QCOMPARE(reader.tokenType(), JsonReader::EndObject);
+	QVERIFY(!reader.hasError());
+	QCOMPARE(settings["gamesPerEncounter"].toInt(), 100);
+	QCOMPARE(settings["type"].toString(), QString("round-robin"));
+
+	// Brackets in strings don't confuse skipping
+	JsonReader reader2("[{\"a\" : \"}]\\\"\"}, 5]");
+	QCOMPARE(reader2.readNext(), JsonReader::StartArray);
+	QCOMPARE(reader2.readNext(), JsonReader::StartObject);
+	reader2.skipCurrentValue();
+	QCOMPARE(reader2.tokenType(), JsonReader::EndObject);
+	QCOMPARE(reader2.readNext(), JsonReader::Number);
+	QCOMPARE(reader2.intValue(), Q_INT64_C(5));
+	QCOMPARE(reader2.readNext(), JsonReader::EndArray);
+}
+
+void tst_JsonReader::numbers_data() const
+{
+	QTest::addColumn<QByteArray>("input");
+	QTest::addColumn<QVariant>("expected");
+
+	QTest::newRow("zero") << QByteArray("0") << QVariant(0);
+	QTest::newRow("int max") << QByteArray("2147483647") << QVariant(2147483647);
+	QTest::newRow("int min") << QByteArray("-2147483648") << QVariant(int(-2147483647 - 1));
+	QTest::newRow("long") << QByteArray("2147483648")
+			      << QVariant(Q_INT64_C(2147483648));
+	QTest::newRow("long max") << QByteArray("9223372036854775807")
+				  << QVariant(Q_INT64_C(9223372036854775807));
+	QTest::newRow("long min") << QByteArray("-9223372036854775808")
+				  << QVariant(Q_INT64_C(-9223372036854775807) - 1);
+	QTest::newRow("overflow") << QByteArray("9223372036854775808")
+				  << QVariant();
+	QTest::newRow("exponent") << QByteArray("1e3") << QVariant(1000.0);
+	QTest::newRow("fraction") << QByteArray("-0.25") << QVariant(-0.25);
+}
+
+void tst_JsonReader::numbers() const
+{
+	QFETCH(QByteArray, input);
+	QFETCH(QVariant, expected);
+
+	JsonReader reader(input);
+	QCOMPARE(reader.readNext(), JsonReader::Number);
+	const QVariant value(reader.readVariant());
+	QCOMPARE(value, expected);
+	QCOMPARE(reader.hasError(), expected.isNull());
+}
+
+void tst_JsonReader::errors_data() const
+{
+	QTest::addColumn<QByteArray>("input");
+	QTest::addColumn<int>("line");
+
+	QTest::newRow("empty") << QByteArray("") << 1;
+	QTest::newRow("missing colon") << QByteArray("{\n\"a\"\n 1}") << 3;
+	QTest::newRow("missing comma") << QByteArray("[1\n2]") << 2;
+	QTest::newRow("trailing comma") << QByteArray("[1,\n\n]") << 3;
+	QTest::newRow("bad literal") << QByteArray("[\ntrue,\nnul]") << 3;
+	QTest::newRow("bad escape") << QByteArray("\"\\x\"") << 1;
+	QTest::newRow("unterminated") << QByteArray("{\"a\" : [1, 2") << 1;
+}
+
+void tst_JsonReader::errors() const
+{
+	QFETCH(QByteArray, input);
+	QFETCH(int, line);
+
+	JsonReader reader(input);
+	reader.readNext();
+	QVERIFY(reader.readVariant().isNull());
+	QVERIFY(reader.hasError());
+	QVERIFY(!reader.errorString().isEmpty());
+	QCOMPARE(reader.errorLineNumber(), qint64(line));
+	QCOMPARE(reader.readNext(), JsonReader::Invalid);
+}
+
+void tst_JsonReader::file() const
+{
+	const QByteArray data(tournamentFile(100));
+
+	QTemporaryFile file;
+	QVERIFY(file.open());
+	QCOMPARE(file.write(data), qint64(data.size()));
+	file.close();
+
+	JsonReader reader;
+	QVERIFY(reader.openFile(file.fileName()));
+	reader.readNext();
+	const QVariant value(reader.readVariant());
+	QVERIFY(!reader.hasError());
+
+	JsonReader reference(data);
+	reference.readNext();
+	QCOMPARE(value, reference.readVariant());
+	QCOMPARE(value.toMap()["matchProgress"].toList().size(), 100);
+
+	QVERIFY(!reader.openFile(file.fileName() + ".missing"));
+}
+
+void tst_JsonReader::benchmark_data() const
+{
+	QTest::addColumn<int>("mode");
+
+	QTest::newRow("JsonParser") << 0;
+	QTest::newRow("JsonReader") << 1;
+	QTest::newRow("JsonReader, skip matchProgress") << 2;
+}
+
+void tst_JsonReader::benchmark() const
+{
+	QFETCH(int, mode);
+
+	const QByteArray data(tournamentFile(1000));
+	QVariant value;
+
+	QBENCHMARK
+	{
+		if (mode == 0)
+		{
+			QTextStream stream(data);
+			stream.setCodec("UTF-8");
+			JsonParser parser(stream);
+			value = parser.parse();
+		}
+		else if (mode == 1)
+		{
+			JsonReader reader(data);
+			reader.readNext();
+			value = reader.readVariant();
+		}
+		else
+		{
+			QVariantMap map;
+			JsonReader reader(data);
+			reader.readNext();
+			while (reader.readNext() == JsonReader::Name)
+			{
+				const QString name(reader.name());
+				reader.readNext();
+				if (name == "matchProgress")
+					reader.skipCurrentValue();
+				else
+					map[name] = reader.readVariant();
+			}
+			value = map;
+		}
+	}
+
+	QVERIFY(value.toMap().contains("tournamentSettings"));
+}
+
+QTEST_MAIN(tst_JsonReader)
+#include "tst_jsonreader.moc"
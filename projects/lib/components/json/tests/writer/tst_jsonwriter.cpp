@@ -0,0 +1,350 @@
+/*
+    Copyright (c) 2010 Ilari Pihlajisto
+
+    Permission is hereby granted, free of charge, to any person
+    obtaining a copy of this software and associated documentation
+    files (the "Software"), to deal in the Software without
+    restriction, including without limitation the rights to use,
+    copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the
+    Software is furnished to do so, subject to the following
+    conditions:
+
+    The above copyright notice and this permission notice shall be
+    included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+    OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <QtTest/QtTest>
+#include <jsonparser.h>
+#include <jsonserializer.h>
+#include <jsonwriter.h>
+
+class tst_JsonWriter: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void variant_data() const;
+		void variant() const;
+		void compact_data() const;
+		void compact() const;
+		void indented() const;
+		void device() const;
+
+		void benchmark_data() const;
+		void benchmark() const;
+
+	private:
+		QVariant parse(const QByteArray& data) const;
+		QVariant liveGame() const;
+};
+Q_DECLARE_METATYPE(QVariant)
+
+
+QVariant tst_JsonWriter::parse(const QByteArray& data) const
+{
+	QTextStream stream(data);
+	stream.setCodec("UTF-8");
+	JsonParser parser(stream);
+	QVariant result(parser.parse());
+	if (parser.hasError())
+		return QVariant(QString("ERROR: %1").arg(parser.errorString()));
+	return result;
+}
+
+QVariant tst_JsonWriter::liveGame() const
+{
+	// Similar to the live JSON file of a 120-ply game
+	QVariantList moves;
+	for (int i = 0; i < 120; i++)
+	{
+		QVariantMap pv;
+		pv["San"] = "Nf3 Nf6 c4 e6 Nc3 Bb4 Qc2 O-O a3 Bxc3+ Qxc3";
+		QVariantList pvMoves;
+		for (int j = 0; j < 11; j++)
+		{
+			QVariantMap pvMove;
+			pvMove["m"] = "Nf3";
+			pvMove["fen"] = "rnbqkbnr/pppppppp/8/8/8/5N2/PPPPPPPP/RNBQKB1R b KQkq - 1 1";
+			pvMove["from"] = "g1";
+			pvMove["to"] = "f3";
+			pvMoves << pvMove;
+		}
+		pv["Moves"] = pvMoves;
+
+		QVariantMap move;
+		move["m"] = "Nf3";
+		move["from"] = "g1";
+		move["to"] = "f3";
+		move["book"] = false;
+		move["wv"] = "0.25";
+		move["d"] = "35";
+		move["sd"] = "52";
+		move["mt"] = "61233";
+		move["tl"] = "5399000";
+		move["s"] = "51234567";
+		move["n"] = "3137000000";
+		move["pv"] = pv;
+		move["fen"] = "rnbqkbnr/pppppppp/8/8/8/5N2/PPPPPPPP/RNBQKB1R b KQkq - 1 1";
+		moves << move;
+	}
+
+	QVariantMap headers;
+	headers["Event"] = "TCEC Season 1 - Superfinal";
+	headers["White"] = "Engine A";
+	headers["Black"] = "Engine B";
+	headers["Result"] = "*";
+
+	QVariantMap game;
+	game["Headers"] = headers;
+	game["Moves"] = moves;
+	return game;
+}
+
+void tst_JsonWriter::variant_data() const
+{
+	QTest::addColumn<QVariant>("input");
+
+	QTest::newRow("null") << QVariant();
+	QTest::newRow("true") << QVariant(true);
+	QTest::newRow("false") << QVariant(false);
+	QTest::newRow("int") << QVariant(1234567890);
+	QTest::newRow("negative int") << QVariant(-1234567890);
+	QTest::newRow("64-bit int") << QVariant(Q_INT64_C(3567830610840546163));
+	QTest::newRow("negative 64-bit int") << QVariant(Q_INT64_C(-3567830610840546163));
+	QTest::newRow("double") << QVariant(0.012);
+	QTest::newRow("negative double") << QVariant(-0.012);
+	QTest::newRow("exponent double") << QVariant(0.0000371);
+	QTest::newRow("string #1") << QVariant(QString());
+	QTest::newRow("string #2") << QVariant("line 1\nline 2\nline 3\n");
+	QTest::newRow("string #3") << QVariant("Path = \"C:\\Program files\\foo\"");
+	QTest::newRow("string #4") << QVariant("/\b\f\n\r\t");
+	QTest::newRow("string #5") << QVariant(QString("%1%2%3%4")
+		.arg(QChar(0x2654))
+		.arg(QChar(0x00E9))
+		.arg(QChar(0x265A))
+		.arg(QChar(0x265F)));
+
+	QVariantMap obj;
+	QTest::newRow("object #1") << QVariant(obj);
+	obj["foo"] = "bar";
+	obj["number"] = -25;
+	obj["state"] = QVariant();
+	obj["empty array"] = QVariantList();
+	QTest::newRow("object #2") << QVariant(obj);
+
+	QVariantList list;
+	QTest::newRow("array #1") << QVariant(list);
+	list << QVariant() << QVariantMap() << "string data" << 1234567890;
+	QTest::newRow("array #2") << QVariant(list);
+
+	QTest::newRow("live game") << liveGame();
+}
+
+void tst_JsonWriter::variant() const
+{
+	QFETCH(QVariant, input);
+
+	QByteArray data;
+	JsonWriter writer(&data);
+	QVERIFY(writer.writeVariant(input));
+	QVERIFY(!writer.hasError());
+
+	QCOMPARE(parse(data), input);
+}
+
+void tst_JsonWriter::compact_data() const
+{
+	QTest::addColumn<QString>("input");
+	QTest::addColumn<QByteArray>("expected");
+
+	QTest::newRow("empty") << QString() << QByteArray("\"\"");
+	QTest::newRow("quotes")
+		<< QString("a \"b\" \\c/")
+		<< QByteArray("\"a \\\"b\\\" \\\\c/\"");
+	QTest::newRow("control")
+		<< QString("\t\n\x01\x1f")
+		<< QByteArray("\"\\t\\n\\u0001\\u001f\"");
+	QTest::newRow("two bytes")
+		<< QString(QChar(0x00E9))
+		<< QByteArray("\"\xc3\xa9\"");
+	QTest::newRow("three bytes")
+		<< QString(QChar(0x2654))
+		<< QByteArray("\"\xe2\x99\x94\"");
+	const uint smiley = 0x1F600;
+	QTest::newRow("surrogate pair")
+		<< QString::fromUcs4(&smiley, 1)
+		<< QByteArray("\"\xf0\x9f\x98\x80\"");
+	QTest::newRow("lone surrogate")
+		<< QString(QChar(0xD800))
+		<< QByteArray("\"\\ud800\"");
+}
+
+void tst_JsonWriter::compact() const
+{
+	QFETCH(QString, input);
+	QFETCH(QByteArray, expected);
+
+	QByteArray data;
+	JsonWriter writer(&data, JsonWriter::Compact);
+	writer.writeValue(input);
+	QCOMPARE(data, expected);
+
+	data.clear();
+	writer.writeStartObject();
+	writer.writeMember("a", 1);
+	writer.writeMember("b", Q_INT64_C(-9223372036854775807) - 1);
+	writer.writeName("c");
+	writer.writeStartArray();
+	writer.writeValue(true);
+	writer.writeNull();
+	writer.writeValue(0.5);
+	writer.writeValue(qQNaN());
+	writer.writeRawValue("{}");
+	writer.writeEndArray();
+	writer.writeMember("d", input);
+	writer.writeEndObject();
+	QCOMPARE(data, "{\"a\":1,\"b\":-9223372036854775808,"
+		       "\"c\":[true,null,0.5,null,{}],\"d\":" + expected + "}");
+}
+
+void tst_JsonWriter::indented() const
+{
+	QByteArray data;
+	JsonWriter writer(&data);
+	writer.writeStartObject();
+	writer.writeMember("name", "value");
+	writer.writeName("list");
+	writer.writeStartArray();
+	writer.writeValue(1);
+	writer.writeStartObject();
+	writer.writeEndObject();
+	writer.writeEndArray();
+	writer.writeEndObject();
+
+	QCOMPARE(data, QByteArray("{\n"
+				  "\t\"name\" : \"value\",\n"
+				  "\t\"list\" : [\n"
+				  "\t\t1,\n"
+				  "\t\t{}\n"
+				  "\t]\n"
+				  "}\n"));
+}
+
+void tst_JsonWriter::device() const
+{
+	const QVariant input(liveGame());
+
+	QBuffer buffer;
+	QVERIFY(buffer.open(QIODevice::WriteOnly));
+	{
+		JsonWriter writer(&buffer);
+		QVERIFY(writer.writeVariant(input));
+		QVERIFY(writer.flush());
+	}
+	buffer.close();
+
+	QCOMPARE(parse(buffer.data()), input);
+}
+
+void tst_JsonWriter::benchmark_data() const
+{
+	QTest::addColumn<bool>("streaming");
+
+	QTest::newRow("JsonSerializer") << false;
+	QTest::newRow("JsonWriter") << true;
+}
+
+void tst_JsonWriter::benchmark() const
+{
+	QFETCH(bool, streaming);
+
+	const QVariant game(liveGame());
+	const QVariantMap headers(game.toMap()["Headers"].toMap());
+	const QVariantList moves(game.toMap()["Moves"].toList());
+
+	QByteArray data;
+	data.reserve(1024 * 1024);
+	if (streaming)
+	{
+		// Written from the source data like the live file writer,
+		// without building a QVariant tree
+		QBENCHMARK
+		{
+			data.resize(0);
+			JsonWriter writer(&data);
+			writer.writeStartObject();
+			writer.writeName("Headers");
+			writer.writeStartObject();
+			for (auto it = headers.constBegin(); it != headers.constEnd(); ++it)
+			{
+				writer.writeName(it.key());
+				writer.writeValue(it.value().toString());
+			}
+			writer.writeEndObject();
+			writer.writeName("Moves");
+			writer.writeStartArray();
+			for (int i = 0; i < moves.size(); i++)
+			{
+				writer.writeStartObject();
+				writer.writeMember("m", "Nf3");
+				writer.writeMember("from", "g1");
+				writer.writeMember("to", "f3");
+				writer.writeMember("book", false);
+				writer.writeMember("wv", "0.25");
+				writer.writeMember("d", "35");
+				writer.writeMember("sd", "52");
+				writer.writeMember("mt", "61233");
+				writer.writeMember("tl", "5399000");
+				writer.writeMember("s", "51234567");
+				writer.writeMember("n", "3137000000");
+				writer.writeName("pv");
+				writer.writeStartObject();
+				writer.writeMember("San", "Nf3 Nf6 c4 e6 Nc3 Bb4 Qc2 O-O a3 Bxc3+ Qxc3");
+				writer.writeName("Moves");
+				writer.writeStartArray();
+				for (int j = 0; j < 11; j++)
+				{
+					writer.writeStartObject();
+					writer.writeMember("m", "Nf3");
+					writer.writeMember("fen", "rnbqkbnr/pppppppp/8/8/8/5N2/PPPPPPPP/RNBQKB1R b KQkq - 1 1");
+					writer.writeMember("from", "g1");
+					writer.writeMember("to", "f3");
+					writer.writeEndObject();
+				}
+				writer.writeEndArray();
+				writer.writeEndObject();
+				writer.writeMember("fen", "rnbqkbnr/pppppppp/8/8/8/5N2/PPPPPPPP/RNBQKB1R b KQkq - 1 1");
+				writer.writeEndObject();
+			}
+			writer.writeEndArray();
+			writer.writeEndObject();
+		}
+	}
+	else
+	{
+		QBENCHMARK
+		{
+			QString str;
+			QTextStream stream(&str, QIODevice::WriteOnly);
+			JsonSerializer serializer(liveGame());
+			serializer.serialize(stream);
+			stream.flush();
+			data = str.toUtf8();
+		}
+	}
+
+	QCOMPARE(parse(data).toMap()["Moves"].toList().size(), moves.size());
+}
+
+QTEST_MAIN(tst_JsonWriter)
+#include "tst_jsonwriter.moc"
@@ -0,0 +1,4 @@
+TARGET = tst_jsonwriter
+
+include(../tests.pri)
+SOURCES += tst_jsonwriter.cpp
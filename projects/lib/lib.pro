@@ -1,6 +1,6 @@
 TEMPLATE = lib
 TARGET = cutechess
-QT = core
+QT = core network
 DESTDIR = $$PWD
 
 !win32-msvc* {
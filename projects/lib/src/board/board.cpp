@@ -61,10 +61,17 @@ Board::Board(Zobrist* zobrist)
 	  m_maxPieceSymbolLength(1),
 	  m_key(0),
 	  m_zobrist(zobrist),
-	  m_sharedZobrist(zobrist)
+	  m_sharedZobrist(zobrist),
+	  m_legalMoveGenerations(0)
 {
 	Q_ASSERT(zobrist != nullptr);
 
+	for (LegalMoveCache& cache : m_legalMoveCache)
+	{
+		cache.key = 0;
+		cache.ply = -1;
+	}
+
 	setPieceType(Piece::NoPiece, QString(), QString());
 }
 
@@ -118,7 +125,10 @@ void Board::initialize()
 	m_width = width();
 	m_height = height();
 	for (int i = 0; i < (m_width + 2) * (m_height + 4); i++)
+	{
 		m_squares.append(Piece::WallPiece);
+		m_squareColor.append(chessSquare(i).color());
+	}
 	vInitialize();
 
 	m_maxPieceSymbolLength = 1;
@@ -127,6 +137,60 @@ void Board::initialize()
 			m_maxPieceSymbolLength = pd.symbol.length();
 
 	m_zobrist->initialize((m_width + 2) * (m_height + 4), m_pieceData.size());
+	clearPieces();
+}
+
+void Board::clearPieces()
+{
+	for (int side = Side::White; side <= Side::Black; side++)
+		m_pieceCount[side].fill(0, m_pieceData.size());
+	m_colorCount.fill(0, m_pieceData.size() * 2);
+	m_pieceIndex.fill(-1, m_squares.size());
+	m_pieceSquares.clear();
+}
+
+void Board::addPiece(Piece piece, int square)
+{
+	Q_ASSERT(piece.type() < m_pieceData.size());
+
+	m_pieceCount[piece.side()][piece.type()]++;
+	int color = m_squareColor.at(square);
+	if (color != Square::NoColor)
+		m_colorCount[piece.type() * 2 + color]++;
+
+	m_pieceIndex[square] = m_pieceSquares.size();
+	m_pieceSquares.append(square);
+}
+
+void Board::removePiece(Piece piece, int square)
+{
+	Q_ASSERT(piece.type() < m_pieceData.size());
+
+	m_pieceCount[piece.side()][piece.type()]--;
+	int color = m_squareColor.at(square);
+	if (color != Square::NoColor)
+		m_colorCount[piece.type() * 2 + color]--;
+
+	// Move the last square of the list into the vacated slot
+	int index = m_pieceIndex.at(square);
+	int last = m_pieceSquares.last();
+	m_pieceSquares[index] = last;
+	m_pieceIndex[last] = index;
+	m_pieceSquares.removeLast();
+	m_pieceIndex[square] = -1;
+}
+
+unsigned Board::pieceSquareColors(int pieceType) const
+{
+	if (pieceType < 0 || pieceType * 2 >= m_colorCount.size())
+		return 0;
+
+	unsigned mask = 0;
+	if (m_colorCount.at(pieceType * 2 + Square::Light) > 0)
+		mask |= 1 << Square::Light;
+	if (m_colorCount.at(pieceType * 2 + Square::Dark) > 0)
+		mask |= 1 << Square::Dark;
+	return mask;
 }
 
 int Board::maxPieceSymbolLength() const
@@ -553,6 +617,7 @@ bool Board::setFenString(const QString& fen)
 
 	for (int i = 0; i < m_squares.size(); i++)
 		m_squares[i] = Piece::WallPiece;
+	clearPieces();
 	m_key = 0;
 
 	// Get the board contents (squares)
@@ -679,6 +744,8 @@ bool Board::setFenString(const QString& fen)
 
 	m_moveHistory.clear();
 	m_startingFen = fen;
+	for (LegalMoveCache& cache : m_legalMoveCache)
+		cache.ply = -1;
 
 	// Let subclasses handle the rest of the FEN string
 	if (token != strList.end())
@@ -804,6 +871,90 @@ void Board::generateSlidingMoves(int sourceSquare,
 	}
 }
 
+void Board::initMoveTable(MoveTable& table,
+			  const QVarLengthArray<int>& offsets,
+			  bool sliding) const
+{
+	const int size = arraySize();
+	table.m_index.clear();
+	table.m_targets.clear();
+	table.m_index.reserve(size + 1);
+
+	for (int sq = 0; sq < size; sq++)
+	{
+		table.m_index.append(table.m_targets.size());
+		if (!isValidSquare(chessSquare(sq)))
+			continue;
+
+		for (int i = 0; i < offsets.size(); i++)
+		{
+			int offset = offsets[i];
+			int targetSquare = sq + offset;
+			while (targetSquare > 0 && targetSquare < size
+			&&     isValidSquare(chessSquare(targetSquare)))
+			{
+				table.m_targets.append(targetSquare);
+				if (!sliding)
+					break;
+				targetSquare += offset;
+			}
+			if (sliding)
+				table.m_targets.append(0);
+		}
+	}
+	table.m_index.append(table.m_targets.size());
+	table.m_targets.squeeze();
+}
+
+void Board::initHoppingTable(MoveTable& table,
+			     const QVarLengthArray<int>& offsets) const
+{
+	initMoveTable(table, offsets, false);
+}
+
+void Board::initSlidingTable(MoveTable& table,
+			     const QVarLengthArray<int>& offsets) const
+{
+	initMoveTable(table, offsets, true);
+}
+
+void Board::generateHoppingMoves(int sourceSquare,
+				 const MoveTable& table,
+				 QVarLengthArray<Move>& moves) const
+{
+	Side opSide = sideToMove().opposite();
+	const int* end = table.end(sourceSquare);
+	for (const int* target = table.begin(sourceSquare); target != end; ++target)
+	{
+		Piece capture = m_squares[*target];
+		if (capture.isEmpty() || capture.side() == opSide)
+			moves.append(Move(sourceSquare, *target));
+	}
+}
+
+void Board::generateSlidingMoves(int sourceSquare,
+				 const MoveTable& table,
+				 QVarLengthArray<Move>& moves) const
+{
+	Side side = sideToMove();
+	const int* end = table.end(sourceSquare);
+	for (const int* target = table.begin(sourceSquare); target != end; ++target)
+	{
+		for (; *target != 0; ++target)
+		{
+			Piece capture = m_squares[*target];
+			if (capture.isWall() || capture.side() == side)
+				break;
+			moves.append(Move(sourceSquare, *target));
+			if (!capture.isEmpty())
+				break;
+		}
+		// Skip to the end of the ray
+		while (*target != 0)
+			++target;
+	}
+}
+
 bool Board::moveExists(const Move& move) const
 {
 	Q_ASSERT(!move.isNull());
@@ -852,7 +1003,14 @@ bool Board::vIsLegalMove(const Move& move)
 
 bool Board::isLegalMove(const Move& move)
 {
-	return !move.isNull() && moveExists(move) && vIsLegalMove(move);
+	if (move.isNull())
+		return false;
+
+	const QVector<Move>* moves = cachedLegalMoves();
+	if (moves != nullptr)
+		return moves->contains(move);
+
+	return moveExists(move) && vIsLegalMove(move);
 }
 
 int Board::repeatCount() const
@@ -888,20 +1046,27 @@ bool Board::isRepetition(const Chess::Move& move)
 
 bool Board::canMove()
 {
-	QVarLengthArray<Move> moves;
-	generateMoves(moves);
-
-	for (int i = 0; i < moves.size(); i++)
-	{
-		if (vIsLegalMove(moves[i]))
-			return true;
-	}
+	return !legalMoves().isEmpty();
+}
 
-	return false;
+const QVector<Move>* Board::cachedLegalMoves() const
+{
+	// Positions with an even and odd ply count have their own
+	// slots, so a move made and undone keeps both positions cached.
+	const int ply = plyCount();
+	const LegalMoveCache& cache = m_legalMoveCache[ply & 1];
+	if (cache.ply != ply || cache.key != m_key)
+		return nullptr;
+
+	return &cache.moves;
 }
 
 QVector<Move> Board::legalMoves()
 {
+	const QVector<Move>* cached = cachedLegalMoves();
+	if (cached != nullptr)
+		return *cached;
+
 	QVarLengthArray<Move> moves;
 	QVector<Move> legalMoves;
 
@@ -914,6 +1079,12 @@ QVector<Move> Board::legalMoves()
 			legalMoves << moves[i];
 	}
 
+	LegalMoveCache& cache = m_legalMoveCache[plyCount() & 1];
+	cache.key = m_key;
+	cache.ply = plyCount();
+	cache.moves = legalMoves;
+	m_legalMoveGenerations++;
+
 	return legalMoves;
 }
 
@@ -204,6 +204,28 @@ class LIB_EXPORT Board
 		Side startingSide() const;
 		/*! Returns the piece at \a square. */
 		Piece pieceAt(const Square& square) const;
+		/*!
+		 * Returns the number of pieces on the board.
+		 *
+		 * Reserve pieces are not counted. The piece counts are
+		 * kept up to date as squares change, so this function and
+		 * its overloads run in constant time.
+		 */
+		int pieceCount() const;
+		/*!
+		 * Returns the number of \a side's pieces of type
+		 * \a pieceType on the board.
+		 */
+		int pieceCount(Side side, int pieceType) const;
+		/*!
+		 * Returns a mask of the square colors occupied by pieces of
+		 * type \a pieceType of either side.
+		 *
+		 * Bit \c Square::Light is set if there are pieces of
+		 * \a pieceType on light squares, and bit \c Square::Dark if
+		 * there are pieces on dark squares.
+		 */
+		unsigned pieceSquareColors(int pieceType) const;
 		/*! Returns the number of halfmoves (plies) played. */
 		int plyCount() const;
 		/*!
@@ -284,8 +306,23 @@ class LIB_EXPORT Board
 		 * reached earlier in the game.
 		 */
 		bool isRepetition(const Move& move);
-		/*! Returns a vector of legal moves in the current position. */
+		/*!
+		 * Returns a vector of legal moves in the current position.
+		 *
+		 * The moves are cached by position key and ply, so calling
+		 * this function again in the same position doesn't generate
+		 * the moves again. The cache holds the current position and
+		 * the position one ply away, which covers the usual pattern
+		 * of making a move, inspecting the position and undoing it.
+		 */
 		QVector<Move> legalMoves();
+		/*!
+		 * Returns the number of times the legal moves of a position
+		 * have been generated because they weren't in the cache.
+		 *
+		 * This is a statistic for benchmarking.
+		 */
+		quint64 legalMoveGenerations() const;
 		/*!
 		 * Returns the result of the game, or Result::NoResult if
 		 * the game is in progress.
@@ -303,6 +340,33 @@ class LIB_EXPORT Board
 		virtual Result tablebaseResult(unsigned int* dtm = nullptr) const;
 
 	protected:
+		/*!
+		 * \brief Precomputed targets of a piece's movement
+		 *
+		 * A MoveTable stores the squares a piece can reach from each
+		 * square of the board with a set of offsets, so the move
+		 * generator and attack detection don't have to check the
+		 * board edges. A hopping table lists the valid targets of
+		 * the offsets. A sliding table lists each ray as a sequence
+		 * of squares that ends in 0, which is never a valid square.
+		 *
+		 * \sa initHoppingTable(), initSlidingTable()
+		 */
+		class MoveTable
+		{
+			public:
+				/*! Returns a pointer to the first target from \a square. */
+				const int* begin(int square) const;
+				/*! Returns a pointer past the last target from \a square. */
+				const int* end(int square) const;
+
+			private:
+				friend class Board;
+
+				QVector<int> m_index;
+				QVector<int> m_targets;
+		};
+
 		/*!
 		 * Initializes the variant.
 		 *
@@ -453,6 +517,46 @@ class LIB_EXPORT Board
 		void generateSlidingMoves(int sourceSquare,
 					  const QVarLengthArray<int>& offsets,
 					  QVarLengthArray<Move>& moves) const;
+		/*!
+		 * Fills \a table with the valid targets of \a offsets from
+		 * every square, for a hopping piece.
+		 *
+		 * \note The board must be initialized, so this function is
+		 * usually called from vInitialize().
+		 */
+		void initHoppingTable(MoveTable& table,
+				      const QVarLengthArray<int>& offsets) const;
+		/*!
+		 * Fills \a table with the rays of \a offsets from every
+		 * square, for a sliding piece.
+		 *
+		 * \note The board must be initialized, so this function is
+		 * usually called from vInitialize().
+		 */
+		void initSlidingTable(MoveTable& table,
+				      const QVarLengthArray<int>& offsets) const;
+		/*!
+		 * Generates hopping moves for a piece.
+		 *
+		 * This is a faster version of the offset-based function.
+		 * \param sourceSquare The source square of the hopping piece
+		 * \param table A hopping table for the piece
+		 * \note The generated moves include captures
+		 */
+		void generateHoppingMoves(int sourceSquare,
+					  const MoveTable& table,
+					  QVarLengthArray<Move>& moves) const;
+		/*!
+		 * Generates sliding moves for a piece.
+		 *
+		 * This is a faster version of the offset-based function.
+		 * \param sourceSquare The source square of the sliding piece
+		 * \param table A sliding table for the piece
+		 * \note The generated moves include captures
+		 */
+		void generateSlidingMoves(int sourceSquare,
+					  const MoveTable& table,
+					  QVarLengthArray<Move>& moves) const;
 		/*!
 		 * Returns true if the current position is a legal position.
 		 * If the position isn't legal it usually means that the last
@@ -485,6 +589,14 @@ class LIB_EXPORT Board
 		bool moveExists(const Move& move) const;
 		/*! Returns true if the side to move has any legal moves. */
 		bool canMove();
+		/*!
+		 * Returns the cached legal moves of the current position, or
+		 * a null pointer if they aren't cached.
+		 *
+		 * Subclasses can use this to avoid generating and testing
+		 * moves that legalMoves() already generated.
+		 */
+		const QVector<Move>* cachedLegalMoves() const;
 		/*!
 		 * Returns the size of the board array, including the padding
 		 * (the inaccessible wall squares).
@@ -501,6 +613,11 @@ class LIB_EXPORT Board
 		void setSquare(int square, Piece piece);
 		/*! Returns the last move made in the game. */
 		const Move& lastMove() const;
+		/*!
+		 * Returns the squares that have a piece on them, in no
+		 * particular order.
+		 */
+		const QVector<int>& pieceSquares() const;
 		/*!
 		 * Returns the reserve piece type corresponding to \a pieceType.
 		 *
@@ -529,8 +646,21 @@ class LIB_EXPORT Board
 			Move move;
 			quint64 key;
 		};
+		struct LegalMoveCache
+		{
+			quint64 key;
+			int ply;
+			QVector<Move> moves;
+		};
 		friend LIB_EXPORT QDebug operator<<(QDebug dbg, const Board* board);
 
+		void initMoveTable(MoveTable& table,
+				   const QVarLengthArray<int>& offsets,
+				   bool sliding) const;
+		void clearPieces();
+		void addPiece(Piece piece, int square);
+		void removePiece(Piece piece, int square);
+
 		bool m_initialized;
 		int m_width;
 		int m_height;
@@ -544,12 +674,29 @@ class LIB_EXPORT Board
 		QVarLengthArray<PieceData> m_pieceData;
 		QVarLengthArray<Piece> m_squares;
 		QVector<MoveData> m_moveHistory;
+		LegalMoveCache m_legalMoveCache[2];
+		quint64 m_legalMoveGenerations;
 		QVector<int> m_reserve[2];
+		QVector<int> m_pieceCount[2];
+		QVector<int> m_colorCount;
+		QVector<int> m_squareColor;
+		QVector<int> m_pieceIndex;
+		QVector<int> m_pieceSquares;
 };
 
 
 extern LIB_EXPORT QDebug operator<<(QDebug dbg, const Board* board);
 
+inline const int* Board::MoveTable::begin(int square) const
+{
+	return m_targets.constData() + m_index[square];
+}
+
+inline const int* Board::MoveTable::end(int square) const
+{
+	return m_targets.constData() + m_index[square + 1];
+}
+
 inline int Board::arraySize() const
 {
 	return m_squares.size();
@@ -589,18 +736,49 @@ inline void Board::setSquare(int square, Piece piece)
 {
 	Piece& old = m_squares[square];
 	if (old.isValid())
+	{
 		xorKey(m_zobrist->piece(old, square));
+		removePiece(old, square);
+	}
 	if (piece.isValid())
+	{
 		xorKey(m_zobrist->piece(piece, square));
+		addPiece(piece, square);
+	}
 
 	old = piece;
 }
 
+inline int Board::pieceCount() const
+{
+	return m_pieceSquares.size();
+}
+
+inline int Board::pieceCount(Side side, int pieceType) const
+{
+	Q_ASSERT(!side.isNull());
+
+	const QVector<int>& counts = m_pieceCount[side];
+	if (pieceType < 0 || pieceType >= counts.size())
+		return 0;
+	return counts.at(pieceType);
+}
+
+inline const QVector<int>& Board::pieceSquares() const
+{
+	return m_pieceSquares;
+}
+
 inline int Board::plyCount() const
 {
 	return m_moveHistory.size();
 }
 
+inline quint64 Board::legalMoveGenerations() const
+{
+	return m_legalMoveGenerations;
+}
+
 inline const Move& Board::lastMove() const
 {
 	return m_moveHistory.last().move;
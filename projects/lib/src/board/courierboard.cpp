@@ -75,6 +75,8 @@ void CourierBoard::vInitialize()
 	m_wazirOffsets[1] = -1;
 	m_wazirOffsets[2] = 1;
 	m_wazirOffsets[3] = arrWidth;
+
+	initHoppingTable(m_wazirTable, m_wazirOffsets);
 }
 
 void CourierBoard::generateMovesForPiece(QVarLengthArray< Move >& moves,
@@ -83,7 +85,7 @@ void CourierBoard::generateMovesForPiece(QVarLengthArray< Move >& moves,
 {
 	Chess::ShatranjBoard::generateMovesForPiece(moves, pieceType, square);
 	if (pieceHasMovement(pieceType, WazirMovement))
-		generateHoppingMoves(square, m_wazirOffsets, moves);
+		generateHoppingMoves(square, m_wazirTable, moves);
 }
 
 bool CourierBoard::inCheck(Side side, int square) const
@@ -94,9 +96,10 @@ bool CourierBoard::inCheck(Side side, int square) const
 		square = kingSquare(side);
 
 	// Wazir attacks by Schleich, Mann
-	for (int i = 0; i < m_wazirOffsets.size(); i++)
+	const int* end = m_wazirTable.end(square);
+	for (const int* sq = m_wazirTable.begin(square); sq != end; ++sq)
 	{
-		piece = pieceAt(square + m_wazirOffsets[i]);
+		piece = pieceAt(*sq);
 		if (piece.side() == opSide
 		&&  pieceHasMovement(piece.type(), WazirMovement))
 			return true;
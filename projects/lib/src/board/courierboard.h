@@ -86,6 +86,7 @@ class LIB_EXPORT CourierBoard : public ShatranjBoard
 						   int square) const;
 	private:
 		QVarLengthArray<int> m_wazirOffsets;
+		MoveTable m_wazirTable;
 };
 
 } // namespace Chess
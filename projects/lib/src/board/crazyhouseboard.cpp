@@ -224,23 +224,30 @@ void CrazyhouseBoard::generateMovesForPiece(QVarLengthArray<Move>& moves,
 	// Generate drops
 	if (square == 0)
 	{
-		const int size = arraySize();
-		for (int i = 0; i < size; i++)
+		const QVarLengthArray<int>& squares = dropSquares();
+		for (int i = 0; i < squares.size(); i++)
 		{
-			Piece tmp = pieceAt(i);
-			if (!tmp.isEmpty())
-				continue;
+			int target = squares[i];
 			if (pieceType == Pawn)
 			{
-				Square sq(chessSquare(i));
+				Square sq(chessSquare(target));
 				if (!pawnDropOkOnRank(sq.rank()))
 					continue;
 			}
-			moves.append(Move(0, i, pieceType));
+			moves.append(Move(0, target, pieceType));
 		}
 	}
 	else
 		WesternBoard::generateMovesForPiece(moves, pieceType, square);
 }
 
+bool CrazyhouseBoard::vIsLegalMove(const Move& move)
+{
+	// A drop can't uncover an attack on the king
+	if (move.sourceSquare() == 0 && !dropNeedsLegalityTest())
+		return true;
+
+	return WesternBoard::vIsLegalMove(move);
+}
+
 } // namespace Chess
@@ -79,6 +79,7 @@ class LIB_EXPORT CrazyhouseBoard : public WesternBoard
 		virtual void generateMovesForPiece(QVarLengthArray<Move>& moves,
 						   int pieceType,
 						   int square) const;
+		virtual bool vIsLegalMove(const Move& move);
 
 	private:
 		static int normalPieceType(int type);
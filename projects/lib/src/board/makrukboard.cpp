@@ -97,6 +97,11 @@ void MakrukBoard::vInitialize()
 	m_silverGeneralOffsets[Side::White][4] = -arwidth;
 
 	rotateAndStoreOffsets(m_silverGeneralOffsets);
+
+	initHoppingTable(m_silverGeneralTable[Side::White],
+			 m_silverGeneralOffsets[Side::White]);
+	initHoppingTable(m_silverGeneralTable[Side::Black],
+			 m_silverGeneralOffsets[Side::Black]);
 }
 
 void MakrukBoard::generateMovesForPiece(QVarLengthArray< Move >& moves,
@@ -104,7 +109,7 @@ void MakrukBoard::generateMovesForPiece(QVarLengthArray< Move >& moves,
 					  int square) const
 {
 	if (pieceHasMovement(pieceType, SilverGeneralMovement))
-		generateHoppingMoves(square, m_silverGeneralOffsets[sideToMove()], moves);
+		generateHoppingMoves(square, m_silverGeneralTable[sideToMove()], moves);
 
 	if (pieceType != Bia)
 		return ShatranjBoard::generateMovesForPiece(moves, pieceType, square);
@@ -146,9 +151,11 @@ bool MakrukBoard::inCheck(Side side, int square) const
 		square = kingSquare(side);
 
 	// Silver General Attacks attacks (by Khon)
-	for (int i = 0; i < m_silverGeneralOffsets[side].size(); i++)
+	const MoveTable& table = m_silverGeneralTable[side];
+	const int* end = table.end(square);
+	for (const int* sq = table.begin(square); sq != end; ++sq)
 	{
-		piece = pieceAt(square + m_silverGeneralOffsets[side][i]);
+		piece = pieceAt(*sq);
 		if (piece.side() == opSide
 		&&  pieceHasMovement(piece.type(), SilverGeneralMovement))
 			return true;
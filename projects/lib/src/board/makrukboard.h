@@ -171,6 +171,7 @@ class LIB_EXPORT MakrukBoard : public ShatranjBoard
 
 	private:
 		QVarLengthArray<int> m_silverGeneralOffsets[2];
+		MoveTable m_silverGeneralTable[2];
 		int m_promotionRank;
 		enum CountingRules m_rules;
 		bool m_useWesternCounting;
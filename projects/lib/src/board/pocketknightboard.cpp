@@ -101,19 +101,21 @@ void PocketKnightBoard::generateMovesForPiece(QVarLengthArray< Move >& moves, in
 	// Generate drops
 	if (square == 0)
 	{
-		const int size = arraySize();
-		for (int i = 0; i < size; i++)
-		{
-			Piece tmp = pieceAt(i);
-			if (!tmp.isEmpty())
-				continue;
-			moves.append(Move(0, i, pieceType));
-		}
+		const QVarLengthArray<int>& squares = dropSquares();
+		for (int i = 0; i < squares.size(); i++)
+			moves.append(Move(0, squares[i], pieceType));
 	}
 	else
 		WesternBoard::generateMovesForPiece(moves, pieceType, square);
 }
 
+bool PocketKnightBoard::vIsLegalMove(const Move& move)
+{
+	// A drop can't uncover an attack on the king
+	if (move.sourceSquare() == 0 && !dropNeedsLegalityTest())
+		return true;
 
+	return WesternBoard::vIsLegalMove(move);
+}
 
 } // namespace Chess
@@ -59,6 +59,7 @@ class LIB_EXPORT PocketKnightBoard : public WesternBoard
 		virtual void generateMovesForPiece(QVarLengthArray< Move >& moves,
 						   int pieceType,
 						   int square) const;
+		virtual bool vIsLegalMove(const Move& move);
 };
 
 } // namespace Chess
@@ -69,6 +69,9 @@ void ShatranjBoard::vInitialize()
 	m_alfilOffsets[1] = -2 * arrWidth + 2;
 	m_alfilOffsets[2] = 2 * arrWidth - 2;
 	m_alfilOffsets[3] = 2 * arrWidth + 2;
+
+	initHoppingTable(m_ferzTable, m_ferzOffsets);
+	initHoppingTable(m_alfilTable, m_alfilOffsets);
 }
 
 void ShatranjBoard::addPromotions(int sourceSquare,
@@ -84,9 +87,9 @@ void ShatranjBoard::generateMovesForPiece(QVarLengthArray< Move >& moves,
 {
 	Chess::WesternBoard::generateMovesForPiece(moves, pieceType, square);
 	if (pieceHasMovement(pieceType, FerzMovement))
-		generateHoppingMoves(square, m_ferzOffsets, moves);
+		generateHoppingMoves(square, m_ferzTable, moves);
 	if (pieceHasMovement(pieceType, AlfilMovement))
-		generateHoppingMoves(square, m_alfilOffsets, moves);
+		generateHoppingMoves(square, m_alfilTable, moves);
 }
 
 bool ShatranjBoard::inCheck(Side side, int square) const
@@ -97,20 +100,19 @@ bool ShatranjBoard::inCheck(Side side, int square) const
 		square = kingSquare(side);
 
 	// Ferz attacks
-	for (int i = 0; i < m_ferzOffsets.size(); i++)
+	const int* end = m_ferzTable.end(square);
+	for (const int* sq = m_ferzTable.begin(square); sq != end; ++sq)
 	{
-		piece = pieceAt(square + m_ferzOffsets[i]);
+		piece = pieceAt(*sq);
 		if (piece.side() == opSide
 		&&  pieceHasMovement(piece.type(), FerzMovement))
 			return true;
 	}
 	// Alfil attacks
-	for (int i = 0; i < m_alfilOffsets.size(); i++)
+	end = m_alfilTable.end(square);
+	for (const int* sq = m_alfilTable.begin(square); sq != end; ++sq)
 	{
-		int target = square + m_alfilOffsets[i];
-		if (!isValidSquare(chessSquare(target)))
-			continue;
-		piece = pieceAt(target);
+		piece = pieceAt(*sq);
 		if (piece.side() == opSide
 		&&  pieceHasMovement(piece.type(), AlfilMovement))
 			return true;
@@ -98,6 +98,8 @@ class LIB_EXPORT ShatranjBoard : public WesternBoard
 	private:
 		QVarLengthArray<int> m_ferzOffsets;
 		QVarLengthArray<int> m_alfilOffsets;
+		MoveTable m_ferzTable;
+		MoveTable m_alfilTable;
 		bool bareKing(Side side, int count = 0) const;
 };
 
@@ -1074,18 +1074,13 @@ QString StandardBoard::defaultFenString() const
 
 Result StandardBoard::tablebaseResult(unsigned int* dtz) const
 {
-	SyzygyTablebase::PieceList pieces;
+	// Don't bother building the piece list for big positions
+	if (pieceCount() > SyzygyTablebase::maxPieces())
+		return Result();
 
-	for (int i = 0; i < arraySize(); i++)
-	{
-		Piece piece(pieceAt(i));
-		if (piece.isValid())
-		{
-			if (pieces.size() > 6)
-				return Result();
-			pieces.append(qMakePair(chessSquare(i), piece));
-		}
-	}
+	SyzygyTablebase::PieceList pieces;
+	for (int square : pieceSquares())
+		pieces.append(qMakePair(chessSquare(square), pieceAt(square)));
 
 	SyzygyTablebase::Castling castling = 0;
 	if (hasCastlingRight(Chess::Side::White, KingSide))
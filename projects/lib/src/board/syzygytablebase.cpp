@@ -61,6 +61,13 @@ void SyzygyTablebase::setPieces(int pieces)
 		s_pieces = pieces;
 }
 
+int SyzygyTablebase::maxPieces()
+{
+	if (!s_initOK)
+		return 0;
+	return qMin(int(TB_LARGEST), s_pieces);
+}
+
 void SyzygyTablebase::setNoRule50()
 {
 	s_noRule50 = true;
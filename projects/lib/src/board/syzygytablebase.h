@@ -73,6 +73,14 @@ class LIB_EXPORT SyzygyTablebase
 		 * adjudication. Default is no limit.
 		 */
 		static void setPieces(int pieces);
+		/*!
+		 * Returns the maximum number of pieces in a position that
+		 * can be probed, or 0 if the tablebases aren't available.
+		 *
+		 * This is the smaller of the largest available tablebase
+		 * and the limit set with setPieces().
+		 */
+		static int maxPieces();
 		/*!
 		 * Disable the 50 move rule from consideration.
 		 */
@@ -49,6 +49,10 @@ WesternBoard::WesternBoard(WesternZobrist* zobrist)
 	m_pawnSteps += {CaptureStep, -1};
 	m_pawnSteps += {FreeStep, 0};
 	m_pawnSteps += {CaptureStep, 1};
+
+	m_dropSquares.isValid = false;
+	m_dropSquares.key = 0;
+	m_dropSquares.inCheck = false;
 }
 
 int WesternBoard::width() const
@@ -135,6 +139,14 @@ void WesternBoard::vInitialize()
 	m_rookOffsets[2] = 1;
 	m_rookOffsets[3] = m_arwidth;
 
+	QVarLengthArray<int> kingOffsets(m_bishopOffsets);
+	kingOffsets.append(m_rookOffsets.constData(), m_rookOffsets.size());
+
+	initHoppingTable(m_knightTable, m_knightOffsets);
+	initHoppingTable(m_kingTable, kingOffsets);
+	initSlidingTable(m_bishopTable, m_bishopOffsets);
+	initSlidingTable(m_rookTable, m_rookOffsets);
+
 	m_pawnAmbiguous = (pawnAmbiguity(FreeStep) > 1);
 	m_multiDigitNotation =  (height() > 9 && coordinateSystem() == NormalCoordinates)
 			     || (width() > 9 && coordinateSystem() == InvertedCoordinates);
@@ -243,18 +255,23 @@ QString WesternBoard::sanMoveString(const Move& move)
 	if (piece.type() != Pawn)	// not pawn
 	{
 		str += pieceSymbol(piece).toUpper();
+		const QVector<Move>* cachedMoves = cachedLegalMoves();
 		QVarLengthArray<Move> moves;
-		generateMoves(moves, piece.type());
+		if (cachedMoves != nullptr)
+			moves.append(cachedMoves->constData(), cachedMoves->size());
+		else
+			generateMoves(moves, piece.type());
 
 		for (int i = 0; i < moves.size(); i++)
 		{
 			const Move& move2 = moves[i];
 			if (move2.sourceSquare() == 0
 			||  move2.sourceSquare() == source
-			||  move2.targetSquare() != target)
+			||  move2.targetSquare() != target
+			||  pieceAt(move2.sourceSquare()).type() != piece.type())
 				continue;
 
-			if (!vIsLegalMove(move2))
+			if (cachedMoves == nullptr && !vIsLegalMove(move2))
 				continue;
 
 			Square square2(chessSquare(move2.sourceSquare()));
@@ -484,8 +501,14 @@ Move WesternBoard::moveFromSanString(const QString& str)
 			return Move();
 	}
 
+	// Use the cached legal moves if there are any, otherwise
+	// generate the pseudo-legal moves of the piece type.
+	const QVector<Move>* cachedMoves = cachedLegalMoves();
 	QVarLengthArray<Move> moves;
-	generateMoves(moves, piece.type());
+	if (cachedMoves != nullptr)
+		moves.append(cachedMoves->constData(), cachedMoves->size());
+	else
+		generateMoves(moves, piece.type());
 	const Move* match = nullptr;
 
 	// Loop through all legal moves to find a move that matches
@@ -495,6 +518,8 @@ Move WesternBoard::moveFromSanString(const QString& str)
 		const Move& move = moves[i];
 		if (move.sourceSquare() == 0 || move.targetSquare() != target)
 			continue;
+		if (pieceAt(move.sourceSquare()).type() != piece.type())
+			continue;
 		Square sourceSq2 = chessSquare(move.sourceSquare());
 		if (sourceSq.rank() != -1 && sourceSq2.rank() != sourceSq.rank())
 			continue;
@@ -506,7 +531,7 @@ Move WesternBoard::moveFromSanString(const QString& str)
 		if (move.promotion() != promotion)
 			continue;
 
-		if (!vIsLegalMove(move))
+		if (cachedMoves == nullptr && !vIsLegalMove(move))
 			continue;
 
 		// Return an empty move if there are multiple moves that
@@ -1085,18 +1110,17 @@ void WesternBoard::generateMovesForPiece(QVarLengthArray<Move>& moves,
 		return generatePawnMoves(square, moves);
 	if (pieceType == King)
 	{
-		generateHoppingMoves(square, m_bishopOffsets, moves);
-		generateHoppingMoves(square, m_rookOffsets, moves);
+		generateHoppingMoves(square, m_kingTable, moves);
 		generateCastlingMoves(moves);
 		return;
 	}
 
 	if (pieceHasMovement(pieceType, KnightMovement))
-		generateHoppingMoves(square, m_knightOffsets, moves);
+		generateHoppingMoves(square, m_knightTable, moves);
 	if (pieceHasMovement(pieceType, BishopMovement))
-		generateSlidingMoves(square, m_bishopOffsets, moves);
+		generateSlidingMoves(square, m_bishopTable, moves);
 	if (pieceHasMovement(pieceType, RookMovement))
-		generateSlidingMoves(square, m_rookOffsets, moves);
+		generateSlidingMoves(square, m_rookTable, moves);
 }
 
 bool WesternBoard::inCheck(Side side, int square) const
@@ -1123,61 +1147,123 @@ bool WesternBoard::inCheck(Side side, int square) const
 		}
 	}
 
-	Piece opKing(opSide, King);
 	Piece piece;
 	
 	// Knight, archbishop, chancellor attacks
-	for (int i = 0; i < m_knightOffsets.size(); i++)
+	const int* end = m_knightTable.end(square);
+	for (const int* sq = m_knightTable.begin(square); sq != end; ++sq)
 	{
-		piece = pieceAt(square + m_knightOffsets[i]);
+		piece = pieceAt(*sq);
 		if (piece.side() == opSide
 		&&  pieceHasMovement(piece.type(), KnightMovement))
 			return true;
 	}
 	
 	// Bishop, queen, archbishop, king attacks
-	for (int i = 0; i < m_bishopOffsets.size(); i++)
+	if (isRayAttacked(opSide, square, m_bishopTable, BishopMovement))
+		return true;
+	
+	// Rook, queen, chancellor, king attacks
+	return isRayAttacked(opSide, square, m_rookTable, RookMovement);
+}
+
+bool WesternBoard::isRayAttacked(Side opSide,
+				 int square,
+				 const MoveTable& table,
+				 unsigned movement) const
+{
+	Piece opKing(opSide, King);
+	const int* end = table.end(square);
+
+	for (const int* sq = table.begin(square); sq != end; ++sq)
 	{
-		int offset = m_bishopOffsets[i];
-		int targetSquare = square + offset;
+		// The first square of a ray is next to the target square
 		if (m_kingCanCapture
-		&&  pieceAt(targetSquare) == opKing)
+		&&  *sq != 0
+		&&  pieceAt(*sq) == opKing)
 			return true;
-		while ((piece = pieceAt(targetSquare)).isEmpty()
-		||     piece.side() == opSide)
+
+		for (; *sq != 0; ++sq)
 		{
-			if (!piece.isEmpty())
-			{
-				if (pieceHasMovement(piece.type(), BishopMovement))
-					return true;
-				break;
-			}
-			targetSquare += offset;
+			Piece piece = pieceAt(*sq);
+			if (piece.isEmpty())
+				continue;
+			if (piece.side() == opSide
+			&&  pieceHasMovement(piece.type(), movement))
+				return true;
+			break;
 		}
+		// Skip to the end of the ray
+		while (*sq != 0)
+			++sq;
 	}
-	
-	// Rook, queen, chancellor, king attacks
-	for (int i = 0; i < m_rookOffsets.size(); i++)
+
+	return false;
+}
+
+const QVarLengthArray<int>& WesternBoard::dropSquares() const
+{
+	return updateDropSquares().squares;
+}
+
+bool WesternBoard::dropNeedsLegalityTest() const
+{
+	return updateDropSquares().inCheck;
+}
+
+const WesternBoard::DropSquares& WesternBoard::updateDropSquares() const
+{
+	if (m_dropSquares.isValid && m_dropSquares.key == key())
+		return m_dropSquares;
+
+	m_dropSquares.isValid = true;
+	m_dropSquares.key = key();
+	m_dropSquares.squares.clear();
+	m_dropSquares.inCheck = inCheck(sideToMove());
+
+	if (!m_dropSquares.inCheck)
 	{
-		int offset = m_rookOffsets[i];
-		int targetSquare = square + offset;
-		if (m_kingCanCapture
-		&&  pieceAt(targetSquare) == opKing)
-			return true;
-		while ((piece = pieceAt(targetSquare)).isEmpty()
-		||     piece.side() == opSide)
+		const int size = arraySize();
+		for (int i = 0; i < size; i++)
 		{
-			if (!piece.isEmpty())
-			{
-				if (pieceHasMovement(piece.type(), RookMovement))
-					return true;
-				break;
-			}
+			if (pieceAt(i).isEmpty())
+				m_dropSquares.squares.append(i);
+		}
+	}
+	else
+	{
+		// A dropped piece can only resolve a check by blocking
+		// the line between the king and a checking slider
+		addInterpositionSquares(m_bishopOffsets, BishopMovement);
+		addInterpositionSquares(m_rookOffsets, RookMovement);
+	}
+
+	return m_dropSquares;
+}
+
+void WesternBoard::addInterpositionSquares(const QVarLengthArray<int>& offsets,
+					   unsigned movement) const
+{
+	Side opSide = sideToMove().opposite();
+	int kingSq = m_kingSquare[sideToMove()];
+	QVarLengthArray<int>& squares = m_dropSquares.squares;
+
+	for (int i = 0; i < offsets.size(); i++)
+	{
+		int offset = offsets[i];
+		int count = squares.size();
+		int targetSquare = kingSq + offset;
+		Piece piece;
+
+		while ((piece = pieceAt(targetSquare)).isEmpty())
+		{
+			squares.append(targetSquare);
 			targetSquare += offset;
 		}
+		if (piece.side() != opSide
+		||  !pieceHasMovement(piece.type(), movement))
+			squares.resize(count);
 	}
-	
-	return false;
 }
 
 bool WesternBoard::isLegalPosition()
@@ -1402,37 +1488,18 @@ Result WesternBoard::result()
 		}
 	}
 
-	// Insufficient mating material
-	int material = 0;
-	bool bishops[] = { false, false };
-	for (int i = 0; i < arraySize(); i++)
-	{
-		const Piece& piece = pieceAt(i);
-		if (!piece.isValid())
-			continue;
-
-		switch (piece.type())
-		{
-		case King:
-			break;
-		case Bishop:
-		{
-			auto color = chessSquare(i).color();
-			if (color != Square::NoColor && !bishops[color])
-			{
-				material++;
-				bishops[color] = true;
-			}
-			break;
-		}
-		case Knight:
-			material++;
-			break;
-		default:
-			material += 2;
-			break;
-		}
-	}
+	// Insufficient mating material: each knight counts as one, all
+	// bishops on the same square color as one, and other pieces as two
+	int kings = pieceCount(Side::White, King) + pieceCount(Side::Black, King);
+	int knights = pieceCount(Side::White, Knight) + pieceCount(Side::Black, Knight);
+	int bishops = pieceCount(Side::White, Bishop) + pieceCount(Side::Black, Bishop);
+	unsigned bishopColors = pieceSquareColors(Bishop);
+
+	int material = 2 * (pieceCount() - kings - knights - bishops) + knights;
+	if (bishopColors & (1 << Square::Light))
+		material++;
+	if (bishopColors & (1 << Square::Dark))
+		material++;
 	if (material <= 1)
 	{
 		str = tr("Insufficient material");
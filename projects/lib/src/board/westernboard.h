@@ -192,6 +192,25 @@ class LIB_EXPORT WesternBoard : public Board
 		 * If \a square is 0, then the king square is used.
 		 */
 		virtual bool inCheck(Side side, int square = 0) const;
+		/*!
+		 * Returns the squares where the side to move may drop a piece.
+		 *
+		 * If the side to move is not in check, these are all the
+		 * empty squares, and every drop on them is legal. In check
+		 * only the empty squares between the king and a checking
+		 * slider are returned, and dropNeedsLegalityTest() returns
+		 * true because a drop there doesn't resolve a double check.
+		 *
+		 * The squares are computed once per position.
+		 */
+		const QVarLengthArray<int>& dropSquares() const;
+		/*!
+		 * Returns true if drops in the current position must be
+		 * verified by making them, ie. the side to move is in check.
+		 *
+		 * \sa dropSquares()
+		 */
+		bool dropNeedsLegalityTest() const;
 
 		/*!
 		 * Returns FEN extensions. The default is an empty string.
@@ -239,6 +258,15 @@ class LIB_EXPORT WesternBoard : public Board
 			int reversibleMoveCount;
 		};
 
+		// Drop squares of the position with key 'key'
+		struct DropSquares
+		{
+			bool isValid;
+			quint64 key;
+			bool inCheck;
+			QVarLengthArray<int> squares;
+		};
+
 		void generateCastlingMoves(QVarLengthArray<Move>& moves) const;
 		void generatePawnMoves(int sourceSquare,
 				       QVarLengthArray<Move>& moves) const;
@@ -255,6 +283,13 @@ class LIB_EXPORT WesternBoard : public Board
 		 *  given \a step with orientation \a sign. */
 		inline int pawnPushOffset(const PawnStep& ps,
 					  int sign) const;
+		bool isRayAttacked(Side opSide,
+				   int square,
+				   const MoveTable& table,
+				   unsigned movement) const;
+		const DropSquares& updateDropSquares() const;
+		void addInterpositionSquares(const QVarLengthArray<int>& offsets,
+					     unsigned movement) const;
 
 		int m_arwidth;
 		int m_sign;
@@ -273,10 +308,15 @@ class LIB_EXPORT WesternBoard : public Board
 		CastlingRights m_castlingRights;
 		int m_castleTarget[2][2];
 		const WesternZobrist* m_zobrist;
+		mutable DropSquares m_dropSquares;
 
 		QVarLengthArray<int> m_knightOffsets;
 		QVarLengthArray<int> m_bishopOffsets;
 		QVarLengthArray<int> m_rookOffsets;
+		MoveTable m_knightTable;
+		MoveTable m_kingTable;
+		MoveTable m_bishopTable;
+		MoveTable m_rookTable;
 };
 
 
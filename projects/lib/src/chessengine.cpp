@@ -18,10 +18,13 @@
 
 #include "chessengine.h"
 #include <QIODevice>
+#include <QMetaMethod>
 #include <QTimer>
+#include <QtEndian>
 #include <QStringRef>
 #include <QtAlgorithms>
 #include "engineoption.h"
+#include "tracer.h"
 
 
 int ChessEngine::s_count = 0;
@@ -82,7 +85,13 @@ ChessEngine::ChessEngine(QObject* parent)
 	  m_protocolStartTimer(new QTimer(this)),
 	  m_ioDevice(nullptr),
 	  m_restartMode(EngineConfiguration::RestartAuto),
-	  m_cuteseal(false)
+	  m_cuteseal(false),
+	  m_cutesealBinary(false),
+	  m_cutesealLineNs(0),
+	  m_cutesealMoveStartNs(-1),
+	  m_clockStartPending(false),
+	  m_moveReadNs(-1),
+	  m_traceStartTime(0)
 {
 	m_pingTimer->setSingleShot(true);
 	m_pingTimer->setInterval(120000);
@@ -120,6 +129,8 @@ void ChessEngine::setDevice(QIODevice* device)
 	m_ioDevice->setParent(this);
 
 	connect(m_ioDevice, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+	connect(m_ioDevice, SIGNAL(bytesWritten(qint64)),
+		this, SLOT(onBytesWritten()));
 	connect(m_ioDevice, SIGNAL(readChannelFinished()), this, SLOT(onCrashed()));
 }
 
@@ -227,6 +238,7 @@ void ChessEngine::start()
 		return;
 	
 	m_pinging = false;
+	m_traceStartTime = Tracer::timestamp();
 	setState(Starting);
 
 	flushWriteBuffer();
@@ -245,6 +257,11 @@ void ChessEngine::onProtocolStart()
 	m_protocolStartTimer->stop();
 	m_pinging = false;
 	setState(Idle);
+	if (m_traceStartTime > 0)
+	{
+		Tracer::complete("engine", "handshake", m_traceStartTime, name());
+		m_traceStartTime = 0;
+	}
 	Q_ASSERT(isReady());
 
 	flushWriteBuffer();
@@ -306,6 +323,217 @@ bool ChessEngine::isCuteseal() const
 	return m_cuteseal;
 }
 
+QString ChessEngine::cutesealDeadline() const
+{
+	const TimeControl* tc = timeControl();
+	if (!m_cuteseal || tc->isInfinite())
+		return QString();
+
+	const qint64 ms = qint64(tc->timeLeft()) + tc->expiryMargin();
+	return QString("cuteseal-deadline %1 ").arg(qMax(ms, qint64(0)) * 1000000);
+}
+
+void ChessEngine::writeClockStart(const QString& command)
+{
+	const QString data(cutesealDeadline() + command);
+
+	// The clock starts when write() hands the command over, or with
+	// cuteseal when the runner echoes it
+	m_moveTimer.invalidate();
+	m_clockStartPending = false;
+	m_cutesealMoveStartNs = -1;
+	m_clockStartCommand = data;
+	write(data);
+}
+
+qint64 ChessEngine::moveTime()
+{
+	qint64 ns;
+	if (m_cuteseal && m_cutesealMoveStartNs >= 0)
+		ns = m_cutesealLineNs - m_cutesealMoveStartNs;
+	else if (m_cuteseal)
+		return -1;
+	else if (m_moveTimer.isValid() && m_moveReadNs >= 0)
+		ns = m_moveReadNs;
+	else
+		return -1;
+	ns = qMax(ns, qint64(0));
+	m_moveTimer.invalidate();
+	m_cutesealMoveStartNs = -1;
+
+	// The message is only built when the debug output is on, the
+	// move time is on the latency path
+	static const QMetaMethod debugSignal(
+		QMetaMethod::fromSignal(&ChessPlayer::debugMessage));
+	const qint64 clockNs = isSignalConnected(debugSignal)
+		? timeControl()->activeTimeElapsed() : -1;
+	if (clockNs >= 0)
+		emit debugMessage(QString("Move time of %1(%2): %3 us, "
+					  "harness overhead: %4 us")
+				  .arg(name())
+				  .arg(m_id)
+				  .arg(ns / 1000)
+				  .arg((clockNs - ns) / 1000));
+
+	return (ns + 500000) / 1000000;
+}
+
+void ChessEngine::onBytesWritten()
+{
+	// QProcess writes its buffer when the pipe is writable, so the
+	// clock starts after the write call that empties the buffer
+	if (m_clockStartPending && m_ioDevice->bytesToWrite() == 0)
+	{
+		m_clockStartPending = false;
+		m_moveTimer.start();
+		m_moveReadNs = -1;
+	}
+}
+
+int ChessEngine::getMaxNetLagMs() const
+{
+	// The runner flags the timeouts, so allow 600 seconds of lag
+	return m_cuteseal ? 600000 : 0;
+}
+
+bool ChessEngine::parseCutesealLine(QString& line)
+{
+	// Format: <line number> <timestamp in ns> <stream> <text>
+	const QStringRef lineNum(firstToken(line));
+	const QStringRef timeNs(nextToken(lineNum));
+	const QStringRef streamName(nextToken(timeNs));
+	const QStringRef text(nextToken(streamName, true));
+
+	bool ok = false;
+	const qint64 ns = timeNs.toLongLong(&ok);
+	if (!ok)
+	{
+		qWarning("Bad cuteseal line from %s: %s",
+			 qUtf8Printable(name()), qUtf8Printable(line));
+		return false;
+	}
+
+	CutesealStream stream;
+	if (streamName == "STDOUT")
+		stream = CutesealStdout;
+	else if (streamName == "STDERR")
+		stream = CutesealStderr;
+	else if (streamName == "STDIN")
+		stream = CutesealStdin;
+	else if (streamName == "STATUS")
+		stream = CutesealStatus;
+	else
+	{
+		qWarning("Bad cuteseal stream from %s: %s",
+			 qUtf8Printable(name()),
+			 qUtf8Printable(streamName.toString()));
+		return false;
+	}
+
+	if (!handleCutesealLine(ns, stream, text))
+		return false;
+
+	line = text.toString();
+	return true;
+}
+
+bool ChessEngine::handleCutesealLine(qint64 ns,
+				     CutesealStream stream,
+				     const QStringRef& text)
+{
+	m_cutesealLineNs = ns;
+
+	switch (stream)
+	{
+	case CutesealStdout:
+	case CutesealStderr:
+		return !text.isEmpty();
+	case CutesealStdin:
+		// The echo of our own command tells when the engine
+		// received it, which is when its clock starts. Commands
+		// without a time limit have no deadline prefix.
+		if (!m_clockStartCommand.isNull() && text == m_clockStartCommand)
+		{
+			m_clockStartCommand.clear();
+			m_cutesealMoveStartNs = ns;
+		}
+		break;
+	case CutesealStatus:
+		if (text == "TIMEOUT" && state() == Thinking)
+			forfeit(Chess::Result::Timeout);
+		break;
+	}
+
+	return false;
+}
+
+void ChessEngine::readCutesealFrames()
+{
+	// Frame: payload length (32 bits), stream (8 bits), timestamp in
+	// ns (64 bits), all little-endian, and the payload. The frames are
+	// decoded in place; only the payload is copied into a string.
+	static const int headerSize = 13;
+	static const char* const streamNames[] = {
+		"STATUS", "STDIN", "STDOUT", "STDERR"
+	};
+
+	if (m_cutesealBuffer.isEmpty())
+		m_cutesealBuffer = m_ioDevice->readAll();
+	else
+		m_cutesealBuffer.append(m_ioDevice->readAll());
+
+	int pos = 0;
+	while (m_cutesealBuffer.size() - pos >= headerSize)
+	{
+		const uchar* header = reinterpret_cast<const uchar*>(
+			m_cutesealBuffer.constData() + pos);
+		const quint32 length = qFromLittleEndian<quint32>(header);
+		if (length > quint32(m_cutesealBuffer.size() - pos - headerSize))
+			break;
+
+		const int stream = header[4];
+		const qint64 ns = qFromLittleEndian<qint64>(header + 5);
+		const QString line(QString::fromUtf8(
+			m_cutesealBuffer.constData() + pos + headerSize,
+			int(length)));
+		pos += headerSize + int(length);
+
+		if (stream > CutesealStderr)
+		{
+			qWarning("Bad cuteseal stream from %s: %d",
+				 qUtf8Printable(name()), stream);
+			continue;
+		}
+
+		emit debugMessage(QString("<%1(%2): %3 %4 %5")
+				  .arg(name())
+				  .arg(m_id)
+				  .arg(ns)
+				  .arg(streamNames[stream])
+				  .arg(line));
+		if (handleCutesealLine(ns, CutesealStream(stream),
+				       QStringRef(&line)))
+			parseLine(line);
+		updateIdleTimer();
+
+		if (!m_ioDevice->isReadable())
+			break;
+	}
+
+	m_cutesealBuffer.remove(0, pos);
+}
+
+void ChessEngine::updateIdleTimer()
+{
+	if (m_idleTimer->isActive())
+	{
+		if (state() == Thinking && !m_pinging)
+			m_idleTimer->start();
+		else
+			m_idleTimer->stop();
+	}
+}
+
 void ChessEngine::endGame(const Chess::Result& result)
 {
 	ChessPlayer::endGame(result);
@@ -465,10 +693,29 @@ void ChessEngine::write(const QString& data, WriteMode mode)
 	if (m_ioDevice->write(data.toLatin1() + "\n") == -1)
 		qWarning("Writing to engine %s(%d) failed",
 			 qUtf8Printable(name()), m_id);
+	else if (!m_cuteseal
+	     &&  !m_clockStartCommand.isNull()
+	     &&  data == m_clockStartCommand)
+	{
+		// With cuteseal the command is cleared by its echo
+		m_clockStartCommand.clear();
+		m_clockStartPending = true;
+		onBytesWritten();
+	}
 }
 
 void ChessEngine::onReadyRead()
 {
+	// The time the engine's output was read from the pipe
+	if (m_moveTimer.isValid())
+		m_moveReadNs = m_moveTimer.nsecsElapsed();
+
+	if (m_cutesealBinary)
+	{
+		readCutesealFrames();
+		return;
+	}
+
 	while (m_ioDevice->isReadable() && m_ioDevice->canReadLine())
 	{
 		QString line = QString(m_ioDevice->readLine());
@@ -479,19 +726,21 @@ void ChessEngine::onReadyRead()
 		if (line.isEmpty())
 			continue;
 
+		// The runner announces binary framing on its first line
+		if (m_cuteseal && line == "CUTESEAL-BINARY 1")
+		{
+			m_cutesealBinary = true;
+			readCutesealFrames();
+			return;
+		}
+
 		emit debugMessage(QString("<%1(%2): %3")
 				  .arg(name())
 				  .arg(m_id)
 				  .arg(line));
-		parseLine(line);
-
-		if (m_idleTimer->isActive())
-		{
-			if (state() == Thinking && !m_pinging)
-				m_idleTimer->start();
-			else
-				m_idleTimer->stop();
-		}
+		if (!m_cuteseal || parseCutesealLine(line))
+			parseLine(line);
+		updateIdleTimer();
 	}
 }
 
@@ -22,6 +22,7 @@
 #include "chessplayer.h"
 #include <QVariant>
 #include <QStringList>
+#include <QElapsedTimer>
 #include "engineconfiguration.h"
 
 class QIODevice;
@@ -230,8 +231,36 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		 */
 		bool pondering() const;
 
+		/*!
+		 * Returns true if the engine's output is framed by
+		 * cuteseal-remote-runner.
+		 */
 		bool isCuteseal() const;
 
+		/*!
+		 * Writes \a command, which starts the engine's clock.
+		 *
+		 * The engine's move time is measured from the moment the
+		 * command is written to the engine process, or from its
+		 * echo from cuteseal-remote-runner. With cuteseal and a
+		 * finite time control the command also gets a deadline
+		 * for the engine's move.
+		 */
+		void writeClockStart(const QString& command);
+		/*!
+		 * Returns the engine's thinking time in milliseconds from
+		 * the last writeClockStart() command to the engine output
+		 * that is being parsed, or -1 if it wasn't measured.
+		 *
+		 * The result can be passed to emitMove() as is. The time the
+		 * harness itself added to the player's clock is written to
+		 * the debug output if it's enabled.
+		 */
+		qint64 moveTime();
+
+		// Inherited from ChessPlayer
+		virtual int getMaxNetLagMs() const;
+
 	protected slots:
 		// Inherited from ChessPlayer
 		virtual void onTimeout();
@@ -274,10 +303,28 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 	private slots:
 		void onQuitTimeout();
 		void onProtocolStartTimeout();
+		void onBytesWritten();
 
 	private:
+		/*! The streams of cuteseal-remote-runner's output. */
+		enum CutesealStream
+		{
+			CutesealStatus,
+			CutesealStdin,
+			CutesealStdout,
+			CutesealStderr
+		};
+
 		static int s_count;
 
+		QString cutesealDeadline() const;
+		bool parseCutesealLine(QString& line);
+		bool handleCutesealLine(qint64 ns,
+					CutesealStream stream,
+					const QStringRef& text);
+		void readCutesealFrames();
+		void updateIdleTimer();
+
 		int m_id;
 		State m_pingState;
 		bool m_pinging;
@@ -295,6 +342,15 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		EngineConfiguration::RestartMode m_restartMode;
 		QString m_configurationString;
 		bool m_cuteseal;
+		bool m_cutesealBinary;
+		QByteArray m_cutesealBuffer;
+		qint64 m_cutesealLineNs;
+		qint64 m_cutesealMoveStartNs;
+		QString m_clockStartCommand;
+		bool m_clockStartPending;
+		QElapsedTimer m_moveTimer;
+		qint64 m_moveReadNs;
+		qint64 m_traceStartTime;
 };
 
 #endif // CHESSENGINE_H
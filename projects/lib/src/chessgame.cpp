@@ -26,8 +26,9 @@
 #include "openingbook.h"
 #include "chessengine.h"
 #include "engineoption.h"
+#include "tracer.h"
 
-#include <jsonserializer.h>
+#include <jsonwriter.h>
 #include <QFileInfo>
 
 
@@ -242,26 +243,12 @@ QString ChessGame::statusString(const Chess::Move& move, bool doMove)
 		m_board->makeMove(move);
 
 	// Material balance 'mb'
-	QMap<QString, int> pMap;
-	for (int file = 0; file < m_board->height(); file++)
-		for (int rank = 0; rank < m_board->width(); rank++)
-		{
-			const Chess::Square sq = Chess::Square(file, rank);
-			const Chess::Piece piece = m_board->pieceAt(sq);
-			if (!piece.isValid()) continue;
-			const QString sym(m_board->pieceSymbol(piece).toUpper());
-			if (!pMap.contains(sym))
-				pMap[sym] = 0;
-			if (piece.side() == Chess::Side::White)
-				++pMap[sym];
-			else
-				--pMap[sym];
-		}
-
 	QString str(", mb=");
 	for(const char* istr : {"P", "N", "B", "R", "Q"})
 	{
-		const int v(pMap[istr]);
+		const int type = m_board->pieceFromSymbol(istr).type();
+		const int v = m_board->pieceCount(Chess::Side::White, type)
+			    - m_board->pieceCount(Chess::Side::Black, type);
 		if (v >= 0)
 			str += '+';
 		str += QString::number(v);
@@ -284,7 +271,8 @@ ChessGame::ChessGame(Chess::Board* board, PgnGame* pgn, QObject* parent)
 	  m_pgnInitialized(false),
 	  m_bookOwnership(false),
 	  m_boardShouldBeFlipped(false),
-	  m_pgn(pgn)
+	  m_pgn(pgn),
+	  m_traceStartTime(0)
 {
 	Q_ASSERT(pgn != nullptr);
 
@@ -299,6 +287,7 @@ ChessGame::ChessGame(Chess::Board* board, PgnGame* pgn, QObject* parent)
 ChessGame::~ChessGame()
 {
 	delete m_board;
+	delete m_liveBoard;
 	if (m_bookOwnership)
 	{
 		bool same = (m_book[0] == m_book[1]);
@@ -391,6 +380,13 @@ void ChessGame::stop(bool emitMoveChanged)
 		finish();
 		return;
 	}
+
+	if (m_traceStartTime > 0)
+	{
+		Tracer::complete("game", "game", m_traceStartTime,
+				 m_result.toShortString());
+		m_traceStartTime = 0;
+	}
 	
 	QDateTime gameEndTime = QDateTime::currentDateTimeUtc();
 
@@ -495,6 +491,7 @@ void ChessGame::onMoveMade(const Chess::Move& move)
 	m_result = m_board->result();
 	if (m_result.isNone())
 	{
+		TraceSpan adjudication("adjudication", "adjudicate");
 		if (m_board->reversibleMoveCount() == 0)
 			m_adjudicator.resetDrawMoveCount();
 
@@ -610,7 +607,9 @@ Chess::Move ChessGame::bookMove(Chess::Side side)
 	||  m_moves.size() >= m_bookDepth[side] * 2)
 		return Chess::Move();
 
+	TraceSpan probe("book", "book probe");
 	Chess::GenericMove bookMove = m_book[side]->move(m_board->key());
+	probe.finish();
 	Chess::Move move = m_board->moveFromGenericMove(bookMove);
 	if (move.isNull())
 		return Chess::Move();
@@ -981,6 +980,11 @@ void ChessGame::startGame()
 	m_pgn->setPlayerName(Chess::Side::Black, m_player[Chess::Side::Black]->name());
 
 	emit started(this);
+	m_traceStartTime = Tracer::timestamp();
+	if (Tracer::isEnabled())
+		Tracer::instant("game", "game start",
+				m_pgn->playerName(Chess::Side::White) + " vs " +
+				m_pgn->playerName(Chess::Side::Black));
 	QDateTime gameStartTime = QDateTime::currentDateTimeUtc();
 	m_pgn->setGameStartTime(gameStartTime);
 
@@ -1034,6 +1038,8 @@ void ChessGame::updateLiveFiles() const
 {
 	if (m_livePgnOut.isEmpty()) return;
 
+	TraceSpan span("io", "live file write", m_livePgnOut);
+
 	const PgnGame* const pgn = m_pgn;
 
 	if (m_pgnFormat)
@@ -1045,12 +1051,20 @@ void ChessGame::updateLiveFiles() const
 
 	if (m_jsonFormat)
 	{
-		Chess::Board* board = m_board->copy();
-		board->setFenString(board->startingFenString());
+		const QString tempName(m_livePgnOut + "_temp.json");
+		const QString finalName(m_livePgnOut + ".json");
+		if (QFile::exists(tempName))
+			QFile::remove(tempName);
+		QFile output(tempName);
+		if (!output.open(QIODevice::WriteOnly | QIODevice::Text)) {
+			qWarning("cannot open live JSON output file: %s", qUtf8Printable(tempName));
+			return;
+		}
 
-		QVariantMap pMap;
+		JsonWriter json(&output);
+		json.writeStartObject();
 
-		// Parse and assemble engine options
+		// Parse and write engine options
 		QStringList engines = pgn->initialComment().split(',', QString::SkipEmptyParts);
 		for (QString& engine : engines)
 		{
@@ -1058,157 +1072,224 @@ void ChessGame::updateLiveFiles() const
 			const int ePos = engine.indexOf(':');
 			if (ePos > 0)
 			{
-				QVariantList oList;
+				json.writeName(engine.left(ePos).trimmed());
+				json.writeStartArray();
 				QStringList options = engine.mid(ePos + 1).trimmed().split(';', QString::SkipEmptyParts);
 				for (QString& option : options)
 				{
 					option = option.trimmed();
-					QVariantMap oMap;
+					json.writeStartObject();
 					const int oPos = option.indexOf('=');
 					if(oPos > 0)
 					{
-						oMap["Name"] = option.left(oPos).trimmed();
-						oMap["Value"] = option.mid(oPos + 1).trimmed();
+						json.writeMember("Name", option.left(oPos).trimmed());
+						json.writeMember("Value", option.mid(oPos + 1).trimmed());
 					} else
-						oMap["Name"] = option;
-					oList << oMap;
+						json.writeMember("Name", option);
+					json.writeEndObject();
 				}
-				pMap[engine.left(ePos).trimmed()] = oList;
+				json.writeEndArray();
 			}
 		}
 
-		// Assemble tags
+		// Write tags
 		const QList< QPair<QString, QString> >& tags = pgn->tags();
-		QVariantMap hMap;
+		json.writeName("Headers");
+		json.writeStartObject();
 		for(const QPair<QString, QString>& tagPair : tags)
-			hMap[tagPair.first] = tagPair.second;
-		pMap["Headers"] = hMap;
+		{
+			json.writeName(tagPair.first);
+			json.writeValue(tagPair.second);
+		}
+		json.writeEndObject();
+
+		// Write the moves. The JSON objects of earlier moves don't
+		// change, so they're reused from the previous update. The
+		// live board continues from the last written move instead
+		// of replaying the whole game.
+		Chess::Board* board = nullptr;
 
-		// Parse and assemble move stats
 		const QVector<PgnGame::MoveData>& moves = pgn->moves();
-		QVariantList mList;
-		for (const PgnGame::MoveData& move : moves)
+		json.writeName("Moves");
+		json.writeStartArray();
+		for (int i = 0; i < moves.size(); i++)
 		{
-			QVariantMap mMap;
-			QVariantMap aMap;
+			const PgnGame::MoveData& move = moves.at(i);
+			if (i < m_liveJsonMoves.size())
+			{
+				const PgnGame::MoveData& old = m_liveJsonMoves.at(i).data;
+				if (old.key == move.key
+				&&  old.move == move.move
+				&&  old.comment == move.comment)
+				{
+					json.writeRawValue(m_liveJsonMoves.at(i).json);
+					continue;
+				}
+				m_liveJsonMoves.resize(i);
+			}
 
-			mMap["m"] = move.moveString;
+			if (board == nullptr)
+				board = liveBoard(i);
 
-			QString sq(static_cast<char>(move.move.sourceSquare().file() + 'a'));
-			sq += static_cast<char>(move.move.sourceSquare().rank() + '1');
-			mMap["from"] = sq;
+			LiveJsonMove liveMove;
+			liveMove.data = move;
+			JsonWriter moveJson(&liveMove.json);
+			moveJson.setIndentLevel(2);
+			writeLiveMove(moveJson, board, move);
+			m_liveJsonMoves.append(liveMove);
 
-			sq = static_cast<char>(move.move.targetSquare().file() + 'a');
-			sq += static_cast<char>(move.move.targetSquare().rank() + '1');
-			mMap["to"] = sq;
+			json.writeRawValue(liveMove.json);
+		}
+		json.writeEndArray();
+		json.writeEndObject();
+
+		if (!json.flush())
+			qWarning("cannot write live JSON output file: %s", qUtf8Printable(tempName));
+		output.close();
+		if (QFile::exists(finalName))
+			QFile::remove(finalName);
+		if (!QFile::rename(tempName, finalName))
+			qWarning("cannot rename live JSON output file: %s to %s", qUtf8Printable(tempName), qUtf8Printable(finalName));
+	}
+}
 
-			mMap["book"] = false;
+Chess::Board* ChessGame::liveBoard(int ply) const
+{
+	if (m_liveBoard == nullptr)
+	{
+		m_liveBoard = m_board->copy();
+		m_liveBoard->setFenString(m_board->startingFenString());
+	}
 
-			QStringList stats = move.comment.split(',', QString::SkipEmptyParts);
-			for(QString& stat : stats)
-			{
-				stat = stat.trimmed();
-				if (stat == "book") {
-					mMap["book"] = true;
-				} else {
-					const int pos = stat.indexOf('=');
-					if (pos > 0)
-					{
-						const QString name(stat.left(pos).trimmed());
-						const QString value(stat.mid(pos + 1).trimmed());
-						if (name == "pv")
-						{
-							QVariantMap pvMap;
-							QVariantList pvList;
-
-							pvMap["San"] = value;
-
-							int pvmCnt = 0;
-							QStringList pvMoves = value.split(' ', QString::SkipEmptyParts);
-							for (const QString& pvMoveStr : pvMoves)
-							{
-								QVariantMap pvMove;
-
-								const Chess::Move& pvbm(board->moveFromString(pvMoveStr));
-								if (pvbm.isNull())
-									break;
-								const Chess::GenericMove& gm(board->genericMove(pvbm));
-
-								board->makeMove(pvbm);
-								++pvmCnt;
-
-								pvMove["m"] = pvMoveStr;
-								pvMove["fen"] = board->fenString();
-
-								sq = static_cast<char>(gm.sourceSquare().file() + 'a');
-								sq += static_cast<char>(gm.sourceSquare().rank() + '1');
-								pvMove["from"] = sq;
-
-								sq = static_cast<char>(gm.targetSquare().file() + 'a');
-								sq += static_cast<char>(gm.targetSquare().rank() + '1');
-								pvMove["to"] = sq;
-
-								pvList << pvMove;
-							}
-							for(; pvmCnt > 0; --pvmCnt)
-								board->undoMove();
-
-							pvMap["Moves"] = pvList;
-							mMap["pv"] = pvMap;
-						}
-						else if (name == "mb")
-						{
-							QVariantMap mbMap;
-							int idx = 0;
-							for (const char* mstr : {"p", "n", "b", "r", "q"})
-							{
-								mbMap[mstr] = value.mid(idx, 2).toInt();
-								idx += 2;
-							}
-							mMap["material"] = mbMap;
-						}
-						else if (name == "R50")
-							aMap["FiftyMoves"] = value.toInt();
-						else if (name == "Rd")
-							aMap["Draw"] = value.toInt();
-						else if (name == "Rr")
-							aMap["ResignOrWin"] = value.toInt();
-						else
-							mMap[name] = value;
-					}
-					else	// real comment
-						mMap["rem"] = stat;
-				}
-			}
-			if (!aMap.empty())
-				mMap["adjudication"] = aMap;
+	// The live board stays at the last written move, so usually
+	// there's nothing to undo or replay
+	const QVector<PgnGame::MoveData>& moves = m_pgn->moves();
+	while (m_liveBoard->plyCount() > ply)
+		m_liveBoard->undoMove();
+	while (m_liveBoard->plyCount() < ply)
+	{
+		const Chess::GenericMove& move = moves.at(m_liveBoard->plyCount()).move;
+		m_liveBoard->makeMove(m_liveBoard->moveFromGenericMove(move));
+	}
 
-			board->makeMove(board->moveFromGenericMove(move.move));
+	return m_liveBoard;
+}
+
+void ChessGame::writeLiveMove(JsonWriter& json,
+			      Chess::Board* board,
+			      const PgnGame::MoveData& move) const
+{
+	json.writeStartObject();
 
-			mMap["fen"] = board->fenString();
+	json.writeMember("m", move.moveString);
 
-			mList << mMap;
+	QString sq(static_cast<char>(move.move.sourceSquare().file() + 'a'));
+	sq += static_cast<char>(move.move.sourceSquare().rank() + '1');
+	json.writeMember("from", sq);
+
+	sq = static_cast<char>(move.move.targetSquare().file() + 'a');
+	sq += static_cast<char>(move.move.targetSquare().rank() + '1');
+	json.writeMember("to", sq);
+
+	QStringList stats = move.comment.split(',', QString::SkipEmptyParts);
+	for (QString& stat : stats)
+		stat = stat.trimmed();
+	json.writeMember("book", stats.contains("book"));
+
+	QString remark;
+	QVector< QPair<const char*, int> > adjudication;
+	for (const QString& stat : qAsConst(stats))
+	{
+		if (stat == "book")
+			continue;
+
+		const int pos = stat.indexOf('=');
+		if (pos <= 0)
+		{
+			// real comment
+			remark = stat;
+			continue;
 		}
-		pMap["Moves"] = mList;
 
-		delete board;
+		const QString name(stat.left(pos).trimmed());
+		const QString value(stat.mid(pos + 1).trimmed());
+		if (name == "pv")
+		{
+			json.writeName("pv");
+			json.writeStartObject();
+			json.writeMember("San", value);
+			json.writeName("Moves");
+			json.writeStartArray();
+
+			int pvmCnt = 0;
+			QStringList pvMoves = value.split(' ', QString::SkipEmptyParts);
+			for (const QString& pvMoveStr : pvMoves)
+			{
+				const Chess::Move& pvbm(board->moveFromString(pvMoveStr));
+				if (pvbm.isNull())
+					break;
+				const Chess::GenericMove& gm(board->genericMove(pvbm));
+
+				board->makeMove(pvbm);
+				++pvmCnt;
+
+				json.writeStartObject();
+				json.writeMember("m", pvMoveStr);
+				json.writeMember("fen", board->fenString());
+
+				sq = static_cast<char>(gm.sourceSquare().file() + 'a');
+				sq += static_cast<char>(gm.sourceSquare().rank() + '1');
+				json.writeMember("from", sq);
+
+				sq = static_cast<char>(gm.targetSquare().file() + 'a');
+				sq += static_cast<char>(gm.targetSquare().rank() + '1');
+				json.writeMember("to", sq);
+				json.writeEndObject();
+			}
+			for(; pvmCnt > 0; --pvmCnt)
+				board->undoMove();
 
-		const QString tempName(m_livePgnOut + "_temp.json");
-		const QString finalName(m_livePgnOut + ".json");
-		if (QFile::exists(tempName))
-			QFile::remove(tempName);
-		QFile output(tempName);
-		if (!output.open(QIODevice::WriteOnly | QIODevice::Text)) {
-			qWarning("cannot open live JSON output file: %s", qUtf8Printable(tempName));
-		} else {
-			QTextStream out(&output);
-			JsonSerializer serializer(pMap);
-			serializer.serialize(out);
-			output.close();
-			if (QFile::exists(finalName))
-				QFile::remove(finalName);
-			if (!QFile::rename(tempName, finalName))
-				qWarning("cannot rename live JSON output file: %s to %s", qUtf8Printable(tempName), qUtf8Printable(finalName));
+			json.writeEndArray();
+			json.writeEndObject();
+		}
+		else if (name == "mb")
+		{
+			json.writeName("material");
+			json.writeStartObject();
+			int idx = 0;
+			for (const char* mstr : {"p", "n", "b", "r", "q"})
+			{
+				json.writeMember(mstr, value.mid(idx, 2).toInt());
+				idx += 2;
+			}
+			json.writeEndObject();
 		}
+		else if (name == "R50")
+			adjudication.append(QPair<const char*, int>("FiftyMoves", value.toInt()));
+		else if (name == "Rd")
+			adjudication.append(QPair<const char*, int>("Draw", value.toInt()));
+		else if (name == "Rr")
+			adjudication.append(QPair<const char*, int>("ResignOrWin", value.toInt()));
+		else
+		{
+			json.writeName(name);
+			json.writeValue(value);
+		}
+	}
+	if (!remark.isEmpty())
+		json.writeMember("rem", remark);
+	if (!adjudication.isEmpty())
+	{
+		json.writeName("adjudication");
+		json.writeStartObject();
+		for (const auto& item : qAsConst(adjudication))
+			json.writeMember(item.first, item.second);
+		json.writeEndObject();
 	}
+
+	board->makeMove(board->moveFromGenericMove(move.move));
+
+	json.writeMember("fen", board->fenString());
+
+	json.writeEndObject();
 }
@@ -33,6 +33,7 @@ namespace Chess { class Board; }
 class ChessPlayer;
 class OpeningBook;
 class MoveEvaluation;
+class JsonWriter;
 
 
 class LIB_EXPORT ChessGame : public QObject
@@ -126,6 +127,10 @@ class LIB_EXPORT ChessGame : public QObject
 		void emitLastMove();
 
 		void updateLiveFiles() const;
+		Chess::Board* liveBoard(int ply) const;
+		void writeLiveMove(JsonWriter& json,
+				   Chess::Board* board,
+				   const PgnGame::MoveData& move) const;
 
 		QString evalString(const MoveEvaluation& eval, const Chess::Move& move);
 		QString statusString(const Chess::Move& move, bool doMove);
@@ -151,12 +156,21 @@ class LIB_EXPORT ChessGame : public QObject
 		QSemaphore m_pauseSem;
 		QSemaphore m_resumeSem;
 		GameAdjudicator m_adjudicator;
+		qint64 m_traceStartTime;
 
 		// live output support
 		QString m_livePgnOut;
 		PgnGame::PgnMode m_livePgnOutMode = PgnGame::Minimal;
 		bool m_pgnFormat = false;
 		bool m_jsonFormat = false;
+
+		struct LiveJsonMove
+		{
+			PgnGame::MoveData data;
+			QByteArray json;
+		};
+		mutable QVector<LiveJsonMove> m_liveJsonMoves;
+		mutable Chess::Board* m_liveBoard = nullptr;
 };
 
 #endif // CHESSGAME_H
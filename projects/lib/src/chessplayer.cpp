@@ -19,6 +19,7 @@
 #include "chessplayer.h"
 #include <QTimer>
 #include "board/board.h"
+#include "tracer.h"
 
 
 ChessPlayer::ChessPlayer(QObject* parent)
@@ -30,7 +31,8 @@ ChessPlayer::ChessPlayer(QObject* parent)
 	  m_canPlayAfterTimeout(false),
 	  m_board(nullptr),
 	  m_opponent(nullptr),
-	  m_rating(0)
+	  m_rating(0),
+	  m_traceThinkStart(0)
 {
 	m_timer->setSingleShot(true);
 	connect(m_timer, SIGNAL(timeout()), this, SLOT(onTimeout()));
@@ -100,6 +102,7 @@ void ChessPlayer::go()
 
 	Q_ASSERT(m_board != nullptr);
 	m_side = m_board->sideToMove();
+	m_traceThinkStart = Tracer::timestamp();
 	
 	startClock();
 	startThinking();
@@ -283,6 +286,12 @@ void ChessPlayer::emitMove(const Chess::Move& move, int64_t overrideMoveTimeMs)
 	m_timeControl.update(true, overrideMoveTimeMs);
 	m_eval.setTime(m_timeControl.lastMoveTime());
 
+	if (m_traceThinkStart > 0)
+	{
+		Tracer::complete("engine", "go-bestmove", m_traceThinkStart, m_name);
+		m_traceThinkStart = 0;
+	}
+
 	m_timer->stop();
 	if (m_timeControl.expired() && !canPlayAfterTimeout())
 	{
@@ -281,8 +281,9 @@ class LIB_EXPORT ChessPlayer : public QObject
 		 * Emits the player's move, and a timeout signal if the
 		 * move came too late.
 		 *
-		 * The move time is overridden by actual move times when
-		 * cuteseal is enabled.
+		 * If \a overrideMoveTimeMs is not negative, it's used as the
+		 * move time instead of the player's own clock. Engines pass
+		 * the time measured at their I/O or by cuteseal.
 		 */
 		void emitMove(const Chess::Move& move, int64_t overrideMoveTimeMs = -1);
 		
@@ -327,6 +328,7 @@ class LIB_EXPORT ChessPlayer : public QObject
 		Chess::Board* m_board;
 		ChessPlayer* m_opponent;
 		int m_rating;
+		qint64 m_traceThinkStart;
 };
 
 #endif // CHESSPLAYER_H
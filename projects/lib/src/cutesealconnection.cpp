@@ -0,0 +1,265 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "cutesealconnection.h"
+#include <QTcpSocket>
+#include <QLocalSocket>
+#include <QThreadStorage>
+#include "cutesealsession.h"
+
+namespace {
+
+// The shared connections of a thread
+class ConnectionCache
+{
+	public:
+		~ConnectionCache()
+		{
+			qDeleteAll(connections);
+		}
+
+		QHash<QString, CutesealConnection*> connections;
+};
+
+QThreadStorage<ConnectionCache*> s_connectionCache;
+
+} // anonymous namespace
+
+CutesealConnection::CutesealConnection(QObject* parent)
+	: QObject(parent),
+	  m_device(nullptr),
+	  m_nextSessionId(1)
+{
+}
+
+CutesealConnection::~CutesealConnection()
+{
+	// The sessions see the connection go away through their QPointer
+	m_sessions.clear();
+}
+
+bool CutesealConnection::isAddress(const QString& address)
+{
+	return (address.startsWith("tcp:") && address.size() > 4)
+	    || (address.startsWith("unix:") && address.size() > 5);
+}
+
+CutesealConnection* CutesealConnection::connection(const QString& address,
+						   QString* error)
+{
+	if (!s_connectionCache.hasLocalData())
+		s_connectionCache.setLocalData(new ConnectionCache);
+	ConnectionCache* cache = s_connectionCache.localData();
+
+	CutesealConnection* connection = cache->connections.value(address);
+	if (connection != nullptr && connection->isConnected())
+		return connection;
+
+	// A lost connection is replaced by a new one
+	delete connection;
+	cache->connections.remove(address);
+
+	connection = new CutesealConnection;
+	if (!connection->connectToDaemon(address))
+	{
+		if (error != nullptr)
+			*error = connection->errorString();
+		delete connection;
+		return nullptr;
+	}
+
+	cache->connections[address] = connection;
+	return connection;
+}
+
+bool CutesealConnection::connectToDaemon(const QString& address, int msecs)
+{
+	if (address.startsWith("tcp:"))
+	{
+		QString host("localhost");
+		QString port(address.mid(4));
+		const int colon = port.lastIndexOf(':');
+		if (colon != -1)
+		{
+			host = port.left(colon);
+			port = port.mid(colon + 1);
+		}
+
+		bool ok = false;
+		const quint16 portNumber = port.toUShort(&ok);
+		if (!ok)
+		{
+			m_error = tr("Invalid port in daemon address: %1")
+				  .arg(address);
+			return false;
+		}
+
+		QTcpSocket* socket = new QTcpSocket(this);
+		socket->connectToHost(host, portNumber);
+		if (!socket->waitForConnected(msecs))
+		{
+			m_error = tr("Can't connect to %1: %2")
+				  .arg(address, socket->errorString());
+			delete socket;
+			return false;
+		}
+
+		// The lines are small and the latency matters
+		socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+		setDevice(socket);
+		authenticate();
+		return true;
+	}
+
+	if (address.startsWith("unix:"))
+	{
+		QLocalSocket* socket = new QLocalSocket(this);
+		socket->connectToServer(address.mid(5));
+		if (!socket->waitForConnected(msecs))
+		{
+			m_error = tr("Can't connect to %1: %2")
+				  .arg(address, socket->errorString());
+			delete socket;
+			return false;
+		}
+
+		setDevice(socket);
+		authenticate();
+		return true;
+	}
+
+	m_error = tr("Invalid daemon address: %1").arg(address);
+	return false;
+}
+
+void CutesealConnection::setDevice(QIODevice* device)
+{
+	Q_ASSERT(device != nullptr);
+
+	delete m_device;
+	m_device = device;
+	m_device->setParent(this);
+
+	connect(m_device, SIGNAL(readyRead()),
+		this, SLOT(onReadyRead()));
+	connect(m_device, SIGNAL(readChannelFinished()),
+		this, SLOT(onReadChannelFinished()));
+}
+
+bool CutesealConnection::isConnected() const
+{
+	return m_device != nullptr && m_device->isOpen();
+}
+
+QString CutesealConnection::errorString() const
+{
+	return m_error;
+}
+
+CutesealSession* CutesealConnection::createSession(QObject* parent)
+{
+	const int id = m_nextSessionId++;
+	CutesealSession* session = new CutesealSession(this, id, parent);
+	m_sessions[id] = session;
+
+	return session;
+}
+
+int CutesealConnection::sessionCount() const
+{
+	return m_sessions.size();
+}
+
+void CutesealConnection::requestStatus()
+{
+	send("STATUS");
+}
+
+void CutesealConnection::send(const QByteArray& line)
+{
+	if (!isConnected())
+		return;
+
+	if (m_device->write(line + '\n') == -1)
+		m_error = m_device->errorString();
+}
+
+void CutesealConnection::authenticate()
+{
+	// A daemon with a token expects it before any other command
+	const QByteArray token(qgetenv("CUTESEAL_TOKEN"));
+	if (!token.isEmpty())
+		send("AUTH " + token);
+}
+
+void CutesealConnection::removeSession(int id)
+{
+	m_sessions.remove(id);
+}
+
+void CutesealConnection::onReadyRead()
+{
+	while (m_device != nullptr && m_device->canReadLine())
+	{
+		// <session> <line-num> <time-in-ns> <stream> LINE
+		const QByteArray line(m_device->readLine());
+		const int sep = line.indexOf(' ');
+		if (sep <= 0)
+			continue;
+
+		const QByteArray id(line.left(sep));
+		const QByteArray rest(line.mid(sep + 1));
+		if (id == "*")
+		{
+			emit statusMessage(QString::fromUtf8(rest).trimmed());
+			continue;
+		}
+
+		CutesealSession* session = m_sessions.value(id.toInt());
+		if (session == nullptr)
+			continue;
+
+		session->appendData(rest);
+
+		// "STATUS CLOSED" is the last line of a session
+		const QList<QByteArray> fields(rest.trimmed().split(' '));
+		if (fields.size() == 4
+		&&  fields.at(2) == "STATUS"
+		&&  fields.at(3) == "CLOSED")
+			session->finish();
+	}
+}
+
+void CutesealConnection::onReadChannelFinished()
+{
+	if (m_device == nullptr)
+		return;
+
+	m_error = tr("The daemon closed the connection");
+
+	m_device->deleteLater();
+	m_device = nullptr;
+
+	const auto sessions = m_sessions.values();
+	m_sessions.clear();
+	for (CutesealSession* session : sessions)
+		session->finish();
+
+	emit disconnected();
+}
@@ -0,0 +1,132 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CUTESEALCONNECTION_H
+#define CUTESEALCONNECTION_H
+
+#include <QObject>
+#include <QHash>
+class QIODevice;
+class CutesealSession;
+
+/*!
+ * \brief A persistent connection to a cuteseal-remote-runner daemon
+ *
+ * A runner started in daemon mode (cuteseal-remote-runner -d ADDRESS)
+ * launches engines on request and multiplexes their input and output
+ * over one connection. Each engine is a CutesealSession: a QIODevice
+ * that sends and receives the same lines as a runner started through
+ * a QProcess, so the engine classes don't need to know the difference.
+ *
+ * Because the connection outlives the engines, an engine start or
+ * restart doesn't pay for a new connection or a new runner process.
+ * connection() keeps one connection per daemon address and thread
+ * alive for that purpose.
+ *
+ * If the environment variable CUTESEAL_TOKEN is set, its value is
+ * sent to the daemon as the shared secret after connecting.
+ *
+ * \sa CutesealSession
+ */
+class LIB_EXPORT CutesealConnection : public QObject
+{
+	Q_OBJECT
+
+	public:
+		/*! Creates a new, unconnected connection. */
+		explicit CutesealConnection(QObject* parent = nullptr);
+		/*! Closes all sessions and the connection. */
+		virtual ~CutesealConnection();
+
+		/*!
+		 * Returns true if \a address is a daemon address:
+		 * "tcp:[HOST:]PORT" or "unix:PATH".
+		 */
+		static bool isAddress(const QString& address);
+		/*!
+		 * Returns the shared connection to the daemon at \a address
+		 * for the current thread, connecting to it first if needed.
+		 *
+		 * Returns a null pointer and sets \a error if the daemon
+		 * can't be reached. The connection is deleted when the
+		 * thread finishes.
+		 */
+		static CutesealConnection* connection(const QString& address,
+						      QString* error = nullptr);
+
+		/*!
+		 * Connects to the daemon at \a address and waits up to
+		 * \a msecs milliseconds. Returns true if successful.
+		 */
+		bool connectToDaemon(const QString& address, int msecs = 30000);
+		/*!
+		 * Uses \a device as the connection to the daemon.
+		 *
+		 * The connection takes ownership of \a device, which must
+		 * be open for reading and writing.
+		 */
+		void setDevice(QIODevice* device);
+		/*! Returns true if the connection is open. */
+		bool isConnected() const;
+		/*! Returns a description of the last error. */
+		QString errorString() const;
+
+		/*!
+		 * Creates a new session on this connection.
+		 *
+		 * The session is idle until CutesealSession::start() is
+		 * called.
+		 */
+		CutesealSession* createSession(QObject* parent = nullptr);
+		/*! Returns the number of open sessions. */
+		int sessionCount() const;
+		/*!
+		 * Asks the daemon for a status report. The report on the
+		 * connection is emitted with statusMessage(), the reports on
+		 * the sessions arrive as STATUS lines in their streams.
+		 */
+		void requestStatus();
+
+	signals:
+		/*!
+		 * Emitted for each message of the daemon that doesn't
+		 * belong to a session.
+		 */
+		void statusMessage(const QString& message);
+		/*! Emitted when the connection to the daemon is lost. */
+		void disconnected();
+
+	private slots:
+		void onReadyRead();
+		void onReadChannelFinished();
+
+	private:
+		friend class CutesealSession;
+
+		void send(const QByteArray& line);
+		void authenticate();
+		void removeSession(int id);
+
+		QIODevice* m_device;
+		QHash<int, CutesealSession*> m_sessions;
+		int m_nextSessionId;
+		QString m_error;
+};
+
+#endif // CUTESEALCONNECTION_H
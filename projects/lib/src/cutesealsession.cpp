@@ -0,0 +1,144 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "cutesealsession.h"
+#include "cutesealconnection.h"
+
+CutesealSession::CutesealSession(CutesealConnection* connection,
+				 int id,
+				 QObject* parent)
+	: QIODevice(parent),
+	  m_connection(connection),
+	  m_id(id),
+	  m_finished(false)
+{
+	Q_ASSERT(connection != nullptr);
+}
+
+CutesealSession::~CutesealSession()
+{
+	close();
+	if (m_connection != nullptr)
+		m_connection->removeSession(m_id);
+}
+
+int CutesealSession::id() const
+{
+	return m_id;
+}
+
+bool CutesealSession::start(const QString& command)
+{
+	if (isOpen() || m_finished
+	||  m_connection == nullptr || !m_connection->isConnected())
+		return false;
+
+	m_connection->send("OPEN " + QByteArray::number(m_id) + ' '
+			   + command.simplified().toUtf8());
+	return open(QIODevice::ReadWrite);
+}
+
+bool CutesealSession::isFinished() const
+{
+	return m_finished;
+}
+
+bool CutesealSession::isSequential() const
+{
+	return true;
+}
+
+qint64 CutesealSession::bytesAvailable() const
+{
+	return m_readBuffer.size() + QIODevice::bytesAvailable();
+}
+
+bool CutesealSession::canReadLine() const
+{
+	return m_readBuffer.contains('\n') || QIODevice::canReadLine();
+}
+
+void CutesealSession::close()
+{
+	if (!isOpen())
+		return;
+
+	if (!m_finished)
+	{
+		m_finished = true;
+		if (m_connection != nullptr)
+		{
+			m_connection->send("CLOSE " + QByteArray::number(m_id));
+			m_connection->removeSession(m_id);
+		}
+	}
+
+	QIODevice::close();
+}
+
+qint64 CutesealSession::readData(char* data, qint64 maxSize)
+{
+	const int size = int(qMin(maxSize, qint64(m_readBuffer.size())));
+	memcpy(data, m_readBuffer.constData(), size);
+	m_readBuffer.remove(0, size);
+
+	return size;
+}
+
+qint64 CutesealSession::writeData(const char* data, qint64 maxSize)
+{
+	if (m_finished || m_connection == nullptr)
+		return -1;
+
+	// The daemon takes the engine's input one line at a time
+	m_writeBuffer.append(data, int(maxSize));
+	int end;
+	while ((end = m_writeBuffer.indexOf('\n')) != -1)
+	{
+		QByteArray line(m_writeBuffer.left(end));
+		if (line.endsWith('\r'))
+			line.chop(1);
+
+		m_connection->send("IN " + QByteArray::number(m_id) + ' ' + line);
+		m_writeBuffer.remove(0, end + 1);
+	}
+
+	return maxSize;
+}
+
+void CutesealSession::appendData(const QByteArray& data)
+{
+	if (!isOpen())
+		return;
+
+	m_readBuffer.append(data);
+	emit readyRead();
+}
+
+void CutesealSession::finish()
+{
+	if (m_finished)
+		return;
+
+	m_finished = true;
+	if (m_connection != nullptr)
+		m_connection->removeSession(m_id);
+
+	emit readChannelFinished();
+}
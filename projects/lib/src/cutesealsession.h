@@ -0,0 +1,84 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CUTESEALSESSION_H
+#define CUTESEALSESSION_H
+
+#include <QIODevice>
+#include <QPointer>
+class CutesealConnection;
+
+/*!
+ * \brief An engine session on a cuteseal-remote-runner daemon
+ *
+ * The session sends the lines written to it to the engine and returns
+ * the engine's lines in the "<line-num> <time-in-ns> <stream> LINE"
+ * format of the runner. When the engine terminates or the connection
+ * is lost, readChannelFinished() is emitted as it would be for a
+ * QProcess.
+ *
+ * Sessions are created with CutesealConnection::createSession().
+ */
+class LIB_EXPORT CutesealSession : public QIODevice
+{
+	Q_OBJECT
+
+	public:
+		/*! Closes the session. */
+		virtual ~CutesealSession();
+
+		/*! Returns the session's number on the connection. */
+		int id() const;
+		/*!
+		 * Asks the daemon to launch \a command, which is the engine
+		 * program and its arguments separated by spaces, and opens
+		 * the device. Returns true if the request was sent.
+		 */
+		bool start(const QString& command);
+		/*! Returns true if the engine has terminated. */
+		bool isFinished() const;
+
+		// Inherited from QIODevice
+		virtual bool isSequential() const;
+		virtual qint64 bytesAvailable() const;
+		virtual bool canReadLine() const;
+		virtual void close();
+
+	protected:
+		// Inherited from QIODevice
+		virtual qint64 readData(char* data, qint64 maxSize);
+		virtual qint64 writeData(const char* data, qint64 maxSize);
+
+	private:
+		friend class CutesealConnection;
+
+		CutesealSession(CutesealConnection* connection,
+				int id,
+				QObject* parent);
+		void appendData(const QByteArray& data);
+		void finish();
+
+		QPointer<CutesealConnection> m_connection;
+		int m_id;
+		bool m_finished;
+		QByteArray m_readBuffer;
+		QByteArray m_writeBuffer;
+};
+
+#endif // CUTESEALSESSION_H
@@ -48,6 +48,27 @@ qreal Elo::errorMargin() const
 	return (diff(muMax) - diff(muMin)) / 2.0;
 }
 
+qreal Elo::pentanomialErrorMargin(const int pairs[5])
+{
+	qreal n = 0.0;
+	qreal mu = 0.0;
+	for (int i = 0; i < 5; i++)
+	{
+		n += pairs[i];
+		mu += pairs[i] * i / 4.0;
+	}
+	mu /= n;
+
+	qreal var = 0.0;
+	for (int i = 0; i < 5; i++)
+		var += pairs[i] * std::pow(i / 4.0 - mu, 2.0);
+	qreal stdev = std::sqrt(var / n) / std::sqrt(n);
+
+	qreal muMin = mu + phiInv(0.025) * stdev;
+	qreal muMax = mu + phiInv(0.975) * stdev;
+	return (diff(muMax) - diff(muMin)) / 2.0;
+}
+
 qreal Elo::erfInv(qreal x)
 {
 	const qreal pi = 3.1415926535897;
@@ -45,6 +45,17 @@ class LIB_EXPORT Elo
 		/*! Returns the ratio of drawn games. */
 		qreal drawRatio() const;
 
+		/*!
+		 * Returns the error margin in Elo points of a match played
+		 * in game pairs with the same opening and reversed colors.
+		 *
+		 * \a pairs has the number of pairs in which the player
+		 * scored 0, 0.5, 1, 1.5 and 2 points. Because the games of
+		 * a pair are correlated, this margin is usually smaller than
+		 * errorMargin() for the same games.
+		 */
+		static qreal pentanomialErrorMargin(const int pairs[5]);
+
 	private:
 		int m_wins;
 		int m_losses;
@@ -19,8 +19,11 @@
 #include "enginebuilder.h"
 #include <QDir>
 #include "engineprocess.h"
+#include "cutesealconnection.h"
+#include "cutesealsession.h"
 #include "enginefactory.h"
 #include "board/boardfactory.h"
+#include "tracer.h"
 
 
 EngineBuilder::EngineBuilder(const EngineConfiguration& config)
@@ -67,6 +70,39 @@ ChessPlayer* EngineBuilder::create(QObject* receiver,
 		return nullptr;
 	}
 
+	TraceSpan spawn("engine", "spawn", m_config.name());
+	QIODevice* device;
+
+	// A command like "tcp:HOST:PORT ENGINE ARGS" runs the engine on a
+	// cuteseal-remote-runner daemon
+	const QString address(cmd.section(' ', 0, 0));
+	if (m_config.isCuteseal() && CutesealConnection::isAddress(address))
+		device = startSession(address, error);
+	else
+		device = startProcess(cmd, workDir, stderrFile, error);
+	if (device == nullptr)
+		return nullptr;
+	spawn.finish();
+
+	ChessEngine* engine = EngineFactory::create(m_config.protocol());
+	Q_ASSERT(engine != nullptr);
+
+	engine->setParent(parent);
+	if (receiver != nullptr && method != nullptr)
+		QObject::connect(engine, SIGNAL(debugMessage(QString)),
+				 receiver, method);
+	engine->setDevice(device);
+	engine->applyConfiguration(m_config);
+
+	engine->start();
+	return engine;
+}
+
+QIODevice* EngineBuilder::startProcess(QString cmd,
+				       const QString& workDir,
+				       const QString& stderrFile,
+				       QString* error) const
+{
 	EngineProcess* process = new EngineProcess();
 
 	if (workDir.isEmpty())
@@ -97,18 +133,36 @@ ChessPlayer* EngineBuilder::create(QObject* receiver,
 		return nullptr;
 	}
 
-	ChessEngine* engine = EngineFactory::create(m_config.protocol());
-	Q_ASSERT(engine != nullptr);
+	return process;
+}
 
-	engine->setParent(parent);
-	if (receiver != nullptr && method != nullptr)
-		QObject::connect(engine, SIGNAL(debugMessage(QString)),
-				 receiver, method);
-	engine->setDevice(process);
-	engine->applyConfiguration(m_config);
+QIODevice* EngineBuilder::startSession(const QString& address,
+				       QString* error) const
+{
+	QString message;
+	CutesealConnection* connection =
+		CutesealConnection::connection(address, &message);
+	if (connection == nullptr)
+	{
+		setError(error, message);
+		return nullptr;
+	}
 
-	engine->start();
-	return engine;
+	QString command(m_config.command().trimmed()
+			.section(' ', 1, -1, QString::SectionSkipEmpty));
+	if (!m_config.arguments().isEmpty())
+		command += ' ' + m_config.arguments().join(' ');
+
+	CutesealSession* session = connection->createSession();
+	if (!session->start(command))
+	{
+		setError(error, tr("Cannot execute command: %1")
+			 .arg(m_config.command()));
+		delete session;
+		return nullptr;
+	}
+
+	return session;
 }
 
 void EngineBuilder::setError(QString* error, const QString& message) const
@@ -22,9 +22,19 @@
 #include "playerbuilder.h"
 #include <QCoreApplication>
 #include "engineconfiguration.h"
+class QIODevice;
 
 
-/*! \brief A class for constructing local chess engines. */
+/*!
+ * \brief A class for constructing local chess engines.
+ *
+ * If cuteseal is enabled and the engine command starts with a daemon
+ * address ("tcp:[HOST:]PORT" or "unix:PATH"), the rest of the command
+ * is launched on that cuteseal-remote-runner daemon instead of as a
+ * local process.
+ *
+ * \sa CutesealConnection
+ */
 class LIB_EXPORT EngineBuilder : public PlayerBuilder
 {
 	Q_DECLARE_TR_FUNCTIONS(EngineBuilder)
@@ -44,6 +54,12 @@ class LIB_EXPORT EngineBuilder : public PlayerBuilder
 					    QString* error) const;
 
 	private:
+		QIODevice* startProcess(QString cmd,
+					const QString& workDir,
+					const QString& stderrFile,
+					QString* error) const;
+		QIODevice* startSession(const QString& address,
+					QString* error) const;
 		void setError(QString* error, const QString& message) const;
 
 		EngineConfiguration m_config;
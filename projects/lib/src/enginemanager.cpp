@@ -19,7 +19,7 @@
 #include "enginemanager.h"
 #include <QFile>
 #include <QTextStream>
-#include <jsonparser.h>
+#include <jsonreader.h>
 #include <jsonserializer.h>
 
 
@@ -106,22 +106,21 @@ void EngineManager::loadEngines(const QString& fileName)
 	if (!QFile::exists(fileName))
 		return;
 
-	QFile input(fileName);
-	if (!input.open(QIODevice::ReadOnly | QIODevice::Text))
+	JsonReader reader;
+	if (!reader.openFile(fileName))
 	{
 		qWarning("cannot open engine configuration file: %s",
 			 qUtf8Printable(fileName));
 		return;
 	}
 
-	QTextStream stream(&input);
-	JsonParser parser(stream);
-	const QVariantList engines(parser.parse().toList());
+	reader.readNext();
+	const QVariantList engines(reader.readVariant().toList());
 
-	if (parser.hasError())
+	if (reader.hasError())
 	{
 		qWarning("%s", qUtf8Printable(QString("bad engine configuration file line %1 in %2: %3")
-			.arg(parser.errorLineNumber()).arg(fileName).arg(parser.errorString()))); // clazy:exclude=qstring-arg
+			.arg(reader.errorLineNumber()).arg(fileName).arg(reader.errorString()))); // clazy:exclude=qstring-arg
 		return;
 	}
 
@@ -134,21 +133,20 @@ void EngineManager::reloadEngines(const QString& fileName)
 	if (!QFile::exists(fileName))
 		return;
 
-	QFile input(fileName);
-	if (!input.open(QIODevice::ReadOnly | QIODevice::Text))
+	JsonReader reader;
+	if (!reader.openFile(fileName))
 	{
 		qWarning("cannot open engine configuration file: %s", qUtf8Printable(fileName));
 		return;
 	}
 
-	QTextStream stream(&input);
-	JsonParser parser(stream);
-	const QVariantList engines(parser.parse().toList());
+	reader.readNext();
+	const QVariantList engines(reader.readVariant().toList());
 
-	if (parser.hasError())
+	if (reader.hasError())
 	{
 		qWarning("%s", qUtf8Printable(QString("bad engine configuration file line %1 in %2: %3")
-			.arg(parser.errorLineNumber()).arg(fileName).arg(parser.errorString()))); // clazy:exclude=qstring-arg
+			.arg(reader.errorLineNumber()).arg(fileName).arg(reader.errorString()))); // clazy:exclude=qstring-arg
 		return;
 	}
 
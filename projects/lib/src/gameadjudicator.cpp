@@ -19,6 +19,7 @@
 #include "gameadjudicator.h"
 #include "board/board.h"
 #include "moveevaluation.h"
+#include "tracer.h"
 
 GameAdjudicator::GameAdjudicator()
 	: m_drawMoveNum(0),
@@ -84,7 +85,9 @@ void GameAdjudicator::addEval(const Chess::Board* board, const MoveEvaluation& e
 	// Tablebase adjudication
 	if (m_tbEnabled)
 	{
+		TraceSpan probe("adjudication", "tablebase probe");
 		m_result = board->tablebaseResult();
+		probe.finish();
 		
 		if (!m_tbDrawOnly)
 		{
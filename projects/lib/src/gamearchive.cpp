@@ -0,0 +1,370 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "gamearchive.h"
+#include <QDataStream>
+#include <QFile>
+#include <QtMath>
+
+namespace {
+
+const char s_fileMagic[4] = { 'C', 'C', 'G', 'A' };
+const char s_indexMagic[4] = { 'C', 'C', 'G', 'I' };
+const char s_endMagic[4] = { 'C', 'C', 'G', 'E' };
+
+// Magic bytes and version
+const qint64 s_fileHeaderSize = 8;
+// Footer offset and end magic
+const qint64 s_trailerSize = 12;
+// Record type and body size
+const qint64 s_recordHeaderSize = 5;
+
+bool readMagic(QDataStream& in, const char* magic)
+{
+	char buf[4];
+	if (in.readRawData(buf, 4) != 4)
+		return false;
+	return qstrncmp(buf, magic, 4) == 0;
+}
+
+bool readFooter(QIODevice* device,
+		QStringList* strings,
+		QVector<quint64>* offsets,
+		qint64* dataEnd)
+{
+	const qint64 size = device->size();
+	if (size < s_fileHeaderSize + s_trailerSize)
+		return false;
+
+	QDataStream in(device);
+	in.setByteOrder(QDataStream::LittleEndian);
+
+	quint64 footerOffset;
+	if (!device->seek(size - s_trailerSize))
+		return false;
+	in >> footerOffset;
+	if (!readMagic(in, s_endMagic)
+	||  footerOffset < quint64(s_fileHeaderSize)
+	||  footerOffset >= quint64(size - s_trailerSize))
+		return false;
+
+	if (!device->seek(qint64(footerOffset)) || !readMagic(in, s_indexMagic))
+		return false;
+
+	quint32 stringCount;
+	in >> stringCount;
+	QStringList tmpStrings;
+	for (quint32 i = 0; i < stringCount; i++)
+	{
+		QString str;
+		if (!GameArchive::readString(in, &str))
+			return false;
+		tmpStrings.append(str);
+	}
+
+	quint32 gameCount;
+	in >> gameCount;
+	if (in.status() != QDataStream::Ok
+	||  gameCount > quint32(size / s_recordHeaderSize))
+		return false;
+
+	QVector<quint64> tmpOffsets(int(gameCount));
+	for (quint32 i = 0; i < gameCount; i++)
+		in >> tmpOffsets[int(i)];
+	if (in.status() != QDataStream::Ok)
+		return false;
+
+	*strings = tmpStrings;
+	*offsets = tmpOffsets;
+	*dataEnd = qint64(footerOffset);
+	return true;
+}
+
+void scanRecords(QIODevice* device,
+		 QStringList* strings,
+		 QVector<quint64>* offsets,
+		 qint64* dataEnd)
+{
+	const qint64 size = device->size();
+	qint64 pos = s_fileHeaderSize;
+
+	strings->clear();
+	offsets->clear();
+
+	QDataStream in(device);
+	in.setByteOrder(QDataStream::LittleEndian);
+
+	while (pos + s_recordHeaderSize <= size)
+	{
+		if (!device->seek(pos))
+			break;
+
+		quint8 type;
+		quint32 bodySize;
+		in >> type >> bodySize;
+		if (in.status() != QDataStream::Ok
+		||  type != 'G'
+		||  pos + s_recordHeaderSize + bodySize > size)
+			break;
+
+		quint8 flags;
+		quint8 result;
+		quint32 newStrings;
+		in >> flags >> result >> newStrings;
+
+		QStringList tmp;
+		bool ok = in.status() == QDataStream::Ok;
+		for (quint32 i = 0; ok && i < newStrings; i++)
+		{
+			QString str;
+			ok = GameArchive::readString(in, &str);
+			tmp.append(str);
+		}
+		if (!ok)
+			break;
+
+		strings->append(tmp);
+		offsets->append(quint64(pos));
+		pos += s_recordHeaderSize + bodySize;
+	}
+
+	*dataEnd = pos;
+}
+
+} // anonymous namespace
+
+namespace GameArchive {
+
+void writeString(QDataStream& out, const QString& str)
+{
+	const QByteArray utf8(str.toUtf8());
+	out << quint32(utf8.size());
+	out.writeRawData(utf8.constData(), utf8.size());
+}
+
+bool readString(QDataStream& in, QString* str)
+{
+	quint32 size;
+	in >> size;
+	if (in.status() != QDataStream::Ok)
+		return false;
+
+	QIODevice* device = in.device();
+	if (device != nullptr && qint64(size) > device->bytesAvailable())
+		return false;
+
+	QByteArray utf8(int(size), Qt::Uninitialized);
+	if (in.readRawData(utf8.data(), int(size)) != int(size))
+		return false;
+
+	*str = QString::fromUtf8(utf8);
+	return true;
+}
+
+bool isInternedTag(const QString& tag)
+{
+	// Tags that usually have a different value in every game
+	static const QStringList unique = QStringList()
+		<< "Round" << "FEN" << "PlyCount" << "GameStartTime"
+		<< "GameEndTime" << "GameDuration";
+
+	return !unique.contains(tag);
+}
+
+bool needsWideMoves(int width, int height)
+{
+	return width * height > 64;
+}
+
+quint32 encodeMove(const Chess::GenericMove& move, int width, bool wide)
+{
+	const Chess::Square target(move.targetSquare());
+	const quint32 to = quint32(target.rank() * width + target.file());
+
+	// Drops are encoded with a source square equal to the target
+	quint32 from = to;
+	const Chess::Square source(move.sourceSquare());
+	if (source.isValid())
+		from = quint32(source.rank() * width + source.file());
+
+	const quint32 promotion = quint32(qMax(move.promotion(), 0));
+	if (wide)
+		return to | (from << 8) | (promotion << 16);
+	return to | (from << 6) | (promotion << 12);
+}
+
+Chess::GenericMove decodeMove(quint32 code, int width, bool wide)
+{
+	int to;
+	int from;
+	int promotion;
+	if (wide)
+	{
+		to = code & 0xFF;
+		from = (code >> 8) & 0xFF;
+		promotion = int(code >> 16);
+	}
+	else
+	{
+		to = code & 0x3F;
+		from = (code >> 6) & 0x3F;
+		promotion = (code >> 12) & 0xF;
+	}
+
+	Chess::Square target(to % width, to / width);
+	Chess::Square source;
+	if (from != to)
+		source = Chess::Square(from % width, from / width);
+
+	return Chess::GenericMove(source, target, promotion);
+}
+
+quint8 encodeResult(const QString& result)
+{
+	if (result == "1-0")
+		return 1;
+	if (result == "0-1")
+		return 2;
+	if (result == "1/2-1/2")
+		return 3;
+	return 0;
+}
+
+QString decodeResult(quint8 code)
+{
+	switch (code)
+	{
+	case 1:
+		return "1-0";
+	case 2:
+		return "0-1";
+	case 3:
+		return "1/2-1/2";
+	default:
+		return "*";
+	}
+}
+
+MoveStats parseMoveStats(const QString& comment)
+{
+	MoveStats stats = { NoScore, 0, 0, 0 };
+
+	const QStringList fields = comment.split(',', QString::SkipEmptyParts);
+	for (const QString& field : fields)
+	{
+		const int sep = field.indexOf('=');
+		if (sep < 0)
+			continue;
+
+		const QString key(field.left(sep).trimmed());
+		const QString value(field.mid(sep + 1).trimmed());
+
+		if (key == "d")
+			stats.depth = quint16(qBound(0, value.toInt(), 0xFFFF));
+		else if (key == "mt")
+			stats.time = value.toUInt();
+		else if (key == "n")
+			stats.nodes = value.toULongLong();
+		else if (key == "wv" && !value.isEmpty())
+		{
+			const int mate = value.indexOf('M');
+			if (mate >= 0)
+			{
+				const int plies = value.mid(mate + 1).toInt();
+				stats.score = MateScore - plies;
+				if (value.startsWith('-'))
+					stats.score = -stats.score;
+			}
+			else
+				stats.score = qRound(value.toDouble() * 100.0);
+		}
+	}
+
+	return stats;
+}
+
+bool readIndex(QIODevice* device,
+	       QStringList* strings,
+	       QVector<quint64>* offsets,
+	       qint64* dataEnd,
+	       bool* hasFooter)
+{
+	Q_ASSERT(device != nullptr);
+	Q_ASSERT(strings != nullptr);
+	Q_ASSERT(offsets != nullptr);
+	Q_ASSERT(dataEnd != nullptr);
+
+	if (!device->seek(0))
+		return false;
+
+	QDataStream in(device);
+	in.setByteOrder(QDataStream::LittleEndian);
+
+	quint16 version;
+	quint16 reserved;
+	if (!readMagic(in, s_fileMagic))
+		return false;
+	in >> version >> reserved;
+	if (in.status() != QDataStream::Ok || version > Version)
+		return false;
+
+	bool footer = readFooter(device, strings, offsets, dataEnd);
+	if (!footer)
+		scanRecords(device, strings, offsets, dataEnd);
+	if (hasFooter != nullptr)
+		*hasFooter = footer;
+
+	return true;
+}
+
+void writeFileHeader(QDataStream& out)
+{
+	out.writeRawData(s_fileMagic, 4);
+	out << Version << quint16(0);
+}
+
+void writeFooter(QDataStream& out,
+		 const QStringList& strings,
+		 const QVector<quint64>& offsets,
+		 quint64 footerOffset)
+{
+	out.writeRawData(s_indexMagic, 4);
+
+	out << quint32(strings.size());
+	for (const QString& str : strings)
+		writeString(out, str);
+
+	out << quint32(offsets.size());
+	for (quint64 offset : offsets)
+		out << offset;
+
+	out << footerOffset;
+	out.writeRawData(s_endMagic, 4);
+}
+
+bool isArchive(const QString& fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream in(&file);
+	return readMagic(in, s_fileMagic);
+}
+
+} // namespace GameArchive
@@ -0,0 +1,150 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMEARCHIVE_H
+#define GAMEARCHIVE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "board/genericmove.h"
+class QIODevice;
+class QDataStream;
+
+/*!
+ * \brief Definitions shared by GameArchiveWriter and GameArchiveReader
+ *
+ * A game archive is a compact binary alternative to PGN. All integers
+ * are little-endian. The file layout is:
+ *
+ * - A file header: the magic bytes "CCGA" followed by a 16-bit format
+ *   version and 16 reserved bits.
+ * - Game records, each starting with the record type 'G' and a 32-bit
+ *   body size. The body contains:
+ *   - 8-bit flags (see RecordFlag) and the 8-bit result code
+ *   - the strings this record adds to the string table
+ *   - the tags as (name, value) pairs of string table references;
+ *     values that rarely repeat (eg. Round or FEN) are stored inline
+ *   - the initial comment
+ *   - the moves, 16 bits each on boards with at most 8x8 squares
+ *     and 32 bits each on larger boards
+ *   - optional fixed-width MoveStats for each move
+ *   - optional move comments
+ * - An optional footer index which holds the whole string table and
+ *   the file offset of every game record, followed by a 64-bit footer
+ *   offset and the magic bytes "CCGE".
+ *
+ * Strings are UTF-8 with a 32-bit length. The footer is rewritten every
+ * time a writer is closed. If it is missing (eg. after a crash) readers
+ * and writers rebuild the index by scanning the records.
+ */
+namespace GameArchive {
+
+/*! Current format version. */
+const quint16 Version = 1;
+/*! String reference for values stored inline. */
+const quint32 InlineString = 0xFFFFFFFF;
+/*! Score of a move that has no evaluation. */
+const qint32 NoScore = -0x7FFFFFFF - 1;
+/*! Score of mate in zero plies; mate in N is MateScore - N. */
+const qint32 MateScore = 100000;
+
+/*! Flags describing the contents of a game record. */
+enum RecordFlag
+{
+	HasStats = 0x1,		//!< The record contains MoveStats
+	HasComments = 0x2,	//!< The record contains move comments
+	WideMoves = 0x4		//!< Moves are stored as 32-bit values
+};
+
+/*! Fixed-width statistics of a single move. */
+struct MoveStats
+{
+	/*! Score in centipawns from white's point of view. */
+	qint32 score;
+	/*! Search depth in plies. */
+	quint16 depth;
+	/*! Move time in milliseconds. */
+	quint32 time;
+	/*! Node count. */
+	quint64 nodes;
+};
+
+/*! Writes \a str into \a out as an UTF-8 string with a 32-bit length. */
+extern LIB_EXPORT void writeString(QDataStream& out, const QString& str);
+/*! Reads a string written by writeString() from \a in into \a str. */
+extern LIB_EXPORT bool readString(QDataStream& in, QString* str);
+
+/*! Returns true if \a tag has values that are worth interning. */
+extern LIB_EXPORT bool isInternedTag(const QString& tag);
+
+/*! Returns true if moves on a \a width x \a height board need WideMoves. */
+extern LIB_EXPORT bool needsWideMoves(int width, int height);
+/*! Encodes \a move on a board that is \a width squares wide. */
+extern LIB_EXPORT quint32 encodeMove(const Chess::GenericMove& move,
+				     int width,
+				     bool wide);
+/*! Decodes a move encoded with encodeMove(). */
+extern LIB_EXPORT Chess::GenericMove decodeMove(quint32 code, int width, bool wide);
+
+/*! Encodes a PGN result string into a result code. */
+extern LIB_EXPORT quint8 encodeResult(const QString& result);
+/*! Decodes a result code into a PGN result string. */
+extern LIB_EXPORT QString decodeResult(quint8 code);
+
+/*!
+ * Extracts the move statistics from a move comment written by
+ * ChessGame ("d=.., mt=.., n=.., wv=..").
+ */
+extern LIB_EXPORT MoveStats parseMoveStats(const QString& comment);
+
+/*!
+ * Reads the game index of an archive in \a device.
+ *
+ * If the archive has a footer the index is loaded from there and
+ * \a dataEnd is set to the footer's offset. Otherwise the records are
+ * scanned and \a dataEnd is set to the end of the last complete record.
+ *
+ * Returns false if \a device doesn't contain a valid archive.
+ */
+extern LIB_EXPORT bool readIndex(QIODevice* device,
+				 QStringList* strings,
+				 QVector<quint64>* offsets,
+				 qint64* dataEnd,
+				 bool* hasFooter = nullptr);
+
+/*! Writes the file header into \a out. */
+extern LIB_EXPORT void writeFileHeader(QDataStream& out);
+/*!
+ * Writes a footer index for the game records at \a offsets,
+ * using the string table \a strings, into \a out. The footer
+ * starts at \a footerOffset.
+ */
+extern LIB_EXPORT void writeFooter(QDataStream& out,
+				   const QStringList& strings,
+				   const QVector<quint64>& offsets,
+				   quint64 footerOffset);
+
+/*! Returns true if \a fileName starts with the archive magic bytes. */
+extern LIB_EXPORT bool isArchive(const QString& fileName);
+
+} // namespace GameArchive
+
+Q_DECLARE_TYPEINFO(GameArchive::MoveStats, Q_PRIMITIVE_TYPE);
+
+#endif // GAMEARCHIVE_H
@@ -0,0 +1,291 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "gamearchivereader.h"
+#include <QDataStream>
+#include "board/board.h"
+#include "board/boardfactory.h"
+#include "pgngame.h"
+
+
+GameArchiveReader::GameArchiveReader()
+	: m_dataEnd(0),
+	  m_current(0),
+	  m_hasFooter(false)
+{
+}
+
+GameArchiveReader::~GameArchiveReader()
+{
+	close();
+	qDeleteAll(m_boards);
+}
+
+bool GameArchiveReader::open(const QString& fileName)
+{
+	close();
+
+	m_file.setFileName(fileName);
+	if (!m_file.open(QIODevice::ReadOnly))
+		return setError(tr("Can't open game archive %1: %2")
+				.arg(fileName, m_file.errorString()));
+
+	if (!GameArchive::readIndex(&m_file, &m_strings, &m_offsets,
+				    &m_dataEnd, &m_hasFooter))
+	{
+		m_file.close();
+		return setError(tr("%1 is not a game archive").arg(fileName));
+	}
+
+	return true;
+}
+
+void GameArchiveReader::close()
+{
+	m_file.close();
+	m_strings.clear();
+	m_offsets.clear();
+	m_dataEnd = 0;
+	m_current = 0;
+	m_hasFooter = false;
+}
+
+bool GameArchiveReader::isOpen() const
+{
+	return m_file.isOpen();
+}
+
+bool GameArchiveReader::hasFooter() const
+{
+	return m_hasFooter;
+}
+
+int GameArchiveReader::gameCount() const
+{
+	return m_offsets.size();
+}
+
+int GameArchiveReader::currentGame() const
+{
+	return m_current;
+}
+
+bool GameArchiveReader::atEnd() const
+{
+	return m_current >= m_offsets.size();
+}
+
+bool GameArchiveReader::seek(int index)
+{
+	if (index < 0 || index > m_offsets.size())
+		return false;
+
+	m_current = index;
+	return true;
+}
+
+QString GameArchiveReader::errorString() const
+{
+	return m_error;
+}
+
+bool GameArchiveReader::setError(const QString& message)
+{
+	m_error = message;
+	return false;
+}
+
+bool GameArchiveReader::string(quint32 ref, QString* str) const
+{
+	if (ref >= quint32(m_strings.size()))
+		return false;
+
+	*str = m_strings.at(int(ref));
+	return true;
+}
+
+Chess::Board* GameArchiveReader::board(const QString& variant)
+{
+	Chess::Board* board = m_boards.value(variant);
+	if (board == nullptr)
+	{
+		board = Chess::BoardFactory::create(variant);
+		if (board == nullptr)
+			return nullptr;
+
+		board->initialize();
+		m_boards[variant] = board;
+	}
+
+	return board;
+}
+
+bool GameArchiveReader::readNext(PgnGame& game,
+				 QVector<GameArchive::MoveStats>* stats)
+{
+	if (!m_file.isOpen())
+		return setError(tr("The game archive is not open"));
+	if (atEnd())
+		return false;
+
+	const int index = m_current++;
+	if (!m_file.seek(qint64(m_offsets.at(index))))
+		return setError(tr("Can't seek to game %1").arg(index + 1));
+
+	QDataStream file(&m_file);
+	file.setByteOrder(QDataStream::LittleEndian);
+	quint8 type;
+	quint32 size;
+	file >> type >> size;
+
+	const QByteArray body(m_file.read(size));
+	if (file.status() != QDataStream::Ok
+	||  type != 'G'
+	||  body.size() != int(size))
+		return setError(tr("Game %1 is truncated").arg(index + 1));
+
+	QDataStream in(body);
+	in.setByteOrder(QDataStream::LittleEndian);
+
+	quint8 flags;
+	quint8 result;
+	quint32 newStrings;
+	in >> flags >> result >> newStrings;
+
+	// New strings are already in the string table
+	QString str;
+	for (quint32 i = 0; i < newStrings; i++)
+	{
+		if (!GameArchive::readString(in, &str))
+			return setError(tr("Game %1 is corrupted").arg(index + 1));
+	}
+
+	game.clear();
+
+	quint16 tagCount;
+	in >> tagCount;
+	for (quint16 i = 0; i < tagCount; i++)
+	{
+		quint32 nameRef;
+		quint32 valueRef;
+		QString name;
+		QString value;
+
+		in >> nameRef >> valueRef;
+		bool ok = string(nameRef, &name);
+		if (valueRef == GameArchive::InlineString)
+			ok = ok && GameArchive::readString(in, &value);
+		else
+			ok = ok && string(valueRef, &value);
+		if (!ok)
+			return setError(tr("Game %1 is corrupted").arg(index + 1));
+
+		game.setTag(name, value);
+	}
+	game.setTag("Result", GameArchive::decodeResult(result));
+
+	QString initialComment;
+	quint32 plyCount;
+	if (!GameArchive::readString(in, &initialComment))
+		return setError(tr("Game %1 is corrupted").arg(index + 1));
+	in >> plyCount;
+
+	const bool wide = flags & GameArchive::WideMoves;
+	if (in.status() != QDataStream::Ok
+	||  plyCount > quint32(body.size()) / (wide ? 4 : 2))
+		return setError(tr("Game %1 is corrupted").arg(index + 1));
+
+	QVector<quint32> codes(int(plyCount));
+	for (quint32& code : codes)
+	{
+		if (wide)
+			in >> code;
+		else
+		{
+			quint16 tmp;
+			in >> tmp;
+			code = tmp;
+		}
+	}
+
+	if (stats != nullptr)
+		stats->clear();
+	if (flags & GameArchive::HasStats)
+	{
+		GameArchive::MoveStats tmp;
+		for (quint32 i = 0; i < plyCount; i++)
+		{
+			in >> tmp.score >> tmp.depth >> tmp.time >> tmp.nodes;
+			if (stats != nullptr)
+				stats->append(tmp);
+		}
+	}
+
+	QStringList comments;
+	if (flags & GameArchive::HasComments)
+	{
+		for (quint32 i = 0; i < plyCount; i++)
+		{
+			if (!GameArchive::readString(in, &str))
+				return setError(tr("Game %1 is corrupted").arg(index + 1));
+			comments.append(str);
+		}
+	}
+
+	if (in.status() != QDataStream::Ok)
+		return setError(tr("Game %1 is corrupted").arg(index + 1));
+
+	// Replay the game to restore the move strings and keys
+	Chess::Board* board = this->board(game.variant());
+	if (board == nullptr)
+		return setError(tr("Unknown variant: %1").arg(game.variant()));
+
+	QString fen(game.startingFenString());
+	if (fen.isEmpty())
+		fen = board->defaultFenString();
+	if (!board->setFenString(fen))
+		return setError(tr("Invalid FEN string in game %1: %2")
+				.arg(index + 1).arg(fen));
+
+	game.setStartingSide(board->sideToMove());
+	game.setResultDescription(initialComment);
+
+	const int width = board->width();
+	for (int i = 0; i < codes.size(); i++)
+	{
+		const Chess::GenericMove move(GameArchive::decodeMove(codes.at(i),
+								      width,
+								      wide));
+		const Chess::Move boardMove(board->moveFromGenericMove(move));
+		if (boardMove.isNull() || !board->isLegalMove(boardMove))
+			return setError(tr("Illegal move in game %1 at ply %2")
+					.arg(index + 1).arg(i + 1));
+
+		PgnGame::MoveData md;
+		md.key = board->key();
+		md.move = move;
+		md.moveString = board->moveString(boardMove,
+						  Chess::Board::StandardAlgebraic);
+		md.comment = comments.value(i);
+
+		board->makeMove(boardMove);
+		game.addMove(md, board->key(), false);
+	}
+
+	return true;
+}
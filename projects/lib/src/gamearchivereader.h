@@ -0,0 +1,105 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMEARCHIVEREADER_H
+#define GAMEARCHIVEREADER_H
+
+#include <QFile>
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+#include <QCoreApplication>
+#include "gamearchive.h"
+class PgnGame;
+namespace Chess { class Board; }
+
+/*!
+ * \brief Reads games from a binary game archive
+ *
+ * The reader loads the archive's index when the file is opened, so
+ * games can be read sequentially with readNext() or accessed in any
+ * order with seek(). Games are replayed on a board to restore the
+ * move strings and position keys of the original PgnGame.
+ *
+ * \sa GameArchiveWriter
+ */
+class LIB_EXPORT GameArchiveReader
+{
+	Q_DECLARE_TR_FUNCTIONS(GameArchiveReader)
+
+	public:
+		/*! Creates a new reader. */
+		GameArchiveReader();
+		/*! Closes the archive. */
+		~GameArchiveReader();
+
+		/*! Opens \a fileName for reading. Returns true if successful. */
+		bool open(const QString& fileName);
+		/*! Closes the archive. */
+		void close();
+		/*! Returns true if the archive is open. */
+		bool isOpen() const;
+		/*!
+		 * Returns true if the archive's index was loaded from its
+		 * footer, ie. the archive was closed properly.
+		 */
+		bool hasFooter() const;
+
+		/*! Returns the number of games in the archive. */
+		int gameCount() const;
+		/*! Returns the index of the game readNext() will read. */
+		int currentGame() const;
+		/*! Returns true if there are no more games to read. */
+		bool atEnd() const;
+		/*!
+		 * Moves to the game at \a index, counting from zero.
+		 * Returns true if successful.
+		 */
+		bool seek(int index);
+
+		/*!
+		 * Reads the next game into \a game.
+		 *
+		 * If \a stats is not null and the record contains move
+		 * statistics, they are stored in \a stats. Returns true
+		 * if successful.
+		 */
+		bool readNext(PgnGame& game,
+			      QVector<GameArchive::MoveStats>* stats = nullptr);
+
+		/*! Returns a description of the last error. */
+		QString errorString() const;
+
+	private:
+		Q_DISABLE_COPY(GameArchiveReader)
+
+		bool string(quint32 ref, QString* str) const;
+		Chess::Board* board(const QString& variant);
+		bool setError(const QString& message);
+
+		QFile m_file;
+		QStringList m_strings;
+		QVector<quint64> m_offsets;
+		QMap<QString, Chess::Board*> m_boards;
+		qint64 m_dataEnd;
+		int m_current;
+		bool m_hasFooter;
+		QString m_error;
+};
+
+#endif // GAMEARCHIVEREADER_H
@@ -0,0 +1,331 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "gamearchivewriter.h"
+#include <QDataStream>
+#include "board/board.h"
+#include "board/boardfactory.h"
+#include "gamearchive.h"
+#include "pgngame.h"
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+bool syncFile(QFile& file)
+{
+#ifdef Q_OS_WIN
+	return _commit(file.handle()) == 0;
+#else
+	return ::fsync(file.handle()) == 0;
+#endif
+}
+
+} // anonymous namespace
+
+GameArchiveWriter::GameArchiveWriter()
+	: m_moveStats(true),
+	  m_moveComments(false)
+{
+}
+
+GameArchiveWriter::~GameArchiveWriter()
+{
+	close();
+}
+
+void GameArchiveWriter::setMoveStatsEnabled(bool enabled)
+{
+	m_moveStats = enabled;
+}
+
+void GameArchiveWriter::setMoveCommentsEnabled(bool enabled)
+{
+	m_moveComments = enabled;
+}
+
+bool GameArchiveWriter::open(const QString& fileName)
+{
+	close();
+
+	m_strings.clear();
+	m_stringRefs.clear();
+	m_offsets.clear();
+	m_error.clear();
+
+	m_file.setFileName(fileName);
+	if (!m_file.open(QIODevice::ReadWrite))
+	{
+		setError(tr("Can't open game archive %1: %2")
+			 .arg(fileName, m_file.errorString()));
+		return false;
+	}
+
+	if (m_file.size() == 0)
+	{
+		QDataStream out(&m_file);
+		out.setByteOrder(QDataStream::LittleEndian);
+		GameArchive::writeFileHeader(out);
+		m_file.flush();
+		return true;
+	}
+
+	qint64 dataEnd = 0;
+	if (!GameArchive::readIndex(&m_file, &m_strings, &m_offsets, &dataEnd))
+	{
+		setError(tr("%1 is not a game archive").arg(fileName));
+		m_file.close();
+		return false;
+	}
+
+	for (int i = 0; i < m_strings.size(); i++)
+		m_stringRefs.insert(m_strings.at(i), quint32(i));
+
+	// Drop the old footer (or a partially written record)
+	// and continue appending from the last complete record
+	if (!m_file.resize(dataEnd) || !m_file.seek(dataEnd))
+	{
+		setError(tr("Can't append to game archive %1: %2")
+			 .arg(fileName, m_file.errorString()));
+		m_file.close();
+		return false;
+	}
+
+	return true;
+}
+
+bool GameArchiveWriter::isOpen() const
+{
+	return m_file.isOpen();
+}
+
+QString GameArchiveWriter::fileName() const
+{
+	return m_file.fileName();
+}
+
+int GameArchiveWriter::gameCount() const
+{
+	return m_offsets.size();
+}
+
+QString GameArchiveWriter::errorString() const
+{
+	return m_error;
+}
+
+void GameArchiveWriter::setError(const QString& message)
+{
+	m_error = message;
+}
+
+quint32 GameArchiveWriter::stringRef(const QString& str, QStringList* newStrings)
+{
+	auto it = m_stringRefs.constFind(str);
+	if (it != m_stringRefs.constEnd())
+		return it.value();
+
+	const quint32 ref = quint32(m_strings.size());
+	m_strings.append(str);
+	m_stringRefs.insert(str, ref);
+	newStrings->append(str);
+
+	return ref;
+}
+
+bool GameArchiveWriter::boardSize(const QString& variant, int* width, int* height)
+{
+	auto it = m_boardSizes.constFind(variant);
+	if (it == m_boardSizes.constEnd())
+	{
+		Chess::Board* board = Chess::BoardFactory::create(variant);
+		if (board == nullptr)
+			return false;
+
+		it = m_boardSizes.insert(variant, qMakePair(board->width(),
+							    board->height()));
+		delete board;
+	}
+
+	*width = it.value().first;
+	*height = it.value().second;
+	return true;
+}
+
+bool GameArchiveWriter::write(const PgnGame& game)
+{
+	if (!m_file.isOpen())
+	{
+		setError(tr("The game archive is not open"));
+		return false;
+	}
+
+	int width = 0;
+	int height = 0;
+	if (!boardSize(game.variant(), &width, &height))
+	{
+		setError(tr("Unknown variant: %1").arg(game.variant()));
+		return false;
+	}
+
+	const QVector<PgnGame::MoveData>& moves = game.moves();
+	bool wide = GameArchive::needsWideMoves(width, height);
+	for (const PgnGame::MoveData& md : moves)
+	{
+		if (md.move.promotion() > 0xF)
+			wide = true;
+	}
+
+	const int oldStringCount = m_strings.size();
+	QStringList newStrings;
+
+	// Tags, except the result which has its own field and the
+	// placeholders which PgnGame::tags() adds for missing roster tags
+	QByteArray tagData;
+	QDataStream tags(&tagData, QIODevice::WriteOnly);
+	tags.setByteOrder(QDataStream::LittleEndian);
+	quint16 tagCount = 0;
+
+	const auto tagList = game.tags();
+	for (const auto& tag : tagList)
+	{
+		if (tag.first == "Result"
+		||  game.tagValue(tag.first).isEmpty())
+			continue;
+
+		tags << stringRef(tag.first, &newStrings);
+		if (GameArchive::isInternedTag(tag.first))
+			tags << stringRef(tag.second, &newStrings);
+		else
+		{
+			tags << GameArchive::InlineString;
+			GameArchive::writeString(tags, tag.second);
+		}
+		tagCount++;
+	}
+
+	quint8 flags = 0;
+	if (m_moveStats)
+		flags |= GameArchive::HasStats;
+	if (m_moveComments)
+		flags |= GameArchive::HasComments;
+	if (wide)
+		flags |= GameArchive::WideMoves;
+
+	QByteArray body;
+	QDataStream out(&body, QIODevice::WriteOnly);
+	out.setByteOrder(QDataStream::LittleEndian);
+
+	out << flags << GameArchive::encodeResult(game.tagValue("Result"));
+	out << quint32(newStrings.size());
+	for (const QString& str : qAsConst(newStrings))
+		GameArchive::writeString(out, str);
+	out << tagCount;
+	out.writeRawData(tagData.constData(), tagData.size());
+	GameArchive::writeString(out, game.initialComment());
+
+	out << quint32(moves.size());
+	for (const PgnGame::MoveData& md : moves)
+	{
+		const quint32 code = GameArchive::encodeMove(md.move, width, wide);
+		if (wide)
+			out << code;
+		else
+			out << quint16(code);
+	}
+
+	if (m_moveStats)
+	{
+		for (const PgnGame::MoveData& md : moves)
+		{
+			const auto stats = GameArchive::parseMoveStats(md.comment);
+			out << stats.score << stats.depth << stats.time << stats.nodes;
+		}
+	}
+	if (m_moveComments)
+	{
+		for (const PgnGame::MoveData& md : moves)
+			GameArchive::writeString(out, md.comment);
+	}
+
+	const qint64 pos = m_file.pos();
+	QDataStream file(&m_file);
+	file.setByteOrder(QDataStream::LittleEndian);
+	file << quint8('G') << quint32(body.size());
+	file.writeRawData(body.constData(), body.size());
+
+	if (file.status() != QDataStream::Ok || !m_file.flush())
+	{
+		setError(tr("Can't write to game archive %1: %2")
+			 .arg(m_file.fileName(), m_file.errorString()));
+
+		// Forget the strings and the partial record
+		for (int i = oldStringCount; i < m_strings.size(); i++)
+			m_stringRefs.remove(m_strings.at(i));
+		m_strings.erase(m_strings.begin() + oldStringCount, m_strings.end());
+		m_file.resize(pos);
+		m_file.seek(pos);
+		return false;
+	}
+
+	m_offsets.append(quint64(pos));
+	return true;
+}
+
+bool GameArchiveWriter::sync()
+{
+	if (!m_file.isOpen())
+		return true;
+
+	if (!m_file.flush() || !syncFile(m_file))
+	{
+		setError(tr("Can't sync game archive %1: %2")
+			 .arg(m_file.fileName(), m_file.errorString()));
+		return false;
+	}
+
+	return true;
+}
+
+bool GameArchiveWriter::close(bool sync)
+{
+	if (!m_file.isOpen())
+		return true;
+
+	const qint64 pos = m_file.size();
+	bool ok = m_file.seek(pos);
+	if (ok)
+	{
+		QDataStream out(&m_file);
+		out.setByteOrder(QDataStream::LittleEndian);
+		GameArchive::writeFooter(out, m_strings, m_offsets, quint64(pos));
+		ok = out.status() == QDataStream::Ok && m_file.flush();
+		if (ok && sync)
+			ok = syncFile(m_file);
+	}
+	if (!ok)
+		setError(tr("Can't write the index of game archive %1: %2")
+			 .arg(m_file.fileName(), m_file.errorString()));
+
+	m_file.close();
+	return ok;
+}
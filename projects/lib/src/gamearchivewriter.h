@@ -0,0 +1,111 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMEARCHIVEWRITER_H
+#define GAMEARCHIVEWRITER_H
+
+#include <QFile>
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+#include <QCoreApplication>
+class PgnGame;
+
+/*!
+ * \brief Writes games into a binary game archive
+ *
+ * The archive format is described in GameArchive. Games are appended
+ * one at a time and flushed immediately, so the file stays readable
+ * even if the writer is never closed. Opening an existing archive
+ * continues appending to it.
+ *
+ * \sa GameArchiveReader
+ */
+class LIB_EXPORT GameArchiveWriter
+{
+	Q_DECLARE_TR_FUNCTIONS(GameArchiveWriter)
+
+	public:
+		/*! Creates a new writer with move statistics enabled. */
+		GameArchiveWriter();
+		/*! Closes the archive. */
+		~GameArchiveWriter();
+
+		/*!
+		 * If \a enabled is true, the depth, score, time and node
+		 * count of every move are stored in fixed-width fields.
+		 * The default value is true.
+		 */
+		void setMoveStatsEnabled(bool enabled);
+		/*!
+		 * If \a enabled is true, the full move comments are stored
+		 * too, which makes conversion back to PGN lossless.
+		 * The default value is false.
+		 */
+		void setMoveCommentsEnabled(bool enabled);
+
+		/*!
+		 * Opens \a fileName for appending games.
+		 *
+		 * A new archive is created if the file doesn't exist or
+		 * is empty. Returns true if successful.
+		 */
+		bool open(const QString& fileName);
+		/*! Returns true if the archive is open. */
+		bool isOpen() const;
+		/*! Returns the name of the archive file. */
+		QString fileName() const;
+		/*! Returns the number of games in the archive. */
+		int gameCount() const;
+
+		/*! Appends \a game to the archive. Returns true if successful. */
+		bool write(const PgnGame& game);
+		/*!
+		 * Forces the games written so far to disk.
+		 * Returns true if successful.
+		 */
+		bool sync();
+		/*!
+		 * Writes the footer index and closes the archive. If
+		 * \a sync is true, the archive is forced to disk before
+		 * it's closed. Returns true if successful.
+		 */
+		bool close(bool sync = false);
+
+		/*! Returns a description of the last error. */
+		QString errorString() const;
+
+	private:
+		Q_DISABLE_COPY(GameArchiveWriter)
+
+		quint32 stringRef(const QString& str, QStringList* newStrings);
+		bool boardSize(const QString& variant, int* width, int* height);
+		void setError(const QString& message);
+
+		QFile m_file;
+		QStringList m_strings;
+		QHash<QString, quint32> m_stringRefs;
+		QVector<quint64> m_offsets;
+		QHash<QString, QPair<int, int> > m_boardSizes;
+		bool m_moveStats;
+		bool m_moveComments;
+		QString m_error;
+};
+
+#endif // GAMEARCHIVEWRITER_H
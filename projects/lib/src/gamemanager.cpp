@@ -17,6 +17,7 @@
 */
 
 #include "gamemanager.h"
+#include <QMetaMethod>
 #include <QThread>
 #include <algorithm>
 #include "playerbuilder.h"
@@ -137,9 +138,15 @@ void GameInitializer::initializeGame()
 
 		if (m_player[i] == nullptr)
 		{
+			// Players don't build debug messages that nobody reads
+			GameManager* manager = qobject_cast<GameManager*>(thread()->parent());
+			const bool debug = manager != nullptr
+					&& manager->isDebugEnabled();
+
 			QString error;
 			m_player[i] = m_builder[i]->create(thread()->parent(),
-							   SIGNAL(debugMessage(QString)),
+							   debug ? SIGNAL(debugMessage(QString))
+								 : nullptr,
 							   this, &error);
 			m_game->setError(error);
 
@@ -353,6 +360,13 @@ void GameManager::setConcurrency(int concurrency)
 	m_concurrency = concurrency;
 }
 
+bool GameManager::isDebugEnabled() const
+{
+	static const QMetaMethod debugSignal(
+		QMetaMethod::fromSignal(&GameManager::debugMessage));
+	return isSignalConnected(debugSignal);
+}
+
 void GameManager::cleanupIdleThreads()
 {
 	QList<GameThread*>::iterator it = m_activeThreads.begin();
@@ -97,6 +97,13 @@ class LIB_EXPORT GameManager : public QObject
 		 * \sa concurrency()
 		 */
 		void setConcurrency(int concurrency);
+		/*!
+		 * Returns true if the debugMessage() signal is connected.
+		 *
+		 * New players are connected to debugMessage() only if it
+		 * is, so that they don't build debug output for nobody.
+		 */
+		bool isDebugEnabled() const;
 
 		/*!
 		 * Cleans up and deletes all idle game threads
@@ -0,0 +1,415 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "gameoutputwriter.h"
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+#include "gamearchivewriter.h"
+#include "tracer.h"
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+QVector<quint32> crcTable()
+{
+	QVector<quint32> table(256);
+	for (quint32 i = 0; i < 256; i++)
+	{
+		quint32 c = i;
+		for (int k = 0; k < 8; k++)
+			c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+		table[int(i)] = c;
+	}
+	return table;
+}
+
+quint32 crc32(const QByteArray& data)
+{
+	static const QVector<quint32> table(crcTable());
+
+	quint32 crc = 0xFFFFFFFFU;
+	for (char ch : data)
+		crc = table[(crc ^ quint8(ch)) & 0xFF] ^ (crc >> 8);
+	return crc ^ 0xFFFFFFFFU;
+}
+
+void appendLittleEndian(QByteArray& data, quint32 value)
+{
+	for (int i = 0; i < 4; i++)
+		data.append(char((value >> (i * 8)) & 0xFF));
+}
+
+} // anonymous namespace
+
+GameOutputWriter::Output::Output()
+	: compressed(false)
+{
+}
+
+GameOutputWriter::GameOutputWriter(QObject* parent)
+	: QThread(parent),
+	  m_busy(false),
+	  m_quit(false),
+	  m_capacity(DefaultQueueCapacity),
+	  m_syncPolicy(NoSync),
+	  m_pgnMode(PgnGame::Verbose),
+	  m_archive(nullptr),
+	  m_stats{0, 0, 0, 0, 0, 0, 0}
+{
+}
+
+GameOutputWriter::~GameOutputWriter()
+{
+	finish();
+	delete m_archive;
+}
+
+void GameOutputWriter::setPgnOutput(const QString& fileName,
+				    PgnGame::PgnMode mode)
+{
+	QMutexLocker locker(&m_mutex);
+	waitForIdle();
+
+	if (fileName != m_pgn.file.fileName())
+	{
+		m_pgn.file.close();
+		m_pgn.file.setFileName(fileName);
+		m_pgn.compressed = fileName.endsWith(".gz", Qt::CaseInsensitive);
+	}
+	m_pgnMode = mode;
+}
+
+void GameOutputWriter::setEpdOutput(const QString& fileName)
+{
+	QMutexLocker locker(&m_mutex);
+	waitForIdle();
+
+	if (fileName != m_epd.file.fileName())
+	{
+		m_epd.file.close();
+		m_epd.file.setFileName(fileName);
+		m_epd.compressed = fileName.endsWith(".gz", Qt::CaseInsensitive);
+	}
+}
+
+bool GameOutputWriter::setGameArchiveOutput(const QString& fileName,
+					    bool moveComments)
+{
+	QMutexLocker locker(&m_mutex);
+	waitForIdle();
+
+	delete m_archive;
+	m_archive = new GameArchiveWriter;
+	m_archive->setMoveCommentsEnabled(moveComments);
+
+	if (!m_archive->open(fileName))
+	{
+		qWarning("%s", qUtf8Printable(m_archive->errorString()));
+		delete m_archive;
+		m_archive = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+void GameOutputWriter::setSyncPolicy(SyncPolicy policy)
+{
+	QMutexLocker locker(&m_mutex);
+	waitForIdle();
+	m_syncPolicy = policy;
+}
+
+void GameOutputWriter::setQueueCapacity(int capacity)
+{
+	Q_ASSERT(capacity > 0);
+
+	QMutexLocker locker(&m_mutex);
+	m_capacity = capacity;
+}
+
+bool GameOutputWriter::hasGameOutput() const
+{
+	QMutexLocker locker(&m_mutex);
+	return !m_pgn.file.fileName().isEmpty() || m_archive != nullptr;
+}
+
+bool GameOutputWriter::hasEpdOutput() const
+{
+	QMutexLocker locker(&m_mutex);
+	return !m_epd.file.fileName().isEmpty();
+}
+
+void GameOutputWriter::writeGame(PgnGame game, int gameNumber)
+{
+	Q_ASSERT(gameNumber > 0);
+	enqueue(Job{std::move(game), gameNumber, QString()});
+}
+
+void GameOutputWriter::writeEpd(const QString& epd)
+{
+	enqueue(Job{PgnGame(), 0, epd});
+}
+
+void GameOutputWriter::enqueue(Job&& job)
+{
+	QMutexLocker locker(&m_mutex);
+
+	// Back-pressure: the producer waits until the writer catches up
+	while (m_queue.size() >= m_capacity)
+		m_jobTaken.wait(&m_mutex);
+
+	m_queue.enqueue(std::move(job));
+	m_stats.queueDepth = m_queue.size();
+	m_stats.maxQueueDepth = qMax(m_stats.maxQueueDepth, m_queue.size());
+
+	if (!isRunning())
+	{
+		m_quit = false;
+		start();
+	}
+	m_jobAdded.wakeOne();
+}
+
+void GameOutputWriter::waitForIdle()
+{
+	while (!m_queue.isEmpty() || m_busy)
+		m_idle.wait(&m_mutex);
+}
+
+void GameOutputWriter::flush()
+{
+	QMutexLocker locker(&m_mutex);
+	waitForIdle();
+}
+
+void GameOutputWriter::finish()
+{
+	{
+		QMutexLocker locker(&m_mutex);
+		m_quit = true;
+		m_jobAdded.wakeAll();
+	}
+	wait();
+
+	// The thread is not running, so the files can be closed here
+	m_pgn.file.close();
+	m_epd.file.close();
+	if (m_archive != nullptr && !m_archive->close(m_syncPolicy != NoSync))
+		qWarning("%s", qUtf8Printable(m_archive->errorString()));
+}
+
+GameOutputWriter::Stats GameOutputWriter::stats() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_stats;
+}
+
+void GameOutputWriter::run()
+{
+	QVector<Job> batch;
+	QMutexLocker locker(&m_mutex);
+
+	forever
+	{
+		while (m_queue.isEmpty() && !m_quit)
+			m_jobAdded.wait(&m_mutex);
+		if (m_queue.isEmpty())
+			break;
+
+		// Group commit: take everything that's waiting
+		batch.reserve(m_queue.size());
+		while (!m_queue.isEmpty())
+			batch.append(m_queue.dequeue());
+		m_stats.queueDepth = 0;
+		m_busy = true;
+		m_jobTaken.wakeAll();
+		locker.unlock();
+
+		QElapsedTimer timer;
+		timer.start();
+		{
+			TraceSpan span("io", "output batch",
+				       QString::number(batch.size()));
+			writeBatch(batch);
+		}
+		const qint64 latency = timer.nsecsElapsed() / 1000;
+
+		locker.relock();
+		m_busy = false;
+		m_stats.batchCount++;
+		m_stats.lastFlushLatency = latency;
+		m_stats.maxFlushLatency = qMax(m_stats.maxFlushLatency, latency);
+		m_stats.totalFlushLatency += latency;
+		for (const Job& job : qAsConst(batch))
+		{
+			if (job.gameNumber > 0)
+				m_stats.gameCount++;
+		}
+		batch.clear();
+		m_idle.wakeAll();
+	}
+}
+
+void GameOutputWriter::writeBatch(QVector<Job>& batch)
+{
+	const bool pgnOutput = !m_pgn.file.fileName().isEmpty();
+	const bool epdOutput = !m_epd.file.fileName().isEmpty();
+
+	if (m_archive != nullptr
+	&&  !m_archive->isOpen()
+	&&  !m_archive->open(m_archive->fileName()))
+		qWarning("%s", qUtf8Printable(m_archive->errorString()));
+
+	for (const Job& job : qAsConst(batch))
+	{
+		if (job.gameNumber == 0)
+		{
+			if (epdOutput)
+			{
+				QTextStream out(&m_epd.buffer,
+						QIODevice::WriteOnly | QIODevice::Append);
+				out << job.epd << "\n";
+			}
+			if (m_syncPolicy == GameSync)
+				commit(m_epd, "EPD");
+			continue;
+		}
+
+		if (pgnOutput)
+		{
+			QTextStream out(&m_pgn.buffer,
+					QIODevice::WriteOnly | QIODevice::Append);
+			if (!job.game.write(out, m_pgnMode))
+				qWarning("Could not write PGN game %d", job.gameNumber);
+		}
+		if (m_archive != nullptr
+		&&  m_archive->isOpen()
+		&&  !m_archive->write(job.game))
+			qWarning("Could not archive game %d: %s", job.gameNumber,
+				 qUtf8Printable(m_archive->errorString()));
+
+		if (m_syncPolicy == GameSync)
+		{
+			commit(m_pgn, "PGN");
+			syncArchive();
+		}
+	}
+
+	commit(m_pgn, "PGN");
+	commit(m_epd, "EPD");
+	if (m_syncPolicy == BatchSync)
+		syncArchive();
+}
+
+void GameOutputWriter::syncArchive()
+{
+	if (m_archive != nullptr
+	&&  m_archive->isOpen()
+	&&  !m_archive->sync())
+		qWarning("%s", qUtf8Printable(m_archive->errorString()));
+}
+
+bool GameOutputWriter::openOutput(Output& output, const char* type)
+{
+	bool isOpen = output.file.isOpen();
+	if (isOpen && output.file.exists())
+		return true;
+
+	if (isOpen)
+	{
+		qWarning("%s file %s does not exist. Reopening...",
+			 type, qUtf8Printable(output.file.fileName()));
+		output.file.close();
+	}
+
+	if (!output.file.open(QIODevice::WriteOnly | QIODevice::Append))
+	{
+		qWarning("Could not open %s file %s",
+			 type, qUtf8Printable(output.file.fileName()));
+		return false;
+	}
+
+	return true;
+}
+
+bool GameOutputWriter::commit(Output& output, const char* type)
+{
+	if (output.buffer.isEmpty())
+		return true;
+
+	if (!openOutput(output, type))
+	{
+		output.buffer.clear();
+		return false;
+	}
+
+	const QByteArray data(output.compressed ? gzipMember(output.buffer)
+						: output.buffer);
+	output.buffer.clear();
+
+	bool ok = output.file.write(data) == data.size() && output.file.flush();
+	if (ok && m_syncPolicy != NoSync)
+		ok = syncFile(output.file);
+	if (!ok)
+		qWarning("Could not write %s file %s",
+			 type, qUtf8Printable(output.file.fileName()));
+
+	return ok;
+}
+
+bool GameOutputWriter::syncFile(QFile& file)
+{
+#ifdef Q_OS_WIN
+	return _commit(file.handle()) == 0;
+#else
+	return ::fsync(file.handle()) == 0;
+#endif
+}
+
+QByteArray GameOutputWriter::gzipMember(const QByteArray& data)
+{
+	/*
+	 * qCompress() produces a 4-byte length prefix and a zlib stream:
+	 * a 2-byte header, the raw deflate data and an Adler-32 checksum.
+	 * The deflate data is rewrapped with a gzip header and trailer.
+	 */
+	const QByteArray zlib(qCompress(data));
+	if (zlib.size() < 10)
+		return QByteArray();
+
+	static const char header[10] = {
+		'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'
+	};
+
+	QByteArray member;
+	member.reserve(zlib.size() + 8);
+	member.append(header, sizeof(header));
+	member.append(zlib.constData() + 6, zlib.size() - 10);
+	appendLittleEndian(member, crc32(data));
+	appendLittleEndian(member, quint32(data.size()));
+
+	return member;
+}
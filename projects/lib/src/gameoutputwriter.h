@@ -0,0 +1,192 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMEOUTPUTWRITER_H
+#define GAMEOUTPUTWRITER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QFile>
+#include "pgngame.h"
+class GameArchiveWriter;
+
+/*!
+ * \brief A thread that saves finished games to the output files
+ *
+ * GameOutputWriter takes games and EPD positions from the tournament
+ * and writes them to the PGN, EPD and game archive files in its own
+ * thread, so a slow file system doesn't hold up the scheduling of new
+ * games. Jobs are written in the order they were queued. All jobs that
+ * are waiting when the thread wakes up are written as one batch and
+ * committed together.
+ *
+ * The queue is bounded: if it's full, writeGame() and writeEpd() block
+ * until the writer has caught up.
+ *
+ * If the name of a PGN or EPD file ends in ".gz", every batch is
+ * written as a gzip member. Concatenated members form a valid gzip
+ * file, so the file can still be appended to and read with the
+ * standard tools.
+ */
+class LIB_EXPORT GameOutputWriter : public QThread
+{
+	Q_OBJECT
+
+	public:
+		/*! When to force the written data to disk. */
+		enum SyncPolicy
+		{
+			/*! Leave it to the operating system (default). */
+			NoSync,
+			/*! Sync after every batch of games. */
+			BatchSync,
+			/*! Sync after every game. */
+			GameSync
+		};
+
+		/*! Queue and write statistics. */
+		struct Stats
+		{
+			/*! Number of jobs currently in the queue. */
+			int queueDepth;
+			/*! Highest number of jobs seen in the queue. */
+			int maxQueueDepth;
+			/*! Number of games written. */
+			int gameCount;
+			/*! Number of batches written. */
+			int batchCount;
+			/*! Duration of the last batch in microseconds. */
+			qint64 lastFlushLatency;
+			/*! Longest batch duration in microseconds. */
+			qint64 maxFlushLatency;
+			/*! Total duration of all batches in microseconds. */
+			qint64 totalFlushLatency;
+		};
+
+		/*! The default maximum number of queued jobs. */
+		static const int DefaultQueueCapacity = 64;
+
+		/*! Creates a new writer with no output files. */
+		explicit GameOutputWriter(QObject* parent = nullptr);
+		/*! Writes the queued jobs and closes the files. */
+		virtual ~GameOutputWriter();
+
+		/*!
+		 * Sets the PGN output file to \a fileName.
+		 *
+		 * The games are saved in mode \a mode. An empty file name
+		 * disables PGN output.
+		 */
+		void setPgnOutput(const QString& fileName,
+				  PgnGame::PgnMode mode = PgnGame::Verbose);
+		/*!
+		 * Sets the EPD output file to \a fileName. An empty file
+		 * name disables EPD output.
+		 */
+		void setEpdOutput(const QString& fileName);
+		/*!
+		 * Sets the binary game archive output file to \a fileName.
+		 *
+		 * Returns false if the archive can't be opened.
+		 * \sa GameArchiveWriter
+		 */
+		bool setGameArchiveOutput(const QString& fileName,
+					  bool moveComments = false);
+		/*! Sets the sync policy to \a policy. */
+		void setSyncPolicy(SyncPolicy policy);
+		/*!
+		 * Sets the maximum number of queued jobs to \a capacity.
+		 * The default value is DefaultQueueCapacity.
+		 */
+		void setQueueCapacity(int capacity);
+
+		/*! Returns true if games are saved in PGN or archive format. */
+		bool hasGameOutput() const;
+		/*! Returns true if end positions are saved in EPD format. */
+		bool hasEpdOutput() const;
+
+		/*!
+		 * Queues \a game, numbered \a gameNumber, for writing.
+		 *
+		 * The game is taken by move; PgnGame's containers are
+		 * implicitly shared, so passing a copy is cheap too.
+		 */
+		void writeGame(PgnGame game, int gameNumber);
+		/*! Queues the EPD position \a epd for writing. */
+		void writeEpd(const QString& epd);
+
+		/*! Blocks until all queued jobs have been written. */
+		void flush();
+		/*!
+		 * Writes all queued jobs, closes the output files and
+		 * stops the thread.
+		 */
+		void finish();
+
+		/*! Returns the queue and write statistics. */
+		Stats stats() const;
+
+	protected:
+		// Inherited from QThread
+		virtual void run();
+
+	private:
+		struct Job
+		{
+			PgnGame game;
+			int gameNumber;
+			QString epd;
+		};
+
+		struct Output
+		{
+			Output();
+
+			QFile file;
+			bool compressed;
+			QByteArray buffer;
+		};
+
+		void enqueue(Job&& job);
+		void waitForIdle();
+		void writeBatch(QVector<Job>& batch);
+		bool openOutput(Output& output, const char* type);
+		bool commit(Output& output, const char* type);
+		void syncArchive();
+		static bool syncFile(QFile& file);
+		static QByteArray gzipMember(const QByteArray& data);
+
+		mutable QMutex m_mutex;
+		QWaitCondition m_jobAdded;
+		QWaitCondition m_jobTaken;
+		QWaitCondition m_idle;
+		QQueue<Job> m_queue;
+		bool m_busy;
+		bool m_quit;
+		int m_capacity;
+		SyncPolicy m_syncPolicy;
+		PgnGame::PgnMode m_pgnMode;
+		Output m_pgn;
+		Output m_epd;
+		GameArchiveWriter* m_archive;
+		Stats m_stats;
+};
+
+#endif // GAMEOUTPUTWRITER_H
@@ -18,10 +18,41 @@
 
 #include "openingsuite.h"
 #include <QFile>
+#include <QFileInfo>
 #include <QTextStream>
+#include <QDataStream>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QHash>
+#include <QSet>
+#include <QScopedPointer>
 #include "pgnstream.h"
 #include "epdrecord.h"
 #include "mersenne.h"
+#include "board/board.h"
+#include "board/boardfactory.h"
+
+namespace {
+
+const quint32 CacheMagic = 0x4350534f; // "OSPC"
+const quint32 CacheVersion = 2;
+// Broken openings listed in the error report; the rest are only logged
+const int MaxReportedOpenings = 10;
+
+quint32 packMove(const Chess::Move& move)
+{
+	return quint32(move.sourceSquare())
+	     | quint32(move.targetSquare()) << 10
+	     | quint32(move.promotion()) << 20;
+}
+
+Chess::Move unpackMove(quint32 data)
+{
+	return Chess::Move(data & 0x3FF, (data >> 10) & 0x3FF,
+			   (data >> 20) & 0x3FF);
+}
+
+} // anonymous namespace
 
 OpeningSuite::OpeningSuite(const QString& fen)
 	: m_format(EpdFormat),
@@ -78,7 +109,8 @@ OpeningSuite::Order OpeningSuite::order() const
 
 bool OpeningSuite::isNull() const
 {
-	return m_epdStream == nullptr && m_pgnStream == nullptr;
+	return m_epdStream == nullptr && m_pgnStream == nullptr
+	    && !isCompiled();
 }
 
 bool OpeningSuite::initialize()
@@ -285,3 +317,364 @@ OpeningSuite::FilePosition OpeningSuite::getEpdPos()
 
 	return pos;
 }
+
+bool OpeningSuite::compile(const QString& variant,
+			   int maxPlies,
+			   const QString& cacheFile)
+{
+	m_fens.clear();
+	m_openingFens.clear();
+	m_openingMoves = QVector<int>(1, 0);
+	m_openingSources.clear();
+	m_moves.clear();
+	m_openingOrder.clear();
+	m_errors.clear();
+
+	if (!m_fileName.isEmpty() && !cacheFile.isEmpty()
+	&&  readCache(cacheFile, variant, maxPlies))
+	{
+		orderOpenings();
+		return true;
+	}
+
+	QScopedPointer<Chess::Board> board(Chess::BoardFactory::create(variant));
+	if (board.isNull())
+	{
+		addError(QString("Unknown chess variant: %1").arg(variant));
+		return false;
+	}
+	board->initialize();
+
+	QHash<QString, int> fenIndexes;
+	QSet<QByteArray> signatures;
+	int count = 0;
+	int broken = 0;
+
+	// Validates an opening and adds it unless it's a duplicate
+	auto add = [&](const QString& fen,
+		       const QVector<Chess::GenericMove>& moves)
+	{
+		count++;
+		const int first = m_moves.size();
+		QString error;
+		if (!addOpening(board.data(), fen, moves, maxPlies, &error))
+		{
+			broken++;
+			reportBrokenOpening(count, broken, error);
+			return;
+		}
+
+		QByteArray signature(fen.toUtf8());
+		for (int i = first; i < m_moves.size(); i++)
+		{
+			const quint32 data = packMove(m_moves.at(i));
+			signature.append('\0');
+			signature.append(reinterpret_cast<const char*>(&data),
+					 sizeof(data));
+		}
+		if (signatures.contains(signature))
+		{
+			m_moves.resize(first);
+			return;
+		}
+		signatures.insert(signature);
+
+		int fenIndex = fenIndexes.value(fen, -1);
+		if (fenIndex == -1)
+		{
+			fenIndex = m_fens.size();
+			fenIndexes[fen] = fenIndex;
+			m_fens.append(fen);
+		}
+		m_openingFens.append(fenIndex);
+		m_openingMoves.append(m_moves.size());
+		m_openingSources.append(count - 1);
+	};
+
+	if (!m_fen.isEmpty())
+	{
+		add(m_fen, QVector<Chess::GenericMove>());
+		orderOpenings();
+		return isCompiled();
+	}
+
+	QFile file(m_fileName);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		addError(QString("Can't open opening suite %1").arg(m_fileName));
+		return false;
+	}
+
+	if (m_format == PgnFormat)
+	{
+		PgnStream in(&file, variant);
+		PgnGame game;
+		QVector<Chess::GenericMove> moves;
+
+		forever
+		{
+			// A Variant tag in the previous game may have changed it
+			in.setVariant(variant);
+			if (!game.read(in, maxPlies, false))
+				break;
+
+			if (game.variant() != variant)
+			{
+				count++;
+				broken++;
+				reportBrokenOpening(count, broken,
+					QString("wrong variant: %1").arg(game.variant()));
+				continue;
+			}
+
+			moves.clear();
+			for (const PgnGame::MoveData& md : game.moves())
+				moves.append(md.move);
+			add(game.startingFenString(), moves);
+		}
+	}
+	else
+	{
+		QTextStream in(&file);
+		EpdRecord epd;
+
+		while (epd.parse(in))
+			add(epd.fen(), QVector<Chess::GenericMove>());
+	}
+
+	if (broken > 0)
+		addError(QString("Skipped %1 broken openings in %2")
+			 .arg(broken).arg(m_fileName));
+	if (!isCompiled())
+	{
+		addError(QString("No usable openings in %1").arg(m_fileName));
+		return false;
+	}
+
+	if (!cacheFile.isEmpty() && !writeCache(cacheFile, variant, maxPlies))
+		qWarning("Can't write opening cache %s",
+			 qUtf8Printable(cacheFile));
+
+	orderOpenings();
+	return true;
+}
+
+QString OpeningSuite::errorString() const
+{
+	return m_errors.join('\n');
+}
+
+bool OpeningSuite::isCompiled() const
+{
+	return !m_openingFens.isEmpty();
+}
+
+int OpeningSuite::openingCount() const
+{
+	return m_openingFens.size();
+}
+
+OpeningSuite::Opening OpeningSuite::nextOpening()
+{
+	Q_ASSERT(isCompiled());
+
+	const int i = m_openingOrder.at(m_gameIndex++);
+	if (m_gameIndex >= m_openingOrder.size())
+		m_gameIndex = 0;
+
+	const int first = m_openingMoves.at(i);
+	Opening opening;
+	opening.fen = m_fens.at(m_openingFens.at(i));
+	opening.moves = m_moves.mid(first, m_openingMoves.at(i + 1) - first);
+
+	m_gamesRead++;
+	return opening;
+}
+
+bool OpeningSuite::addOpening(Chess::Board* board,
+			      const QString& fen,
+			      const QVector<Chess::GenericMove>& moves,
+			      int maxPlies,
+			      QString* error)
+{
+	if (fen.isEmpty())
+	{
+		// A random variant would get a different position every time
+		if (board->isRandomVariant() && !moves.isEmpty())
+		{
+			*error = "the moves need a FEN string";
+			return false;
+		}
+		board->reset();
+	}
+	else if (!board->setFenString(fen))
+	{
+		*error = QString("invalid FEN string: %1").arg(fen);
+		return false;
+	}
+
+	const int first = m_moves.size();
+	const int plies = qMin(moves.size(), maxPlies);
+	for (int i = 0; i < plies; i++)
+	{
+		const Chess::Move move(board->moveFromGenericMove(moves.at(i)));
+		if (move.isNull() || !board->isLegalMove(move))
+		{
+			m_moves.resize(first);
+			*error = QString("illegal move at ply %1").arg(i + 1);
+			return false;
+		}
+
+		// Leave out the move that ends the game
+		board->makeMove(move);
+		if (!board->result().isNone())
+			break;
+		m_moves.append(move);
+	}
+
+	return true;
+}
+
+void OpeningSuite::addError(const QString& message)
+{
+	qWarning("%s", qUtf8Printable(message));
+	m_errors.append(message);
+}
+
+void OpeningSuite::reportBrokenOpening(int number, int broken,
+				       const QString& error)
+{
+	const QString message(QString("Opening %1 in %2: %3")
+			      .arg(number).arg(m_fileName, error));
+	if (broken <= MaxReportedOpenings)
+		addError(message);
+	else
+		qWarning("%s", qUtf8Printable(message));
+}
+
+void OpeningSuite::orderOpenings()
+{
+	const int count = openingCount();
+	m_openingOrder.clear();
+	m_openingOrder.reserve(count);
+	m_gamesRead = 0;
+	m_gameIndex = 0;
+
+	if (m_order == RandomOrder)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			int j = Mersenne::random() % (i + 1);
+			if (j == i)
+				m_openingOrder.append(i);
+			else
+			{
+				m_openingOrder.append(m_openingOrder.at(j));
+				m_openingOrder[j] = i;
+			}
+		}
+	}
+	else
+	{
+		// The start index counts the openings of the file, so
+		// the broken and duplicate ones before it are skipped
+		for (int i = 0; i < count; i++)
+		{
+			m_openingOrder.append(i);
+			if (m_openingSources.at(i) < m_startIndex)
+				m_gameIndex = (i + 1) % count;
+		}
+	}
+}
+
+bool OpeningSuite::readCache(const QString& fileName,
+			     const QString& variant,
+			     int maxPlies)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	const QFileInfo source(m_fileName);
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_5_0);
+
+	quint32 magic;
+	quint32 version;
+	qint64 size;
+	QDateTime modified;
+	qint32 format;
+	QString cachedVariant;
+	qint32 plies;
+	in >> magic >> version;
+	if (in.status() != QDataStream::Ok
+	||  magic != CacheMagic || version != CacheVersion)
+		return false;
+
+	in >> size >> modified >> format >> cachedVariant >> plies;
+	if (in.status() != QDataStream::Ok
+	||  size != source.size()
+	||  modified != source.lastModified()
+	||  format != qint32(m_format)
+	||  cachedVariant != variant
+	||  plies != maxPlies)
+		return false;
+
+	QStringList fens;
+	QVector<qint32> openingFens;
+	QVector<qint32> openingMoves;
+	QVector<qint32> openingSources;
+	QVector<quint32> moves;
+	in >> fens >> openingFens >> openingMoves >> openingSources >> moves;
+	if (in.status() != QDataStream::Ok
+	||  openingFens.isEmpty()
+	||  openingMoves.size() != openingFens.size() + 1
+	||  openingSources.size() != openingFens.size()
+	||  openingMoves.first() != 0
+	||  openingMoves.last() != moves.size())
+		return false;
+
+	for (int i = 0; i < openingFens.size(); i++)
+	{
+		if (openingFens.at(i) < 0 || openingFens.at(i) >= fens.size()
+		||  openingMoves.at(i) > openingMoves.at(i + 1)
+		||  (i > 0 && openingSources.at(i) <= openingSources.at(i - 1)))
+			return false;
+	}
+
+	m_fens = fens;
+	m_openingFens = openingFens;
+	m_openingMoves = openingMoves;
+	m_openingSources = openingSources;
+	m_moves.clear();
+	m_moves.reserve(moves.size());
+	for (quint32 move : qAsConst(moves))
+		m_moves.append(unpackMove(move));
+
+	return true;
+}
+
+bool OpeningSuite::writeCache(const QString& fileName,
+			      const QString& variant,
+			      int maxPlies) const
+{
+	QSaveFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+
+	const QFileInfo source(m_fileName);
+	QVector<quint32> moves;
+	moves.reserve(m_moves.size());
+	for (const Chess::Move& move : m_moves)
+		moves.append(packMove(move));
+
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_0);
+	out << CacheMagic << CacheVersion
+	    << source.size() << source.lastModified()
+	    << qint32(m_format) << variant << qint32(maxPlies)
+	    << m_fens << m_openingFens << m_openingMoves
+	    << m_openingSources << moves;
+
+	return out.status() == QDataStream::Ok && file.commit();
+}
@@ -20,11 +20,14 @@
 #define OPENINGSUITE_H
 
 #include <QVector>
+#include <QStringList>
 #include "pgngame.h"
+#include "board/move.h"
 class QString;
 class QFile;
 class QTextStream;
 class PgnStream;
+namespace Chess { class Board; }
 
 /*!
  * \brief A suite of chess openings
@@ -34,6 +37,13 @@ class PgnStream;
  * reads positions and games from a text stream (eg. a text file)
  * and returns the opening as a PgnGame object.
  *
+ * A suite can also be compiled with compile(). Compiling reads every
+ * opening once, checks it on a board and drops duplicates, so the
+ * games can take a ready-made opening from nextOpening() without any
+ * parsing or move validation. Broken openings are reported when the
+ * suite is compiled instead of when a game starts. The compiled suite
+ * can be cached in a file for the next run.
+ *
  * \sa EpdRecord
  * \sa PgnGame
  */
@@ -54,6 +64,18 @@ class LIB_EXPORT OpeningSuite
 			RandomOrder		//!< Random order
 		};
 
+		/*! A compiled opening. */
+		struct Opening
+		{
+			/*!
+			 * The starting position in FEN notation, or an
+			 * empty string for the variant's default position.
+			 */
+			QString fen;
+			/*! The legal moves played from the starting position. */
+			QVector<Chess::Move> moves;
+		};
+
 		/*!
 		 * Creates a new opening suite that starts every game at \a fen.
 		 */
@@ -106,6 +128,45 @@ class LIB_EXPORT OpeningSuite
 		 */
 		PgnGame nextGame(int maxPlies);
 
+		/*!
+		 * Compiles the opening suite for chess variant \a variant.
+		 *
+		 * Every opening is read from the file, cut to \a maxPlies
+		 * plies and played on a board. Openings with an invalid
+		 * position or an illegal move are reported and skipped, and
+		 * duplicates are dropped. If the file is read again later,
+		 * the order and start index of the suite still apply. The
+		 * start index counts the openings of the file: if that
+		 * opening was dropped, the suite starts at the next
+		 * compiled one.
+		 *
+		 * If \a cacheFile is not empty, the compiled suite is loaded
+		 * from it if it's up to date; otherwise it's written there.
+		 *
+		 * Returns true if at least one opening was compiled.
+		 */
+		bool compile(const QString& variant,
+			     int maxPlies,
+			     const QString& cacheFile = QString());
+		/*! Returns true if the suite has been compiled. */
+		bool isCompiled() const;
+		/*! Returns the number of compiled openings. */
+		int openingCount() const;
+		/*!
+		 * Returns the problems found by the last compile(), one
+		 * per line, or an empty string if there were none.
+		 *
+		 * Only the first broken openings are listed, followed by
+		 * the number of broken openings that were skipped.
+		 */
+		QString errorString() const;
+		/*!
+		 * Returns the next compiled opening.
+		 *
+		 * \note The suite must be compiled.
+		 */
+		Opening nextOpening();
+
 	private:
 		struct FilePosition
 		{
@@ -115,6 +176,17 @@ class LIB_EXPORT OpeningSuite
 
 		FilePosition getPgnPos();
 		FilePosition getEpdPos();
+		bool readCache(const QString& fileName, const QString& variant,
+			       int maxPlies);
+		bool writeCache(const QString& fileName, const QString& variant,
+				int maxPlies) const;
+		bool addOpening(Chess::Board* board, const QString& fen,
+				const QVector<Chess::GenericMove>& moves,
+				int maxPlies, QString* error);
+		void orderOpenings();
+		void addError(const QString& message);
+		void reportBrokenOpening(int number, int broken,
+					 const QString& error);
 
 		Format m_format;
 		Order m_order;
@@ -127,6 +199,18 @@ class LIB_EXPORT OpeningSuite
 		QTextStream* m_epdStream;
 		PgnStream* m_pgnStream;
 		QVector<FilePosition> m_filePositions;
+
+		// Compiled openings: opening i has the FEN string at index
+		// m_openingFens[i] and the moves from m_openingMoves[i] to
+		// m_openingMoves[i + 1]. m_openingSources[i] is its index
+		// in the file.
+		QStringList m_fens;
+		QVector<int> m_openingFens;
+		QVector<int> m_openingMoves;
+		QVector<int> m_openingSources;
+		QVector<Chess::Move> m_moves;
+		QVector<int> m_openingOrder;
+		QStringList m_errors;
 };
 
 #endif // OPENINGSUITE_H
@@ -0,0 +1,136 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "positionindex.h"
+#include <QtEndian>
+
+
+PositionIndex::PositionIndex()
+	: m_records(nullptr),
+	  m_postingCount(0),
+	  m_gameCount(0)
+{
+}
+
+PositionIndex::~PositionIndex()
+{
+	close();
+}
+
+bool PositionIndex::open(const QString& fileName)
+{
+	close();
+
+	m_file.setFileName(fileName);
+	if (!m_file.open(QIODevice::ReadOnly))
+		return setError(tr("Can't open position index %1: %2")
+				.arg(fileName, m_file.errorString()));
+
+	const qint64 size = m_file.size();
+	const uchar* data = size >= HeaderSize ? m_file.map(0, size) : nullptr;
+	if (data == nullptr
+	||  qFromLittleEndian<quint32>(data) != Magic
+	||  qFromLittleEndian<quint32>(data + 4) != Version)
+	{
+		close();
+		return setError(tr("%1 is not a position index").arg(fileName));
+	}
+
+	const quint64 count = qFromLittleEndian<quint64>(data + 16);
+	if (count != quint64(size - HeaderSize) / RecordSize)
+	{
+		close();
+		return setError(tr("Position index %1 is truncated").arg(fileName));
+	}
+
+	m_records = data + HeaderSize;
+	m_postingCount = qint64(count);
+	m_gameCount = qFromLittleEndian<quint32>(data + 8);
+
+	return true;
+}
+
+void PositionIndex::close()
+{
+	// Closing the file also unmaps it
+	m_file.close();
+	m_records = nullptr;
+	m_postingCount = 0;
+	m_gameCount = 0;
+}
+
+bool PositionIndex::isOpen() const
+{
+	return m_records != nullptr;
+}
+
+quint32 PositionIndex::gameCount() const
+{
+	return m_gameCount;
+}
+
+qint64 PositionIndex::postingCount() const
+{
+	return m_postingCount;
+}
+
+QString PositionIndex::errorString() const
+{
+	return m_error;
+}
+
+bool PositionIndex::setError(const QString& message)
+{
+	m_error = message;
+	return false;
+}
+
+quint64 PositionIndex::keyAt(qint64 index) const
+{
+	return qFromLittleEndian<quint64>(m_records + index * RecordSize);
+}
+
+quint32 PositionIndex::gameAt(qint64 index) const
+{
+	return qFromLittleEndian<quint32>(m_records + index * RecordSize + 8);
+}
+
+QVector<quint32> PositionIndex::find(quint64 key) const
+{
+	QVector<quint32> games;
+
+	// Find the first posting for the key
+	qint64 first = 0;
+	qint64 count = m_postingCount;
+	while (count > 0)
+	{
+		const qint64 step = count / 2;
+		if (keyAt(first + step) < key)
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+			count = step;
+	}
+
+	for (qint64 i = first; i < m_postingCount && keyAt(i) == key; i++)
+		games.append(gameAt(i));
+
+	return games;
+}
@@ -0,0 +1,98 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POSITIONINDEX_H
+#define POSITIONINDEX_H
+
+#include <QFile>
+#include <QVector>
+#include <QCoreApplication>
+
+/*!
+ * \brief A memory-mapped index from positions to games
+ *
+ * A position index maps the Zobrist key of every position that
+ * occurs in a game collection to the numbers of the games it occurs
+ * in. The index file is written by PositionIndexWriter.
+ *
+ * The file starts with a 24-byte header: a magic number, the format
+ * version and the number of games as little-endian 32-bit integers,
+ * 4 reserved bytes and the number of postings as a 64-bit integer.
+ * The postings follow as 12-byte records: a 64-bit position key and a
+ * 32-bit game number, both little-endian. The records are sorted by
+ * key and then by game number, with no duplicates.
+ *
+ * The file is mapped into memory when it's opened, so a lookup is a
+ * binary search that touches only a few pages of the file no matter
+ * how large the collection is.
+ */
+class LIB_EXPORT PositionIndex
+{
+	Q_DECLARE_TR_FUNCTIONS(PositionIndex)
+
+	public:
+		/*! The magic number at the start of the file. */
+		static const quint32 Magic = 0x58444950;
+		/*! The version of the file format. */
+		static const quint32 Version = 1;
+		/*! The size of the file header in bytes. */
+		static const int HeaderSize = 24;
+		/*! The size of a posting record in bytes. */
+		static const int RecordSize = 12;
+
+		/*! Creates a new index reader. */
+		PositionIndex();
+		/*! Closes the index. */
+		~PositionIndex();
+
+		/*! Opens and maps \a fileName. Returns true if successful. */
+		bool open(const QString& fileName);
+		/*! Closes the index. */
+		void close();
+		/*! Returns true if the index is open. */
+		bool isOpen() const;
+
+		/*! Returns the number of games in the indexed collection. */
+		quint32 gameCount() const;
+		/*! Returns the number of (position, game) postings. */
+		qint64 postingCount() const;
+
+		/*!
+		 * Returns the numbers of the games in which the position
+		 * with Zobrist key \a key occurs, in ascending order.
+		 */
+		QVector<quint32> find(quint64 key) const;
+
+		/*! Returns a description of the last error. */
+		QString errorString() const;
+
+	private:
+		Q_DISABLE_COPY(PositionIndex)
+
+		quint64 keyAt(qint64 index) const;
+		quint32 gameAt(qint64 index) const;
+		bool setError(const QString& message);
+
+		QFile m_file;
+		const uchar* m_records;
+		qint64 m_postingCount;
+		quint32 m_gameCount;
+		QString m_error;
+};
+
+#endif // POSITIONINDEX_H
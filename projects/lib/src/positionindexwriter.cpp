@@ -0,0 +1,322 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "positionindexwriter.h"
+#include <algorithm>
+#include <queue>
+#include <vector>
+#include <QPair>
+#include <QTemporaryFile>
+#include <QtEndian>
+#include "pgngame.h"
+#include "positionindex.h"
+
+namespace {
+
+const int s_bufferSize = 1 << 16;
+
+void appendRecord(QByteArray& data, quint64 key, quint32 game)
+{
+	uchar record[PositionIndex::RecordSize];
+	qToLittleEndian<quint64>(key, record);
+	qToLittleEndian<quint32>(game, record + 8);
+	data.append(reinterpret_cast<const char*>(record), sizeof(record));
+}
+
+} // anonymous namespace
+
+bool PositionIndexWriter::Posting::operator<(const Posting& other) const
+{
+	if (key != other.key)
+		return key < other.key;
+	return game < other.game;
+}
+
+bool PositionIndexWriter::Posting::operator==(const Posting& other) const
+{
+	return key == other.key && game == other.game;
+}
+
+/*! Reads the postings of a sorted run one buffer at a time. */
+class PositionIndexWriter::RunReader
+{
+	public:
+		explicit RunReader(QTemporaryFile* file)
+			: m_file(file),
+			  m_pos(0)
+		{
+			m_file->seek(0);
+		}
+
+		bool next(Posting* posting)
+		{
+			if (m_pos >= m_data.size())
+			{
+				m_data = m_file->read(s_bufferSize
+						      * PositionIndex::RecordSize);
+				m_pos = 0;
+				if (m_data.size() < PositionIndex::RecordSize)
+					return false;
+			}
+
+			const uchar* record = reinterpret_cast<const uchar*>(
+				m_data.constData() + m_pos);
+			posting->key = qFromLittleEndian<quint64>(record);
+			posting->game = qFromLittleEndian<quint32>(record + 8);
+			m_pos += PositionIndex::RecordSize;
+			return true;
+		}
+
+	private:
+		QTemporaryFile* m_file;
+		QByteArray m_data;
+		int m_pos;
+};
+
+PositionIndexWriter::PositionIndexWriter()
+	: m_file(nullptr),
+	  m_runSize(DefaultRunSize),
+	  m_gameCount(0)
+{
+}
+
+PositionIndexWriter::~PositionIndexWriter()
+{
+	discard();
+}
+
+void PositionIndexWriter::setRunSize(int size)
+{
+	Q_ASSERT(size > 0);
+	m_runSize = size;
+}
+
+int PositionIndexWriter::runSize() const
+{
+	return m_runSize;
+}
+
+bool PositionIndexWriter::open(const QString& fileName)
+{
+	discard();
+
+	m_file = new QSaveFile(fileName);
+	if (!m_file->open(QIODevice::WriteOnly))
+	{
+		setError(tr("Can't open position index %1: %2")
+			 .arg(fileName, m_file->errorString()));
+		discard();
+		return false;
+	}
+
+	m_buffer.reserve(qMin(m_runSize, s_bufferSize));
+	return true;
+}
+
+quint32 PositionIndexWriter::gameCount() const
+{
+	return m_gameCount;
+}
+
+QString PositionIndexWriter::errorString() const
+{
+	return m_error;
+}
+
+bool PositionIndexWriter::setError(const QString& message)
+{
+	m_error = message;
+	return false;
+}
+
+void PositionIndexWriter::discard()
+{
+	if (m_file != nullptr)
+	{
+		m_file->cancelWriting();
+		delete m_file;
+		m_file = nullptr;
+	}
+
+	qDeleteAll(m_runs);
+	m_runs.clear();
+	m_buffer.clear();
+	m_gameCount = 0;
+}
+
+bool PositionIndexWriter::addGame(const PgnGame& game)
+{
+	if (m_file == nullptr)
+		return setError(tr("The position index is not open"));
+
+	const quint32 number = m_gameCount++;
+	for (const PgnGame::MoveData& md : game.moves())
+		m_buffer.append(Posting{md.key, number});
+	m_buffer.append(Posting{game.key(), number});
+
+	// A game's postings always end up in the same run, so the runs
+	// can't have postings in common.
+	if (m_buffer.size() >= m_runSize && !spillRun())
+	{
+		discard();
+		return false;
+	}
+	return true;
+}
+
+void PositionIndexWriter::sortBuffer()
+{
+	std::sort(m_buffer.begin(), m_buffer.end());
+	m_buffer.erase(std::unique(m_buffer.begin(), m_buffer.end()),
+		       m_buffer.end());
+}
+
+bool PositionIndexWriter::spillRun()
+{
+	sortBuffer();
+
+	auto run = new QTemporaryFile;
+	m_runs.append(run);
+	if (!run->open())
+		return setError(tr("Can't create a temporary file: %1")
+				.arg(run->errorString()));
+
+	QByteArray data;
+	data.reserve(s_bufferSize * PositionIndex::RecordSize);
+	for (const Posting& posting : qAsConst(m_buffer))
+	{
+		appendRecord(data, posting.key, posting.game);
+		if (data.size() >= s_bufferSize * PositionIndex::RecordSize)
+		{
+			if (run->write(data) != data.size())
+				return setError(run->errorString());
+			data.clear();
+		}
+	}
+	if (run->write(data) != data.size() || !run->flush())
+		return setError(run->errorString());
+
+	m_buffer.clear();
+	return true;
+}
+
+bool PositionIndexWriter::writeData(QByteArray& data)
+{
+	const bool ok = m_file->write(data) == data.size();
+	data.clear();
+	if (!ok)
+		return setError(m_file->errorString());
+	return true;
+}
+
+bool PositionIndexWriter::merge(QByteArray& data, quint64* count)
+{
+	typedef QPair<Posting, int> Head;
+	auto greater = [](const Head& a, const Head& b)
+	{
+		return b.first < a.first;
+	};
+	std::priority_queue<Head, std::vector<Head>, decltype(greater)> heads(greater);
+
+	std::vector<RunReader> readers;
+	readers.reserve(m_runs.size());
+	for (QTemporaryFile* run : qAsConst(m_runs))
+	{
+		readers.emplace_back(run);
+		Posting posting;
+		if (readers.back().next(&posting))
+			heads.push(qMakePair(posting, int(readers.size()) - 1));
+	}
+
+	while (!heads.empty())
+	{
+		const Head head(heads.top());
+		heads.pop();
+
+		appendRecord(data, head.first.key, head.first.game);
+		(*count)++;
+		if (data.size() >= s_bufferSize * PositionIndex::RecordSize
+		&&  !writeData(data))
+			return false;
+
+		Posting posting;
+		if (readers[head.second].next(&posting))
+			heads.push(qMakePair(posting, head.second));
+	}
+
+	return true;
+}
+
+bool PositionIndexWriter::close()
+{
+	if (m_file == nullptr)
+		return setError(tr("The position index is not open"));
+
+	// If all postings fit in one run, they're written without a merge
+	if (m_runs.isEmpty())
+		sortBuffer();
+	else if (!m_buffer.isEmpty() && !spillRun())
+	{
+		discard();
+		return false;
+	}
+
+	QByteArray data;
+	data.reserve(s_bufferSize * PositionIndex::RecordSize);
+	data.fill(0, PositionIndex::HeaderSize);
+	uchar* header = reinterpret_cast<uchar*>(data.data());
+	qToLittleEndian<quint32>(PositionIndex::Magic, header);
+	qToLittleEndian<quint32>(PositionIndex::Version, header + 4);
+	qToLittleEndian<quint32>(m_gameCount, header + 8);
+
+	quint64 count = 0;
+	bool ok = true;
+	if (m_runs.isEmpty())
+	{
+		for (const Posting& posting : qAsConst(m_buffer))
+		{
+			appendRecord(data, posting.key, posting.game);
+			count++;
+			if (data.size() >= s_bufferSize * PositionIndex::RecordSize
+			&&  !(ok = writeData(data)))
+				break;
+		}
+	}
+	else
+		ok = merge(data, &count);
+
+	ok = ok && writeData(data);
+
+	// Fill in the number of postings
+	if (ok)
+	{
+		uchar field[8];
+		qToLittleEndian<quint64>(count, field);
+		ok = m_file->seek(16)
+		  && m_file->write(reinterpret_cast<const char*>(field), 8) == 8;
+		if (!ok)
+			setError(m_file->errorString());
+	}
+
+	if (ok && !m_file->commit())
+		ok = setError(tr("Can't write position index %1: %2")
+			      .arg(m_file->fileName(), m_file->errorString()));
+
+	discard();
+	return ok;
+}
@@ -0,0 +1,116 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POSITIONINDEXWRITER_H
+#define POSITIONINDEXWRITER_H
+
+#include <QList>
+#include <QSaveFile>
+#include <QVector>
+#include <QCoreApplication>
+class QTemporaryFile;
+class PgnGame;
+
+/*!
+ * \brief Builds a position index for a game collection
+ *
+ * Games are added in the order of the collection, and each game is
+ * numbered by its position in that order, starting from zero. Every
+ * position key of a game becomes a posting in the index.
+ *
+ * The postings are collected in memory and sorted in runs of
+ * runSize() postings. Full runs are spilled to temporary files and
+ * merged into the index file by close(), so the memory use doesn't
+ * depend on the size of the collection. The index file is replaced
+ * atomically; if the writer is destroyed without calling close(), an
+ * existing index is left untouched.
+ *
+ * \sa PositionIndex
+ */
+class LIB_EXPORT PositionIndexWriter
+{
+	Q_DECLARE_TR_FUNCTIONS(PositionIndexWriter)
+
+	public:
+		/*! The default number of postings in a sorted run. */
+		static const int DefaultRunSize = 1 << 22;
+
+		/*! Creates a new writer. */
+		PositionIndexWriter();
+		/*! Discards the unfinished index. */
+		~PositionIndexWriter();
+
+		/*!
+		 * Sets the number of postings kept in memory to \a size.
+		 * The default value is DefaultRunSize.
+		 */
+		void setRunSize(int size);
+		/*! Returns the number of postings kept in memory. */
+		int runSize() const;
+
+		/*! Opens \a fileName for writing. Returns true if successful. */
+		bool open(const QString& fileName);
+		/*! Returns the number of games added so far. */
+		quint32 gameCount() const;
+
+		/*!
+		 * Adds the positions of \a game to the index as the next
+		 * game in the collection. Returns true if successful.
+		 *
+		 * A game that couldn't be read should still be added,
+		 * possibly empty, to keep the numbering intact.
+		 */
+		bool addGame(const PgnGame& game);
+		/*!
+		 * Merges the sorted runs into the index file and closes it.
+		 * Returns true if successful.
+		 */
+		bool close();
+
+		/*! Returns a description of the last error. */
+		QString errorString() const;
+
+	private:
+		Q_DISABLE_COPY(PositionIndexWriter)
+
+		struct Posting
+		{
+			quint64 key;
+			quint32 game;
+
+			bool operator<(const Posting& other) const;
+			bool operator==(const Posting& other) const;
+		};
+		class RunReader;
+
+		void sortBuffer();
+		bool spillRun();
+		bool merge(QByteArray& data, quint64* count);
+		bool writeData(QByteArray& data);
+		void discard();
+		bool setError(const QString& message);
+
+		QSaveFile* m_file;
+		QVector<Posting> m_buffer;
+		QList<QTemporaryFile*> m_runs;
+		int m_runSize;
+		quint32 m_gameCount;
+		QString m_error;
+};
+
+#endif // POSITIONINDEXWRITER_H
@@ -22,6 +22,7 @@
 
 class BayesElo;
 class SprtProbability;
+class PairProbability;
 
 class BayesElo
 {
@@ -130,14 +131,157 @@ double SprtProbability::pDraw() const
 }
 
 
+/*
+ * The distribution of game pair scores: the probability of each of the
+ * five possible scores, counted per game (0, 0.25, 0.5, 0.75 and 1).
+ */
+class PairProbability
+{
+	public:
+		static const int Count = 5;
+
+		PairProbability();
+		PairProbability(const int pairs[Count]);
+
+		double p(int i) const;
+		double score(int i) const;
+		double mean() const;
+		double variance() const;
+
+		// Returns the maximum likelihood distribution whose
+		// t-value (mean - 0.5) / sigma is t
+		PairProbability withTValue(double t) const;
+
+	private:
+		static double solveSecular(const double p[Count],
+					   const double x[Count]);
+
+		double m_p[Count];
+};
+
+PairProbability::PairProbability()
+{
+	for (int i = 0; i < Count; i++)
+		m_p[i] = 1.0 / Count;
+}
+
+PairProbability::PairProbability(const int pairs[Count])
+{
+	// Empty classes are given a tiny weight to keep the
+	// distribution regular
+	double n = 0.0;
+	for (int i = 0; i < Count; i++)
+	{
+		m_p[i] = qMax(double(pairs[i]), 1e-3);
+		n += m_p[i];
+	}
+	for (int i = 0; i < Count; i++)
+		m_p[i] /= n;
+}
+
+double PairProbability::p(int i) const
+{
+	return m_p[i];
+}
+
+double PairProbability::score(int i) const
+{
+	return i / double(Count - 1);
+}
+
+double PairProbability::mean() const
+{
+	double mu = 0.0;
+	for (int i = 0; i < Count; i++)
+		mu += m_p[i] * score(i);
+	return mu;
+}
+
+double PairProbability::variance() const
+{
+	const double mu = mean();
+	double var = 0.0;
+	for (int i = 0; i < Count; i++)
+		var += m_p[i] * (score(i) - mu) * (score(i) - mu);
+	return var;
+}
+
+double PairProbability::solveSecular(const double p[Count],
+				     const double x[Count])
+{
+	// Solves sum(p[i] * x[i] / (1 + l * x[i])) = 0 for l. The
+	// function is decreasing on the interval where every
+	// 1 + l * x[i] is positive, so the root is found by bisection.
+	double v = x[0];
+	double w = x[0];
+	for (int i = 1; i < Count; i++)
+	{
+		v = qMin(v, x[i]);
+		w = qMax(w, x[i]);
+	}
+	if (v >= 0.0 || w <= 0.0)
+		return 0.0;
+
+	const double epsilon = 1e-9;
+	double lo = -1.0 / w + epsilon;
+	double hi = -1.0 / v - epsilon;
+	for (int k = 0; k < 100; k++)
+	{
+		const double l = (lo + hi) / 2.0;
+		double f = 0.0;
+		for (int i = 0; i < Count; i++)
+			f += p[i] * x[i] / (1.0 + l * x[i]);
+		if (f > 0.0)
+			lo = l;
+		else
+			hi = l;
+	}
+
+	return (lo + hi) / 2.0;
+}
+
+PairProbability PairProbability::withTValue(double t) const
+{
+	PairProbability mle;
+
+	for (int k = 0; k < 10; k++)
+	{
+		const double mu = mle.mean();
+		const double sigma = std::sqrt(mle.variance());
+
+		double x[Count];
+		for (int i = 0; i < Count; i++)
+		{
+			const double z = (mu - score(i)) / sigma;
+			x[i] = score(i) - 0.5 - t * sigma * (1.0 + z * z) / 2.0;
+		}
+		const double l = solveSecular(m_p, x);
+
+		double change = 0.0;
+		for (int i = 0; i < Count; i++)
+		{
+			const double p = m_p[i] / (1.0 + l * x[i]);
+			change = qMax(change, std::abs(p - mle.m_p[i]));
+			mle.m_p[i] = p;
+		}
+		if (change < 1e-9)
+			break;
+	}
+
+	return mle;
+}
+
+
 Sprt::Sprt()
-	: m_elo0(0),
+	: m_model(Trinomial),
+	  m_elo0(0),
 	  m_elo1(0),
 	  m_alpha(0),
 	  m_beta(0),
 	  m_wins(0),
 	  m_losses(0),
-	  m_draws(0)
+	  m_draws(0),
+	  m_pairs{0, 0, 0, 0, 0}
 {
 }
 
@@ -155,7 +299,36 @@ void Sprt::initialize(double elo0, double elo1,
 	m_beta = beta;
 }
 
+Sprt::Model Sprt::model() const
+{
+	return m_model;
+}
+
+void Sprt::setModel(Model model)
+{
+	m_model = model;
+}
+
 Sprt::Status Sprt::status() const
+{
+	if (m_model == Pentanomial)
+		return pentanomialStatus();
+	return trinomialStatus();
+}
+
+void Sprt::setBounds(Status* status) const
+{
+	// Bounds based on error levels of the test
+	status->lBound = std::log(m_beta / (1.0 - m_alpha));
+	status->uBound = std::log((1.0 - m_beta) / m_alpha);
+
+	if (status->llr > status->uBound)
+		status->result = AcceptH1;
+	else if (status->llr < status->lBound)
+		status->result = AcceptH0;
+}
+
+Sprt::Status Sprt::trinomialStatus() const
 {
 	Status status = {
 		Continue,
@@ -182,15 +355,39 @@ Sprt::Status Sprt::status() const
 		     m_losses * std::log(p1.pLoss() / p0.pLoss()) +
 		     m_draws * std::log(p1.pDraw() / p0.pDraw());
 
-	// Bounds based on error levels of the test
-	status.lBound = std::log(m_beta / (1.0 - m_alpha));
-	status.uBound = std::log((1.0 - m_beta) / m_alpha);
+	setBounds(&status);
+	return status;
+}
 
-	if (status.llr > status.uBound)
-		status.result = AcceptH1;
-	else if (status.llr < status.lBound)
-		status.result = AcceptH0;
+Sprt::Status Sprt::pentanomialStatus() const
+{
+	Status status = {
+		Continue,
+		0.0,
+		0.0,
+		0.0
+	};
+
+	double n = 0.0;
+	for (int i = 0; i < PairProbability::Count; i++)
+		n += qMax(double(m_pairs[i]), 1e-3);
+	if (n < 2.0)
+		return status;
 
+	// Normalized Elo to t-value of a game pair
+	const double tPerElo = std::log(10.0) / 800.0 * std::sqrt(2.0);
+
+	// Maximum likelihood laws under H0 and H1
+	const PairProbability p(m_pairs);
+	const PairProbability p0(p.withTValue(m_elo0 * tPerElo));
+	const PairProbability p1(p.withTValue(m_elo1 * tPerElo));
+
+	// Generalized Log-Likelyhood Ratio
+	for (int i = 0; i < PairProbability::Count; i++)
+		status.llr += p.p(i) * std::log(p1.p(i) / p0.p(i));
+	status.llr *= n;
+
+	setBounds(&status);
 	return status;
 }
 
@@ -203,3 +400,16 @@ void Sprt::addGameResult(GameResult result)
 	else if (result == Loss)
 		m_losses++;
 }
+
+void Sprt::addGamePairResult(GameResult first, GameResult second)
+{
+	if (first == NoResult || second == NoResult)
+		return;
+
+	// Score in half points
+	auto score = [](GameResult result)
+	{
+		return result == Win ? 2 : (result == Draw ? 1 : 0);
+	};
+	m_pairs[score(first) + score(second)]++;
+}
@@ -27,6 +27,13 @@
  * players when the Elo difference is known to be outside of the specified
  * interval.
  *
+ * Two statistical models are supported. The trinomial model treats games
+ * as independent wins, draws and losses. The pentanomial model scores
+ * pairs of games played with the same opening and reversed colors.
+ * The games of a pair are correlated, so the pentanomial model gives a
+ * smaller, more accurate variance and usually reaches a decision with
+ * fewer games.
+ *
  * \sa http://en.wikipedia.org/wiki/Sequential_probability_ratio_test
  */
 class LIB_EXPORT Sprt
@@ -49,6 +56,23 @@ class LIB_EXPORT Sprt
 			Draw		//!< Game was drawn
 		};
 
+		/*! The statistical model of the test. */
+		enum Model
+		{
+			/*!
+			 * Games are independent wins, draws and losses.
+			 * The Elo bounds are BayesElo (default).
+			 */
+			Trinomial,
+			/*!
+			 * Games are played in pairs with the same opening,
+			 * and a pair scores 0, 0.5, 1, 1.5 or 2 points.
+			 * The Elo bounds are normalized Elo and the test is
+			 * a generalized SPRT.
+			 */
+			Pentanomial
+		};
+
 		/*! The status of the test. */
 		struct Status
 		{
@@ -78,6 +102,10 @@ class LIB_EXPORT Sprt
 		 */
 		void initialize(double elo0, double elo1,
 				double alpha, double beta);
+		/*! Returns the statistical model of the test. */
+		Model model() const;
+		/*! Sets the statistical model of the test to \a model. */
+		void setModel(Model model);
 		/*! Returns the current status of the test. */
 		Status status() const;
 		/*!
@@ -87,8 +115,21 @@ class LIB_EXPORT Sprt
 		 * check if H0 or H1 can be accepted.
 		 */
 		void addGameResult(GameResult result);
+		/*!
+		 * Updates the pentanomial statistics with a game pair:
+		 * \a first and \a second are the results of the two games
+		 * played with the same opening.
+		 *
+		 * Only the Pentanomial model uses these statistics.
+		 */
+		void addGamePairResult(GameResult first, GameResult second);
 
 	private:
+		Status trinomialStatus() const;
+		Status pentanomialStatus() const;
+		void setBounds(Status* status) const;
+
+		Model m_model;
 		double m_elo0;
 		double m_elo1;
 		double m_alpha;
@@ -96,6 +137,7 @@ class LIB_EXPORT Sprt
 		int m_wins;
 		int m_losses;
 		int m_draws;
+		int m_pairs[5];
 };
 
 #endif // SPRT_H
@@ -45,7 +45,16 @@ HEADERS += $$PWD/chessengine.h \
     $$PWD/pyramidtournament.h \
     $$PWD/tournamentplayer.h \
     $$PWD/tournamentpair.h \
-    $$PWD/worker.h
+    $$PWD/worker.h \
+    $$PWD/tracer.h \
+    $$PWD/gamearchive.h \
+    $$PWD/gamearchivewriter.h \
+    $$PWD/gameoutputwriter.h \
+    $$PWD/gamearchivereader.h \
+    $$PWD/positionindex.h \
+    $$PWD/positionindexwriter.h \
+    $$PWD/cutesealconnection.h \
+    $$PWD/cutesealsession.h
 SOURCES += $$PWD/chessengine.cpp \
     $$PWD/chessgame.cpp \
     $$PWD/chessplayer.cpp \
@@ -89,7 +98,16 @@ SOURCES += $$PWD/chessengine.cpp \
     $$PWD/pyramidtournament.cpp \
     $$PWD/tournamentplayer.cpp \
     $$PWD/tournamentpair.cpp \
-    $$PWD/worker.cpp
+    $$PWD/worker.cpp \
+    $$PWD/tracer.cpp \
+    $$PWD/gamearchive.cpp \
+    $$PWD/gamearchivewriter.cpp \
+    $$PWD/gameoutputwriter.cpp \
+    $$PWD/gamearchivereader.cpp \
+    $$PWD/positionindex.cpp \
+    $$PWD/positionindexwriter.cpp \
+    $$PWD/cutesealconnection.cpp \
+    $$PWD/cutesealsession.cpp
 win32 { 
     HEADERS += $$PWD/engineprocess_win.h \
 	$$PWD/pipereader_win.h
@@ -378,6 +378,13 @@ int TimeControl::activeTimeLeft() const
 	return m_timeLeft;
 }
 
+qint64 TimeControl::activeTimeElapsed() const
+{
+	if (m_time.isValid())
+		return m_time.nsecsElapsed();
+	return -1;
+}
+
 void TimeControl::readSettings(QSettings* settings)
 {
 	settings->beginGroup("time_control");
@@ -197,6 +197,11 @@ class LIB_EXPORT TimeControl
 		 * state first to verify that it's in the thinking state.
 		 */
 		int activeTimeLeft() const;
+		/*!
+		 * Returns the time in nanoseconds since the clock was
+		 * started, or -1 if it wasn't started.
+		 */
+		qint64 activeTimeElapsed() const;
 
 		/*! Reads time control settings from \a settings. */
 		void readSettings(QSettings* settings);
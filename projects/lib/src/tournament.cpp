@@ -17,6 +17,7 @@
 
 
 #include "tournament.h"
+#include <algorithm>
 #include <QFile>
 #include <QMultiMap>
 #include <QSet>
@@ -31,6 +32,8 @@
 #include "openingbook.h"
 #include "sprt.h"
 #include "elo.h"
+#include "tracer.h"
+#include "gameoutputwriter.h"
 #include <QFileInfo>
 
 Tournament::Tournament(GameManager* gameManager, EngineManager* engineManager,
@@ -55,13 +58,15 @@ Tournament::Tournament(GameManager* gameManager, EngineManager* engineManager,
 	  m_recover(false),
 	  m_pgnCleanup(true),
 	  m_pgnWriteUnfinishedGames(true),
+	  m_streaming(false),
 	  m_finished(false),
 	  m_bookOwnership(false),
 	  m_openingSuite(nullptr),
 	  m_sprt(new Sprt),
+	  m_gamePairs{0, 0, 0, 0, 0},
+	  m_outputWriter(new GameOutputWriter),
 	  m_repetitionCounter(0),
 	  m_swapSides(true),
-	  m_pgnOutMode(PgnGame::Verbose),
 	  m_pair(nullptr),
 	  m_livePgnOutMode(PgnGame::Verbose),
 	  m_pgnFormat(true),
@@ -99,11 +104,7 @@ Tournament::~Tournament()
 	delete m_openingSuite;
 	delete m_sprt;
 
-	if (m_pgnFile.isOpen())
-		m_pgnFile.close();
-
-	if (m_epdFile.isOpen())
-		m_epdFile.close();
+	delete m_outputWriter;
 }
 
 GameManager* Tournament::gameManager() const
@@ -290,12 +291,7 @@ void Tournament::setSeedCount(int seedCount)
 
 void Tournament::setPgnOutput(const QString& fileName, PgnGame::PgnMode mode)
 {
-	if (fileName != m_pgnFile.fileName())
-	{
-		m_pgnFile.close();
-		m_pgnFile.setFileName(fileName);
-	}
-	m_pgnOutMode = mode;
+	m_outputWriter->setPgnOutput(fileName, mode);
 }
 
 void Tournament::setPgnWriteUnfinishedGames(bool enabled)
@@ -310,11 +306,27 @@ void Tournament::setPgnCleanupEnabled(bool enabled)
 
 void Tournament::setEpdOutput(const QString& fileName)
 {
-	if (fileName != m_epdFile.fileName())
-	{
-		m_epdFile.close();
-		m_epdFile.setFileName(fileName);
-	}
+	m_outputWriter->setEpdOutput(fileName);
+}
+
+bool Tournament::setGameArchiveOutput(const QString& fileName, bool moveComments)
+{
+	return m_outputWriter->setGameArchiveOutput(fileName, moveComments);
+}
+
+GameOutputWriter* Tournament::outputWriter() const
+{
+	return m_outputWriter;
+}
+
+void Tournament::setStreamingMode(bool enabled)
+{
+	m_streaming = enabled;
+}
+
+bool Tournament::isStreamingMode() const
+{
+	return m_streaming;
 }
 
 void Tournament::setLivePgnOutput(const QString& fileName, PgnGame::PgnMode mode)
@@ -542,7 +554,7 @@ void Tournament::startGame(TournamentPair* pair)
 		{
 			if (m_openingSuite != nullptr)
 			{
-				if (!game->setMoves(m_openingSuite->nextGame(m_openingDepth)))
+				if (!setOpening(game))
 					qWarning("The opening suite is incompatible with the "
 					"current chess variant");
 			}
@@ -572,7 +584,7 @@ void Tournament::startGame(TournamentPair* pair)
 			m_repetitionCounter = 1;
 			if (m_openingSuite != nullptr)
 			{
-				if (!game->setMoves(m_openingSuite->nextGame(m_openingDepth)))
+				if (!setOpening(game))
 					qWarning("The opening suite is incompatible with the "
 					"current chess variant");
 			}
@@ -672,7 +684,7 @@ void Tournament::skipGame(TournamentPair* pair)
 		{
 			if (m_openingSuite != nullptr)
 			{
-				if (!game->setMoves(m_openingSuite->nextGame(m_openingDepth)))
+				if (!setOpening(game))
 					qWarning("The opening suite is incompatible with the "
 					"current chess variant");
 			}
@@ -702,7 +714,7 @@ void Tournament::skipGame(TournamentPair* pair)
 			m_repetitionCounter = 1;
 			if (m_openingSuite != nullptr)
 			{
-				if (!game->setMoves(m_openingSuite->nextGame(m_openingDepth)))
+				if (!setOpening(game))
 					qWarning("The opening suite is incompatible with the "
 					"current chess variant");
 			}
@@ -819,88 +831,53 @@ bool Tournament::writePgn(PgnGame* pgn, int gameNumber)
 	Q_ASSERT(pgn != nullptr);
 	Q_ASSERT(gameNumber > 0);
 
-	if (m_pgnFile.fileName().isEmpty())
+	if (!m_outputWriter->hasGameOutput())
 		return true;
 
-	bool isOpen = m_pgnFile.isOpen();
-	if (!isOpen || !m_pgnFile.exists())
+	// In streaming mode nothing is held back for reordering
+	if (m_streaming)
 	{
-		if (isOpen)
-		{
-			qWarning("PGN file %s does not exist. Reopening...",
-				 qUtf8Printable(m_pgnFile.fileName()));
-			m_pgnFile.close();
-		}
-
-		if (!m_pgnFile.open(QIODevice::WriteOnly | QIODevice::Append))
-		{
-			qWarning("Could not open PGN file %s",
-				 qUtf8Printable(m_pgnFile.fileName()));
-			return false;
-		}
-		m_pgnOut.setDevice(&m_pgnFile);
+		m_savedGameCount++;
+		if (shouldSaveGame(*pgn, gameNumber))
+			m_outputWriter->writeGame(*pgn, gameNumber);
+		return true;
 	}
 
-	bool ok = true;
+	// Games are handed to the output writer in order. The copies
+	// share their data with the original PgnGame objects.
 	m_pgnGames[gameNumber] = *pgn;
 	while (m_pgnGames.contains(m_savedGameCount + 1))
 	{
 		PgnGame tmp = m_pgnGames.take(++m_savedGameCount);
-		Chess::Result::Type type = tmp.result().type();
-		if (!m_pgnWriteUnfinishedGames
-		&&  (tmp.result().isNone() || (m_stopping && faulty(type))))
-		{
-			qWarning("Omitted incomplete game %d", m_savedGameCount);
-			continue;
-		}
-		if (!tmp.write(m_pgnOut, m_pgnOutMode)
-		||  m_pgnFile.error() != QFile::NoError)
-		{
-			ok = false;
-			qWarning("Could not write PGN game %d", m_savedGameCount);
-		}
+		if (shouldSaveGame(tmp, m_savedGameCount))
+			m_outputWriter->writeGame(std::move(tmp), m_savedGameCount);
 	}
 
-	return ok;
+	return true;
+}
+
+bool Tournament::shouldSaveGame(const PgnGame& pgn, int gameNumber) const
+{
+	Chess::Result::Type type = pgn.result().type();
+	if (!m_pgnWriteUnfinishedGames
+	&&  (pgn.result().isNone() || (m_stopping && faulty(type))))
+	{
+		qWarning("Omitted incomplete game %d", gameNumber);
+		return false;
+	}
+
+	return true;
 }
 
 bool Tournament::writeEpd(ChessGame *game)
 {
 	Q_ASSERT(game != nullptr);
 
-	if (m_epdFile.fileName().isEmpty())
+	if (!m_outputWriter->hasEpdOutput())
 		return true;
 
-	bool isOpen = m_epdFile.isOpen();
-	if (!isOpen || !m_epdFile.exists())
-	{
-		if (isOpen)
-		{
-			qWarning("EPD file %s does not exist. Reopening...",
-				 qUtf8Printable(m_epdFile.fileName()));
-			m_epdFile.close();
-		}
-
-		if (!m_epdFile.open(QIODevice::WriteOnly | QIODevice::Append))
-		{
-			qWarning("Could not open EPD file %s",
-				 qUtf8Printable(m_epdFile.fileName()));
-			return false;
-		}
-		m_epdOut.setDevice(&m_epdFile);
-	}
-
-	const QString& epdPos = game->board()->fenString();
-	m_epdOut << epdPos << "\n";
-	m_epdOut.flush();
-	bool ok = true;
-	if (m_epdFile.error() != QFile::NoError)
-	{
-		ok = false;
-		qWarning("Could not write EPD position");
-	}
-
-	return ok;
+	m_outputWriter->writeEpd(game->board()->fenString());
+	return true;
 }
 
 void Tournament::addScore(int player, int score)
@@ -1008,11 +985,15 @@ void Tournament::onGameFinished(ChessGame* game)
 	if (!m_recover && crashed)
 		stop();
 
-	if (!m_sprt->isNull() && sprtResult != Sprt::NoResult)
+	if (sprtResult != Sprt::NoResult)
 	{
-		m_sprt->addGameResult(sprtResult);
-		if (m_sprt->status().result != Sprt::Continue)
-			QMetaObject::invokeMethod(this, "stop", Qt::QueuedConnection);
+		addGamePairResult(gameNumber, sprtResult);
+		if (!m_sprt->isNull())
+		{
+			m_sprt->addGameResult(sprtResult);
+			if (m_sprt->status().result != Sprt::Continue)
+				QMetaObject::invokeMethod(this, "stop", Qt::QueuedConnection);
+		}
 	}
 
 	emit gameFinished(game, gameNumber, iWhite, iBlack);
@@ -1032,6 +1013,39 @@ void Tournament::onGameFinished(ChessGame* game)
 	game->deleteLater();
 }
 
+bool Tournament::setOpening(ChessGame* game)
+{
+	if (!m_openingSuite->isCompiled())
+		return game->setMoves(m_openingSuite->nextGame(m_openingDepth));
+
+	// The compiled openings were already checked on a board
+	const OpeningSuite::Opening opening(m_openingSuite->nextOpening());
+	game->setStartingFen(opening.fen);
+	game->setMoves(opening.moves);
+	return true;
+}
+
+void Tournament::addGamePairResult(int gameNumber, Sprt::GameResult result)
+{
+	// Game pairs are only tracked in two-player matches where each
+	// opening is played twice, ie. by games 1 and 2, 3 and 4, etc.
+	if (playerCount() != 2 || m_openingRepetitions != 2)
+		return;
+
+	const int pair = (gameNumber - 1) / 2;
+	if (!m_unpairedResults.contains(pair))
+	{
+		m_unpairedResults.insert(pair, result);
+		return;
+	}
+
+	const Sprt::GameResult first = m_unpairedResults.take(pair);
+	const int score = (first == Sprt::Win ? 2 : first == Sprt::Draw ? 1 : 0)
+			+ (result == Sprt::Win ? 2 : result == Sprt::Draw ? 1 : 0);
+	m_gamePairs[score]++;
+	m_sprt->addGamePairResult(first, result);
+}
+
 void Tournament::onGameDestroyed(ChessGame* game)
 {
 	if (game != m_lastGame)
@@ -1055,6 +1069,7 @@ void Tournament::onGameStartFailed(ChessGame* game)
 void Tournament::onFinished()
 {
 	m_gameManager->cleanupIdleThreads();
+	m_outputWriter->finish();
 	m_finished = true;
 	emit finished();
 }
@@ -1072,6 +1087,8 @@ void Tournament::start()
 
 	m_gameData.clear();
 	m_pgnGames.clear();
+	m_unpairedResults.clear();
+	std::fill(m_gamePairs, m_gamePairs + 5, 0);
 	m_startFen.clear();
 	m_openingMoves.clear();
 	const bool usesBerger = usesBergerSchedule();
@@ -1086,6 +1103,11 @@ void Tournament::start()
 	initializePairing();
 	m_finalGameCount = gamesPerCycle() * gamesPerEncounter() * roundMultiplier();
 
+	if (!m_sprt->isNull() && m_sprt->model() == Sprt::Pentanomial
+	&&  (playerCount() != 2 || m_openingRepetitions != 2))
+		qWarning("The pentanomial SPRT needs a two-player match "
+			 "with every opening played twice");
+
 	if (m_resumeGameNumber)
 	{
 		//m_finishedGameCount = m_resumeGameNumber - 1;
@@ -1145,6 +1167,14 @@ QString Tournament::results() const
 			ret += QString("Elo difference: %1 +/- %2")
 				.arg(elo.diff(), 0, 'f', 2)
 				.arg(elo.errorMargin(), 0, 'f', 2);
+
+			int pairCount = 0;
+			for (int count : m_gamePairs)
+				pairCount += count;
+			if (pairCount > 1)
+				ret += QString(", pentanomial +/- %1 (%2 game pairs)")
+					.arg(Elo::pentanomialErrorMargin(m_gamePairs), 0, 'f', 2)
+					.arg(pairCount);
 			break;
 		}
 
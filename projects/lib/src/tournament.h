@@ -32,12 +32,13 @@
 #include "tournamentplayer.h"
 #include "tournamentpair.h"
 #include "enginemanager.h"
+#include "sprt.h"
 class GameManager;
 class PlayerBuilder;
 class ChessGame;
 class OpeningBook;
 class OpeningSuite;
-class Sprt;
+class GameOutputWriter;
 
 /*!
  * \brief Base class for chess tournaments
@@ -70,6 +71,11 @@ class LIB_EXPORT Tournament : public QObject
 		virtual int gamesPerRound() const = 0;
 		/*! Returns the GameManager that manages the tournament's games. */
 		GameManager* gameManager() const;
+		/*!
+		 * Returns the writer that saves the finished games to the
+		 * PGN, EPD and game archive output files.
+		 */
+		GameOutputWriter* outputWriter() const;
 		/*! Returns the EngineManager that manages the tournament's engines. */
 		EngineManager* engineManager() const;
 		/*! Returns true if the tournament is finished; otherwise returns false. */
@@ -188,6 +194,9 @@ class LIB_EXPORT Tournament : public QObject
 		 * Uses \a suite as the opening suite (a collection of openings)
 		 * for the games.
 		 *
+		 * If \a suite is compiled, the games take their openings
+		 * from the compiled suite.
+		 *
 		 * The tournament takes ownership of \a suite.
 		 */
 		void setOpeningSuite(OpeningSuite* suite);
@@ -230,6 +239,33 @@ class LIB_EXPORT Tournament : public QObject
 		 */
 		void setEpdOutput(const QString& fileName);
 
+		/*!
+		 * Sets the binary game archive output file to \a fileName.
+		 *
+		 * The finished games are appended to the archive in the
+		 * same order and with the same filtering as PGN output. If
+		 * \a moveComments is true the move comments are stored too,
+		 * otherwise only fixed-width move statistics are kept.
+		 *
+		 * Returns false if the archive can't be opened.
+		 * \sa GameArchiveWriter
+		 */
+		bool setGameArchiveOutput(const QString& fileName,
+					  bool moveComments = false);
+		/*!
+		 * Sets streaming mode to \a enabled.
+		 *
+		 * In streaming mode the tournament's memory use doesn't grow
+		 * with the number of games. Finished games are handed to the
+		 * output writer in the order they finish instead of being
+		 * held back until every earlier game has finished, so the
+		 * output files are not necessarily sorted by game number.
+		 * The default value is false.
+		 */
+		void setStreamingMode(bool enabled);
+		/*! Returns true if streaming mode is enabled. */
+		bool isStreamingMode() const;
+
  		/*!
  		 * Sets the live PGN output file for the games to \a fileName.
  		 *
@@ -483,6 +519,7 @@ class LIB_EXPORT Tournament : public QObject
 	private slots:
 		void startNextGame();
 		bool writePgn(PgnGame* pgn, int gameNumber);
+		bool shouldSaveGame(const PgnGame& pgn, int gameNumber) const;
 		bool writeEpd(ChessGame* game);
 		void onGameStarted(ChessGame* game);
 		void onGameFinished(ChessGame* game);
@@ -497,6 +534,9 @@ class LIB_EXPORT Tournament : public QObject
 			int whiteIndex;
 			int blackIndex;
 		};
+		void addGamePairResult(int gameNumber, Sprt::GameResult result);
+		bool setOpening(ChessGame* game);
+
 		struct RankingData
 		{
 			QString name;
@@ -529,19 +569,18 @@ class LIB_EXPORT Tournament : public QObject
 		bool m_recover;
 		bool m_pgnCleanup;
 		bool m_pgnWriteUnfinishedGames;
+		bool m_streaming;
 		bool m_finished;
 		bool m_bookOwnership;
 		GameAdjudicator m_adjudicator;
 		OpeningSuite* m_openingSuite;
 		Sprt* m_sprt;
-		QFile m_pgnFile;
-		QTextStream m_pgnOut;
-		QFile m_epdFile;
-		QTextStream m_epdOut;
+		int m_gamePairs[5];
+		QMap<int, Sprt::GameResult> m_unpairedResults;
+		GameOutputWriter* m_outputWriter;
 		QString m_startFen;
 		int m_repetitionCounter;
 		int m_swapSides;
-		PgnGame::PgnMode m_pgnOutMode;
 		TournamentPair* m_pair;
 		QMap< QPair<int, int>, TournamentPair* > m_pairs;
 		QList<TournamentPlayer> m_players;
@@ -0,0 +1,334 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tracer.h"
+#include <QAtomicPointer>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QFile>
+#include <QThread>
+#include <jsonwriter.h>
+
+namespace {
+
+struct TraceEvent
+{
+	const char* category;
+	const char* name;
+	qint64 time;
+	qint64 duration;	// -1 for instant events
+	QString detail;
+};
+
+/*
+ * Events are appended to fixed-size chunks by the owning thread only.
+ * The number of valid events in a chunk and the link to the next chunk
+ * are published with release semantics, so write() can read a buffer
+ * while its thread keeps appending to it.
+ */
+struct TraceChunk
+{
+	enum { Size = 1024 };
+
+	TraceChunk() : count(0), next(nullptr) {}
+
+	TraceEvent events[Size];
+	QAtomicInt count;
+	QAtomicPointer<TraceChunk> next;
+};
+
+struct ThreadBuffer
+{
+	int threadId;
+	QString threadName;
+	TraceChunk* head;	// first chunk not yet freed by write()
+	TraceChunk* tail;	// chunk the thread appends to
+	ThreadBuffer* next;
+	int written;		// events of head already written
+	bool named;		// thread name already written
+};
+
+QAtomicPointer<ThreadBuffer> s_buffers(nullptr);
+QAtomicInt s_threadCount(0);
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+QMutex s_mutex;
+QElapsedTimer s_timer;
+QString s_fileName;
+bool s_fileStarted = false;
+
+ThreadBuffer* threadBuffer()
+{
+	if (t_buffer != nullptr)
+		return t_buffer;
+
+	ThreadBuffer* buffer = new ThreadBuffer;
+	buffer->threadId = s_threadCount.fetchAndAddRelaxed(1) + 1;
+
+	QThread* thread = QThread::currentThread();
+	QCoreApplication* app = QCoreApplication::instance();
+	if (app != nullptr && thread == app->thread())
+		buffer->threadName = "Main thread";
+	else if (!thread->objectName().isEmpty())
+		buffer->threadName = thread->objectName();
+	else
+		buffer->threadName = QString("Thread %1").arg(buffer->threadId);
+
+	buffer->head = buffer->tail = new TraceChunk;
+	buffer->written = 0;
+	buffer->named = false;
+
+	// The buffers are never freed so that write() can always
+	// read them, even after their threads have finished. Their
+	// chunks are freed by write() once they've been written.
+	ThreadBuffer* head;
+	do
+	{
+		head = s_buffers.loadAcquire();
+		buffer->next = head;
+	} while (!s_buffers.testAndSetOrdered(head, buffer));
+
+	t_buffer = buffer;
+	return buffer;
+}
+
+void appendEvent(const char* category,
+		 const char* name,
+		 qint64 time,
+		 qint64 duration,
+		 const QString& detail)
+{
+	ThreadBuffer* buffer = threadBuffer();
+	TraceChunk* chunk = buffer->tail;
+
+	int count = chunk->count.load();
+	if (count == TraceChunk::Size)
+	{
+		TraceChunk* newChunk = new TraceChunk;
+		chunk->next.storeRelease(newChunk);
+		buffer->tail = chunk = newChunk;
+		count = 0;
+	}
+
+	TraceEvent& event = chunk->events[count];
+	event.category = category;
+	event.name = name;
+	event.time = time;
+	event.duration = duration;
+	event.detail = detail;
+
+	chunk->count.storeRelease(count + 1);
+}
+
+double microseconds(qint64 ns)
+{
+	return double(ns) / 1000.0;
+}
+
+void writeMetadata(JsonWriter& json,
+		   const char* name,
+		   qint64 pid,
+		   int tid,
+		   const QString& value)
+{
+	json.writeStartObject();
+	json.writeMember("name", name);
+	json.writeMember("ph", "M");
+	json.writeMember("pid", pid);
+	json.writeMember("tid", tid);
+	json.writeName("args");
+	json.writeStartObject();
+	json.writeMember("name", value);
+	json.writeEndObject();
+	json.writeEndObject();
+}
+
+void writeEvent(JsonWriter& json,
+		const TraceEvent& event,
+		qint64 pid,
+		int tid)
+{
+	json.writeStartObject();
+	json.writeMember("name", event.name);
+	json.writeMember("cat", event.category);
+	if (event.duration >= 0)
+	{
+		json.writeMember("ph", "X");
+		json.writeMember("dur", microseconds(event.duration));
+	}
+	else
+	{
+		json.writeMember("ph", "i");
+		json.writeMember("s", "t");
+	}
+	json.writeMember("ts", microseconds(event.time));
+	json.writeMember("pid", pid);
+	json.writeMember("tid", tid);
+	if (!event.detail.isEmpty())
+	{
+		json.writeName("args");
+		json.writeStartObject();
+		json.writeMember("detail", event.detail);
+		json.writeEndObject();
+	}
+	json.writeEndObject();
+}
+
+} // anonymous namespace
+
+QAtomicInt Tracer::s_enabled(0);
+
+void Tracer::start(const QString& fileName)
+{
+	QMutexLocker locker(&s_mutex);
+
+	if (fileName != s_fileName)
+		s_fileStarted = false;
+	s_fileName = fileName;
+	if (!s_timer.isValid())
+		s_timer.start();
+	s_enabled.storeRelease(1);
+}
+
+void Tracer::stop()
+{
+	s_enabled.storeRelease(0);
+}
+
+qint64 Tracer::timestamp()
+{
+	if (!isEnabled())
+		return 0;
+	return s_timer.nsecsElapsed();
+}
+
+void Tracer::complete(const char* category,
+		      const char* name,
+		      qint64 startTime,
+		      const QString& detail)
+{
+	if (!isEnabled())
+		return;
+
+	qint64 now = s_timer.nsecsElapsed();
+	appendEvent(category, name, startTime, qMax(now - startTime, qint64(0)), detail);
+}
+
+void Tracer::instant(const char* category,
+		     const char* name,
+		     const QString& detail)
+{
+	if (!isEnabled())
+		return;
+
+	appendEvent(category, name, s_timer.nsecsElapsed(), -1, detail);
+}
+
+bool Tracer::write()
+{
+	QMutexLocker locker(&s_mutex);
+
+	if (s_fileName.isEmpty())
+		return false;
+
+	// The file is a JSON array of events. Each write appends the
+	// events recorded since the previous write by overwriting the
+	// closing bracket, so the file is always a complete document.
+	static const QByteArray s_end("\n]\n");
+
+	QFile file(s_fileName);
+	bool ok = s_fileStarted
+		? file.open(QIODevice::ReadWrite)
+		  && file.seek(qMax(file.size() - s_end.size(), qint64(0)))
+		: file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+	if (!ok)
+	{
+		qWarning("Can't open trace file %s: %s",
+			 qUtf8Printable(s_fileName),
+			 qUtf8Printable(file.errorString()));
+		return false;
+	}
+
+	const qint64 pid = QCoreApplication::applicationPid();
+	QByteArray out;
+	JsonWriter json(&out, JsonWriter::Compact);
+	bool first = !s_fileStarted;
+	auto separate = [&]()
+	{
+		out += first ? "[\n" : ",\n";
+		first = false;
+	};
+
+	if (!s_fileStarted)
+	{
+		separate();
+		writeMetadata(json, "process_name", pid, 0,
+			      QCoreApplication::applicationName());
+	}
+
+	for (ThreadBuffer* buffer = s_buffers.loadAcquire();
+	     buffer != nullptr; buffer = buffer->next)
+	{
+		if (!buffer->named)
+		{
+			separate();
+			writeMetadata(json, "thread_name", pid,
+				      buffer->threadId, buffer->threadName);
+			buffer->named = true;
+		}
+
+		TraceChunk* chunk = buffer->head;
+		for (;;)
+		{
+			const int count = chunk->count.loadAcquire();
+			for (int i = buffer->written; i < count; i++)
+			{
+				separate();
+				writeEvent(json, chunk->events[i], pid,
+					   buffer->threadId);
+			}
+			buffer->written = count;
+
+			// A full chunk with a successor is never touched
+			// by its thread again, so it can be freed.
+			TraceChunk* next = chunk->next.loadAcquire();
+			if (count < TraceChunk::Size || next == nullptr)
+				break;
+			delete chunk;
+			buffer->head = chunk = next;
+			buffer->written = 0;
+		}
+	}
+
+	if (first)
+		return true;
+	out += s_end;
+
+	if (file.write(out) != out.size() || !file.flush())
+	{
+		qWarning("Can't write trace file %s: %s",
+			 qUtf8Printable(s_fileName),
+			 qUtf8Printable(file.errorString()));
+		return false;
+	}
+	s_fileStarted = true;
+
+	return true;
+}
@@ -0,0 +1,164 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QAtomicInt>
+
+/*!
+ * \brief A timeline recorder for harness events
+ *
+ * The Tracer records spans (events with a duration) and instant
+ * events into per-thread buffers and writes them out in the Chrome
+ * Trace Event format, which can be viewed in chrome://tracing or
+ * in the Perfetto UI.
+ *
+ * Each thread appends only to its own buffer, so recording an event
+ * never takes a lock. When tracing is disabled every function returns
+ * after a single atomic load.
+ *
+ * Event categories and names must be string literals (or otherwise
+ * outlive the Tracer) because only the pointers are stored.
+ *
+ * \sa TraceSpan
+ */
+class LIB_EXPORT Tracer
+{
+	public:
+		/*! Returns true if events are being recorded. */
+		static bool isEnabled();
+		/*!
+		 * Starts recording events to be written into \a fileName.
+		 *
+		 * Timestamps are relative to the moment this function
+		 * is first called.
+		 */
+		static void start(const QString& fileName);
+		/*! Stops recording events. Recorded events are kept. */
+		static void stop();
+
+		/*!
+		 * Returns the current trace timestamp in nanoseconds,
+		 * or 0 if tracing is disabled.
+		 */
+		static qint64 timestamp();
+		/*!
+		 * Records a span named \a name in \a category that started
+		 * at \a startTime (as returned by timestamp()) and ends now.
+		 *
+		 * \a detail is stored in the event's arguments.
+		 */
+		static void complete(const char* category,
+				     const char* name,
+				     qint64 startTime,
+				     const QString& detail = QString());
+		/*! Records an instant event named \a name in \a category. */
+		static void instant(const char* category,
+				    const char* name,
+				    const QString& detail = QString());
+
+		/*!
+		 * Writes the events recorded since the previous call to
+		 * the file given to start().
+		 *
+		 * The events are appended to the file, which stays a
+		 * complete JSON array, so this function can be called
+		 * repeatedly, eg. after every game. Written events are
+		 * released from memory. Returns true if successful.
+		 */
+		static bool write();
+
+	private:
+		Tracer();
+
+		static QAtomicInt s_enabled;
+};
+
+/*!
+ * \brief A scoped Tracer span
+ *
+ * TraceSpan records a span from its construction until its
+ * destruction (or until finish() is called). If tracing is disabled
+ * when the span is created nothing is recorded.
+ */
+class LIB_EXPORT TraceSpan
+{
+	public:
+		/*! Starts a span named \a name in \a category. */
+		TraceSpan(const char* category,
+			  const char* name,
+			  const QString& detail = QString());
+		/*! Finishes the span if it hasn't been finished yet. */
+		~TraceSpan();
+
+		/*! Sets the detail string recorded with the span. */
+		void setDetail(const QString& detail);
+		/*! Finishes the span now. */
+		void finish();
+
+	private:
+		Q_DISABLE_COPY(TraceSpan)
+
+		const char* m_category;
+		const char* m_name;
+		qint64 m_startTime;
+		QString m_detail;
+};
+
+inline bool Tracer::isEnabled()
+{
+	return s_enabled.loadAcquire() != 0;
+}
+
+inline TraceSpan::TraceSpan(const char* category,
+			    const char* name,
+			    const QString& detail)
+	: m_category(category),
+	  m_name(name),
+	  m_startTime(-1)
+{
+	if (Tracer::isEnabled())
+	{
+		m_startTime = Tracer::timestamp();
+		m_detail = detail;
+	}
+}
+
+inline TraceSpan::~TraceSpan()
+{
+	finish();
+}
+
+inline void TraceSpan::setDetail(const QString& detail)
+{
+	if (m_startTime >= 0)
+		m_detail = detail;
+}
+
+inline void TraceSpan::finish()
+{
+	if (m_startTime < 0)
+		return;
+
+	Tracer::complete(m_category, m_name, m_startTime, m_detail);
+	m_startTime = -1;
+}
+
+#endif // TRACER_H
@@ -23,6 +23,7 @@
 #include "board/board.h"
 #include "board/boardfactory.h"
 #include "timecontrol.h"
+#include "tracer.h"
 
 #include "enginebuttonoption.h"
 #include "enginecheckoption.h"
@@ -91,8 +92,7 @@ UciEngine::UciEngine(QObject* parent)
 	  m_movesPondered(0),
 	  m_ponderHits(0),
 	  m_ignoreThinking(false),
-	  m_rePing(false),
-	  m_cutesealMoveStartNs(0)
+	  m_rePing(false)
 {
 	addVariant("standard");
 	setName("UciEngine");
@@ -230,7 +230,8 @@ void UciEngine::startThinking()
 	if (m_ponderState == PonderHit)
 	{
 		m_ponderState = NotPondering;
-		write("ponderhit");
+		Tracer::instant("engine", "ponderhit", name());
+		writeClockStart("ponderhit");
 		return;
 	}
 
@@ -250,18 +251,12 @@ void UciEngine::startThinking()
 	else
 		qFatal("Player %s doesn't have a side", qUtf8Printable(name()));
 
-	QString command;
-	if (isCuteseal())
-	{
-		// give deadline for shouting TIMEOUT if the engine doesn't respond with bestmove
-		command = QString("cuteseal-deadline %1 ").arg(int64_t { myTc->timeLeft() + myTc->expiryMargin() } * 1000000);
-	}
-
-	command += "go";
+	QString command("go");
 	if (pondering() && !m_ponderMove.isNull())
 	{
 		command += " ponder";
 		m_ponderState = Pondering;
+		Tracer::instant("engine", "ponder", name());
 	}
 	else
 		m_ponderState = NotPondering;
@@ -288,7 +283,7 @@ void UciEngine::startThinking()
 	if (myTc->nodeLimit() > 0)
 		command += QString(" nodes %1").arg(myTc->nodeLimit());
 
-	write(command);
+	writeClockStart(command);
 }
 
 void UciEngine::startPondering()
@@ -601,51 +596,7 @@ EngineOption* UciEngine::parseOption(const QStringRef& line)
 
 void UciEngine::parseLine(const QString& line)
 {
-	QStringRef command;
-	int64_t localCommandTimeNs = -1;
-
-	if (isCuteseal())
-	{
-		QStringRef lineNum(firstToken(line));
-		QStringRef timeNs(nextToken(lineNum));
-		QStringRef streamToken(nextToken(timeNs));
-
-		localCommandTimeNs = timeNs.toLongLong();
-		command = nextToken(streamToken);
-
-		if (streamToken == "STATUS")
-		{
-			if (command == "TIMEOUT")
-			{
-				forfeit(Chess::Result::Timeout);
-			}
-
-			return;
-		}
-		else if (streamToken == "STDIN")
-		{
-			if (command == "cuteseal-deadline")
-			{
-				// implement move time bookkeeping
-				m_cutesealMoveStartNs = localCommandTimeNs;
-			}
-		}
-		else if (streamToken == "STDOUT" || streamToken == "STDERR")
-		{
-			// nothing here
-		}
-		else
-		{
-			qWarning() << "Bad cuteseal stream token: " << streamToken;
-			return;
-		}
-
-	}
-	else
-	{
-		command = firstToken(line);
-	}
-
+	const QStringRef command(firstToken(line));
 
 	if (command == "info")
 	{
@@ -694,7 +645,9 @@ void UciEngine::parseLine(const QString& line)
 		QStringRef token(nextToken(command));
 		QString moveString(token.toString());
 		m_moveStrings += " " + moveString;
+		TraceSpan validation("engine", "validate move", moveString);
 		Chess::Move move = board()->moveFromString(moveString);
+		validation.finish();
 		if (move.isNull())
 		{
 			forfeit(Chess::Result::IllegalMove, moveString);
@@ -708,15 +661,7 @@ void UciEngine::parseLine(const QString& line)
 			board()->undoMove();
 		}
 
-		if (!isCuteseal())
-		{
-			emitMove(move);
-		}
-		else
-		{
-			int64_t deltaNs = (localCommandTimeNs - m_cutesealMoveStartNs);
-			emitMove(move, (deltaNs + 500000) / 1000000);
-		}
+		emitMove(move, moveTime());
 	}
 	else if (command == "readyok")
 	{
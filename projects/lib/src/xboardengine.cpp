@@ -26,6 +26,7 @@
 #include <climits>
 
 #include "timecontrol.h"
+#include "tracer.h"
 #include "enginebuttonoption.h"
 #include "enginecheckoption.h"
 #include "enginecombooption.h"
@@ -63,6 +64,65 @@ QString variantToXboard(const QString& str)
 
 const int s_infiniteSec = 86400;
 
+enum Keyword
+{
+	UnknownKeyword,
+	MoveKeyword,
+	PongKeyword,
+	FeatureKeyword,
+	WhiteWinsKeyword,
+	BlackWinsKeyword,
+	DrawKeyword,
+	NoResultKeyword,
+	ResignKeyword,
+	IllegalKeyword,
+	ErrorKeyword
+};
+
+struct KeywordSlot
+{
+	const char* name;
+	Keyword keyword;
+};
+
+/*
+ * Perfect hash table of the keywords that start an engine line. A
+ * token's slot is (4 * length + first char + 7 * last char) % 16 and
+ * no two keywords share a slot, so one comparison finds the keyword.
+ */
+const KeywordSlot s_keywords[16] =
+{
+	{ "move", MoveKeyword },
+	{ "pong", PongKeyword },
+	{ nullptr, UnknownKeyword },
+	{ "0-1", BlackWinsKeyword },
+	{ "*", NoResultKeyword },
+	{ "feature", FeatureKeyword },
+	{ nullptr, UnknownKeyword },
+	{ "Error", ErrorKeyword },
+	{ nullptr, UnknownKeyword },
+	{ "Illegal", IllegalKeyword },
+	{ nullptr, UnknownKeyword },
+	{ "1/2-1/2", DrawKeyword },
+	{ "resign", ResignKeyword },
+	{ "1-0", WhiteWinsKeyword },
+	{ nullptr, UnknownKeyword },
+	{ nullptr, UnknownKeyword }
+};
+
+Keyword keyword(const QStringRef& token)
+{
+	const int length = token.size();
+	const uint hash = 4 * length
+			+ token.at(0).unicode()
+			+ 7 * token.at(length - 1).unicode();
+	const KeywordSlot& slot = s_keywords[hash % 16];
+
+	if (slot.name != nullptr && token == QLatin1String(slot.name))
+		return slot.keyword;
+	return UnknownKeyword;
+}
+
 } // anonymous namespace
 
 XboardEngine::XboardEngine(QObject* parent)
@@ -335,14 +395,20 @@ void XboardEngine::makeMove(const Chess::Move& move)
 			setForceMode(true);
 	}
 
-	moveString = transformMove(moveString, board()->height(), -1);
+	sendMove(moveString);
+	m_nextMove = Chess::Move();
+}
 
+void XboardEngine::sendMove(const QString& moveString, bool startsClock)
+{
+	QString str(transformMove(moveString, board()->height(), -1));
 	if (m_ftUsermove)
-		write("usermove " + moveString);
-	else
-		write(moveString);
+		str.prepend("usermove ");
 
-	m_nextMove = Chess::Move();
+	if (startsClock)
+		writeClockStart(str);
+	else
+		write(str);
 }
 
 void XboardEngine::startThinking()
@@ -350,10 +416,14 @@ void XboardEngine::startThinking()
 	setForceMode(false);
 	sendTimeLeft();
 
+	// The engine's clock starts with 'go' or with the opponent's move
 	if (m_nextMove.isNull())
-		write("go");
+		writeClockStart("go");
 	else
-		makeMove(m_nextMove);
+	{
+		sendMove(m_nextMoveString, true);
+		m_nextMove = Chess::Move();
+	}
 }
 
 void XboardEngine::onTimeout()
@@ -597,182 +667,210 @@ void XboardEngine::parseLine(const QString& line)
 	if (command.isEmpty())
 		return;
 
-	if (command == "1-0" || command == "0-1"
-	||  command == "*" || command == "1/2-1/2" || command == "resign")
+	switch (keyword(command))
 	{
-		if ((state() != Thinking && state() != Observing)
-		||  !board()->result().isNone())
+	case WhiteWinsKeyword:
+	case BlackWinsKeyword:
+	case DrawKeyword:
+	case NoResultKeyword:
+	case ResignKeyword:
+		parseResult(command);
+		return;
+	case MoveKeyword:
+		parseMove(nextToken(command, true));
+		return;
+	case PongKeyword:
+		if (nextToken(command).toInt() == m_lastPing)
+			pong();
+		return;
+	case FeatureKeyword:
+		parseFeatures(nextToken(command, true).toString());
+		return;
+	case ErrorKeyword:
 		{
-			finishGame();
-			return;
+			// If the engine complains about an unknown result command,
+			// we can assume that it's safe to finish the game.
+			const QString args(nextToken(command, true).toString());
+			if (args.section(':', 1).trimmed().startsWith("result"))
+				finishGame();
 		}
+		return;
+	case IllegalKeyword:
+	case UnknownKeyword:
+		break;
+	}
 
-		QString description(nextToken(command, true).toString());
-		if (description.startsWith('{'))
-			description.remove(0, 1);
-		if (description.endsWith('}'))
-			description.chop(1);
-
-		if (command == "*")
-			claimResult(Chess::Result(Chess::Result::NoResult,
-						  Chess::Side::NoSide,
-						  description));
-		else if (command == "1/2-1/2")
+	if (command.at(0).isDigit())
+	{
+		if (!command.contains('.'))	// principal variation
+			parseThinking(command);
+		else
 		{
-			if (state() == Thinking && areClaimsValidated())
-				// The engine claims that its next move will draw the game
-				m_drawOnNextMove = true;
-			else
-				claimResult(Chess::Result(Chess::Result::Draw,
-							  Chess::Side::NoSide,
-							  description));
+			// move format of old CECP engines: 1. ... e2e4
+			const QStringRef args(nextToken(command, true));
+			if (args.startsWith("..."))
+				parseMove(args);
 		}
-		else if ((command == "1-0" && side() == Chess::Side::White)
-		     ||  (command == "0-1" && side() == Chess::Side::Black))
-			claimResult(Chess::Result(Chess::Result::Win,
-						  side(),
-						  description));
-		else
-			forfeit(Chess::Result::Resignation);
+	}
+	else if (command.startsWith("Illegal"))
+	{
+		forfeit(Chess::Result::Adjudication,
+			tr("%1 claims illegal %2")
+			.arg(this->side().toString())
+			.arg(nextToken(command, true).toString()));
+	}
+}
 
+void XboardEngine::parseResult(const QStringRef& command)
+{
+	if ((state() != Thinking && state() != Observing)
+	||  !board()->result().isNone())
+	{
+		finishGame();
 		return;
 	}
-	else if (command.at(0).isDigit()
-	     && !command.contains("."))	// principal variation
+
+	QString description(nextToken(command, true).toString());
+	if (description.startsWith('{'))
+		description.remove(0, 1);
+	if (description.endsWith('}'))
+		description.chop(1);
+
+	if (command == "*")
+		claimResult(Chess::Result(Chess::Result::NoResult,
+					  Chess::Side::NoSide,
+					  description));
+	else if (command == "1/2-1/2")
 	{
-		bool ok = false;
-		int val = 0;
-		QStringRef ref(command);
-		
-		// Search depth
-		QString depth(ref.toString());
-		if (!(depth.cend() - 1)->isDigit())
-			depth.chop(1);
-		m_eval.setDepth(depth.toInt());
-
-		// Evaluation
-		if ((ref = nextToken(ref)).isNull())
-			return;
-		val = ref.toString().toInt(&ok);
-		if (ok)
-		{
-			if (whiteEvalPov() && side() == Chess::Side::Black)
-				val = -val;
-			m_eval.setScore(adaptScore(val));
-		}
+		if (state() == Thinking && areClaimsValidated())
+			// The engine claims that its next move will draw the game
+			m_drawOnNextMove = true;
+		else
+			claimResult(Chess::Result(Chess::Result::Draw,
+						  Chess::Side::NoSide,
+						  description));
+	}
+	else if ((command == "1-0" && side() == Chess::Side::White)
+	     ||  (command == "0-1" && side() == Chess::Side::Black))
+		claimResult(Chess::Result(Chess::Result::Win,
+					  side(),
+					  description));
+	else
+		forfeit(Chess::Result::Resignation);
+}
 
-		// Search time
-		if ((ref = nextToken(ref)).isNull())
-			return;
-		val = ref.toString().toInt(&ok);
-		if (ok)
-			m_eval.setTime(val * 10);
+void XboardEngine::parseThinking(const QStringRef& depth)
+{
+	// Fields: depth, score, time in centiseconds, nodes and the PV.
+	// The numbers are read straight from the line and the PV is
+	// stored as the engine sent it.
+	bool ok = false;
+	QStringRef ref(depth);
+
+	// Search depth, possibly followed by a mark like '.' or '&'
+	if (!ref.at(ref.size() - 1).isDigit())
+		ref.chop(1);
+	m_eval.setDepth(ref.toInt());
+
+	// Evaluation
+	if ((ref = nextToken(depth)).isNull())
+		return;
+	int val = ref.toInt(&ok);
+	if (ok)
+	{
+		if (whiteEvalPov() && side() == Chess::Side::Black)
+			val = -val;
+		m_eval.setScore(adaptScore(val));
+	}
 
-		// Node count
-		if ((ref = nextToken(ref)).isNull())
-			return;
-		unsigned long long node = ref.toString().toULongLong(&ok);
-		if (ok)
-			m_eval.setNodeCount(node);
+	// Search time
+	if ((ref = nextToken(ref)).isNull())
+		return;
+	val = ref.toInt(&ok);
+	if (ok)
+		m_eval.setTime(val * 10);
 
-		// Principal variation
-		if ((ref = nextToken(ref, true)).isNull())
-			return;
-		m_eval.setPv(ref.toString());
+	// Node count
+	if ((ref = nextToken(ref)).isNull())
+		return;
+	const quint64 nodes = ref.toULongLong(&ok);
+	if (ok)
+		m_eval.setNodeCount(nodes);
 
-		emit thinking(m_eval);
+	// Principal variation
+	if ((ref = nextToken(ref, true)).isNull())
+		return;
+	m_eval.setPv(ref.toString());
 
+	emit thinking(m_eval);
+}
+
+void XboardEngine::parseMove(const QStringRef& args)
+{
+	if (state() != Thinking)
+	{
+		if (state() == FinishingGame)
+			finishGame();
+		else
+			qWarning("Unexpected move from %s",
+				 qUtf8Printable(name()));
 		return;
 	}
 
-	// move format of old CECP engines: 1. ... e2e4
-	bool testDigitAndDot = command.at(0).isDigit() && command.contains(".");
+	// remove "..." of old format if necessary
+	const int mark = args.indexOf("...");
+	const QString movestr((mark < 0 ? args : args.mid(4)).toString());
+	const QString newMovestr(transformMove(movestr, board()->height(), +1));
+
+	TraceSpan validation("engine", "validate move", newMovestr);
+	Chess::Move move = board()->moveFromString(newMovestr);
+	validation.finish();
+	if (move.isNull())
+	{
+		forfeit(Chess::Result::IllegalMove, newMovestr);
+		return;
+	}
 
-	const QString args(nextToken(command, true).toString());
-	if (command == "move" || (testDigitAndDot && args.startsWith("...")))
+	if (m_drawOnNextMove)
 	{
-		if (state() != Thinking)
+		m_drawOnNextMove = false;
+		Chess::Result boardResult;
+		board()->makeMove(move);
+		boardResult = board()->result();
+		board()->undoMove();
+
+		// If the engine claimed a draw before this move, the
+		// game must have ended in a draw by now
+		if (!boardResult.isDraw())
 		{
-			if (state() == FinishingGame)
-				finishGame();
-			else
-				qWarning("Unexpected move from %s",
-					 qUtf8Printable(name()));
+			claimResult(Chess::Result(Chess::Result::Draw));
 			return;
 		}
+	}
 
-		// remove "..." of old format if necessary
-		int mark = (args.indexOf("..."));
-		const QString& movestr = mark < 0 ? args : args.mid(4);
-		const QString& newMovestr = transformMove(movestr, board()->height(), +1);
+	emitMove(move, moveTime());
+}
 
-		Chess::Move move = board()->moveFromString(newMovestr);
-		if (move.isNull())
-		{
-			forfeit(Chess::Result::IllegalMove, newMovestr);
-			return;
-		}
+void XboardEngine::parseFeatures(const QString& args)
+{
+	QRegExp rx("\\w+\\s*=\\s*(\"[^\"]*\"|\\d+)");
 
-		if (m_drawOnNextMove)
-		{
-			m_drawOnNextMove = false;
-			Chess::Result boardResult;
-			board()->makeMove(move);
-			boardResult = board()->result();
-			board()->undoMove();
-
-			// If the engine claimed a draw before this move, the
-			// game must have ended in a draw by now
-			if (!boardResult.isDraw())
-			{
-				claimResult(Chess::Result(Chess::Result::Draw));
-				return;
-			}
-		}
+	int pos = 0;
 
-		emitMove(move);
-	}
-	else if (command == "pong")
+	while ((pos = rx.indexIn(args, pos)) != -1)
 	{
-		if (args.toInt() == m_lastPing)
-			pong();
-	}
-	else if (command == "feature")
-	{
-		QRegExp rx("\\w+\\s*=\\s*(\"[^\"]*\"|\\d+)");
-		
-		int pos = 0;
-		
-		while ((pos = rx.indexIn(args, pos)) != -1)
+		QString cap = rx.cap();
+		int index = cap.indexOf('=');
+		if (index != -1)
 		{
-			QString cap = rx.cap();
-			int index = cap.indexOf('=');
-			if (index != -1)
-			{
-				QString feature = cap.left(index).trimmed();
-				QString val = cap.mid(index + 1).trimmed();
-				val.remove('\"');
-
-				setFeature(feature, val);
-			}
+			QString feature = cap.left(index).trimmed();
+			QString val = cap.mid(index + 1).trimmed();
+			val.remove('\"');
 
-			pos += rx.matchedLength();
+			setFeature(feature, val);
 		}
-	}
-	else if (command.startsWith("Illegal"))
-	{
-		forfeit(Chess::Result::Adjudication,
-			tr("%1 claims illegal %2")
-			.arg(this->side().toString())
-			.arg(args));
-	}
-	else if (command == "Error")
-	{
-		// If the engine complains about an unknown result command,
-		// we can assume that it's safe to finish the game.
-		QString str = args.section(':', 1).trimmed();
-		if (str.startsWith("result"))
-			finishGame();
+
+		pos += rx.matchedLength();
 	}
 }
 
@@ -63,10 +63,15 @@ class LIB_EXPORT XboardEngine : public ChessEngine
 	private:
 		EngineOption* parseOption(const QString& line);
 		void setFeature(const QString& name, const QString& val);
+		void parseResult(const QStringRef& command);
+		void parseThinking(const QStringRef& depth);
+		void parseMove(const QStringRef& args);
+		void parseFeatures(const QString& args);
 		void setForceMode(bool enable);
 		void sendTimeLeft();
 		void finishGame();
 		QString moveString(const Chess::Move& move);
+		void sendMove(const QString& moveString, bool startsClock = false);
 		int adaptScore(int score) const;
 		const QString transformMove(const QString& str, int height, int shift) const;
 		
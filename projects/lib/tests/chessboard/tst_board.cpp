@@ -24,6 +24,12 @@ class tst_Board: public QObject
 		void perft_data() const;
 		void perft();
 
+		void pieceCounts_data() const;
+		void pieceCounts();
+
+		void legalMoveCache_data() const;
+		void legalMoveCache();
+
 		void cleanupTestCase();
 	
 	private:
@@ -100,6 +106,45 @@ static quint64 smpPerft(Chess::Board* board, int depth)
 	return nodeCount;
 }
 
+static bool pieceCountsMatch(const Chess::Board* board)
+{
+	QMap<QPair<int, int>, int> counts;
+	QMap<int, unsigned> colors;
+	int total = 0;
+
+	for (int file = 0; file < board->width(); file++)
+	{
+		for (int rank = 0; rank < board->height(); rank++)
+		{
+			const Chess::Square square(file, rank);
+			const Chess::Piece piece(board->pieceAt(square));
+			if (!piece.isValid())
+				continue;
+
+			total++;
+			counts[qMakePair(int(piece.side()), piece.type())]++;
+			colors[piece.type()] |= 1 << square.color();
+		}
+	}
+
+	if (board->pieceCount() != total
+	||  board->pieceSquares().size() != total)
+		return false;
+	for (auto it = counts.constBegin(); it != counts.constEnd(); ++it)
+	{
+		const Chess::Side side(Chess::Side::Type(it.key().first));
+		if (board->pieceCount(side, it.key().second) != it.value())
+			return false;
+	}
+	for (auto it = colors.constBegin(); it != colors.constEnd(); ++it)
+	{
+		if (board->pieceSquareColors(it.key()) != it.value())
+			return false;
+	}
+
+	return true;
+}
+
 
 void tst_Board::zobristKeys_data() const
 {
@@ -1036,6 +1081,26 @@ void tst_Board::perft_data() const
 		<< "3q1bkr/2p1pBp1/q1n3p1/1N2p3/1Pp5/P4Q~2/BBPp1PPP/R2K2NR[RPPn] b - - 0 28"
 		<< 3
 		<< Q_UINT64_C(6386);
+	QTest::newRow("crazyhouse rank check")
+		<< variant
+		<< "4k3/8/8/8/8/8/8/r3K3[QRBNPqrbnp] w - - 0 1"
+		<< 3 // 1 ply: 15, 2 plies: 4550, 3 plies: 947982
+		<< Q_UINT64_C(947982);
+	QTest::newRow("crazyhouse double check")
+		<< variant
+		<< "4k3/8/8/8/8/5n2/8/r3K3[QRBNPqrbnp] w - - 0 1"
+		<< 3 // 1 ply: 2, 2 plies: 626, 3 plies: 153006
+		<< Q_UINT64_C(153006);
+	QTest::newRow("crazyhouse knight check")
+		<< variant
+		<< "4k3/8/8/8/8/3n4/8/4K3[QRBNPqrbnp] w - - 0 1"
+		<< 3 // 1 ply: 4, 2 plies: 1214, 3 plies: 305482
+		<< Q_UINT64_C(305482);
+	QTest::newRow("crazyhouse diagonal check")
+		<< variant
+		<< "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR[Pp] w KQkq - 1 3"
+		<< 4 // 1 ply: 2, 2 plies: 135, 3 plies: 2492, 4 plies: 131807
+		<< Q_UINT64_C(131807);
 
 	variant = "loop";
 	QTest::newRow("loop startpos")
@@ -1048,6 +1113,11 @@ void tst_Board::perft_data() const
 		<< "5R2/2p1Nb2/2B4k/6p1/8/P3PP2/1PPqR3/3R1BKn[QBNPPPPrrrnppp] b - - 1 1"
 		<< 3 // 1 ply:157, 2 plies: 31983, 3 plies: 4144334
 		<< Q_UINT64_C(4144334);
+	QTest::newRow("loop check")
+		<< variant
+		<< "r3k2r/8/8/8/8/8/8/R3K1r1[QBNPPqbnpp] w Qkq - 0 1"
+		<< 3 // 1 ply: 6, 2 plies: 1542, 3 plies: 269915
+		<< Q_UINT64_C(269915);
 
 	variant = "chessgi";
 	QTest::newRow("chessgi startpos")
@@ -1060,6 +1130,16 @@ void tst_Board::perft_data() const
 		<< "5Rp1/2p1Nb2/2B4k/6p1/8/P3PP2/1PPqR3/3R1BKn[QBNPPPPrrrnpp] b - - 1 48"
 		<< 3 // 1 ply:162, 2 plies: 33032, 3 plies: 4493963
 		<< Q_UINT64_C(4493963);
+	QTest::newRow("chessgi diagonal check")
+		<< variant
+		<< "4k3/8/8/8/1b6/8/8/4K3[PPRNpprn] w - - 0 1"
+		<< 3 // 1 ply: 10, 2 plies: 1869, 3 plies: 255947
+		<< Q_UINT64_C(255947);
+	QTest::newRow("chessgi rank check")
+		<< variant
+		<< "4k3/8/8/8/8/8/8/r3K3[PNpn] w - - 0 1"
+		<< 3 // 1 ply: 9, 2 plies: 1176, 3 plies: 88422
+		<< Q_UINT64_C(88422);
 		// TBD sjaakii (/wo dbl steps from first rank) 1 ply:161, 2 plies: 32816, 3 plies: 4434101
 
 	variant = "berolina";
@@ -1230,6 +1310,11 @@ void tst_Board::perft_data() const
 		<< "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR[Nn] w KQkq - 0 1"
 		<< 4 // 4 plies: 3071267, 5 plies: 99614985, 6 plies: 3228439195 
 		<< Q_UINT64_C(3071267);
+	QTest::newRow("pocketknight check")
+		<< variant
+		<< "rnbqk1nr/pppp1ppp/8/4p3/1b6/3P4/PPP1PPPP/RNBQKBNR[Nn] w KQkq - 1 3"
+		<< 4 // 1 ply: 7, 2 plies: 457, 3 plies: 19526, 4 plies: 968096
+		<< Q_UINT64_C(968096);
 
 	variant = "gryphon";
 	QTest::newRow("gryphon startpos")
@@ -1482,5 +1567,109 @@ void tst_Board::perft()
 	QCOMPARE(smpPerft(m_board, depth), nodecount);
 }
 
+void tst_Board::pieceCounts_data() const
+{
+	QTest::addColumn<QString>("variant");
+	QTest::addColumn<QString>("fen");
+
+	QTest::newRow("standard startpos")
+		<< "standard"
+		<< "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+	QTest::newRow("standard promotions and castling")
+		<< "standard"
+		<< "r3k2r/1P4P1/8/3pP3/8/8/1p4p1/R3K2R w KQkq d6 0 1";
+	QTest::newRow("crazyhouse drops")
+		<< "crazyhouse"
+		<< "r1bqk2r/pppp1ppp/2n2n2/4p3/1bB1P3/2N2N2/PPPP1PPP/R1BQK2R[Pp] w KQkq - 0 1";
+	QTest::newRow("capablanca")
+		<< "capablanca"
+		<< "rnabqkbcnr/pppppppppp/10/10/10/10/PPPPPPPPPP/RNABQKBCNR w KQkq - 0 1";
+}
+
+void tst_Board::pieceCounts()
+{
+	QFETCH(QString, variant);
+	QFETCH(QString, fen);
+
+	setVariant(variant);
+	QVERIFY(m_board->setFenString(fen));
+	QVERIFY(pieceCountsMatch(m_board));
+
+	const auto moves = m_board->legalMoves();
+	for (const Chess::Move& move : moves)
+	{
+		m_board->makeMove(move);
+		QVERIFY(pieceCountsMatch(m_board));
+
+		const auto replies = m_board->legalMoves();
+		for (const Chess::Move& reply : replies)
+		{
+			m_board->makeMove(reply);
+			QVERIFY(pieceCountsMatch(m_board));
+			m_board->undoMove();
+		}
+
+		m_board->undoMove();
+		QVERIFY(pieceCountsMatch(m_board));
+	}
+}
+
+void tst_Board::legalMoveCache_data() const
+{
+	QTest::addColumn<QString>("variant");
+	QTest::addColumn<QString>("fen");
+
+	QTest::newRow("standard")
+		<< "standard"
+		<< "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+	QTest::newRow("crazyhouse")
+		<< "crazyhouse"
+		<< "r1bqk2r/pppp1ppp/2n2n2/4p3/1bB1P3/2N2N2/PPPP1PPP/R1BQK2R[Pp] w KQkq - 0 1";
+	QTest::newRow("atomic")
+		<< "atomic"
+		<< "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+}
+
+void tst_Board::legalMoveCache()
+{
+	QFETCH(QString, variant);
+	QFETCH(QString, fen);
+
+	setVariant(variant);
+	QVERIFY(m_board->setFenString(fen));
+
+	const quint64 generations = m_board->legalMoveGenerations();
+	const auto moves = m_board->legalMoves();
+	QCOMPARE(m_board->legalMoveGenerations(), generations + 1);
+
+	for (const Chess::Move& move : moves)
+	{
+		QVERIFY(m_board->isLegalMove(move));
+		const QString san(m_board->moveString(move, Chess::Board::StandardAlgebraic));
+		QCOMPARE(m_board->moveFromString(san), move);
+
+		m_board->makeMove(move);
+		const auto replies = m_board->legalMoves();
+		m_board->undoMove();
+		QCOMPARE(m_board->moveString(move, Chess::Board::StandardAlgebraic), san);
+
+		m_board->makeMove(move);
+		QCOMPARE(m_board->legalMoves(), replies);
+		m_board->undoMove();
+	}
+
+	// Only the positions after each move were generated, and the
+	// starting position stayed cached
+	QCOMPARE(m_board->legalMoves(), moves);
+	QCOMPARE(m_board->legalMoveGenerations(),
+		 generations + 1 + quint64(moves.size()));
+
+	// A new position must not use the old moves
+	QVERIFY(m_board->setFenString(fen));
+	QCOMPARE(m_board->legalMoves(), moves);
+	QCOMPARE(m_board->legalMoveGenerations(),
+		 generations + 2 + quint64(moves.size()));
+}
+
 QTEST_MAIN(tst_Board)
 #include "tst_board.moc"
@@ -0,0 +1,269 @@
+#include <QtTest/QtTest>
+#include <chessengine.h>
+#include <engineconfiguration.h>
+#include <timecontrol.h>
+
+/*
+ * Stands in for the engine process. Written data stays in the write
+ * buffer until drain() is called, like QProcess before the pipe is
+ * writable, and feed() makes engine output available for reading.
+ */
+class FakeDevice : public QIODevice
+{
+	Q_OBJECT
+
+	public:
+		FakeDevice()
+		{
+			open(QIODevice::ReadWrite);
+		}
+
+		virtual bool isSequential() const
+		{
+			return true;
+		}
+
+		virtual qint64 bytesAvailable() const
+		{
+			return m_input.size() + QIODevice::bytesAvailable();
+		}
+
+		virtual qint64 bytesToWrite() const
+		{
+			return m_pending;
+		}
+
+		virtual bool canReadLine() const
+		{
+			return m_input.contains('\n') || QIODevice::canReadLine();
+		}
+
+		// Hands at most \a count buffered bytes to the engine
+		void drain(qint64 count = -1)
+		{
+			if (count < 0 || count > m_pending)
+				count = m_pending;
+			m_pending -= count;
+			emit bytesWritten(count);
+		}
+
+		void feed(const QByteArray& line)
+		{
+			m_input.append(line + "\n");
+			emit readyRead();
+		}
+
+		QByteArray takeLine()
+		{
+			const int i = m_written.indexOf('\n');
+			const QByteArray line(m_written.left(i));
+			m_written.remove(0, i + 1);
+			return line;
+		}
+
+	protected:
+		virtual qint64 readData(char* data, qint64 maxSize)
+		{
+			const qint64 size = qMin(maxSize, qint64(m_input.size()));
+			memcpy(data, m_input.constData(), size_t(size));
+			m_input.remove(0, int(size));
+			return size;
+		}
+
+		virtual qint64 writeData(const char* data, qint64 size)
+		{
+			m_written.append(data, int(size));
+			m_pending += size;
+			return size;
+		}
+
+	private:
+		QByteArray m_input;
+		QByteArray m_written;
+		qint64 m_pending = 0;
+};
+
+/*
+ * Speaks no protocol; the test writes the commands and checks the
+ * move times directly.
+ */
+class TestEngine : public ChessEngine
+{
+	Q_OBJECT
+
+	public:
+		TestEngine(bool cuteseal, const TimeControl& timeControl)
+		{
+			EngineConfiguration config;
+			config.setCuteseal(cuteseal);
+			applyConfiguration(config);
+			setTimeControl(timeControl);
+			setDevice(m_device = new FakeDevice);
+			start();
+			onProtocolStart();
+		}
+
+		FakeDevice* fakeDevice() const
+		{
+			return m_device;
+		}
+
+		QStringList lines;
+
+		virtual QString protocol() const { return "test"; }
+		virtual void makeMove(const Chess::Move& move) { Q_UNUSED(move); }
+		virtual void sendOption(const QString& name, const QVariant& value)
+		{
+			Q_UNUSED(name);
+			Q_UNUSED(value);
+		}
+		virtual void sendQuit() {}
+
+	protected:
+		virtual void startGame() {}
+		virtual void startThinking() {}
+		virtual void startProtocol() {}
+		virtual void parseLine(const QString& line) { lines.append(line); }
+		virtual bool sendPing() { return false; }
+		virtual void sendStop() {}
+
+	private:
+		FakeDevice* m_device;
+};
+
+class tst_ChessEngine: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void localMoveTime();
+		void localPonderhit();
+		void cutesealMoveTime_data() const;
+		void cutesealMoveTime();
+		void cutesealMissingEcho();
+
+	private:
+		static TimeControl finiteTimeControl();
+};
+
+TimeControl tst_ChessEngine::finiteTimeControl()
+{
+	TimeControl tc;
+	tc.setTimePerTc(60000);
+	tc.setTimeLeft(60000);
+	return tc;
+}
+
+void tst_ChessEngine::localMoveTime()
+{
+	TestEngine engine(false, finiteTimeControl());
+	FakeDevice* device = engine.fakeDevice();
+	QCOMPARE(engine.moveTime(), qint64(-1));
+
+	engine.writeClockStart("go");
+	QCOMPARE(device->takeLine(), QByteArray("go"));
+
+	// The time the command waits in the write buffer isn't counted,
+	// nor is a partial write
+	QTest::qSleep(200);
+	device->drain(1);
+	QTest::qSleep(200);
+	device->drain();
+
+	QTest::qSleep(100);
+	device->feed("bestmove e2e4");
+	QCOMPARE(engine.lines, QStringList() << "bestmove e2e4");
+
+	// Neither is the time the harness takes to get to the move
+	QTest::qSleep(200);
+	const qint64 ms = engine.moveTime();
+	QVERIFY2(ms >= 100 && ms < 300, qPrintable(QString::number(ms)));
+
+	// Every move is measured once
+	QCOMPARE(engine.moveTime(), qint64(-1));
+}
+
+void tst_ChessEngine::localPonderhit()
+{
+	TestEngine engine(false, finiteTimeControl());
+	FakeDevice* device = engine.fakeDevice();
+
+	engine.writeClockStart("go ponder");
+	device->drain();
+	QTest::qSleep(100);
+	device->feed("info depth 1");
+
+	// The engine's clock starts with the ponderhit
+	QTest::qSleep(200);
+	engine.writeClockStart("ponderhit");
+	QCOMPARE(device->takeLine(), QByteArray("go ponder"));
+	QCOMPARE(device->takeLine(), QByteArray("ponderhit"));
+	QCOMPARE(engine.moveTime(), qint64(-1));
+	device->drain();
+
+	QTest::qSleep(100);
+	device->feed("bestmove e2e4");
+	const qint64 ms = engine.moveTime();
+	QVERIFY2(ms >= 100 && ms < 300, qPrintable(QString::number(ms)));
+}
+
+void tst_ChessEngine::cutesealMoveTime_data() const
+{
+	QTest::addColumn<bool>("infinite");
+
+	QTest::newRow("deadline") << false;
+	QTest::newRow("no deadline") << true;
+}
+
+void tst_ChessEngine::cutesealMoveTime()
+{
+	QFETCH(bool, infinite);
+
+	TimeControl tc(finiteTimeControl());
+	if (infinite)
+		tc.setInfinity();
+	TestEngine engine(true, tc);
+	FakeDevice* device = engine.fakeDevice();
+
+	engine.writeClockStart("go");
+	const QByteArray command(device->takeLine());
+	QCOMPARE(command.startsWith("cuteseal-deadline "), !infinite);
+	QVERIFY(command.endsWith("go"));
+
+	// The runner's timestamps are used, not the local clock
+	device->drain();
+	device->feed("0 1000000000 STDOUT info string before go");
+	device->feed("1 2000000000 STDIN  " + command);
+	device->feed("2 2100000000 STDOUT info depth 1");
+	QTest::qSleep(100);
+	device->feed("3 2250400000 STDOUT bestmove e2e4");
+
+	QCOMPARE(engine.lines, QStringList()
+		 << "info string before go"
+		 << "info depth 1"
+		 << "bestmove e2e4");
+	QCOMPARE(engine.moveTime(), qint64(250));
+	QCOMPARE(engine.moveTime(), qint64(-1));
+}
+
+void tst_ChessEngine::cutesealMissingEcho()
+{
+	TestEngine engine(true, finiteTimeControl());
+	FakeDevice* device = engine.fakeDevice();
+
+	engine.writeClockStart("go");
+	device->feed("0 1000000000 STDIN  " + device->takeLine());
+	device->feed("1 1500000000 STDOUT bestmove e2e4");
+	QCOMPARE(engine.moveTime(), qint64(500));
+
+	// Without the echo of the new command the previous start is
+	// stale, and the echo of another command doesn't start the clock
+	engine.writeClockStart("go");
+	device->takeLine();
+	device->feed("2 2000000000 STDIN  isready");
+	device->feed("3 2500000000 STDOUT bestmove e2e4");
+	QCOMPARE(engine.moveTime(), qint64(-1));
+}
+
+QTEST_MAIN(tst_ChessEngine)
+#include "tst_chessengine.moc"
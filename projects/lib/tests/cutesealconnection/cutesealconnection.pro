@@ -0,0 +1,5 @@
+include(../tests.pri)
+
+QT += network
+TARGET = tst_cutesealconnection
+SOURCES += tst_cutesealconnection.cpp
@@ -0,0 +1,305 @@
+#include <QtTest/QtTest>
+#include <algorithm>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <cutesealconnection.h>
+#include <cutesealsession.h>
+
+/*
+ * Answers like "cuteseal-remote-runner -d": the input of each session
+ * is echoed as STDIN and STDOUT lines, and "quit" ends the session.
+ */
+class FakeDaemon : public QObject
+{
+	Q_OBJECT
+
+	public:
+		FakeDaemon()
+		{
+			connect(&m_server, SIGNAL(newConnection()),
+				this, SLOT(onNewConnection()));
+		}
+
+		bool listen()
+		{
+			const QString name(QString("tst_cuteseal_%1")
+					   .arg(QCoreApplication::applicationPid()));
+			QLocalServer::removeServer(name);
+			return m_server.listen(name);
+		}
+
+		QString address() const
+		{
+			return "unix:" + m_server.fullServerName();
+		}
+
+		void disconnectClients()
+		{
+			for (QLocalSocket* socket : qAsConst(m_clients))
+				socket->disconnectFromServer();
+			m_clients.clear();
+		}
+
+		QList<QByteArray> commands;
+
+	private slots:
+		void onNewConnection()
+		{
+			while (QLocalSocket* socket = m_server.nextPendingConnection())
+			{
+				m_clients.append(socket);
+				connect(socket, SIGNAL(readyRead()),
+					this, SLOT(onReadyRead()));
+			}
+		}
+
+		void onReadyRead()
+		{
+			QLocalSocket* socket = qobject_cast<QLocalSocket*>(sender());
+			while (socket->canReadLine())
+			{
+				QByteArray line(socket->readLine());
+				line.chop(1);
+				commands.append(line);
+
+				const QList<QByteArray> fields(line.split(' '));
+				const QByteArray id(fields.value(1));
+				if (fields.at(0) == "STATUS")
+					socket->write("* 0 0 STATUS REPORT Daemon alive\n");
+				else if (fields.at(0) == "OPEN")
+					reply(socket, id, "STATUS", "INFO Engine launched");
+				else if (fields.at(0) == "IN")
+				{
+					const QByteArray text(line.mid(id.size() + 4));
+					reply(socket, id, "STDIN ", text);
+					if (text == "quit")
+						reply(socket, id, "STATUS", "CLOSED");
+					else
+						reply(socket, id, "STDOUT", text);
+				}
+				else if (fields.at(0) == "CLOSE")
+					reply(socket, id, "STATUS", "CLOSED");
+			}
+		}
+
+	private:
+		void reply(QLocalSocket* socket,
+			   const QByteArray& id,
+			   const QByteArray& stream,
+			   const QByteArray& line)
+		{
+			qint64& lineNum = m_lineNums[id];
+			socket->write(id + ' ' + QByteArray::number(lineNum++)
+				      + " 0 " + stream + ' ' + line + '\n');
+		}
+
+		QLocalServer m_server;
+		QList<QLocalSocket*> m_clients;
+		QHash<QByteArray, qint64> m_lineNums;
+};
+
+class tst_CutesealConnection: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void init();
+		void cleanup();
+
+		void isAddress_data() const;
+		void isAddress() const;
+		void manySessions();
+		void sessionEnd();
+		void connectionLost();
+		void status();
+		void sharedConnection();
+
+	private:
+		FakeDaemon* m_daemon;
+};
+
+void tst_CutesealConnection::init()
+{
+	m_daemon = new FakeDaemon;
+	QVERIFY(m_daemon->listen());
+}
+
+void tst_CutesealConnection::cleanup()
+{
+	delete m_daemon;
+}
+
+void tst_CutesealConnection::isAddress_data() const
+{
+	QTest::addColumn<QString>("address");
+	QTest::addColumn<bool>("valid");
+
+	QTest::newRow("tcp") << "tcp:9000" << true;
+	QTest::newRow("tcp host") << "tcp:example.org:9000" << true;
+	QTest::newRow("unix") << "unix:/tmp/cuteseal.sock" << true;
+	QTest::newRow("empty tcp") << "tcp:" << false;
+	QTest::newRow("empty unix") << "unix:" << false;
+	QTest::newRow("program") << "/usr/bin/stockfish" << false;
+}
+
+void tst_CutesealConnection::isAddress() const
+{
+	QFETCH(QString, address);
+	QFETCH(bool, valid);
+
+	QCOMPARE(CutesealConnection::isAddress(address), valid);
+}
+
+void tst_CutesealConnection::manySessions()
+{
+	const int sessionCount = 100;
+	const int lineCount = 5;
+
+	CutesealConnection connection;
+	QVERIFY(connection.connectToDaemon(m_daemon->address()));
+
+	QList<CutesealSession*> sessions;
+	QHash<CutesealSession*, QList<QByteArray>> output;
+	for (int i = 0; i < sessionCount; i++)
+	{
+		CutesealSession* session = connection.createSession(&connection);
+		connect(session, &QIODevice::readyRead, [=, &output]()
+		{
+			while (session->canReadLine())
+				output[session].append(session->readLine().trimmed());
+		});
+		QVERIFY(session->start(QString("engine-%1 --flag").arg(i)));
+		sessions.append(session);
+	}
+	QCOMPARE(connection.sessionCount(), sessionCount);
+
+	// Interleave the input of all sessions on the connection
+	for (int j = 0; j < lineCount; j++)
+	{
+		for (int i = 0; i < sessionCount; i++)
+			sessions.at(i)->write(QString("line %1 of %2\n")
+					      .arg(j).arg(i).toLatin1());
+	}
+
+	// Opening line plus STDIN and STDOUT for every input line
+	const int expected = 1 + lineCount * 2;
+	QTRY_VERIFY_WITH_TIMEOUT(
+		std::all_of(sessions.begin(), sessions.end(),
+			    [&](CutesealSession* session)
+			    { return output.value(session).size() == expected; }),
+		10000);
+
+	for (int i = 0; i < sessionCount; i++)
+	{
+		const QList<QByteArray> lines(output.value(sessions.at(i)));
+		QList<QByteArray> stdoutLines;
+		for (int j = 0; j < lines.size(); j++)
+		{
+			// The session gets the runner's framing without the id
+			QVERIFY(lines.at(j).startsWith(QByteArray::number(j) + " 0 "));
+			const int pos = lines.at(j).indexOf("STDOUT ");
+			if (pos != -1)
+				stdoutLines.append(lines.at(j).mid(pos + 7));
+		}
+
+		QCOMPARE(stdoutLines.size(), lineCount);
+		for (int j = 0; j < lineCount; j++)
+			QCOMPARE(stdoutLines.at(j),
+				 QString("line %1 of %2").arg(j).arg(i).toLatin1());
+	}
+
+	QCOMPARE(m_daemon->commands.first(),
+		 QByteArray::number(sessions.first()->id()).prepend("OPEN ")
+		 + " engine-0 --flag");
+}
+
+void tst_CutesealConnection::sessionEnd()
+{
+	CutesealConnection connection;
+	QVERIFY(connection.connectToDaemon(m_daemon->address()));
+
+	CutesealSession* session1 = connection.createSession(&connection);
+	CutesealSession* session2 = connection.createSession(&connection);
+	QVERIFY(session1->start("engine"));
+	QVERIFY(session2->start("engine"));
+
+	// The engine quits on its own
+	QSignalSpy finished1(session1, SIGNAL(readChannelFinished()));
+	session1->write("quit\n");
+	QTRY_COMPARE(finished1.count(), 1);
+	QVERIFY(session1->isFinished());
+	QCOMPARE(connection.sessionCount(), 1);
+
+	// The session is killed
+	QSignalSpy finished2(session2, SIGNAL(readChannelFinished()));
+	session2->close();
+	QVERIFY(session2->isFinished());
+	QCOMPARE(connection.sessionCount(), 0);
+	QTRY_COMPARE(m_daemon->commands.last(),
+		     QByteArray::number(session2->id()).prepend("CLOSE "));
+	QCOMPARE(finished2.count(), 0);
+	QVERIFY(!session2->isOpen());
+}
+
+void tst_CutesealConnection::connectionLost()
+{
+	CutesealConnection connection;
+	QVERIFY(connection.connectToDaemon(m_daemon->address()));
+
+	QList<QSignalSpy*> spies;
+	for (int i = 0; i < 10; i++)
+	{
+		CutesealSession* session = connection.createSession(&connection);
+		QVERIFY(session->start("engine"));
+		spies.append(new QSignalSpy(session,
+					    SIGNAL(readChannelFinished())));
+	}
+
+	QSignalSpy disconnected(&connection, SIGNAL(disconnected()));
+	m_daemon->disconnectClients();
+	QTRY_COMPARE(disconnected.count(), 1);
+
+	QVERIFY(!connection.isConnected());
+	QCOMPARE(connection.sessionCount(), 0);
+	for (QSignalSpy* spy : qAsConst(spies))
+		QCOMPARE(spy->count(), 1);
+	qDeleteAll(spies);
+}
+
+void tst_CutesealConnection::status()
+{
+	CutesealConnection connection;
+	QVERIFY(connection.connectToDaemon(m_daemon->address()));
+
+	QSignalSpy spy(&connection, SIGNAL(statusMessage(QString)));
+	connection.requestStatus();
+	QTRY_COMPARE(spy.count(), 1);
+	QCOMPARE(spy.first().first().toString(),
+		 QString("0 0 STATUS REPORT Daemon alive"));
+}
+
+void tst_CutesealConnection::sharedConnection()
+{
+	const QString address(m_daemon->address());
+
+	CutesealConnection* connection1 = CutesealConnection::connection(address);
+	QVERIFY(connection1 != nullptr);
+	QCOMPARE(CutesealConnection::connection(address), connection1);
+
+	// A lost connection is replaced
+	QSignalSpy disconnected(connection1, SIGNAL(disconnected()));
+	m_daemon->disconnectClients();
+	QTRY_COMPARE(disconnected.count(), 1);
+
+	CutesealConnection* connection2 = CutesealConnection::connection(address);
+	QVERIFY(connection2 != nullptr);
+	QVERIFY(connection2->isConnected());
+
+	QString error;
+	QVERIFY(CutesealConnection::connection("unix:/nonexistent/socket",
+					       &error) == nullptr);
+	QVERIFY(!error.isEmpty());
+}
+
+QTEST_MAIN(tst_CutesealConnection)
+#include "tst_cutesealconnection.moc"
@@ -0,0 +1,16 @@
+include(../tests.pri)
+
+QT += network
+TARGET = tst_cutesealdaemon
+SOURCES += tst_cutesealdaemon.cpp
+
+# The tests talk to the real runner, which is built along with them
+RUNNER_SOURCE = $$PWD/../../../../cuteseal-remote-runner/main.cc
+runner.target = $$OUT_PWD/cuteseal-remote-runner
+runner.commands = $$QMAKE_CXX -Wall -std=c++17 -O2 -o $$runner.target $$RUNNER_SOURCE
+runner.depends = $$RUNNER_SOURCE
+QMAKE_EXTRA_TARGETS += runner
+PRE_TARGETDEPS += $$runner.target
+QMAKE_CLEAN += $$runner.target
+
+DEFINES += CUTESEAL_RUNNER=\\\"$$runner.target\\\"
@@ -0,0 +1,313 @@
+#include <QtTest/QtTest>
+#include <algorithm>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <cutesealconnection.h>
+#include <cutesealsession.h>
+
+/*
+ * Runs "cuteseal-remote-runner -d" on a Unix socket in a temporary
+ * directory. The daemon is stopped when the object is destroyed.
+ */
+class RunnerDaemon
+{
+	public:
+		~RunnerDaemon()
+		{
+			if (m_process.state() != QProcess::NotRunning)
+			{
+				m_process.terminate();
+				m_process.waitForFinished();
+			}
+		}
+
+		bool start(const QByteArray& token)
+		{
+			if (!m_dir.isValid())
+				return false;
+
+			QProcessEnvironment env(QProcessEnvironment::systemEnvironment());
+			env.remove("CUTESEAL_TOKEN");
+			if (!token.isEmpty())
+				env.insert("CUTESEAL_TOKEN", token);
+			m_process.setProcessEnvironment(env);
+			m_process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+			m_process.start(CUTESEAL_RUNNER, QStringList() << "-d" << address());
+
+			// The daemon takes connections once it says so
+			while (m_process.waitForReadyRead(5000))
+			{
+				while (m_process.canReadLine())
+				{
+					if (m_process.readLine().contains("Daemon listening"))
+						return true;
+				}
+			}
+			return false;
+		}
+
+		QString address() const
+		{
+			return "unix:" + m_dir.filePath("daemon.sock");
+		}
+
+	private:
+		QTemporaryDir m_dir;
+		QProcess m_process;
+};
+
+/*
+ * Collects the output lines of cuteseal sessions, optionally without
+ * the echoed input.
+ */
+class SessionOutput : public QObject
+{
+	Q_OBJECT
+
+	public:
+		explicit SessionOutput(bool keepInput = true)
+			: m_keepInput(keepInput)
+		{
+		}
+
+		void watch(CutesealSession* session)
+		{
+			connect(session, SIGNAL(readyRead()),
+				this, SLOT(onReadyRead()));
+		}
+
+		QList<QByteArray> lines(CutesealSession* session) const
+		{
+			return m_lines.value(session);
+		}
+
+		// Returns the text of \a session's lines of \a stream
+		QList<QByteArray> text(CutesealSession* session,
+				       const QByteArray& stream) const
+		{
+			const QByteArray tag(' ' + stream + ' ');
+			QList<QByteArray> text;
+			for (const QByteArray& line : m_lines.value(session))
+			{
+				const int pos = line.indexOf(tag);
+				if (pos != -1)
+					text.append(line.mid(pos + tag.size()));
+			}
+			return text;
+		}
+
+	private slots:
+		void onReadyRead()
+		{
+			CutesealSession* session = qobject_cast<CutesealSession*>(sender());
+			while (session->canReadLine())
+			{
+				const QByteArray line(session->readLine().trimmed());
+				if (m_keepInput || !line.contains(" STDIN "))
+					m_lines[session].append(line);
+			}
+		}
+
+	private:
+		bool m_keepInput;
+		QHash<CutesealSession*, QList<QByteArray>> m_lines;
+};
+
+class tst_CutesealDaemon: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void cleanup();
+
+		void manySessions();
+		void authentication_data() const;
+		void authentication();
+		void stuckEngine();
+};
+
+void tst_CutesealDaemon::cleanup()
+{
+	qunsetenv("CUTESEAL_TOKEN");
+}
+
+void tst_CutesealDaemon::manySessions()
+{
+	const int sessionCount = 100;
+	const int lineCount = 5;
+
+	RunnerDaemon daemon;
+	QVERIFY(daemon.start(QByteArray()));
+
+	CutesealConnection connection;
+	QVERIFY2(connection.connectToDaemon(daemon.address()),
+		 qPrintable(connection.errorString()));
+
+	SessionOutput output;
+	QList<CutesealSession*> sessions;
+	for (int i = 0; i < sessionCount; i++)
+	{
+		CutesealSession* session = connection.createSession(&connection);
+		output.watch(session);
+		QVERIFY(session->start("cat"));
+		sessions.append(session);
+	}
+
+	// Interleave the input of all sessions on the connection
+	for (int j = 0; j < lineCount; j++)
+	{
+		for (int i = 0; i < sessionCount; i++)
+			sessions.at(i)->write(QString("line %1 of %2\n")
+					      .arg(j).arg(i).toLatin1());
+	}
+
+	QTRY_VERIFY_WITH_TIMEOUT(
+		std::all_of(sessions.begin(), sessions.end(),
+			    [&](CutesealSession* session)
+			    {
+				    return output.text(session, "STDOUT").size()
+					   == lineCount;
+			    }),
+		10000);
+
+	for (int i = 0; i < sessionCount; i++)
+	{
+		CutesealSession* session = sessions.at(i);
+
+		// Every session has its own line numbers
+		const QList<QByteArray> lines(output.lines(session));
+		for (int j = 0; j < lines.size(); j++)
+			QVERIFY(lines.at(j).startsWith(QByteArray::number(j) + ' '));
+
+		const QList<QByteArray> input(output.text(session, "STDIN "));
+		const QList<QByteArray> stdoutLines(output.text(session, "STDOUT"));
+		QCOMPARE(input.size(), lineCount);
+		for (int j = 0; j < lineCount; j++)
+		{
+			const QByteArray line(QString("line %1 of %2")
+					      .arg(j).arg(i).toLatin1());
+			QCOMPARE(input.at(j), line);
+			QCOMPARE(stdoutLines.at(j), line);
+		}
+	}
+
+	QSignalSpy spy(&connection, SIGNAL(statusMessage(QString)));
+	connection.requestStatus();
+	QTRY_COMPARE(spy.count(), 1);
+	QVERIFY(spy.first().first().toString().endsWith(
+		QString("REPORT Daemon alive, %1 sessions").arg(sessionCount)));
+
+	// Closed sessions leave the others running
+	for (int i = 0; i < sessionCount; i += 2)
+		sessions.at(i)->close();
+	QCOMPARE(connection.sessionCount(), sessionCount / 2);
+
+	for (int i = 1; i < sessionCount; i += 2)
+		sessions.at(i)->write("last line\n");
+	QTRY_VERIFY_WITH_TIMEOUT(
+		std::all_of(sessions.begin(), sessions.end(),
+			    [&](CutesealSession* session)
+			    {
+				    return session->isFinished()
+					|| output.text(session, "STDOUT").size()
+					   == lineCount + 1;
+			    }),
+		10000);
+	QVERIFY(connection.isConnected());
+}
+
+void tst_CutesealDaemon::authentication_data() const
+{
+	QTest::addColumn<QByteArray>("daemonToken");
+	QTest::addColumn<QByteArray>("clientToken");
+	QTest::addColumn<bool>("accepted");
+
+	QTest::newRow("token") << QByteArray("secret") << QByteArray("secret") << true;
+	QTest::newRow("wrong token") << QByteArray("secret") << QByteArray("secreT") << false;
+	QTest::newRow("short token") << QByteArray("secret") << QByteArray("secre") << false;
+	QTest::newRow("no token") << QByteArray("secret") << QByteArray() << false;
+	QTest::newRow("no daemon token") << QByteArray() << QByteArray("secret") << true;
+}
+
+void tst_CutesealDaemon::authentication()
+{
+	QFETCH(QByteArray, daemonToken);
+	QFETCH(QByteArray, clientToken);
+	QFETCH(bool, accepted);
+
+	RunnerDaemon daemon;
+	QVERIFY(daemon.start(daemonToken));
+
+	if (!clientToken.isEmpty())
+		qputenv("CUTESEAL_TOKEN", clientToken);
+
+	CutesealConnection connection;
+	QSignalSpy status(&connection, SIGNAL(statusMessage(QString)));
+	QSignalSpy disconnected(&connection, SIGNAL(disconnected()));
+	QVERIFY(connection.connectToDaemon(daemon.address()));
+
+	SessionOutput output;
+	CutesealSession* session = connection.createSession(&connection);
+	output.watch(session);
+	QVERIFY(session->start("cat"));
+	session->write("hello\n");
+
+	if (accepted)
+	{
+		QTRY_COMPARE(output.text(session, "STDOUT"),
+			     QList<QByteArray>() << "hello");
+		QVERIFY(connection.isConnected());
+		QCOMPARE(status.count(), 0);
+		return;
+	}
+
+	// The daemon runs nothing for the client and hangs up
+	QTRY_COMPARE(disconnected.count(), 1);
+	QVERIFY(session->isFinished());
+	QVERIFY(output.lines(session).isEmpty());
+	QCOMPARE(status.count(), 1);
+	QVERIFY(status.first().first().toString().endsWith(
+		"STATUS ERROR Authentication failed"));
+}
+
+void tst_CutesealDaemon::stuckEngine()
+{
+	RunnerDaemon daemon;
+	QVERIFY(daemon.start(QByteArray()));
+
+	CutesealConnection connection;
+	QVERIFY(connection.connectToDaemon(daemon.address()));
+
+	// The echo of the stuck engine's input is not kept
+	SessionOutput output(false);
+	CutesealSession* stuck = connection.createSession(&connection);
+	CutesealSession* engine = connection.createSession(&connection);
+	output.watch(stuck);
+	output.watch(engine);
+	QVERIFY(stuck->start("sleep 1000"));
+	QVERIFY(engine->start("cat"));
+
+	// More input than the daemon queues for an engine that never
+	// reads it, while the daemon keeps echoing every line back
+	QSignalSpy finished(stuck, SIGNAL(readChannelFinished()));
+	const QByteArray line(QByteArray(1024 * 1024, 'x') + '\n');
+	for (int i = 0; i < 70; i++)
+		stuck->write(line);
+	engine->write("hello\n");
+
+	QTRY_COMPARE_WITH_TIMEOUT(finished.count(), 1, 30000);
+	QVERIFY(output.text(stuck, "STATUS").contains(
+		"ERROR Engine is not reading its input"));
+	QCOMPARE(output.text(stuck, "STATUS").last(), QByteArray("CLOSED"));
+
+	// The other session on the connection is unaffected
+	QTRY_COMPARE(output.text(engine, "STDOUT"),
+		     QList<QByteArray>() << "hello");
+	engine->write("still here\n");
+	QTRY_COMPARE(output.text(engine, "STDOUT").size(), 2);
+	QVERIFY(connection.isConnected());
+	QCOMPARE(connection.sessionCount(), 1);
+}
+
+QTEST_MAIN(tst_CutesealDaemon)
+#include "tst_cutesealdaemon.moc"
@@ -0,0 +1,300 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <pgngame.h>
+#include <pgnstream.h>
+#include <gamearchive.h>
+#include <gamearchivereader.h>
+#include <gamearchivewriter.h>
+
+static const char s_pgn[] =
+	"[Event \"Test\"]\n"
+	"[Site \"?\"]\n"
+	"[Date \"2018.01.01\"]\n"
+	"[Round \"1\"]\n"
+	"[White \"Alpha\"]\n"
+	"[Black \"Beta\"]\n"
+	"[Result \"1-0\"]\n"
+	"\n"
+	"{Opening} 1. e4 {d=20, wv=0.35, mt=1000, n=123456} "
+	"e5 {d=21, wv=-0.30, mt=2000, n=234567} "
+	"2. Qh5 {d=22, wv=M5, mt=3000, n=345678} "
+	"Nc6 3. Bc4 Nf6 4. Qxf7# {White mates} 1-0\n"
+	"\n"
+	"[Event \"Test\"]\n"
+	"[Site \"?\"]\n"
+	"[Date \"2018.01.01\"]\n"
+	"[Round \"2\"]\n"
+	"[White \"Beta\"]\n"
+	"[Black \"Alpha\"]\n"
+	"[Result \"1/2-1/2\"]\n"
+	"[FEN \"4k3/8/8/8/8/8/4P3/4K3 w - - 0 1\"]\n"
+	"[SetUp \"1\"]\n"
+	"\n"
+	"1. e4 Kd7 2. e5 Ke6 1/2-1/2\n"
+	"\n"
+	"[Event \"Test\"]\n"
+	"[Site \"?\"]\n"
+	"[Date \"2018.01.01\"]\n"
+	"[Round \"3\"]\n"
+	"[White \"Alpha\"]\n"
+	"[Black \"Beta\"]\n"
+	"[Result \"0-1\"]\n"
+	"[FEN \"8/P6k/8/8/8/8/8/K7 w - - 0 1\"]\n"
+	"[SetUp \"1\"]\n"
+	"\n"
+	"1. a8=N Kg6 0-1\n";
+
+class tst_GameArchive: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void moveStats();
+		void moveCodes();
+		void roundTrip();
+		void append();
+		void seek();
+		void missingFooter();
+		void invalidFile();
+
+	private:
+		QString writeArchive(const QString& name, int count);
+		void compareGames(const PgnGame& actual, const PgnGame& expected);
+
+		QTemporaryDir m_dir;
+		QList<PgnGame> m_games;
+};
+
+void tst_GameArchive::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+
+	const QByteArray data(s_pgn);
+	PgnStream in(&data);
+	PgnGame game;
+	while (game.read(in))
+		m_games.append(game);
+	QCOMPARE(m_games.size(), 3);
+}
+
+QString tst_GameArchive::writeArchive(const QString& name, int count)
+{
+	const QString fileName(m_dir.filePath(name));
+	QFile::remove(fileName);
+
+	GameArchiveWriter writer;
+	writer.setMoveCommentsEnabled(true);
+	if (!writer.open(fileName))
+		return QString();
+	for (int i = 0; i < count; i++)
+	{
+		if (!writer.write(m_games.at(i % m_games.size())))
+			return QString();
+	}
+	if (!writer.close())
+		return QString();
+
+	return fileName;
+}
+
+void tst_GameArchive::compareGames(const PgnGame& actual,
+				   const PgnGame& expected)
+{
+	QCOMPARE(actual.tags(), expected.tags());
+	QCOMPARE(actual.initialComment(), expected.initialComment());
+	QCOMPARE(actual.startingSide(), expected.startingSide());
+	QCOMPARE(actual.moves().size(), expected.moves().size());
+
+	for (int i = 0; i < expected.moves().size(); i++)
+	{
+		const PgnGame::MoveData& a = actual.moves().at(i);
+		const PgnGame::MoveData& b = expected.moves().at(i);
+		QCOMPARE(a.move, b.move);
+		QCOMPARE(a.moveString, b.moveString);
+		QCOMPARE(a.key, b.key);
+		QCOMPARE(a.comment, b.comment);
+	}
+}
+
+void tst_GameArchive::moveStats()
+{
+	auto stats = GameArchive::parseMoveStats("d=20, wv=0.35, mt=1000, n=123456");
+	QCOMPARE(stats.depth, quint16(20));
+	QCOMPARE(stats.score, qint32(35));
+	QCOMPARE(stats.time, quint32(1000));
+	QCOMPARE(stats.nodes, quint64(123456));
+
+	stats = GameArchive::parseMoveStats("wv=-M7");
+	QCOMPARE(stats.score, qint32(-(GameArchive::MateScore - 7)));
+
+	stats = GameArchive::parseMoveStats("book");
+	QCOMPARE(stats.score, GameArchive::NoScore);
+	QCOMPARE(stats.depth, quint16(0));
+}
+
+void tst_GameArchive::moveCodes()
+{
+	const Chess::GenericMove normal(Chess::Square(4, 1),
+					Chess::Square(4, 3), 0);
+	const Chess::GenericMove promotion(Chess::Square(0, 6),
+					   Chess::Square(0, 7), 2);
+	const Chess::GenericMove drop(Chess::Square(),
+				      Chess::Square(3, 4), 5);
+
+	for (const auto& move : { normal, promotion, drop })
+	{
+		QCOMPARE(GameArchive::decodeMove(
+			 GameArchive::encodeMove(move, 8, false), 8, false), move);
+		QCOMPARE(GameArchive::decodeMove(
+			 GameArchive::encodeMove(move, 10, true), 10, true), move);
+	}
+
+	QVERIFY(!GameArchive::needsWideMoves(8, 8));
+	QVERIFY(GameArchive::needsWideMoves(10, 8));
+}
+
+void tst_GameArchive::roundTrip()
+{
+	const QString fileName(writeArchive("roundtrip.ccga", m_games.size()));
+	QVERIFY(!fileName.isEmpty());
+	QVERIFY(GameArchive::isArchive(fileName));
+
+	GameArchiveReader reader;
+	QVERIFY(reader.open(fileName));
+	QVERIFY(reader.hasFooter());
+	QCOMPARE(reader.gameCount(), m_games.size());
+
+	PgnGame game;
+	QVector<GameArchive::MoveStats> stats;
+	for (const PgnGame& expected : qAsConst(m_games))
+	{
+		QVERIFY(reader.readNext(game, &stats));
+		compareGames(game, expected);
+		QCOMPARE(stats.size(), expected.moves().size());
+	}
+	QVERIFY(reader.atEnd());
+	QVERIFY(!reader.readNext(game));
+	QVERIFY(reader.errorString().isEmpty());
+
+	reader.seek(0);
+	QVERIFY(reader.readNext(game, &stats));
+	QCOMPARE(stats.at(0).depth, quint16(20));
+	QCOMPARE(stats.at(1).score, qint32(-30));
+	QCOMPARE(stats.at(2).score, qint32(GameArchive::MateScore - 5));
+	QCOMPARE(stats.at(3).score, GameArchive::NoScore);
+}
+
+void tst_GameArchive::append()
+{
+	const QString fileName(writeArchive("append.ccga", 2));
+	QVERIFY(!fileName.isEmpty());
+
+	GameArchiveWriter writer;
+	writer.setMoveCommentsEnabled(true);
+	QVERIFY(writer.open(fileName));
+	QCOMPARE(writer.gameCount(), 2);
+	QVERIFY(writer.write(m_games.at(2)));
+	QVERIFY(writer.close());
+
+	GameArchiveReader reader;
+	QVERIFY(reader.open(fileName));
+	QCOMPARE(reader.gameCount(), 3);
+
+	PgnGame game;
+	for (const PgnGame& expected : qAsConst(m_games))
+	{
+		QVERIFY(reader.readNext(game));
+		compareGames(game, expected);
+	}
+}
+
+void tst_GameArchive::seek()
+{
+	const QString fileName(writeArchive("seek.ccga", 30));
+	QVERIFY(!fileName.isEmpty());
+
+	GameArchiveReader reader;
+	QVERIFY(reader.open(fileName));
+	QCOMPARE(reader.gameCount(), 30);
+
+	PgnGame game;
+	for (int i : { 29, 0, 13, 14 })
+	{
+		QVERIFY(reader.seek(i));
+		QCOMPARE(reader.currentGame(), i);
+		QVERIFY(reader.readNext(game));
+		compareGames(game, m_games.at(i % m_games.size()));
+	}
+	QVERIFY(!reader.seek(31));
+}
+
+void tst_GameArchive::missingFooter()
+{
+	const QString fileName(m_dir.filePath("nofooter.ccga"));
+	QFile::remove(fileName);
+
+	// Simulate a crash in the middle of writing the last record
+	qint64 size = 0;
+	{
+		GameArchiveWriter writer;
+		writer.setMoveCommentsEnabled(true);
+		QVERIFY(writer.open(fileName));
+		QVERIFY(writer.write(m_games.at(0)));
+		QVERIFY(writer.write(m_games.at(1)));
+		size = QFileInfo(fileName).size();
+		QVERIFY(writer.write(m_games.at(2)));
+		QVERIFY(writer.close());
+	}
+
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadWrite));
+	QVERIFY(file.resize(size + 10));
+	file.close();
+
+	GameArchiveReader reader;
+	QVERIFY(reader.open(fileName));
+	QVERIFY(!reader.hasFooter());
+	QCOMPARE(reader.gameCount(), 2);
+
+	PgnGame game;
+	QVERIFY(reader.readNext(game));
+	compareGames(game, m_games.at(0));
+	reader.close();
+
+	// Appending drops the partial record
+	GameArchiveWriter writer;
+	writer.setMoveCommentsEnabled(true);
+	QVERIFY(writer.open(fileName));
+	QCOMPARE(writer.gameCount(), 2);
+	QVERIFY(writer.write(m_games.at(2)));
+	QVERIFY(writer.close());
+
+	QVERIFY(reader.open(fileName));
+	QVERIFY(reader.hasFooter());
+	QCOMPARE(reader.gameCount(), 3);
+	QVERIFY(reader.seek(2));
+	QVERIFY(reader.readNext(game));
+	compareGames(game, m_games.at(2));
+}
+
+void tst_GameArchive::invalidFile()
+{
+	const QString fileName(m_dir.filePath("invalid.pgn"));
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	file.write(s_pgn);
+	file.close();
+
+	QVERIFY(!GameArchive::isArchive(fileName));
+
+	GameArchiveReader reader;
+	QVERIFY(!reader.open(fileName));
+	QVERIFY(!reader.errorString().isEmpty());
+
+	GameArchiveWriter writer;
+	QVERIFY(!writer.open(fileName));
+}
+
+QTEST_MAIN(tst_GameArchive)
+#include "tst_gamearchive.moc"
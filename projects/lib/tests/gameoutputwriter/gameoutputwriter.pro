@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_gameoutputwriter
+SOURCES += tst_gameoutputwriter.cpp
@@ -0,0 +1,177 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <QProcess>
+#include <QStandardPaths>
+#include <pgngame.h>
+#include <pgnstream.h>
+#include <gameoutputwriter.h>
+
+class tst_GameOutputWriter: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void order();
+		void epd();
+		void smallQueue();
+		void gzip();
+
+	private:
+		PgnGame game(int round) const;
+		QList<PgnGame> readGames(const QByteArray& data) const;
+
+		QTemporaryDir m_dir;
+		PgnGame m_game;
+};
+
+void tst_GameOutputWriter::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+
+	const QByteArray data("[Event \"Test\"]\n"
+			      "[Round \"1\"]\n"
+			      "[White \"Alpha\"]\n"
+			      "[Black \"Beta\"]\n"
+			      "[Result \"1-0\"]\n\n"
+			      "1. e4 e5 2. Qh5 Nc6 3. Bc4 Nf6 4. Qxf7# 1-0\n");
+	PgnStream in(&data);
+	QVERIFY(m_game.read(in));
+}
+
+PgnGame tst_GameOutputWriter::game(int round) const
+{
+	PgnGame tmp(m_game);
+	tmp.setTag("Round", QString::number(round));
+	return tmp;
+}
+
+QList<PgnGame> tst_GameOutputWriter::readGames(const QByteArray& data) const
+{
+	QList<PgnGame> games;
+	PgnStream in(&data);
+	PgnGame tmp;
+	while (tmp.read(in))
+		games.append(tmp);
+	return games;
+}
+
+void tst_GameOutputWriter::order()
+{
+	const QString fileName(m_dir.filePath("order.pgn"));
+	const int count = 100;
+	{
+		GameOutputWriter writer;
+		writer.setPgnOutput(fileName);
+		writer.setSyncPolicy(GameOutputWriter::BatchSync);
+		QVERIFY(writer.hasGameOutput());
+		QVERIFY(!writer.hasEpdOutput());
+
+		for (int i = 1; i <= count; i++)
+			writer.writeGame(game(i), i);
+		writer.flush();
+
+		const auto stats = writer.stats();
+		QCOMPARE(stats.gameCount, count);
+		QCOMPARE(stats.queueDepth, 0);
+		QVERIFY(stats.batchCount >= 1);
+		QVERIFY(stats.batchCount <= count);
+		QVERIFY(stats.maxQueueDepth >= 1);
+		QVERIFY(stats.maxQueueDepth <= GameOutputWriter::DefaultQueueCapacity);
+	}
+
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	const auto games = readGames(file.readAll());
+	QCOMPARE(games.size(), count);
+	for (int i = 0; i < count; i++)
+	{
+		QCOMPARE(games.at(i).round(), i + 1);
+		QCOMPARE(games.at(i).moves().size(), m_game.moves().size());
+	}
+}
+
+void tst_GameOutputWriter::epd()
+{
+	const QString fileName(m_dir.filePath("positions.epd"));
+	const QStringList positions = QStringList()
+		<< "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1"
+		<< "4k3/8/8/8/8/8/4P3/4K3 w - - 0 1"
+		<< "8/P6k/8/8/8/8/8/K7 w - - 0 1";
+
+	GameOutputWriter writer;
+	writer.setEpdOutput(fileName);
+	QVERIFY(writer.hasEpdOutput());
+	QVERIFY(!writer.hasGameOutput());
+
+	for (const QString& pos : positions)
+		writer.writeEpd(pos);
+	writer.finish();
+
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+	const QStringList lines = QString::fromUtf8(file.readAll())
+		.split('\n', QString::SkipEmptyParts);
+	QCOMPARE(lines, positions);
+	QCOMPARE(writer.stats().gameCount, 0);
+}
+
+void tst_GameOutputWriter::smallQueue()
+{
+	const QString fileName(m_dir.filePath("small.pgn"));
+	const int count = 50;
+
+	GameOutputWriter writer;
+	writer.setQueueCapacity(1);
+	writer.setPgnOutput(fileName, PgnGame::Minimal);
+	writer.setSyncPolicy(GameOutputWriter::GameSync);
+	for (int i = 1; i <= count; i++)
+		writer.writeGame(game(i), i);
+	writer.finish();
+	QCOMPARE(writer.stats().maxQueueDepth, 1);
+
+	// The writer starts again when new games are queued
+	writer.writeGame(game(count + 1), count + 1);
+	writer.finish();
+	QCOMPARE(writer.stats().gameCount, count + 1);
+
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	const auto games = readGames(file.readAll());
+	QCOMPARE(games.size(), count + 1);
+	QCOMPARE(games.last().round(), count + 1);
+}
+
+void tst_GameOutputWriter::gzip()
+{
+	const QString gzip(QStandardPaths::findExecutable("gzip"));
+	if (gzip.isEmpty())
+		QSKIP("gzip is not available");
+
+	const QString fileName(m_dir.filePath("games.pgn.gz"));
+	{
+		GameOutputWriter writer;
+		writer.setPgnOutput(fileName);
+		for (int i = 1; i <= 10; i++)
+		{
+			writer.writeGame(game(i), i);
+			// Flushing creates a new gzip member every time
+			if (i % 3 == 0)
+				writer.flush();
+		}
+	}
+
+	QProcess process;
+	process.start(gzip, QStringList() << "-dc" << fileName);
+	QVERIFY(process.waitForFinished());
+	QCOMPARE(process.exitStatus(), QProcess::NormalExit);
+	QCOMPARE(process.exitCode(), 0);
+
+	const auto games = readGames(process.readAllStandardOutput());
+	QCOMPARE(games.size(), 10);
+	for (int i = 0; i < games.size(); i++)
+		QCOMPARE(games.at(i).round(), i + 1);
+}
+
+QTEST_MAIN(tst_GameOutputWriter)
+#include "tst_gameoutputwriter.moc"
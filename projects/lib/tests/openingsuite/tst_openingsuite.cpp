@@ -0,0 +1,201 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <QRegularExpression>
+#include <openingsuite.h>
+
+static const char s_pgn[] =
+	"[Event \"Test\"]\n"
+	"[Result \"*\"]\n"
+	"\n"
+	"1. e4 e5 2. Nf3 Nc6 *\n"
+	"\n"
+	"[Event \"Test\"]\n"
+	"[Result \"*\"]\n"
+	"\n"
+	"1. d4 d5 *\n"
+	"\n"
+	"[Event \"Test\"]\n"
+	"[Result \"*\"]\n"
+	"\n"
+	"1. e4 e5 2. Bc4 *\n"
+	"\n"
+	"[Event \"Test\"]\n"
+	"[Result \"*\"]\n"
+	"\n"
+	"1. c4 *\n";
+
+static const char s_epd[] =
+	"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - id \"e4\";\n"
+	"8/8/8/8 w - - id \"broken\";\n"
+	"rnbqkbnr/pppppppp/8/8/3P4/8/PPP1PPPP/RNBQKBNR b KQkq - id \"d4\";\n"
+	"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - id \"e4\";\n";
+
+class tst_OpeningSuite: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void pgnSuite();
+		void epdSuite();
+		void startIndex_data() const;
+		void startIndex();
+		void cache();
+		void randomOrder();
+
+	private:
+		QString writeFile(const QString& name, const char* data);
+
+		QTemporaryDir m_dir;
+};
+
+void tst_OpeningSuite::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+}
+
+QString tst_OpeningSuite::writeFile(const QString& name, const char* data)
+{
+	const QString fileName(m_dir.filePath(name));
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly) || file.write(data) == -1)
+		return QString();
+
+	return fileName;
+}
+
+void tst_OpeningSuite::pgnSuite()
+{
+	const QString fileName(writeFile("suite.pgn", s_pgn));
+	QVERIFY(!fileName.isEmpty());
+
+	// The first and third games are the same when cut to 2 plies
+	OpeningSuite suite(fileName, OpeningSuite::PgnFormat,
+			   OpeningSuite::SequentialOrder, 1);
+	QVERIFY(suite.compile("standard", 2));
+	QVERIFY(suite.isCompiled());
+	QVERIFY(!suite.isNull());
+	QCOMPARE(suite.openingCount(), 3);
+	QVERIFY(suite.errorString().isEmpty());
+
+	// The start index is the second opening; the suite then wraps
+	const int plies[] = { 2, 1, 2, 2, 1 };
+	for (int count : plies)
+	{
+		const OpeningSuite::Opening opening(suite.nextOpening());
+		QVERIFY(opening.fen.isEmpty());
+		QCOMPARE(opening.moves.size(), count);
+	}
+}
+
+void tst_OpeningSuite::epdSuite()
+{
+	const QString fileName(writeFile("suite.epd", s_epd));
+	QVERIFY(!fileName.isEmpty());
+
+	QTest::ignoreMessage(QtWarningMsg,
+			     QRegularExpression("^Opening 2 in .*: invalid FEN"));
+	QTest::ignoreMessage(QtWarningMsg,
+			     QRegularExpression("^Skipped 1 broken openings"));
+
+	OpeningSuite suite(fileName, OpeningSuite::EpdFormat);
+	QVERIFY(suite.compile("standard", 8));
+	QCOMPARE(suite.openingCount(), 2);
+	QCOMPARE(suite.errorString().count('\n'), 1);
+	QVERIFY(suite.errorString().startsWith("Opening 2 in "));
+
+	OpeningSuite::Opening opening(suite.nextOpening());
+	QVERIFY(opening.fen.startsWith("rnbqkbnr/pppppppp/8/8/4P3/"));
+	QVERIFY(opening.moves.isEmpty());
+	opening = suite.nextOpening();
+	QVERIFY(opening.fen.startsWith("rnbqkbnr/pppppppp/8/8/3P4/"));
+}
+
+void tst_OpeningSuite::startIndex_data() const
+{
+	QTest::addColumn<int>("start");
+	QTest::addColumn<QString>("fen");
+
+	const QString e4("rnbqkbnr/pppppppp/8/8/4P3/");
+	const QString d4("rnbqkbnr/pppppppp/8/8/3P4/");
+
+	// The start index counts the broken and duplicate openings too
+	QTest::newRow("first") << 0 << e4;
+	QTest::newRow("broken") << 1 << d4;
+	QTest::newRow("kept") << 2 << d4;
+	QTest::newRow("duplicate") << 3 << e4;
+}
+
+void tst_OpeningSuite::startIndex()
+{
+	QFETCH(int, start);
+	QFETCH(QString, fen);
+
+	const QString fileName(writeFile("start.epd", s_epd));
+	const QString cacheFile(m_dir.filePath("start.cache"));
+	QVERIFY(!fileName.isEmpty());
+	QFile::remove(cacheFile);
+
+	QTest::ignoreMessage(QtWarningMsg,
+			     QRegularExpression("^Opening 2 in .*: invalid FEN"));
+	QTest::ignoreMessage(QtWarningMsg,
+			     QRegularExpression("^Skipped 1 broken openings"));
+
+	OpeningSuite suite1(fileName, OpeningSuite::EpdFormat,
+			    OpeningSuite::SequentialOrder, start);
+	QVERIFY(suite1.compile("standard", 8, cacheFile));
+	QVERIFY(suite1.nextOpening().fen.startsWith(fen));
+
+	// The cached suite starts at the same opening
+	OpeningSuite suite2(fileName, OpeningSuite::EpdFormat,
+			    OpeningSuite::SequentialOrder, start);
+	QVERIFY(suite2.compile("standard", 8, cacheFile));
+	QVERIFY(suite2.nextOpening().fen.startsWith(fen));
+}
+
+void tst_OpeningSuite::cache()
+{
+	const QString fileName(writeFile("cached.pgn", s_pgn));
+	const QString cacheFile(m_dir.filePath("cached.cache"));
+	QVERIFY(!fileName.isEmpty());
+
+	OpeningSuite suite1(fileName, OpeningSuite::PgnFormat);
+	QVERIFY(suite1.compile("standard", 3, cacheFile));
+	QVERIFY(QFile::exists(cacheFile));
+
+	OpeningSuite suite2(fileName, OpeningSuite::PgnFormat);
+	QVERIFY(suite2.compile("standard", 3, cacheFile));
+	QCOMPARE(suite2.openingCount(), suite1.openingCount());
+	for (int i = 0; i < suite1.openingCount(); i++)
+	{
+		const OpeningSuite::Opening opening1(suite1.nextOpening());
+		const OpeningSuite::Opening opening2(suite2.nextOpening());
+		QCOMPARE(opening2.fen, opening1.fen);
+		QVERIFY(opening2.moves == opening1.moves);
+	}
+
+	// A cache compiled with other settings is not used
+	OpeningSuite suite3(fileName, OpeningSuite::PgnFormat);
+	QVERIFY(suite3.compile("standard", 2, cacheFile));
+	QCOMPARE(suite3.openingCount(), 3);
+}
+
+void tst_OpeningSuite::randomOrder()
+{
+	const QString fileName(writeFile("random.pgn", s_pgn));
+	QVERIFY(!fileName.isEmpty());
+
+	OpeningSuite suite(fileName, OpeningSuite::PgnFormat,
+			   OpeningSuite::RandomOrder);
+	QVERIFY(suite.compile("standard", 8));
+	QCOMPARE(suite.openingCount(), 4);
+
+	// Every opening is played once before any is repeated
+	QSet<int> lengths;
+	for (int i = 0; i < suite.openingCount(); i++)
+		lengths.insert(suite.nextOpening().moves.size());
+	QCOMPARE(lengths, QSet<int>() << 4 << 2 << 3 << 1);
+}
+
+QTEST_MAIN(tst_OpeningSuite)
+#include "tst_openingsuite.moc"
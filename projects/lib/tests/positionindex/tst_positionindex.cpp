@@ -0,0 +1,141 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <pgngame.h>
+#include <pgnstream.h>
+#include <positionindex.h>
+#include <positionindexwriter.h>
+
+static const char s_pgn[] =
+	"[Event \"Test\"]\n"
+	"[Result \"*\"]\n"
+	"\n"
+	"1. e4 e5 2. Nf3 Nc6 *\n"
+	"\n"
+	"[Event \"Test\"]\n"
+	"[Result \"*\"]\n"
+	"\n"
+	"1. d4 d5 *\n"
+	"\n"
+	"[Event \"Test\"]\n"
+	"[Result \"*\"]\n"
+	"\n"
+	"1. e4 c5 *\n"
+	"\n"
+	"[Event \"Test\"]\n"
+	"[Result \"*\"]\n"
+	"\n"
+	"1. Nf3 Nc6 2. e4 e5 3. Nc3 *\n";
+
+class tst_PositionIndex: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void find();
+		void spilledRuns();
+		void invalidFile();
+
+	private:
+		QString writeIndex(const QString& name, int runSize);
+
+		QTemporaryDir m_dir;
+		QList<PgnGame> m_games;
+};
+
+void tst_PositionIndex::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+
+	const QByteArray data(s_pgn);
+	PgnStream in(&data);
+	PgnGame game;
+	while (game.read(in))
+		m_games.append(game);
+	QCOMPARE(m_games.size(), 4);
+}
+
+QString tst_PositionIndex::writeIndex(const QString& name, int runSize)
+{
+	const QString fileName(m_dir.filePath(name));
+
+	PositionIndexWriter writer;
+	writer.setRunSize(runSize);
+	if (!writer.open(fileName))
+		return QString();
+	for (const PgnGame& game : qAsConst(m_games))
+	{
+		if (!writer.addGame(game))
+			return QString();
+	}
+	if (!writer.close())
+		return QString();
+
+	return fileName;
+}
+
+void tst_PositionIndex::find()
+{
+	const QString fileName(writeIndex("find.idx",
+					  PositionIndexWriter::DefaultRunSize));
+	QVERIFY(!fileName.isEmpty());
+
+	PositionIndex index;
+	QVERIFY(index.open(fileName));
+	QCOMPARE(index.gameCount(), quint32(4));
+	// One posting per distinct position of each game
+	QCOMPARE(index.postingCount(), qint64(5 + 3 + 3 + 6));
+
+	const PgnGame& game = m_games.at(0);
+	QCOMPARE(index.find(game.moves().at(0).key),
+		 QVector<quint32>() << 0 << 1 << 2 << 3);
+	QCOMPARE(index.find(game.moves().at(1).key),
+		 QVector<quint32>() << 0 << 2);
+	// 1. e4 e5 2. Nf3 Nc6 is reached by transposition in the last game
+	QCOMPARE(index.find(game.key()),
+		 QVector<quint32>() << 0 << 3);
+	QCOMPARE(index.find(m_games.at(1).key()),
+		 QVector<quint32>() << 1);
+	QVERIFY(index.find(0).isEmpty());
+	QVERIFY(index.find(~quint64(0)).isEmpty());
+}
+
+void tst_PositionIndex::spilledRuns()
+{
+	const QString merged(writeIndex("merged.idx", 3));
+	const QString single(writeIndex("single.idx",
+					PositionIndexWriter::DefaultRunSize));
+	QVERIFY(!merged.isEmpty());
+	QVERIFY(!single.isEmpty());
+
+	QFile a(merged);
+	QFile b(single);
+	QVERIFY(a.open(QIODevice::ReadOnly));
+	QVERIFY(b.open(QIODevice::ReadOnly));
+	QCOMPARE(a.readAll(), b.readAll());
+}
+
+void tst_PositionIndex::invalidFile()
+{
+	PositionIndex index;
+	QVERIFY(!index.open(m_dir.filePath("missing.idx")));
+	QVERIFY(!index.isOpen());
+
+	QFile file(m_dir.filePath("invalid.idx"));
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	file.write(s_pgn);
+	file.close();
+	QVERIFY(!index.open(file.fileName()));
+
+	// Drop the last record
+	const QString fileName(writeIndex("truncated.idx",
+					  PositionIndexWriter::DefaultRunSize));
+	QVERIFY(!fileName.isEmpty());
+	QVERIFY(QFile::resize(fileName, QFileInfo(fileName).size()
+				 - PositionIndex::RecordSize));
+	QVERIFY(!index.open(fileName));
+	QVERIFY(!index.errorString().isEmpty());
+}
+
+QTEST_MAIN(tst_PositionIndex)
+#include "tst_positionindex.moc"
@@ -9,6 +9,8 @@ class tst_Sprt: public QObject
 	private slots:
 		void sprt_data() const;
 		void sprt();
+		void pentanomial_data() const;
+		void pentanomial();
 
 	private:
 		bool fuzzyCompare(double val1, double val2);
@@ -100,5 +102,73 @@ void tst_Sprt::sprt()
 	QVERIFY(fuzzyCompare(status.uBound, ubound));
 }
 
+void tst_Sprt::pentanomial_data() const
+{
+	QTest::addColumn<double>("elo0");
+	QTest::addColumn<double>("elo1");
+	QTest::addColumn<QVector<int>>("pairs");
+	QTest::addColumn<double>("llr");
+	QTest::addColumn<int>("result");
+
+	QTest::newRow("equal")
+		<< 0.0
+		<< 5.0
+		<< (QVector<int>() << 1000 << 5000 << 10000 << 5000 << 1000)
+		<< -4.56
+		<< int(Sprt::AcceptH0);
+
+	QTest::newRow("slightly better")
+		<< 0.0
+		<< 5.0
+		<< (QVector<int>() << 900 << 5000 << 10000 << 5100 << 1000)
+		<< 2.25
+		<< int(Sprt::Continue);
+
+	QTest::newRow("better")
+		<< 0.0
+		<< 2.0
+		<< (QVector<int>() << 461 << 3622 << 7613 << 3919 << 503)
+		<< 3.15
+		<< int(Sprt::AcceptH1);
+}
+
+void tst_Sprt::pentanomial()
+{
+	QFETCH(double, elo0);
+	QFETCH(double, elo1);
+	QFETCH(QVector<int>, pairs);
+	QFETCH(double, llr);
+	QFETCH(int, result);
+
+	const Sprt::GameResult pairResults[5][2] = {
+		{ Sprt::Loss, Sprt::Loss },
+		{ Sprt::Draw, Sprt::Loss },
+		{ Sprt::Win, Sprt::Loss },
+		{ Sprt::Win, Sprt::Draw },
+		{ Sprt::Win, Sprt::Win }
+	};
+
+	Sprt sprt;
+	sprt.initialize(elo0, elo1, 0.05, 0.05);
+	sprt.setModel(Sprt::Pentanomial);
+
+	for (int i = 0; i < 5; i++)
+	{
+		for (int j = 0; j < pairs.at(i); j++)
+			sprt.addGamePairResult(pairResults[i][0],
+					       pairResults[i][1]);
+	}
+
+	Sprt::Status status = sprt.status();
+	QVERIFY(fuzzyCompare(status.llr, llr));
+	QVERIFY(fuzzyCompare(status.lBound, -2.94));
+	QVERIFY(fuzzyCompare(status.uBound, 2.94));
+	QCOMPARE(int(status.result), result);
+
+	// Single games don't affect the pentanomial test
+	sprt.addGameResult(Sprt::Win);
+	QVERIFY(fuzzyCompare(sprt.status().llr, llr));
+}
+
 QTEST_MAIN(tst_Sprt)
 #include "tst_sprt.moc"
@@ -1,5 +1,8 @@
 TEMPLATE = subdirs
-SUBDIRS = chessboard tb sprt mersenne tournamentplayer tournamentpair polyglotbook
+SUBDIRS = chessboard tb sprt mersenne tournamentplayer tournamentpair polyglotbook gamearchive gameoutputwriter positionindex openingsuite cutesealconnection chessengine
 win32 {
     SUBDIRS += pipereader
 }
+unix {
+    SUBDIRS += cutesealdaemon
+}